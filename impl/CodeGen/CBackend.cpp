@@ -0,0 +1,648 @@
+
+#include "kaiju/CodeGen/CBackend.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+
+#include "kaiju/IR/AllocaInst.h"
+#include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/BranchInst.h"
+#include "kaiju/IR/CmpInst.h"
+#include "kaiju/IR/Constants.h"
+#include "kaiju/IR/LoadInst.h"
+#include "kaiju/IR/PhiNode.h"
+#include "kaiju/IR/ReturnInst.h"
+#include "kaiju/IR/StoreInst.h"
+
+namespace {
+
+const char *const Prologue =
+R"(/* Generated by kaiju. */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Called on operations without a defined result, such as division by
+   zero. */
+#ifndef KAIJU_TRAP
+#define KAIJU_TRAP() abort()
+#endif
+
+__extension__ typedef unsigned __int128 kaiju_u128;
+__extension__ typedef __int128 kaiju_i128;
+)";
+
+// Helpers for integers computed in $N bit variables of the unsigned type $U,
+// whose signed counterpart is $S. Widths w of the IR type are at most $N,
+// the callers truncate results to them.
+const char *const IntegerHelpers =
+R"(
+static inline $S kaiju_sext$N($U a, unsigned w) {
+    return ($S)(a << ($N - w)) >> ($N - w);
+}
+
+static inline $U kaiju_udiv$N($U a, $U b) {
+    if (b == 0)
+        KAIJU_TRAP();
+    return a / b;
+}
+
+static inline $U kaiju_urem$N($U a, $U b) {
+    if (b == 0)
+        KAIJU_TRAP();
+    return a % b;
+}
+
+static inline $U kaiju_sdiv$N($U a, $U b, unsigned w) {
+    $S x = kaiju_sext$N(a, w), y = kaiju_sext$N(b, w);
+    if (y == 0 || (y == -1 && a == ($U)1 << (w - 1)))
+        KAIJU_TRAP();
+    return ($U)(x / y);
+}
+
+static inline $U kaiju_srem$N($U a, $U b, unsigned w) {
+    $S x = kaiju_sext$N(a, w), y = kaiju_sext$N(b, w);
+    if (y == 0 || (y == -1 && a == ($U)1 << (w - 1)))
+        KAIJU_TRAP();
+    return ($U)(x % y);
+}
+
+static inline $U kaiju_shl$N($U a, $U b, unsigned w) {
+    if (b >= w)
+        KAIJU_TRAP();
+    return a << b;
+}
+
+static inline $U kaiju_lshr$N($U a, $U b, unsigned w) {
+    if (b >= w)
+        KAIJU_TRAP();
+    return a >> b;
+}
+
+static inline $U kaiju_ashr$N($U a, $U b, unsigned w) {
+    if (b >= w)
+        KAIJU_TRAP();
+    return ($U)(kaiju_sext$N(a, w) >> b);
+}
+)";
+
+const char *const MulHighHelpers =
+R"(
+static inline uint32_t kaiju_mulhu32(uint32_t a, uint32_t b, unsigned w) {
+    return (uint32_t)((uint64_t)a * b >> w);
+}
+
+static inline uint32_t kaiju_mulhs32(uint32_t a, uint32_t b, unsigned w) {
+    return (uint32_t)((int64_t)kaiju_sext32(a, w) * kaiju_sext32(b, w) >> w);
+}
+
+static inline uint64_t kaiju_mulhu64(uint64_t a, uint64_t b, unsigned w) {
+    return (uint64_t)((kaiju_u128)a * b >> w);
+}
+
+static inline uint64_t kaiju_mulhs64(uint64_t a, uint64_t b, unsigned w) {
+    return (uint64_t)((kaiju_i128)kaiju_sext64(a, w) * kaiju_sext64(b, w)
+                      >> w);
+}
+
+static inline kaiju_u128 kaiju_mulhu128(kaiju_u128 a, kaiju_u128 b,
+                                        unsigned w) {
+    kaiju_u128 al = (uint64_t)a, ah = a >> 64;
+    kaiju_u128 bl = (uint64_t)b, bh = b >> 64;
+    kaiju_u128 ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+    kaiju_u128 mid = (ll >> 64) + (uint64_t)lh + (uint64_t)hl;
+    kaiju_u128 lo = mid << 64 | (uint64_t)ll;
+    kaiju_u128 hi = hh + (lh >> 64) + (hl >> 64) + (mid >> 64);
+    return w == 128 ? hi : lo >> w | hi << (128 - w);
+}
+
+static inline kaiju_u128 kaiju_mulhs128(kaiju_u128 a, kaiju_u128 b,
+                                        unsigned w) {
+    kaiju_u128 hi = kaiju_mulhu128(a, b, w);
+    if (a >> (w - 1) & 1)
+        hi -= b;
+    if (b >> (w - 1) & 1)
+        hi -= a;
+    return hi;
+}
+)";
+
+// \brief Returns \p Text with every $N, $U and $S replaced.
+std::string instantiate(const char *Text, const char *N, const char *U,
+                        const char *S) {
+    std::string Out;
+    for (const char *P = Text; *P; ++P) {
+        if (*P != '$') {
+            Out += *P;
+            continue;
+        }
+
+        switch (*++P) {
+        case 'N': Out += N; break;
+        case 'U': Out += U; break;
+        case 'S': Out += S; break;
+        }
+    }
+
+    return Out;
+}
+
+// \brief Returns the width of the C variables integers of width \p W are
+// computed in.
+unsigned getComputeWidth(unsigned W) {
+    return W <= 32 ? 32 : W <= 64 ? 64 : 128;
+}
+
+// \brief Returns the C type values of type \p Ty are held in while
+// computing.
+std::string getComputeType(const Type *Ty) {
+    if (const IntegerType *IT = dyn_cast<IntegerType>(Ty)) {
+        switch (getComputeWidth(IT->getBitWidth())) {
+        case 32: return "uint32_t";
+        case 64: return "uint64_t";
+        default: return "kaiju_u128";
+        }
+    }
+
+    switch (Ty->getTypeID()) {
+    case Type::HalfTyID:
+    case Type::FloatTyID:
+        return "float";
+    case Type::DoubleTyID:
+        return "double";
+    case Type::PointerTyID:
+        return "void *";
+    default:
+        assert(Ty->getTypeID() == Type::VoidTyID && "unsupported type.");
+        return "void";
+    }
+}
+
+// \brief Returns the C type of arguments and results of type \p Ty.
+std::string getInterfaceType(const Type *Ty) {
+    if (const IntegerType *IT = dyn_cast<IntegerType>(Ty)) {
+        unsigned W = IT->getBitWidth();
+        return W <= 8  ? "uint8_t"
+             : W <= 16 ? "uint16_t"
+             : W <= 32 ? "uint32_t"
+             : W <= 64 ? "uint64_t"
+                       : "kaiju_u128";
+    }
+
+    return getComputeType(Ty);
+}
+
+// \brief Returns \p V as a C integer constant of the type integers of
+// width \p W are computed in.
+std::string getIntegerLiteral(uint128_t V, unsigned W) {
+    char Buf[96];
+
+    switch (getComputeWidth(W)) {
+    case 32:
+        std::snprintf(Buf, sizeof(Buf), "0x%lxu", (unsigned long)V);
+        return Buf;
+
+    case 64:
+        std::snprintf(Buf, sizeof(Buf), "UINT64_C(0x%llx)",
+                      (unsigned long long)V);
+        return Buf;
+    }
+
+    if (!(V >> 64)) {
+        std::snprintf(Buf, sizeof(Buf), "(kaiju_u128)UINT64_C(0x%llx)",
+                      (unsigned long long)V);
+        return Buf;
+    }
+
+    std::snprintf(Buf, sizeof(Buf),
+                  "((kaiju_u128)UINT64_C(0x%llx) << 64 | UINT64_C(0x%llx))",
+                  (unsigned long long)(V >> 64), (unsigned long long)V);
+    return Buf;
+}
+
+// \brief Returns \p V as a C floating point constant, exactly, as a hex
+// float.
+std::string getFPLiteral(double V, bool Double) {
+    if (!Double)
+        V = (float)V;
+
+    if (std::isnan(V))
+        return "NAN";
+    if (std::isinf(V))
+        return V < 0 ? "-INFINITY" : "INFINITY";
+
+    char Buf[64];
+    std::snprintf(Buf, sizeof(Buf), Double ? "%a" : "%af", V);
+    return Buf;
+}
+
+// \brief Names the output cannot give to a function of its own: the C99
+// keywords, main, and what <math.h> and <stdlib.h> declare without an
+// underscore in the name. Sorted.
+const char *const ReservedNames[] = {
+    "INFINITY", "NAN", "NULL", "abort", "abs", "acos", "acosh", "asin",
+    "asinh", "atan", "atan2", "atanh", "atexit", "atof", "atoi", "atol",
+    "atoll", "auto", "break", "bsearch", "calloc", "case", "cbrt", "ceil",
+    "char", "const", "continue", "copysign", "cos", "cosh", "default", "div",
+    "do", "double", "else", "enum", "erf", "erfc", "exit", "exp", "exp2",
+    "expm1", "extern", "fabs", "fdim", "float", "floor", "fma", "fmax",
+    "fmin", "fmod", "for", "fpclassify", "free", "frexp", "getenv", "goto",
+    "hypot", "if", "ilogb", "inline", "int", "isfinite", "isgreater",
+    "isgreaterequal", "isinf", "isless", "islessequal", "islessgreater",
+    "isnan", "isnormal", "isunordered", "labs", "ldexp", "ldiv", "lgamma",
+    "llabs", "lldiv", "llrint", "llround", "log", "log10", "log1p", "log2",
+    "logb", "long", "lrint", "lround", "main", "malloc", "mblen", "mbstowcs",
+    "mbtowc", "modf", "nan", "nearbyint", "nextafter", "nexttoward", "pow",
+    "qsort", "rand", "realloc", "register", "remainder", "remquo", "restrict",
+    "return", "rint", "round", "scalbln", "scalbn", "short", "signbit",
+    "signed", "sin", "sinh", "sizeof", "sqrt", "srand", "static", "strtod",
+    "strtof", "strtol", "strtold", "strtoll", "strtoul", "strtoull", "struct",
+    "switch", "system", "tan", "tanh", "tgamma", "trunc", "typedef", "union",
+    "unsigned", "void", "volatile", "wcstombs", "wctomb", "while",
+};
+
+// \brief Returns whether \p Id, or \p Id without an f or l suffix as in
+// sqrtf and sqrtl, is one of the ReservedNames.
+bool isReservedName(const std::string &Id) {
+    auto Less = [](const char *L, const char *R) {
+        return std::strcmp(L, R) < 0;
+    };
+    auto Contains = [&](const std::string &S) {
+        return std::binary_search(std::begin(ReservedNames),
+                                  std::end(ReservedNames), S.c_str(), Less);
+    };
+
+    if (Contains(Id))
+        return true;
+    char Last = Id.back();
+    return (Last == 'f' || Last == 'l')
+        && Contains(Id.substr(0, Id.size() - 1));
+}
+
+// \brief Returns the C identifier of a function named \p Name, different
+// for different names; see emitC().
+std::string getIdentifier(StringRef Name) {
+    std::string Id;
+    for (char C : Name) {
+        if (std::isalnum((unsigned char)C)) {
+            Id += C;
+        } else if (C == '_') {
+            Id += "__";
+        } else {
+            char Hex[4];
+            std::snprintf(Hex, sizeof(Hex), "_%02X", (unsigned char)C);
+            Id += Hex;
+        }
+    }
+
+    // Names kept as they are never start with kaiju_, so the prefixed ones
+    // are distinct from them, and from the helpers, none of which starts
+    // with kaiju_fn_.
+    if (Id.empty() || Id[0] == '_' || std::isdigit((unsigned char)Id[0])
+        || Id.compare(0, 6, "kaiju_") == 0 || Id.compare(0, 6, "KAIJU_") == 0
+        || isReservedName(Id))
+        Id.insert(0, "kaiju_fn_");
+    return Id;
+}
+
+// Class CWriter
+//
+// \brief Writes functions as C.
+//
+// Arguments are named a0, a1, ..., the values of instructions v0, v1, ...,
+// stack slots s0, s1, ... and blocks bb0, bb1, .... Integers are kept in
+// variables of the compute width, zero extended from their own width. Phi
+// nodes are variables assigned on the edges into their block.
+//
+class CWriter {
+    raw_ostream &OS;
+
+    std::map<const Value *, std::string> Names;
+    std::map<const BasicBlock *, unsigned> Blocks;
+    std::map<const AllocaInst *, unsigned> Slots;
+
+    std::string getOperand(const Value *V) const;
+
+    std::string getLabel(const BasicBlock *BB) const {
+        return "bb" + std::to_string(Blocks.find(BB)->second);
+    }
+
+    void writeBinaryOperator(const BinaryOperator *I);
+    void writeCmpInst(const CmpInst *I);
+
+    // \brief Writes the phi copies of the edge from \p From to \p To and
+    // the jump, indented by \p Indent.
+    void writeJump(const BasicBlock *From, const BasicBlock *To,
+                   const char *Indent);
+
+    void writeInstruction(const Instruction *I);
+
+public:
+    explicit CWriter(raw_ostream &S) : OS(S) { /* empty */ }
+
+    void writePrologue();
+    void writeFunction(const Function &Fn);
+};
+
+std::string CWriter::getOperand(const Value *V) const {
+    auto It = Names.find(V);
+    if (It != Names.end())
+        return It->second;
+
+    Type *Ty = V->getValueType();
+    if (const ConstantInt *CI = dyn_cast<ConstantInt>(V))
+        return getIntegerLiteral(CI->getZExtValue(),
+                                 cast<IntegerType>(Ty)->getBitWidth());
+    if (const ConstantFP *CF = dyn_cast<ConstantFP>(V))
+        return getFPLiteral(CF->getValue(),
+                            Ty->getTypeID() == Type::DoubleTyID);
+
+    assert(isa<UndefValue>(V) && "value has no name.");
+    return Ty->getTypeID() == Type::PointerTyID ? "(void *)0" : "0";
+}
+
+void CWriter::writePrologue() {
+    OS << Prologue
+       << instantiate(IntegerHelpers, "32", "uint32_t", "int32_t")
+       << instantiate(IntegerHelpers, "64", "uint64_t", "int64_t")
+       << instantiate(IntegerHelpers, "128", "kaiju_u128", "kaiju_i128")
+       << MulHighHelpers;
+}
+
+void CWriter::writeBinaryOperator(const BinaryOperator *I) {
+    std::string X = getOperand(I->getLHS()), Y = getOperand(I->getRHS());
+    Type *Ty = I->getValueType();
+    const IntegerType *IT = dyn_cast<IntegerType>(Ty);
+
+    if (!IT) {
+        const char *Op = nullptr;
+        switch (I->getOpcode()) {
+        case Instruction::Add: Op = " + "; break;
+        case Instruction::Sub: Op = " - "; break;
+        case Instruction::Mul: Op = " * "; break;
+        case Instruction::Div: Op = " / "; break;
+        case Instruction::Rem:
+            OS << (Ty->getTypeID() == Type::DoubleTyID ? "fmod(" : "fmodf(")
+               << X << ", " << Y << ");\n";
+            return;
+        default:
+            assert(false && "invalid floating point operation.");
+            break;
+        }
+
+        OS << X << Op << Y << ";\n";
+        return;
+    }
+
+    unsigned W = IT->getBitWidth(), N = getComputeWidth(W);
+    std::string Args = "(" + X + ", " + Y + ", " + std::to_string(W) + ")";
+    std::string Expr;
+    bool Truncate = true;
+
+    switch (I->getOpcode()) {
+    case Instruction::Add:   Expr = X + " + " + Y; break;
+    case Instruction::Sub:   Expr = X + " - " + Y; break;
+    case Instruction::Mul:   Expr = X + " * " + Y; break;
+    case Instruction::And:   Expr = X + " & " + Y; Truncate = false; break;
+    case Instruction::Div:   Expr = "kaiju_sdiv"; break;
+    case Instruction::Rem:   Expr = "kaiju_srem"; break;
+    case Instruction::UDiv:  Expr = "kaiju_udiv"; Truncate = false; break;
+    case Instruction::URem:  Expr = "kaiju_urem"; Truncate = false; break;
+    case Instruction::Shl:   Expr = "kaiju_shl"; break;
+    case Instruction::LShr:  Expr = "kaiju_lshr"; Truncate = false; break;
+    case Instruction::AShr:  Expr = "kaiju_ashr"; break;
+    case Instruction::MulHS: Expr = "kaiju_mulhs"; break;
+    case Instruction::MulHU: Expr = "kaiju_mulhu"; break;
+    }
+
+    // Helpers are suffixed with the compute width, unsigned division takes
+    // no width.
+    if (Expr.compare(0, 6, "kaiju_") == 0) {
+        Expr += std::to_string(N);
+        if (I->getOpcode() == Instruction::UDiv
+         || I->getOpcode() == Instruction::URem)
+            Expr += "(" + X + ", " + Y + ")";
+        else
+            Expr += Args;
+    }
+
+    if (Truncate && W != N)
+        OS << "(" << Expr << ") & "
+           << getIntegerLiteral(maskTrailingOnes(W), W);
+    else
+        OS << Expr;
+    OS << ";\n";
+}
+
+void CWriter::writeCmpInst(const CmpInst *I) {
+    std::string X = getOperand(I->getLHS()), Y = getOperand(I->getRHS());
+    unsigned W = cast<IntegerType>(I->getLHS()->getValueType())->getBitWidth();
+
+    const char *Op = nullptr;
+    bool Signed = false;
+    switch (I->getPredicate()) {
+    case CmpInst::EQ:  Op = " == "; break;
+    case CmpInst::NE:  Op = " != "; break;
+    case CmpInst::ULT: Op = " < "; break;
+    case CmpInst::ULE: Op = " <= "; break;
+    case CmpInst::UGT: Op = " > "; break;
+    case CmpInst::UGE: Op = " >= "; break;
+    case CmpInst::SLT: Op = " < "; Signed = true; break;
+    case CmpInst::SLE: Op = " <= "; Signed = true; break;
+    case CmpInst::SGT: Op = " > "; Signed = true; break;
+    case CmpInst::SGE: Op = " >= "; Signed = true; break;
+    }
+
+    if (Signed) {
+        std::string Sext = "kaiju_sext" + std::to_string(getComputeWidth(W));
+        std::string Width = ", " + std::to_string(W) + ")";
+        X = Sext + "(" + X + Width;
+        Y = Sext + "(" + Y + Width;
+    }
+
+    OS << X << Op << Y << ";\n";
+}
+
+void CWriter::writeJump(const BasicBlock *From, const BasicBlock *To,
+                        const char *Indent) {
+    std::vector<std::pair<const PhiNode *, std::string>> Copies;
+
+    for (const Instruction *I : *To) {
+        const PhiNode *Phi = dyn_cast<PhiNode>(I);
+        if (!Phi)
+            break;
+
+        for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i) {
+            if (Phi->getIncomingBlock(i) != From)
+                continue;
+
+            Copies.push_back(std::make_pair(Phi,
+                getOperand(Phi->getIncomingValue(i))));
+            break;
+        }
+    }
+
+    // The copies are parallel, a phi node may be the operand of another.
+    if (Copies.size() == 1)
+        OS << Indent << getOperand(Copies[0].first) << " = "
+           << Copies[0].second << ";\n";
+    else if (!Copies.empty()) {
+        OS << Indent << "{\n";
+        for (unsigned i = 0, e = Copies.size(); i != e; ++i)
+            OS << Indent << "    "
+               << getComputeType(Copies[i].first->getValueType())
+               << " t" << i << " = " << Copies[i].second << ";\n";
+        for (unsigned i = 0, e = Copies.size(); i != e; ++i)
+            OS << Indent << "    " << getOperand(Copies[i].first)
+               << " = t" << i << ";\n";
+        OS << Indent << "}\n";
+    }
+
+    OS << Indent << "goto " << getLabel(To) << ";\n";
+}
+
+void CWriter::writeInstruction(const Instruction *I) {
+    if (isa<PhiNode>(I))
+        return;
+
+    if (const BranchInst *Br = dyn_cast<BranchInst>(I)) {
+        const BasicBlock *BB = I->getParent();
+        if (Br->isUnconditional())
+            return writeJump(BB, Br->getSuccessor(0), "    ");
+
+        OS << "    if (" << getOperand(Br->getCondition()) << ") {\n";
+        writeJump(BB, Br->getSuccessor(0), "        ");
+        OS << "    }\n";
+        return writeJump(BB, Br->getSuccessor(1), "    ");
+    }
+
+    if (const ReturnInst *Ret = dyn_cast<ReturnInst>(I)) {
+        if (Value *RV = Ret->getReturnValue())
+            OS << "    return " << getOperand(RV) << ";\n";
+        else
+            OS << "    return;\n";
+        return;
+    }
+
+    if (const StoreInst *SI = dyn_cast<StoreInst>(I)) {
+        OS << "    *(" << getComputeType(SI->getValueOperand()->getValueType())
+           << " *)" << getOperand(SI->getPointerOperand()) << " = "
+           << getOperand(SI->getValueOperand()) << ";\n";
+        return;
+    }
+
+    OS << "    " << getOperand(I) << " = ";
+
+    if (const BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I))
+        writeBinaryOperator(BinOp);
+    else if (const CmpInst *Cmp = dyn_cast<CmpInst>(I))
+        writeCmpInst(Cmp);
+    else if (const AllocaInst *AI = dyn_cast<AllocaInst>(I))
+        OS << "&s" << Slots[AI] << ";\n";
+    else if (const LoadInst *LI = dyn_cast<LoadInst>(I))
+        OS << "*(" << getComputeType(I->getValueType()) << " *)"
+           << getOperand(LI->getPointerOperand()) << ";\n";
+    else
+        assert(false && "unsupported instruction.");
+}
+
+void CWriter::writeFunction(const Function &Fn) {
+    Names.clear();
+    Blocks.clear();
+    Slots.clear();
+
+    OS << "\n" << getInterfaceType(Fn.getReturnType()) << " "
+       << getIdentifier(Fn.getName()) << "(";
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i)
+        OS << (i ? ", " : "")
+           << getInterfaceType(Fn.getArg(i)->getValueType()) << " p" << i;
+    OS << (Fn.arg_size() ? ") {\n" : "void) {\n");
+
+    // Arguments are truncated to their width on entry, as by the
+    // Interpreter.
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i) {
+        Type *Ty = Fn.getArg(i)->getValueType();
+        std::string Name = "a" + std::to_string(i);
+        Names[Fn.getArg(i)] = Name;
+
+        OS << "    " << getComputeType(Ty) << " " << Name << " = p" << i;
+        if (const IntegerType *IT = dyn_cast<IntegerType>(Ty)) {
+            unsigned W = IT->getBitWidth();
+            if (W != 8 && W != 16 && W != 32 && W != 64 && W != 128)
+                OS << " & " << getIntegerLiteral(maskTrailingOnes(W), W);
+        }
+        OS << ";\n";
+    }
+
+    std::set<const BasicBlock *> Targets;
+    unsigned NumValues = 0;
+    for (const BasicBlock *BB : Fn) {
+        unsigned Index = Blocks.size();
+        Blocks[BB] = Index;
+
+        for (const Instruction *I : *BB) {
+            if (const BranchInst *Br = dyn_cast<BranchInst>(I))
+                for (unsigned i = 0, e = Br->getNumSuccessors(); i != e; ++i)
+                    Targets.insert(Br->getSuccessor(i));
+
+            if (const AllocaInst *AI = dyn_cast<AllocaInst>(I)) {
+                unsigned Slot = Slots.size();
+                Slots[AI] = Slot;
+                OS << "    " << getComputeType(AI->getAllocatedType())
+                   << " s" << Slot << ";\n";
+            }
+
+            if (I->getValueType()->getTypeID() == Type::VoidTyID)
+                continue;
+
+            std::string Name = "v" + std::to_string(NumValues++);
+            Names[I] = Name;
+            OS << "    " << getComputeType(I->getValueType()) << " " << Name
+               << ";\n";
+        }
+    }
+
+    if (Fn.empty())
+        OS << "    KAIJU_TRAP();\n";
+
+    for (const BasicBlock *BB : Fn) {
+        if (Targets.count(BB))
+            OS << getLabel(BB) << ":\n";
+
+        for (const Instruction *I : *BB)
+            writeInstruction(I);
+
+        // Reaching the end of a block without a terminator traps.
+        if (!BB->getTerminator())
+            OS << "    KAIJU_TRAP();\n";
+    }
+
+    OS << "}\n";
+}
+
+} // end anonymous namespace
+
+void kaiju::emitC(const std::vector<const Function *> &Fns, raw_ostream &OS) {
+    CWriter W(OS);
+    W.writePrologue();
+
+    for (const Function *Fn : Fns)
+        W.writeFunction(*Fn);
+}
+
+void kaiju::emitC(const TranslationUnit &TU, raw_ostream &OS) {
+    std::vector<const Function *> Fns;
+    for (auto &Entry : TU.getFunctions())
+        Fns.push_back(Entry.second);
+
+    emitC(Fns, OS);
+}
@@ -0,0 +1,263 @@
+
+#include "kaiju/CodeGen/ELFObjectWriter.h"
+
+using namespace kaiju;
+
+#include <cstring>
+#include <string>
+
+#include "kaiju/CodeGen/X86CodeGen.h"
+
+namespace {
+
+// Sections, in the order of the section header table.
+enum SectionIndex {
+    SecNull,
+    SecText,
+    SecRodata,
+    SecRelaText,
+    SecSymtab,
+    SecStrtab,
+    SecNoteGNUStack,
+    SecShstrtab,
+    NumSections,
+};
+
+const char *const SectionNames[] = {
+    "", ".text", ".rodata", ".rela.text", ".symtab", ".strtab",
+    ".note.GNU-stack", ".shstrtab",
+};
+
+// Constants of the ELF specification and the x86-64 psABI.
+const unsigned EHdrSize = 64;
+const unsigned SHdrSize = 64;
+const unsigned SymSize = 24;
+const unsigned RelaSize = 24;
+
+const uint16_t ET_REL = 1;
+const uint16_t EM_X86_64 = 62;
+
+const uint32_t SHT_PROGBITS = 1;
+const uint32_t SHT_SYMTAB = 2;
+const uint32_t SHT_STRTAB = 3;
+const uint32_t SHT_RELA = 4;
+
+const uint64_t SHF_ALLOC = 0x2;
+const uint64_t SHF_EXECINSTR = 0x4;
+const uint64_t SHF_INFO_LINK = 0x40;
+
+const uint8_t STT_FUNC = 2;
+const uint8_t STT_SECTION = 3;
+const uint8_t STB_LOCAL = 0;
+const uint8_t STB_GLOBAL = 1;
+
+const uint32_t R_X86_64_PC32 = 2;
+
+// The symbol table starts with the null symbol and the section symbols of
+// .text and .rodata, the function symbols follow.
+const unsigned SymText = 1;
+const unsigned SymRodata = 2;
+const unsigned NumLocalSymbols = 3;
+
+uint64_t alignTo(uint64_t V, uint64_t Align) {
+    return (V + Align - 1) / Align * Align;
+}
+
+// Class ObjectBuffer
+//
+// \brief Writes little endian fields at given offsets of a buffer sized in
+// advance.
+//
+class ObjectBuffer {
+    std::vector<uint8_t> &Buffer;
+
+public:
+    // ctor.
+    ObjectBuffer(std::vector<uint8_t> &B, std::size_t Size) : Buffer(B) {
+        Buffer.assign(Size, 0);
+    }
+
+    void write8(uint64_t Offset, uint8_t V) { Buffer[Offset] = V; }
+
+    void write16(uint64_t Offset, uint16_t V) {
+        for (unsigned i = 0; i != 2; ++i)
+            Buffer[Offset + i] = V >> (8 * i);
+    }
+
+    void write32(uint64_t Offset, uint32_t V) {
+        for (unsigned i = 0; i != 4; ++i)
+            Buffer[Offset + i] = V >> (8 * i);
+    }
+
+    void write64(uint64_t Offset, uint64_t V) {
+        for (unsigned i = 0; i != 8; ++i)
+            Buffer[Offset + i] = V >> (8 * i);
+    }
+
+    void writeBytes(uint64_t Offset, const void *Data, std::size_t Size) {
+        if (Size)
+            std::memcpy(&Buffer[Offset], Data, Size);
+    }
+};
+
+// \brief A section's place in the file.
+struct SectionLayout {
+    uint64_t Offset;
+    uint64_t Size;
+};
+
+} // end anonymous namespace
+
+bool kaiju::writeELFObject(const std::vector<Function *> &Fns,
+                           std::vector<uint8_t> &Buffer) {
+    Buffer.clear();
+
+    std::vector<X86MachineCode> Code(Fns.size());
+    for (std::size_t i = 0, e = Fns.size(); i != e; ++i)
+        if (!compileToX86(*Fns[i], Code[i]))
+            return false;
+
+    // Functions are placed 16 byte aligned in .text, their constant pools
+    // one after the other in .rodata.
+    std::vector<uint64_t> TextOffsets, RodataOffsets;
+    uint64_t TextSize = 0, RodataSize = 0, NumRelocs = 0;
+    for (const X86MachineCode &MC : Code) {
+        TextSize = alignTo(TextSize, 16);
+        TextOffsets.push_back(TextSize);
+        TextSize += MC.Text.size();
+
+        RodataOffsets.push_back(RodataSize);
+        RodataSize += 8 * MC.Constants.size();
+        NumRelocs += MC.ConstantRefs.size();
+    }
+
+    std::string Strtab(1, '\0');
+    std::vector<uint32_t> NameOffsets;
+    for (const Function *Fn : Fns) {
+        NameOffsets.push_back(Strtab.size());
+        Strtab += Fn->getName().str();
+        Strtab += '\0';
+    }
+
+    std::string Shstrtab;
+    uint32_t ShNames[NumSections];
+    for (unsigned i = 0; i != NumSections; ++i) {
+        ShNames[i] = Shstrtab.size();
+        Shstrtab += SectionNames[i];
+        Shstrtab += '\0';
+    }
+
+    SectionLayout Layout[NumSections] = {};
+    uint64_t Offset = EHdrSize;
+    auto place = [&](unsigned Sec, uint64_t Size, uint64_t Align) {
+        Offset = alignTo(Offset, Align);
+        Layout[Sec] = SectionLayout { Offset, Size };
+        Offset += Size;
+    };
+
+    place(SecText, TextSize, 16);
+    place(SecRodata, RodataSize, 8);
+    place(SecRelaText, NumRelocs * RelaSize, 8);
+    place(SecSymtab, (NumLocalSymbols + Fns.size()) * SymSize, 8);
+    place(SecStrtab, Strtab.size(), 1);
+    place(SecNoteGNUStack, 0, 1);
+    place(SecShstrtab, Shstrtab.size(), 1);
+    uint64_t SHOffset = alignTo(Offset, 8);
+
+    ObjectBuffer Out(Buffer, SHOffset + NumSections * SHdrSize);
+
+    // The ELF header.
+    static const uint8_t Ident[] = {
+        0x7F, 'E', 'L', 'F',
+        2,      // ELFCLASS64
+        1,      // ELFDATA2LSB
+        1,      // EV_CURRENT
+        0,      // ELFOSABI_SYSV
+    };
+    Out.writeBytes(0, Ident, sizeof(Ident));
+    Out.write16(16, ET_REL);
+    Out.write16(18, EM_X86_64);
+    Out.write32(20, 1);
+    Out.write64(40, SHOffset);
+    Out.write16(52, EHdrSize);
+    Out.write16(58, SHdrSize);
+    Out.write16(60, NumSections);
+    Out.write16(62, SecShstrtab);
+
+    // Code, constant pools and the relocations between them.
+    uint64_t Rela = Layout[SecRelaText].Offset;
+    for (std::size_t i = 0, e = Code.size(); i != e; ++i) {
+        const X86MachineCode &MC = Code[i];
+        Out.writeBytes(Layout[SecText].Offset + TextOffsets[i],
+                       MC.Text.data(), MC.Text.size());
+
+        for (std::size_t k = 0, n = MC.Constants.size(); k != n; ++k)
+            Out.write64(Layout[SecRodata].Offset + RodataOffsets[i] + 8 * k,
+                        MC.Constants[k]);
+
+        // The displacement is relative to the end of the instruction, which
+        // it ends.
+        for (const X86MachineCode::ConstantRef &Ref : MC.ConstantRefs) {
+            Out.write64(Rela, TextOffsets[i] + Ref.Offset);
+            Out.write64(Rela + 8, uint64_t(SymRodata) << 32 | R_X86_64_PC32);
+            Out.write64(Rela + 16, RodataOffsets[i] + 8 * Ref.Index - 4);
+            Rela += RelaSize;
+        }
+    }
+
+    // The symbol table, the null symbol is all zeros.
+    uint64_t Sym = Layout[SecSymtab].Offset;
+    Out.write8(Sym + SymText * SymSize + 4, STB_LOCAL << 4 | STT_SECTION);
+    Out.write16(Sym + SymText * SymSize + 6, SecText);
+    Out.write8(Sym + SymRodata * SymSize + 4, STB_LOCAL << 4 | STT_SECTION);
+    Out.write16(Sym + SymRodata * SymSize + 6, SecRodata);
+
+    for (std::size_t i = 0, e = Fns.size(); i != e; ++i) {
+        uint64_t S = Sym + (NumLocalSymbols + i) * SymSize;
+        Out.write32(S, NameOffsets[i]);
+        Out.write8(S + 4, STB_GLOBAL << 4 | STT_FUNC);
+        Out.write16(S + 6, SecText);
+        Out.write64(S + 8, TextOffsets[i]);
+        Out.write64(S + 16, Code[i].Text.size());
+    }
+
+    Out.writeBytes(Layout[SecStrtab].Offset, Strtab.data(), Strtab.size());
+    Out.writeBytes(Layout[SecShstrtab].Offset, Shstrtab.data(),
+                   Shstrtab.size());
+
+    // The section headers, the first is all zeros.
+    auto writeHeader = [&](unsigned Sec, uint32_t Type, uint64_t Flags,
+                           uint32_t Link, uint32_t Info, uint64_t Align,
+                           uint64_t EntSize) {
+        uint64_t H = SHOffset + Sec * SHdrSize;
+        Out.write32(H, ShNames[Sec]);
+        Out.write32(H + 4, Type);
+        Out.write64(H + 8, Flags);
+        Out.write64(H + 24, Layout[Sec].Offset);
+        Out.write64(H + 32, Layout[Sec].Size);
+        Out.write32(H + 40, Link);
+        Out.write32(H + 44, Info);
+        Out.write64(H + 48, Align);
+        Out.write64(H + 56, EntSize);
+    };
+
+    writeHeader(SecText, SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR, 0, 0, 16, 0);
+    writeHeader(SecRodata, SHT_PROGBITS, SHF_ALLOC, 0, 0, 8, 0);
+    writeHeader(SecRelaText, SHT_RELA, SHF_INFO_LINK, SecSymtab, SecText, 8,
+                RelaSize);
+    writeHeader(SecSymtab, SHT_SYMTAB, 0, SecStrtab, NumLocalSymbols, 8,
+                SymSize);
+    writeHeader(SecStrtab, SHT_STRTAB, 0, 0, 0, 1, 0);
+    writeHeader(SecNoteGNUStack, SHT_PROGBITS, 0, 0, 0, 1, 0);
+    writeHeader(SecShstrtab, SHT_STRTAB, 0, 0, 0, 1, 0);
+    return true;
+}
+
+bool kaiju::writeELFObject(const TranslationUnit &TU,
+                           std::vector<uint8_t> &Buffer) {
+    std::vector<Function *> Fns;
+    for (auto &Entry : TU.getFunctions())
+        Fns.push_back(Entry.second);
+
+    return writeELFObject(Fns, Buffer);
+}
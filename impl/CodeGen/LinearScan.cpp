@@ -0,0 +1,269 @@
+
+#include "kaiju/CodeGen/LinearScan.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+
+const unsigned NoUse = ~0u;
+
+} // end anonymous namespace
+
+unsigned LinearScan::addInterval(unsigned Class, unsigned Start, unsigned End,
+                                 const unsigned *UseBegin,
+                                 const unsigned *UseEnd, unsigned Hint) {
+    assert(Class < Registers.size() && "unknown register class.");
+    assert(Start <= End && "empty interval.");
+
+    unsigned Begin = Uses.size();
+    Uses.insert(Uses.end(), UseBegin, UseEnd);
+    Intervals.push_back(Interval { Class, Start, End, Begin,
+                                   (unsigned)Uses.size(), Hint });
+    return Intervals.size() - 1;
+}
+
+unsigned LinearScan::getNextUse(const Piece &P, unsigned Pos) const {
+    const Interval &I = Intervals[P.Interval];
+    const unsigned *Begin = Uses.data() + I.UseBegin;
+    const unsigned *End = Uses.data() + I.UseEnd;
+
+    const unsigned *It = std::lower_bound(Begin, End, Pos);
+    return It != End && *It <= P.End ? *It : NoUse;
+}
+
+void LinearScan::run() {
+    typedef std::pair<unsigned, unsigned> Entry;
+
+    // Pieces waiting for a location, by their start.
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>
+        Unhandled;
+
+    Pieces.clear();
+    for (unsigned i = 0, e = Intervals.size(); i != e; ++i) {
+        const Interval &I = Intervals[i];
+        Pieces.push_back(Piece { i, I.Start, I.End, false, 0 });
+        Unhandled.push(Entry(I.Start, i));
+    }
+
+    // Pieces in registers, and registers taken, by class.
+    std::vector<std::vector<unsigned>> Active(Registers.size());
+    std::vector<std::vector<bool>> Busy(Registers.size(),
+                                        std::vector<bool>(256));
+
+    // The register every interval last left at its end, for the intervals
+    // hinting at it.
+    std::vector<int> Released(Intervals.size(), -1);
+
+    // Leaves piece P in memory up to its first use after Pos, and splits off
+    // the rest for another visit.
+    auto Spill = [&](unsigned P, unsigned Pos) {
+        Pieces[P].InReg = false;
+
+        unsigned Next = getNextUse(Pieces[P], Pos + 1);
+        if (Next == NoUse)
+            return;
+
+        Piece Rest = Pieces[P];
+        Rest.Start = Next;
+        Pieces[P].End = Next - 1;
+        Pieces.push_back(Rest);
+        Unhandled.push(Entry(Next, Pieces.size() - 1));
+    };
+
+    while (!Unhandled.empty()) {
+        unsigned Pos = Unhandled.top().first;
+        unsigned Cur = Unhandled.top().second;
+        Unhandled.pop();
+
+        const Interval &I = Intervals[Pieces[Cur].Interval];
+        unsigned C = I.Class;
+        std::vector<unsigned> &List = Active[C];
+
+        for (unsigned i = 0; i != List.size(); ) {
+            const Piece &Old = Pieces[List[i]];
+            if (Old.End >= Pos) {
+                ++i;
+                continue;
+            }
+
+            Busy[C][Old.Reg] = false;
+            Released[Old.Interval] = Old.Reg;
+            List[i] = List.back();
+            List.pop_back();
+        }
+
+        // A piece split off a value in memory starts at a use, which can
+        // read memory as well. A register only pays off for the uses after
+        // it.
+        unsigned CurUse = getNextUse(Pieces[Cur], Pos);
+        if (Pieces[Cur].Start != I.Start) {
+            CurUse = getNextUse(Pieces[Cur], Pos + 1);
+            if (CurUse == NoUse)
+                continue;
+        }
+
+        int Reg = -1;
+        if (Pieces[Cur].Start == I.Start && I.Hint != ~0u
+         && Released[I.Hint] >= 0 && !Busy[C][Released[I.Hint]])
+            Reg = Released[I.Hint];
+
+        for (unsigned i = 0, e = Registers[C].size(); i != e && Reg < 0; ++i)
+            if (!Busy[C][Registers[C][i]])
+                Reg = Registers[C][i];
+
+        if (Reg >= 0) {
+            Busy[C][Reg] = true;
+            Pieces[Cur].InReg = true;
+            Pieces[Cur].Reg = Reg;
+            List.push_back(Cur);
+            continue;
+        }
+
+        // Take the register of an active piece used after the current one,
+        // the one used furthest away among those cheapest to spill: a piece
+        // split off a value in memory need not store it again, and one not
+        // read by the instruction the current piece starts at is not
+        // reloaded for it.
+        int Victim = -1;
+        unsigned VictimUse = 0, VictimCost = 0;
+        for (unsigned i = 0, e = List.size(); i != e; ++i) {
+            const Piece &P = Pieces[List[i]];
+            unsigned Use = getNextUse(P, Pos);
+            if (Use <= CurUse)
+                continue;
+
+            unsigned Cost = P.Start == Intervals[P.Interval].Start;
+            if (Pos % 2 && getNextUse(P, Pos - 1) == Pos - 1)
+                ++Cost;
+
+            if (Victim < 0 || Cost < VictimCost
+                           || (Cost == VictimCost && Use > VictimUse)) {
+                Victim = i;
+                VictimUse = Use;
+                VictimCost = Cost;
+            }
+        }
+
+        if (Victim < 0) {
+            Spill(Cur, Pos);
+            continue;
+        }
+
+        // The victim goes to memory from the last split position up to Pos,
+        // or from its start if there is none.
+        unsigned V = List[Victim];
+        Reg = Pieces[V].Reg;
+
+        auto It = std::upper_bound(SplitPositions.begin(),
+                                   SplitPositions.end(), Pos);
+        if (It != SplitPositions.begin() && *(It - 1) > Pieces[V].Start) {
+            Piece Mem = Pieces[V];
+            Mem.Start = *(It - 1);
+            Pieces[V].End = Mem.Start - 1;
+            Pieces.push_back(Mem);
+            V = Pieces.size() - 1;
+        }
+
+        Spill(V, Pos);
+
+        Pieces[Cur].InReg = true;
+        Pieces[Cur].Reg = Reg;
+        List[Victim] = Cur;
+    }
+
+    collectParts();
+    assignSlots();
+}
+
+void LinearScan::collectParts() {
+    std::vector<unsigned> Order(Pieces.size());
+    for (unsigned i = 0, e = Order.size(); i != e; ++i)
+        Order[i] = i;
+
+    std::sort(Order.begin(), Order.end(), [&](unsigned A, unsigned B) {
+        const Piece &PA = Pieces[A], &PB = Pieces[B];
+        return PA.Interval != PB.Interval ? PA.Interval < PB.Interval
+                                          : PA.Start < PB.Start;
+    });
+
+    Parts.clear();
+    PartBegins.assign(Intervals.size() + 1, 0);
+
+    for (unsigned i = 0, e = Order.size(); i != e; ++i) {
+        const Piece &P = Pieces[Order[i]];
+        if (i && Pieces[Order[i - 1]].Interval == P.Interval) {
+            const Part &Prev = Parts.back();
+            if (Prev.InReg == P.InReg && (!P.InReg || Prev.Reg == P.Reg))
+                continue;
+        }
+
+        Parts.push_back(Part { P.Start, P.InReg, P.Reg, 0 });
+        PartBegins[P.Interval + 1] = Parts.size();
+    }
+
+    for (unsigned i = 1, e = PartBegins.size(); i != e; ++i)
+        PartBegins[i] = std::max(PartBegins[i], PartBegins[i - 1]);
+}
+
+void LinearScan::assignSlots() {
+    typedef std::pair<unsigned, unsigned> Entry;
+
+    // A spilled interval keeps its slot from its first part in memory to
+    // its end, so every part in memory finds the value stored by the last.
+    std::vector<Entry> Spilled;
+    for (unsigned i = 0, e = Intervals.size(); i != e; ++i)
+        for (const Part &P : getParts(i))
+            if (!P.InReg) {
+                Spilled.push_back(Entry(P.Start, i));
+                break;
+            }
+
+    std::sort(Spilled.begin(), Spilled.end());
+
+    // Slots in use by the end of their interval, and free slots.
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> Taken;
+    std::vector<unsigned> Free;
+    std::vector<unsigned> Slots(Intervals.size());
+
+    NumSlots = 0;
+    for (const Entry &S : Spilled) {
+        while (!Taken.empty() && Taken.top().first < S.first) {
+            Free.push_back(Taken.top().second);
+            Taken.pop();
+        }
+
+        unsigned Slot;
+        if (Free.empty())
+            Slot = NumSlots++;
+        else {
+            Slot = Free.back();
+            Free.pop_back();
+        }
+
+        Slots[S.second] = Slot;
+        Taken.push(Entry(Intervals[S.second].End, Slot));
+    }
+
+    for (unsigned i = 0, e = Intervals.size(); i != e; ++i)
+        for (unsigned p = PartBegins[i]; p != PartBegins[i + 1]; ++p)
+            if (!Parts[p].InReg)
+                Parts[p].Slot = Slots[i];
+}
+
+const LinearScan::Part &LinearScan::getPart(unsigned I, unsigned Pos) const {
+    const Part *Begin = Parts.data() + PartBegins[I];
+    const Part *End = Parts.data() + PartBegins[I + 1];
+    assert(Begin != End && Begin->Start <= Pos && "position not covered.");
+
+    if (End - Begin == 1)
+        return *Begin;
+
+    const Part *It = std::upper_bound(Begin, End, Pos,
+        [](unsigned P, const Part &Part) { return P < Part.Start; });
+    return *(It - 1);
+}
@@ -0,0 +1,325 @@
+
+#include "kaiju/CodeGen/X86Assembler.h"
+
+using namespace kaiju;
+using namespace kaiju::X86;
+
+namespace {
+
+// \brief Returns whether \p V fits a sign extended 8 bit immediate.
+bool isInt8(int32_t V) {
+    return V >= -128 && V <= 127;
+}
+
+} // end anonymous namespace
+
+void X86Assembler::imm32(int32_t V) {
+    uint32_t U = V;
+    for (unsigned i = 0; i != 4; ++i)
+        byte(U >> (8 * i));
+}
+
+void X86Assembler::imm64(uint64_t V) {
+    for (unsigned i = 0; i != 8; ++i)
+        byte(V >> (8 * i));
+}
+
+void X86Assembler::patch32(std::size_t Offset, int32_t V) {
+    uint32_t U = V;
+    for (unsigned i = 0; i != 4; ++i)
+        Buffer[Offset + i] = U >> (8 * i);
+}
+
+void X86Assembler::rex(bool W, uint8_t Reg, const Operand &RM, bool Force) {
+    uint8_t Bits = (W ? 8 : 0) | ((Reg & 8) ? 4 : 0);
+    if (RM.Kind != Operand::RIPRelative && (RM.Register & 8))
+        Bits |= 1;
+
+    if (Bits || Force)
+        byte(0x40 | Bits);
+}
+
+void X86Assembler::modrm(uint8_t Reg, const Operand &RM) {
+    Reg = (Reg & 7) << 3;
+
+    switch (RM.Kind) {
+    case Operand::Reg:
+        byte(0xC0 | Reg | (RM.Register & 7));
+        return;
+
+    case Operand::Memory: {
+        // Always with a displacement, so RBP and R13 need no special case.
+        // RSP and R12 as a base need a SIB byte.
+        uint8_t Base = RM.Register & 7;
+        byte((isInt8(RM.Disp) ? 0x40 : 0x80) | Reg | Base);
+        if (Base == RSP)
+            byte(0x24);
+
+        if (isInt8(RM.Disp))
+            byte(RM.Disp);
+        else
+            imm32(RM.Disp);
+        return;
+    }
+
+    case Operand::RIPRelative:
+        byte(Reg | 5);
+        LastDisp = Buffer.size();
+        imm32(0);
+        return;
+    }
+}
+
+void X86Assembler::push(GPR R) {
+    if (R & 8)
+        byte(0x41);
+    byte(0x50 | (R & 7));
+}
+
+void X86Assembler::pop(GPR R) {
+    if (R & 8)
+        byte(0x41);
+    byte(0x58 | (R & 7));
+}
+
+void X86Assembler::ret() {
+    byte(0xC3);
+}
+
+void X86Assembler::ud2() {
+    byte(0x0F);
+    byte(0x0B);
+}
+
+void X86Assembler::mov(GPR Dst, const Operand &Src) {
+    rex(true, Dst, Src);
+    byte(0x8B);
+    modrm(Dst, Src);
+}
+
+void X86Assembler::mov(const Operand &Dst, GPR Src) {
+    rex(true, Src, Dst);
+    byte(0x89);
+    modrm(Src, Dst);
+}
+
+void X86Assembler::movImm(GPR Dst, uint64_t V) {
+    // A 32 bit move zero extends and is the shortest form.
+    if (V <= 0xFFFFFFFFu) {
+        rex(false, 0, Operand::reg(Dst));
+        byte(0xB8 | (Dst & 7));
+        imm32(V);
+        return;
+    }
+
+    if (int64_t(V) == int32_t(V)) {
+        movImm32(Operand::reg(Dst), int32_t(V));
+        return;
+    }
+
+    rex(true, 0, Operand::reg(Dst));
+    byte(0xB8 | (Dst & 7));
+    imm64(V);
+}
+
+void X86Assembler::movImm32(const Operand &Dst, int32_t V) {
+    rex(true, 0, Dst);
+    byte(0xC7);
+    modrm(0, Dst);
+    imm32(V);
+}
+
+void X86Assembler::mov32(GPR Dst, GPR Src) {
+    rex(false, Src, Operand::reg(Dst));
+    byte(0x89);
+    modrm(Src, Operand::reg(Dst));
+}
+
+void X86Assembler::movzx8(GPR Dst, GPR Src) {
+    rex(false, Dst, Operand::reg(Src), Src >= RSP);
+    byte(0x0F);
+    byte(0xB6);
+    modrm(Dst, Operand::reg(Src));
+}
+
+void X86Assembler::movzx16(GPR Dst, GPR Src) {
+    rex(false, Dst, Operand::reg(Src));
+    byte(0x0F);
+    byte(0xB7);
+    modrm(Dst, Operand::reg(Src));
+}
+
+void X86Assembler::movsx8(GPR Dst, GPR Src) {
+    rex(true, Dst, Operand::reg(Src));
+    byte(0x0F);
+    byte(0xBE);
+    modrm(Dst, Operand::reg(Src));
+}
+
+void X86Assembler::movsx16(GPR Dst, GPR Src) {
+    rex(true, Dst, Operand::reg(Src));
+    byte(0x0F);
+    byte(0xBF);
+    modrm(Dst, Operand::reg(Src));
+}
+
+void X86Assembler::movsx32(GPR Dst, GPR Src) {
+    rex(true, Dst, Operand::reg(Src));
+    byte(0x63);
+    modrm(Dst, Operand::reg(Src));
+}
+
+void X86Assembler::leaFrame(GPR Dst, int32_t Disp) {
+    rex(true, Dst, Operand::frame(Disp));
+    byte(0x8D);
+    modrm(Dst, Operand::frame(Disp));
+}
+
+void X86Assembler::alu(ALUOp Op, GPR Dst, const Operand &Src) {
+    rex(true, Dst, Src);
+    byte((Op << 3) | 3);
+    modrm(Dst, Src);
+}
+
+void X86Assembler::aluImm(ALUOp Op, const Operand &Dst, int32_t V) {
+    rex(true, 0, Dst);
+    byte(isInt8(V) ? 0x83 : 0x81);
+    modrm(Op, Dst);
+    if (isInt8(V))
+        byte(V);
+    else
+        imm32(V);
+}
+
+void X86Assembler::imul(GPR Dst, const Operand &Src) {
+    rex(true, Dst, Src);
+    byte(0x0F);
+    byte(0xAF);
+    modrm(Dst, Src);
+}
+
+void X86Assembler::imulImm(GPR Dst, const Operand &Src, int32_t V) {
+    rex(true, Dst, Src);
+    byte(isInt8(V) ? 0x6B : 0x69);
+    modrm(Dst, Src);
+    if (isInt8(V))
+        byte(V);
+    else
+        imm32(V);
+}
+
+void X86Assembler::mul(const Operand &Src) {
+    rex(true, 0, Src);
+    byte(0xF7);
+    modrm(4, Src);
+}
+
+void X86Assembler::imul1(const Operand &Src) {
+    rex(true, 0, Src);
+    byte(0xF7);
+    modrm(5, Src);
+}
+
+void X86Assembler::div(const Operand &Src) {
+    rex(true, 0, Src);
+    byte(0xF7);
+    modrm(6, Src);
+}
+
+void X86Assembler::idiv(const Operand &Src) {
+    rex(true, 0, Src);
+    byte(0xF7);
+    modrm(7, Src);
+}
+
+void X86Assembler::cqo() {
+    byte(0x48);
+    byte(0x99);
+}
+
+void X86Assembler::shiftCL(ShiftOp Op, GPR Dst) {
+    rex(true, 0, Operand::reg(Dst));
+    byte(0xD3);
+    modrm(Op, Operand::reg(Dst));
+}
+
+void X86Assembler::shiftImm(ShiftOp Op, GPR Dst, uint8_t Amount) {
+    rex(true, 0, Operand::reg(Dst));
+    byte(0xC1);
+    modrm(Op, Operand::reg(Dst));
+    byte(Amount);
+}
+
+void X86Assembler::shrd(GPR Dst, GPR Src, uint8_t Amount) {
+    rex(true, Src, Operand::reg(Dst));
+    byte(0x0F);
+    byte(0xAC);
+    modrm(Src, Operand::reg(Dst));
+    byte(Amount);
+}
+
+void X86Assembler::test(GPR A, GPR B) {
+    rex(true, B, Operand::reg(A));
+    byte(0x85);
+    modrm(B, Operand::reg(A));
+}
+
+void X86Assembler::setcc(CondCode CC, GPR Dst) {
+    rex(false, 0, Operand::reg(Dst), Dst >= RSP);
+    byte(0x0F);
+    byte(0x90 | CC);
+    modrm(0, Operand::reg(Dst));
+}
+
+std::size_t X86Assembler::jcc(CondCode CC) {
+    byte(0x0F);
+    byte(0x80 | CC);
+    std::size_t Offset = Buffer.size();
+    imm32(0);
+    return Offset;
+}
+
+std::size_t X86Assembler::jmp() {
+    byte(0xE9);
+    std::size_t Offset = Buffer.size();
+    imm32(0);
+    return Offset;
+}
+
+std::size_t X86Assembler::call() {
+    byte(0xE8);
+    std::size_t Offset = Buffer.size();
+    imm32(0);
+    return Offset;
+}
+
+void X86Assembler::movsse(bool Double, XMM Dst, const Operand &Src) {
+    byte(Double ? 0xF2 : 0xF3);
+    rex(false, Dst, Src);
+    byte(0x0F);
+    byte(0x10);
+    modrm(Dst, Src);
+}
+
+void X86Assembler::movsse(bool Double, const Operand &Dst, XMM Src) {
+    byte(Double ? 0xF2 : 0xF3);
+    rex(false, Src, Dst);
+    byte(0x0F);
+    byte(0x11);
+    modrm(Src, Dst);
+}
+
+void X86Assembler::movaps(XMM Dst, XMM Src) {
+    rex(false, Dst, Operand::reg(Src));
+    byte(0x0F);
+    byte(0x28);
+    modrm(Dst, Operand::reg(Src));
+}
+
+void X86Assembler::sse(SSEOp Op, bool Double, XMM Dst, const Operand &Src) {
+    byte(Double ? 0xF2 : 0xF3);
+    rex(false, Dst, Src);
+    byte(0x0F);
+    byte(Op);
+    modrm(Dst, Src);
+}
@@ -0,0 +1,1305 @@
+
+#include "kaiju/CodeGen/X86CodeGen.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+#include "kaiju/CodeGen/LinearScan.h"
+#include "kaiju/CodeGen/X86Assembler.h"
+#include "kaiju/Exec/GenericValue.h"
+#include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/BranchInst.h"
+#include "kaiju/IR/CmpInst.h"
+#include "kaiju/IR/Constants.h"
+#include "kaiju/IR/Dominators.h"
+#include "kaiju/IR/PhiNode.h"
+#include "kaiju/IR/ReturnInst.h"
+
+using namespace kaiju::X86;
+
+namespace {
+
+// RAX, RCX, RDX and R11 are scratch registers of the code generator, as are
+// XMM14 and XMM15. Caller saved registers are preferred.
+const GPR AllocatableGPRs[] = {
+    RSI, RDI, R8, R9, R10, RBX, R12, R13, R14, R15,
+};
+
+const unsigned NumAllocatableXMMs = 14;
+
+// \brief Returns the allocatable registers of the integer and the floating
+// point register class.
+std::vector<std::vector<uint8_t>> getRegisterClasses() {
+    std::vector<std::vector<uint8_t>> Classes(2);
+    for (GPR R : AllocatableGPRs)
+        Classes[0].push_back(R);
+    for (unsigned R = 0; R != NumAllocatableXMMs; ++R)
+        Classes[1].push_back(R);
+    return Classes;
+}
+
+const GPR IntegerArgRegs[] = { RDI, RSI, RDX, RCX, R8, R9 };
+const unsigned NumFloatArgRegs = 8;
+
+bool isCalleeSaved(unsigned R) {
+    return R == RBX || R >= R12;
+}
+
+bool fitsInt32(int64_t V) {
+    return V == int32_t(V);
+}
+
+// \brief Sign extends the low \p W bits of \p V, for widths of 1 to 64.
+int64_t sext64(uint64_t V, unsigned W) {
+    return (int64_t)(V << (64 - W)) >> (64 - W);
+}
+
+// \brief Returns whether values of type \p Ty are supported, and whether
+// they live in SSE registers.
+bool isSupportedType(const Type *Ty, bool &FP) {
+    FP = Ty->getTypeID() == Type::FloatTyID
+      || Ty->getTypeID() == Type::DoubleTyID;
+    if (FP)
+        return true;
+
+    const IntegerType *IT = dyn_cast<IntegerType>(Ty);
+    return IT && IT->getBitWidth() <= 64;
+}
+
+bool isDouble(const Type *Ty) {
+    return Ty->getTypeID() == Type::DoubleTyID;
+}
+
+// \brief Where a value lives at some point, a register or a frame slot.
+struct Location {
+    bool InReg;
+    uint8_t Reg;
+    int32_t Offset;
+
+    Operand getOperand() const {
+        return InReg ? Operand::reg(Reg) : Operand::frame(Offset);
+    }
+
+    bool operator==(const Location &O) const {
+        return InReg == O.InReg && (InReg ? Reg == O.Reg : Offset == O.Offset);
+    }
+};
+
+// \brief A copy of one of a set of parallel copies, from a location or from
+// a constant.
+struct Move {
+    Location Dst;
+    Location Src;
+    const Value *Constant;
+    bool FP;
+    bool Double;
+};
+
+// Class CodeGen
+//
+// \brief Lowers a Function to x86-64.
+//
+// Blocks are laid out in reverse post order and their instructions numbered
+// in that order. Liveness is computed by exploring the paths back from every
+// use to the definition, into sparse per block sets, and every value gets
+// the range of positions it is live at, which LinearScan assigns registers
+// and frame slots, splitting it at its uses. Copies between the parts of a
+// split value precede the instruction they are split at, and edges between
+// blocks carry parallel copies for phi nodes and for values that live in
+// different places at either end.
+//
+class CodeGen {
+    Function &Fn;
+    X86MachineCode &Code;
+    X86Assembler Asm;
+    DominatorTree DT;
+
+    std::map<const Value *, unsigned> VRegs;
+    std::vector<const Value *> VRegValues;
+    std::vector<unsigned> UseCounts;
+
+    // \brief The values live into every block, phi nodes excluded, sorted.
+    std::vector<std::vector<unsigned>> LiveIns;
+
+    // \brief The number of the first instruction of every block, and of its
+    // end point, where the copies along its outgoing edges happen.
+    std::vector<unsigned> BlockStarts;
+    std::vector<unsigned> BlockEnds;
+
+    LinearScan RA;
+
+    // \brief Copies between the parts of split values, by the number of the
+    // instruction they precede.
+    std::vector<std::pair<unsigned, Move>> SplitMoves;
+
+    // \brief The number of the instruction being emitted.
+    unsigned Pos;
+
+    std::map<uint64_t, unsigned> ConstantIndices;
+
+    unsigned NumSlots;
+    std::vector<GPR> SavedRegs;
+
+    // \brief A jump whose displacement at \p Offset targets \p Block.
+    struct Jump {
+        std::size_t Offset;
+        unsigned Block;
+    };
+
+    // \brief A conditional jump along an edge with phi copies, which are
+    // emitted out of line after the function body.
+    struct Stub {
+        std::size_t Offset;
+        unsigned From;
+        unsigned To;
+    };
+
+    std::vector<std::size_t> Labels;
+    std::vector<Jump> Jumps;
+    std::vector<Stub> Stubs;
+
+    bool isSupported();
+    void computeIntervals();
+    void allocateRegisters();
+
+    unsigned getVReg(const Value *V) const {
+        auto It = VRegs.find(V);
+        assert(It != VRegs.end() && "value has no interval.");
+        return It->second;
+    }
+
+    // \brief Returns where virtual register \p VReg is at position \p P.
+    // Instruction number k uses its operands at position 2k and defines its
+    // result at 2k + 1, so a result may take the register of an operand that
+    // dies.
+    Location getLocation(unsigned VReg, unsigned P) const {
+        const LinearScan::Part &Part = RA.getPart(VReg, P);
+        if (Part.InReg)
+            return Location { true, Part.Reg, 0 };
+
+        // Slots sit below the saved registers in the frame.
+        int32_t Slot = SavedRegs.size() + Part.Slot;
+        return Location { false, 0, -8 * (Slot + 1) };
+    }
+
+    // \brief Returns where \p V is at the instruction being emitted.
+    Location getLocation(const Value *V) const {
+        return getLocation(getVReg(V), 2 * Pos + 1);
+    }
+
+    // \brief Returns whether \p V is in register \p R.
+    bool isInReg(const Value *V, unsigned R) const {
+        if (!VRegs.count(V))
+            return false;
+        Location L = getLocation(V);
+        return L.InReg && L.Reg == R;
+    }
+
+    // \brief Returns whether \p V is an integer constant, with its bits in
+    // \p Imm. Undefined values read as zero.
+    static bool getImmediate(const Value *V, uint64_t &Imm);
+
+    // \brief Returns the constant pool index of the floating point constant
+    // \p V.
+    unsigned getConstantIndex(const Value *V);
+
+    // \brief Records that the instruction just emitted addresses constant
+    // \p Index.
+    void refConstant(unsigned Index) {
+        Code.ConstantRefs.push_back(X86MachineCode::ConstantRef {
+            (uint32_t)Asm.getLastDispOffset(), Index });
+    }
+
+    // \brief Returns the register an instruction computing into \p Dst with
+    // a second operand \p B should use, its own register unless B is in it.
+    GPR getTarget(const Location &Dst, const Value *B) const {
+        return Dst.InReg && !isInReg(B, Dst.Reg) ? GPR(Dst.Reg) : RAX;
+    }
+
+    XMM getTargetXMM(const Location &Dst, const Value *B) const {
+        return Dst.InReg && !isInReg(B, Dst.Reg) ? XMM(Dst.Reg) : XMM15;
+    }
+
+    void loadGPR(GPR R, const Value *V);
+    void storeGPR(const Value *V, GPR R);
+    void loadXMM(XMM R, const Value *V);
+    void storeXMM(const Value *V, XMM R);
+
+    // \brief Clears the bits of \p R above the low \p W.
+    void normalize(GPR R, unsigned W);
+
+    // \brief Sign extends the low \p W bits of \p R.
+    void signExtend(GPR R, unsigned W);
+
+    void emitMove(const Move &M);
+    void emitParallelMoves(const std::vector<Move> &Moves);
+
+    void emitPrologue();
+    void emitEpilogue();
+
+    void emitIntegerBinaryOperator(const BinaryOperator *I, unsigned W);
+    void emitFloatBinaryOperator(const BinaryOperator *I);
+
+    // \brief Emits the comparison of \p I and returns the condition code
+    // that holds when the predicate does.
+    CondCode emitCompare(const CmpInst *I);
+    void emitCmpInst(const CmpInst *I);
+
+    // \brief Returns whether the comparison at \p It is only used by the
+    // branch right after it, which then tests the flags directly.
+    bool isFusedCompare(BasicBlock::const_iterator It,
+                        BasicBlock::const_iterator End) const;
+
+    // \brief Collects the copies along the edge from block \p From to block
+    // \p To into \p Moves.
+    void getEdgeMoves(unsigned From, unsigned To,
+                      std::vector<Move> &Moves) const;
+
+    // \brief Returns whether the edge from \p From to \p To carries copies.
+    bool needsCopies(unsigned From, unsigned To) const;
+    void emitCopies(unsigned From, unsigned To);
+
+    void emitJump(unsigned To) {
+        Jumps.push_back(Jump { Asm.jmp(), To });
+    }
+
+    void emitBranchInst(const BranchInst *I, unsigned BB, const CmpInst *Cmp);
+    void emitReturnInst(const ReturnInst *I);
+
+public:
+    CodeGen(Function &F, X86MachineCode &C)
+         : Fn(F), Code(C), Asm(C.Text), DT(F), RA(getRegisterClasses()),
+           Pos(0), NumSlots(0) { /* empty */ }
+
+    bool run();
+};
+
+bool CodeGen::getImmediate(const Value *V, uint64_t &Imm) {
+    if (const ConstantInt *CI = dyn_cast<ConstantInt>(V)) {
+        Imm = (uint64_t)CI->getZExtValue();
+        return true;
+    }
+
+    if (isa<UndefValue>(V) && isa<IntegerType>(V->getValueType())) {
+        Imm = 0;
+        return true;
+    }
+
+    return false;
+}
+
+unsigned CodeGen::getConstantIndex(const Value *V) {
+    uint64_t Bits = 0;
+
+    if (const ConstantFP *CF = dyn_cast<ConstantFP>(V)) {
+        if (isDouble(CF->getValueType())) {
+            double D = CF->getValue();
+            std::memcpy(&Bits, &D, sizeof(D));
+        } else {
+            float F = (float)CF->getValue();
+            uint32_t B;
+            std::memcpy(&B, &F, sizeof(F));
+            Bits = B;
+        }
+    }
+
+    auto It = ConstantIndices.find(Bits);
+    if (It != ConstantIndices.end())
+        return It->second;
+
+    unsigned Index = Code.Constants.size();
+    Code.Constants.push_back(Bits);
+    ConstantIndices[Bits] = Index;
+    return Index;
+}
+
+bool CodeGen::isSupported() {
+    BasicBlock *Entry = Fn.getEntryBlock();
+    if (!Entry || !DT.getPredecessors(0).empty())
+        return false;
+
+    bool FP;
+    unsigned NumInts = 0, NumFloats = 0;
+
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i) {
+        if (!isSupportedType(Fn.getArg(i)->getValueType(), FP))
+            return false;
+        ++(FP ? NumFloats : NumInts);
+    }
+
+    if (NumInts > 6 || NumFloats > NumFloatArgRegs)
+        return false;
+
+    Type *RetTy = Fn.getReturnType();
+    if (RetTy->getTypeID() != Type::VoidTyID && !isSupportedType(RetTy, FP))
+        return false;
+
+    for (unsigned b = 0, e = DT.size(); b != e; ++b) {
+        for (const Instruction *I : *DT.getBlock(b)) {
+            for (unsigned i = 0, n = I->getNumOperands(); i != n; ++i) {
+                const Value *Op = I->getOperand(i);
+                if (!isa<Instruction>(Op) && !isa<Argument>(Op)
+                 && !isa<BasicBlock>(Op) && !isa<ConstantInt>(Op)
+                 && !isa<ConstantFP>(Op) && !isa<UndefValue>(Op))
+                    return false;
+            }
+
+            if (const BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I)) {
+                if (!isSupportedType(I->getValueType(), FP))
+                    return false;
+
+                if (FP && BinOp->getOpcode() != Instruction::Add
+                       && BinOp->getOpcode() != Instruction::Sub
+                       && BinOp->getOpcode() != Instruction::Mul
+                       && BinOp->getOpcode() != Instruction::Div)
+                    return false;
+            } else if (const CmpInst *Cmp = dyn_cast<CmpInst>(I)) {
+                if (!isSupportedType(Cmp->getLHS()->getValueType(), FP))
+                    return false;
+            } else if (isa<PhiNode>(I)) {
+                if (!isSupportedType(I->getValueType(), FP))
+                    return false;
+            } else if (!isa<BranchInst>(I) && !isa<ReturnInst>(I))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void CodeGen::computeIntervals() {
+    unsigned N = DT.size();
+    std::vector<unsigned> DefBlocks;
+
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i) {
+        VRegs[Fn.getArg(i)] = VRegValues.size();
+        VRegValues.push_back(Fn.getArg(i));
+        DefBlocks.push_back(0);
+    }
+
+    for (unsigned b = 0; b != N; ++b)
+        for (const Instruction *I : *DT.getBlock(b))
+            if (I->getValueType()->getTypeID() != Type::VoidTyID) {
+                VRegs[I] = VRegValues.size();
+                VRegValues.push_back(I);
+                DefBlocks.push_back(b);
+            }
+
+    unsigned NumVRegs = VRegValues.size();
+    UseCounts.assign(NumVRegs, 0);
+
+    auto GetVReg = [&](const Value *V) {
+        auto It = VRegs.find(V);
+        return It == VRegs.end() ? ~0u : It->second;
+    };
+
+    // \brief A use of a value in a block, at its end for phi operands, which
+    // are live out of the predecessor they flow from rather than live into
+    // the phi's block.
+    struct BlockUse {
+        unsigned VReg;
+        unsigned Block;
+        bool AtEnd;
+    };
+
+    std::vector<BlockUse> BlockUses;
+
+    // Number the instructions, then the end point of every block.
+    BlockStarts.resize(N);
+    BlockEnds.resize(N);
+
+    unsigned Index = 1;
+    for (unsigned b = 0; b != N; ++b) {
+        const BasicBlock *BB = DT.getBlock(b);
+        BlockStarts[b] = Index;
+        Index += BB->size();
+        BlockEnds[b] = Index++;
+
+        for (const Instruction *I : *BB) {
+            if (const PhiNode *Phi = dyn_cast<PhiNode>(I)) {
+                for (unsigned i = 0, e = Phi->getNumIncomingValues();
+                     i != e; ++i) {
+                    const BasicBlock *Pred = Phi->getIncomingBlock(i);
+                    unsigned V = GetVReg(Phi->getIncomingValue(i));
+                    if (V != ~0u && DT.isReachable(Pred)) {
+                        BlockUses.push_back(
+                            BlockUse { V, DT.getNumber(Pred), true });
+                        ++UseCounts[V];
+                    }
+                }
+                continue;
+            }
+
+            for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+                unsigned V = GetVReg(I->getOperand(i));
+                if (V != ~0u) {
+                    BlockUses.push_back(BlockUse { V, b, false });
+                    ++UseCounts[V];
+                }
+            }
+        }
+    }
+
+    // Walk back from every use to the definition, marking the value live
+    // along the way. Values are visited in order, so the sets stay sorted
+    // and a value already marked is the last of a set.
+    std::stable_sort(BlockUses.begin(), BlockUses.end(),
+        [](const BlockUse &A, const BlockUse &B) { return A.VReg < B.VReg; });
+
+    std::vector<std::vector<unsigned>> LiveOuts(N);
+    std::vector<unsigned> Worklist;
+    LiveIns.assign(N, std::vector<unsigned>());
+
+    auto MarkLiveIn = [&](unsigned B, unsigned V) {
+        if (B == DefBlocks[V] || (!LiveIns[B].empty() && LiveIns[B].back() == V))
+            return;
+        LiveIns[B].push_back(V);
+        Worklist.push_back(B);
+    };
+
+    auto MarkLiveOut = [&](unsigned B, unsigned V) {
+        if (!LiveOuts[B].empty() && LiveOuts[B].back() == V)
+            return;
+        LiveOuts[B].push_back(V);
+        MarkLiveIn(B, V);
+    };
+
+    for (const BlockUse &U : BlockUses) {
+        if (U.AtEnd)
+            MarkLiveOut(U.Block, U.VReg);
+        else
+            MarkLiveIn(U.Block, U.VReg);
+
+        while (!Worklist.empty()) {
+            unsigned B = Worklist.back();
+            Worklist.pop_back();
+            for (unsigned P : DT.getPredecessors(B))
+                MarkLiveOut(P, U.VReg);
+        }
+    }
+
+    // Every value is live from its first to its last point. Moves can be
+    // inserted before any instruction but the first of a block, where the
+    // copies along the incoming edges land, and the branch on a fused
+    // comparison.
+    std::vector<unsigned> Starts(NumVRegs, ~0u), Ends(NumVRegs, 0);
+    std::vector<std::pair<unsigned, unsigned>> Uses;
+
+    auto AddPoint = [&](unsigned V, unsigned P) {
+        Starts[V] = std::min(Starts[V], P);
+        Ends[V] = std::max(Ends[V], P);
+    };
+
+    // Point 1 is the function entry, where the arguments arrive.
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i)
+        AddPoint(i, 1);
+
+    for (unsigned b = 0; b != N; ++b) {
+        const BasicBlock *BB = DT.getBlock(b);
+
+        for (unsigned V : LiveIns[b])
+            AddPoint(V, 2 * BlockStarts[b]);
+        for (unsigned V : LiveOuts[b])
+            AddPoint(V, 2 * BlockEnds[b] + 1);
+
+        unsigned K = BlockStarts[b];
+        for (auto It = BB->begin(), E = BB->end(); It != E; ++It, ++K) {
+            const Instruction *I = *It;
+
+            unsigned Def = GetVReg(I);
+            if (Def != ~0u)
+                AddPoint(Def, 2 * K + 1);
+
+            // Phi nodes are written by the copies along the incoming edges,
+            // just before the block starts.
+            if (isa<PhiNode>(I)) {
+                AddPoint(Def, 2 * BlockStarts[b]);
+                continue;
+            }
+
+            bool CanSplit = It != BB->begin()
+                && !(isa<BranchInst>(I) && isa<CmpInst>(*(It - 1))
+                     && isFusedCompare(It - 1, E));
+            if (CanSplit)
+                RA.addSplitPosition(2 * K);
+
+            for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+                unsigned V = GetVReg(I->getOperand(i));
+                if (V == ~0u)
+                    continue;
+
+                AddPoint(V, 2 * K);
+                if (CanSplit && (Uses.empty() || Uses.back() !=
+                                 std::make_pair(V, 2 * K)))
+                    Uses.push_back(std::make_pair(V, 2 * K));
+            }
+        }
+    }
+
+    std::stable_sort(Uses.begin(), Uses.end(),
+        [](const std::pair<unsigned, unsigned> &A,
+           const std::pair<unsigned, unsigned> &B) {
+            return A.first < B.first;
+        });
+
+    std::vector<unsigned> UsePositions;
+    for (const auto &U : Uses)
+        UsePositions.push_back(U.second);
+
+    for (unsigned V = 0, Next = 0; V != NumVRegs; ++V) {
+        unsigned First = Next;
+        while (Next != Uses.size() && Uses[Next].first == V)
+            ++Next;
+
+        // Binary operators compute into the register of their left operand
+        // if they can.
+        unsigned Hint = ~0u;
+        if (const BinaryOperator *I = dyn_cast<BinaryOperator>(VRegValues[V]))
+            Hint = GetVReg(I->getLHS());
+
+        bool FP;
+        isSupportedType(VRegValues[V]->getValueType(), FP);
+        RA.addInterval(FP, Starts[V], Ends[V], UsePositions.data() + First,
+                       UsePositions.data() + Next, Hint);
+    }
+}
+
+void CodeGen::allocateRegisters() {
+    RA.run();
+
+    bool Used[16] = {};
+    for (unsigned V = 0, e = VRegValues.size(); V != e; ++V) {
+        bool FP;
+        isSupportedType(VRegValues[V]->getValueType(), FP);
+        if (FP)
+            continue;
+
+        for (const LinearScan::Part &P : RA.getParts(V))
+            if (P.InReg)
+                Used[P.Reg] = true;
+    }
+
+    for (GPR R : AllocatableGPRs)
+        if (Used[R] && isCalleeSaved(R))
+            SavedRegs.push_back(R);
+
+    NumSlots = RA.getNumSlots();
+
+    // Copy split values between their parts, which all start at the use
+    // position of an instruction. Values never change, so a value that was
+    // in its slot earlier in the same block is still there.
+    for (unsigned V = 0, e = VRegValues.size(); V != e; ++V) {
+        auto Parts = RA.getParts(V);
+        if (Parts.end() - Parts.begin() == 1)
+            continue;
+
+        bool FP;
+        const Type *Ty = VRegValues[V]->getValueType();
+        isSupportedType(Ty, FP);
+
+        unsigned InSlot = 0;
+        for (const LinearScan::Part *P = Parts.begin() + 1; P != Parts.end();
+             ++P) {
+            if (!(P - 1)->InReg)
+                InSlot = P->Start - 1;
+
+            unsigned K = P->Start / 2;
+            if (!P->InReg && InSlot) {
+                auto It = std::upper_bound(BlockStarts.begin(),
+                                           BlockStarts.end(), K);
+                if (InSlot >= 2 * *(It - 1))
+                    continue;
+            }
+
+            SplitMoves.push_back(std::make_pair(K,
+                Move { getLocation(V, P->Start), getLocation(V, P->Start - 1),
+                       nullptr, FP, isDouble(Ty) }));
+        }
+    }
+
+    std::stable_sort(SplitMoves.begin(), SplitMoves.end(),
+        [](const std::pair<unsigned, Move> &A,
+           const std::pair<unsigned, Move> &B) {
+            return A.first < B.first;
+        });
+}
+
+void CodeGen::loadGPR(GPR R, const Value *V) {
+    uint64_t Imm;
+    if (getImmediate(V, Imm))
+        return Asm.movImm(R, Imm);
+
+    Location L = getLocation(V);
+    if (!(L.InReg && L.Reg == R))
+        Asm.mov(R, L.getOperand());
+}
+
+void CodeGen::storeGPR(const Value *V, GPR R) {
+    Location L = getLocation(V);
+    if (!(L.InReg && L.Reg == R))
+        Asm.mov(L.getOperand(), R);
+}
+
+void CodeGen::loadXMM(XMM R, const Value *V) {
+    bool Double = isDouble(V->getValueType());
+
+    if (!VRegs.count(V)) {
+        Asm.movsse(Double, R, Operand::rip());
+        return refConstant(getConstantIndex(V));
+    }
+
+    Location L = getLocation(V);
+    if (!L.InReg)
+        Asm.movsse(Double, R, L.getOperand());
+    else if (L.Reg != R)
+        Asm.movaps(R, XMM(L.Reg));
+}
+
+void CodeGen::storeXMM(const Value *V, XMM R) {
+    Location L = getLocation(V);
+    if (!L.InReg)
+        Asm.movsse(isDouble(V->getValueType()), L.getOperand(), R);
+    else if (L.Reg != R)
+        Asm.movaps(XMM(L.Reg), R);
+}
+
+void CodeGen::normalize(GPR R, unsigned W) {
+    if (W == 64)
+        return;
+    if (W == 32)
+        return Asm.mov32(R, R);
+    if (W == 16)
+        return Asm.movzx16(R, R);
+    if (W == 8)
+        return Asm.movzx8(R, R);
+
+    uint64_t Mask = ~uint64_t(0) >> (64 - W);
+    if (W < 32)
+        return Asm.aluImm(ALU_AND, Operand::reg(R), (int32_t)Mask);
+
+    Asm.movImm(R11, Mask);
+    Asm.alu(ALU_AND, R, Operand::reg(R11));
+}
+
+void CodeGen::signExtend(GPR R, unsigned W) {
+    if (W == 64)
+        return;
+    if (W == 32)
+        return Asm.movsx32(R, R);
+    if (W == 16)
+        return Asm.movsx16(R, R);
+    if (W == 8)
+        return Asm.movsx8(R, R);
+
+    Asm.shiftImm(SHIFT_SHL, R, 64 - W);
+    Asm.shiftImm(SHIFT_SAR, R, 64 - W);
+}
+
+void CodeGen::emitMove(const Move &M) {
+    const Location &Dst = M.Dst, &Src = M.Src;
+
+    if (!M.FP) {
+        if (Dst.InReg)
+            return Asm.mov(GPR(Dst.Reg), Src.getOperand());
+        if (Src.InReg)
+            return Asm.mov(Dst.getOperand(), GPR(Src.Reg));
+
+        Asm.mov(RAX, Src.getOperand());
+        return Asm.mov(Dst.getOperand(), RAX);
+    }
+
+    if (Dst.InReg && Src.InReg)
+        return Asm.movaps(XMM(Dst.Reg), XMM(Src.Reg));
+    if (Dst.InReg)
+        return Asm.movsse(M.Double, XMM(Dst.Reg), Src.getOperand());
+    if (Src.InReg)
+        return Asm.movsse(M.Double, Dst.getOperand(), XMM(Src.Reg));
+
+    Asm.movsse(M.Double, XMM14, Src.getOperand());
+    Asm.movsse(M.Double, Dst.getOperand(), XMM14);
+}
+
+void CodeGen::emitParallelMoves(const std::vector<Move> &Moves) {
+    // Constants read no location, so they are written once everything else
+    // has been read.
+    std::vector<Move> Pending, Constants;
+    for (const Move &M : Moves) {
+        if (M.Constant)
+            Constants.push_back(M);
+        else if (!(M.Src == M.Dst))
+            Pending.push_back(M);
+    }
+
+    auto IsRead = [&](const Location &L) {
+        for (const Move &M : Pending)
+            if (M.Src == L)
+                return true;
+        return false;
+    };
+
+    while (!Pending.empty()) {
+        bool Progress = false;
+
+        for (unsigned i = 0; i != Pending.size(); ) {
+            if (IsRead(Pending[i].Dst)) {
+                ++i;
+                continue;
+            }
+
+            emitMove(Pending[i]);
+            Pending.erase(Pending.begin() + i);
+            Progress = true;
+        }
+
+        if (Progress)
+            continue;
+
+        // Every pending copy is on a cycle. Park the value one of them
+        // overwrites in a scratch register and let its readers use that.
+        Move &M = Pending.front();
+        Location Scratch = { true, M.FP ? uint8_t(XMM15) : uint8_t(R11), 0 };
+
+        emitMove(Move { Scratch, M.Dst, nullptr, M.FP, M.Double });
+        for (Move &Other : Pending)
+            if (Other.Src == M.Dst)
+                Other.Src = Scratch;
+    }
+
+    for (const Move &M : Constants) {
+        if (M.FP) {
+            XMM R = M.Dst.InReg ? XMM(M.Dst.Reg) : XMM14;
+            loadXMM(R, M.Constant);
+            if (!M.Dst.InReg)
+                Asm.movsse(M.Double, M.Dst.getOperand(), R);
+            continue;
+        }
+
+        uint64_t Imm;
+        getImmediate(M.Constant, Imm);
+
+        if (M.Dst.InReg)
+            Asm.movImm(GPR(M.Dst.Reg), Imm);
+        else if (fitsInt32((int64_t)Imm))
+            Asm.movImm32(M.Dst.getOperand(), (int32_t)Imm);
+        else {
+            Asm.movImm(RAX, Imm);
+            Asm.mov(M.Dst.getOperand(), RAX);
+        }
+    }
+}
+
+void CodeGen::emitPrologue() {
+    if (NumSlots) {
+        Asm.push(RBP);
+        Asm.mov(Operand::reg(RBP), RSP);
+    }
+
+    for (GPR R : SavedRegs)
+        Asm.push(R);
+
+    // Keep the stack 16 byte aligned, as if calls were made.
+    if (NumSlots) {
+        unsigned Size = 8 * NumSlots;
+        if ((SavedRegs.size() + NumSlots) % 2)
+            Size += 8;
+        Asm.aluImm(ALU_SUB, Operand::reg(RSP), Size);
+    }
+
+    // Move the arguments to their locations, then clear the bits above
+    // their width which the caller may leave unspecified.
+    std::vector<Move> Moves;
+    unsigned NumInts = 0, NumFloats = 0;
+
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i) {
+        const Argument *Arg = Fn.getArg(i);
+        bool FP;
+        isSupportedType(Arg->getValueType(), FP);
+
+        Location Src = { true, 0, 0 };
+        if (FP)
+            Src.Reg = NumFloats++;
+        else
+            Src.Reg = IntegerArgRegs[NumInts++];
+        Moves.push_back(Move { getLocation(Arg), Src, nullptr, FP,
+                               isDouble(Arg->getValueType()) });
+    }
+
+    emitParallelMoves(Moves);
+
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i) {
+        const Argument *Arg = Fn.getArg(i);
+        const IntegerType *IT = dyn_cast<IntegerType>(Arg->getValueType());
+        if (!IT || IT->getBitWidth() == 64)
+            continue;
+
+        Location L = getLocation(Arg);
+        GPR R = L.InReg ? GPR(L.Reg) : RAX;
+        loadGPR(R, Arg);
+        normalize(R, IT->getBitWidth());
+        storeGPR(Arg, R);
+    }
+}
+
+void CodeGen::emitEpilogue() {
+    if (NumSlots && !SavedRegs.empty())
+        Asm.leaFrame(RSP, -8 * (int32_t)SavedRegs.size());
+
+    for (auto It = SavedRegs.rbegin(), E = SavedRegs.rend(); It != E; ++It)
+        Asm.pop(*It);
+
+    if (NumSlots) {
+        if (SavedRegs.empty())
+            Asm.mov(Operand::reg(RSP), RBP);
+        Asm.pop(RBP);
+    }
+
+    Asm.ret();
+}
+
+void CodeGen::emitIntegerBinaryOperator(const BinaryOperator *I, unsigned W) {
+    const Value *A = I->getLHS(), *B = I->getRHS();
+    Location Dst = getLocation(I);
+
+    uint64_t Imm = 0;
+    bool IsImm = getImmediate(B, Imm);
+
+    auto GetSource = [&]() {
+        if (!IsImm)
+            return getLocation(B).getOperand();
+        Asm.movImm(R11, Imm);
+        return Operand::reg(R11);
+    };
+
+    switch (I->getOpcode()) {
+    case Instruction::Add:
+    case Instruction::Sub:
+    case Instruction::Mul:
+    case Instruction::And: {
+        ALUOp Op = I->getOpcode() == Instruction::Add ? ALU_ADD
+                 : I->getOpcode() == Instruction::Sub ? ALU_SUB : ALU_AND;
+        bool IsMul = I->getOpcode() == Instruction::Mul;
+
+        // The low W bits of the result only depend on the low W bits of the
+        // operands, so immediates may be sign extended.
+        GPR T = getTarget(Dst, B);
+        loadGPR(T, A);
+
+        if (IsImm && fitsInt32(sext64(Imm, W))) {
+            int32_t V = (int32_t)sext64(Imm, W);
+            if (IsMul)
+                Asm.imulImm(T, Operand::reg(T), V);
+            else
+                Asm.aluImm(Op, Operand::reg(T), V);
+        } else if (IsMul)
+            Asm.imul(T, GetSource());
+        else
+            Asm.alu(Op, T, GetSource());
+
+        if (I->getOpcode() != Instruction::And)
+            normalize(T, W);
+        return storeGPR(I, T);
+    }
+
+    case Instruction::Shl:
+    case Instruction::LShr:
+    case Instruction::AShr: {
+        if (!IsImm)
+            loadGPR(RCX, B);
+
+        GPR T = getTarget(Dst, B);
+        loadGPR(T, A);
+
+        ShiftOp Op = SHIFT_SHL;
+        if (I->getOpcode() == Instruction::LShr)
+            Op = SHIFT_SHR;
+        else if (I->getOpcode() == Instruction::AShr) {
+            Op = SHIFT_SAR;
+            signExtend(T, W);
+        }
+
+        if (IsImm)
+            Asm.shiftImm(Op, T, Imm & 63);
+        else
+            Asm.shiftCL(Op, T);
+
+        if (Op != SHIFT_SHR)
+            normalize(T, W);
+        return storeGPR(I, T);
+    }
+
+    case Instruction::UDiv:
+    case Instruction::URem: {
+        loadGPR(RAX, A);
+        Operand Src = GetSource();
+        Asm.alu(ALU_XOR, RDX, Operand::reg(RDX));
+        Asm.div(Src);
+        return storeGPR(I, I->getOpcode() == Instruction::UDiv ? RAX : RDX);
+    }
+
+    case Instruction::Div:
+    case Instruction::Rem: {
+        loadGPR(RAX, A);
+        signExtend(RAX, W);
+        loadGPR(R11, B);
+        signExtend(R11, W);
+        Asm.cqo();
+        Asm.idiv(Operand::reg(R11));
+
+        GPR R = I->getOpcode() == Instruction::Div ? RAX : RDX;
+        normalize(R, W);
+        return storeGPR(I, R);
+    }
+
+    case Instruction::MulHU: {
+        loadGPR(RAX, A);
+        Asm.mul(GetSource());
+        if (W == 64)
+            return storeGPR(I, RDX);
+
+        Asm.shrd(RAX, RDX, W);
+        return storeGPR(I, RAX);
+    }
+
+    case Instruction::MulHS: {
+        loadGPR(RAX, A);
+        signExtend(RAX, W);
+        loadGPR(R11, B);
+        signExtend(R11, W);
+        Asm.imul1(Operand::reg(R11));
+        if (W == 64)
+            return storeGPR(I, RDX);
+
+        Asm.shrd(RAX, RDX, W);
+        normalize(RAX, W);
+        return storeGPR(I, RAX);
+    }
+    }
+}
+
+void CodeGen::emitFloatBinaryOperator(const BinaryOperator *I) {
+    const Value *A = I->getLHS(), *B = I->getRHS();
+    bool Double = isDouble(I->getValueType());
+
+    SSEOp Op = SSE_ADD;
+    switch (I->getOpcode()) {
+    case Instruction::Sub: Op = SSE_SUB; break;
+    case Instruction::Mul: Op = SSE_MUL; break;
+    case Instruction::Div: Op = SSE_DIV; break;
+    default: break;
+    }
+
+    XMM T = getTargetXMM(getLocation(I), B);
+    loadXMM(T, A);
+
+    if (!VRegs.count(B)) {
+        Asm.sse(Op, Double, T, Operand::rip());
+        refConstant(getConstantIndex(B));
+    } else
+        Asm.sse(Op, Double, T, getLocation(B).getOperand());
+
+    storeXMM(I, T);
+}
+
+CondCode CodeGen::emitCompare(const CmpInst *I) {
+    static const CondCode Codes[] = {
+        CC_E, CC_NE, CC_B, CC_BE, CC_A, CC_AE, CC_L, CC_LE, CC_G, CC_GE,
+    };
+
+    const Value *A = I->getLHS(), *B = I->getRHS();
+    unsigned W = cast<IntegerType>(A->getValueType())->getBitWidth();
+    CondCode CC = Codes[I->getPredicate() - CmpInst::EQ];
+
+    uint64_t Imm = 0;
+    bool IsImm = getImmediate(B, Imm);
+
+    // Values are kept zero extended, signed comparisons of narrower values
+    // extend their operands first.
+    if (I->getPredicate() >= CmpInst::SLT && W < 64) {
+        loadGPR(RAX, A);
+        signExtend(RAX, W);
+
+        if (IsImm && fitsInt32(sext64(Imm, W)))
+            Asm.aluImm(ALU_CMP, Operand::reg(RAX), (int32_t)sext64(Imm, W));
+        else {
+            loadGPR(R11, B);
+            signExtend(R11, W);
+            Asm.alu(ALU_CMP, RAX, Operand::reg(R11));
+        }
+        return CC;
+    }
+
+    GPR L = RAX;
+    if (VRegs.count(A) && getLocation(A).InReg)
+        L = GPR(getLocation(A).Reg);
+    else
+        loadGPR(RAX, A);
+
+    if (IsImm && fitsInt32((int64_t)Imm))
+        Asm.aluImm(ALU_CMP, Operand::reg(L), (int32_t)Imm);
+    else if (IsImm) {
+        Asm.movImm(R11, Imm);
+        Asm.alu(ALU_CMP, L, Operand::reg(R11));
+    } else
+        Asm.alu(ALU_CMP, L, getLocation(B).getOperand());
+
+    return CC;
+}
+
+void CodeGen::emitCmpInst(const CmpInst *I) {
+    CondCode CC = emitCompare(I);
+
+    Location Dst = getLocation(I);
+    GPR T = Dst.InReg ? GPR(Dst.Reg) : RAX;
+    Asm.setcc(CC, T);
+    Asm.movzx8(T, T);
+    storeGPR(I, T);
+}
+
+bool CodeGen::isFusedCompare(BasicBlock::const_iterator It,
+                             BasicBlock::const_iterator End) const {
+    if (It + 1 == End)
+        return false;
+
+    const BranchInst *Br = dyn_cast<BranchInst>(*(It + 1));
+    return Br && Br->isConditional() && Br->getCondition() == *It
+        && UseCounts[VRegs.find(*It)->second] == 1;
+}
+
+void CodeGen::getEdgeMoves(unsigned From, unsigned To,
+                           std::vector<Move> &Moves) const {
+    const BasicBlock *Pred = DT.getBlock(From);
+    unsigned Out = 2 * BlockEnds[From] + 1, In = 2 * BlockStarts[To] + 1;
+
+    for (unsigned V : LiveIns[To]) {
+        Location Src = getLocation(V, Out), Dst = getLocation(V, In);
+        if (Src == Dst)
+            continue;
+
+        bool FP;
+        const Type *Ty = VRegValues[V]->getValueType();
+        isSupportedType(Ty, FP);
+        Moves.push_back(Move { Dst, Src, nullptr, FP, isDouble(Ty) });
+    }
+
+    for (const Instruction *I : *DT.getBlock(To)) {
+        const PhiNode *Phi = dyn_cast<PhiNode>(I);
+        if (!Phi)
+            break;
+
+        for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i) {
+            if (Phi->getIncomingBlock(i) != Pred)
+                continue;
+
+            const Value *V = Phi->getIncomingValue(i);
+            Location Dst = getLocation(getVReg(Phi), In);
+            bool FP, Double = isDouble(Phi->getValueType());
+            isSupportedType(Phi->getValueType(), FP);
+
+            if (!VRegs.count(V))
+                Moves.push_back(Move { Dst, Location(), V, FP, Double });
+            else {
+                Location Src = getLocation(getVReg(V), Out);
+                if (!(Src == Dst))
+                    Moves.push_back(Move { Dst, Src, nullptr, FP, Double });
+            }
+            break;
+        }
+    }
+}
+
+bool CodeGen::needsCopies(unsigned From, unsigned To) const {
+    std::vector<Move> Moves;
+    getEdgeMoves(From, To, Moves);
+    return !Moves.empty();
+}
+
+void CodeGen::emitCopies(unsigned From, unsigned To) {
+    std::vector<Move> Moves;
+    getEdgeMoves(From, To, Moves);
+    emitParallelMoves(Moves);
+}
+
+void CodeGen::emitBranchInst(const BranchInst *I, unsigned BB,
+                             const CmpInst *Cmp) {
+    unsigned Next = BB + 1;
+
+    if (I->isUnconditional()) {
+        unsigned Dest = DT.getNumber(I->getSuccessor(0));
+        emitCopies(BB, Dest);
+        if (Dest != Next)
+            emitJump(Dest);
+        return;
+    }
+
+    unsigned True = DT.getNumber(I->getSuccessor(0));
+    unsigned False = DT.getNumber(I->getSuccessor(1));
+
+    CondCode CC = CC_NE;
+    uint64_t Imm;
+
+    if (Cmp)
+        CC = emitCompare(Cmp);
+    else if (getImmediate(I->getCondition(), Imm)) {
+        unsigned Dest = (Imm & 1) ? True : False;
+        emitCopies(BB, Dest);
+        if (Dest != Next)
+            emitJump(Dest);
+        return;
+    } else {
+        Location L = getLocation(I->getCondition());
+        if (L.InReg)
+            Asm.test(GPR(L.Reg), GPR(L.Reg));
+        else
+            Asm.aluImm(ALU_CMP, L.getOperand(), 0);
+    }
+
+    // Fall through into the true successor by inverting the condition.
+    if (True == Next && !needsCopies(BB, False)) {
+        Jumps.push_back(Jump { Asm.jcc(CondCode(CC ^ 1)), False });
+        return emitCopies(BB, True);
+    }
+
+    std::size_t Offset = Asm.jcc(CC);
+    if (needsCopies(BB, True))
+        Stubs.push_back(Stub { Offset, BB, True });
+    else
+        Jumps.push_back(Jump { Offset, True });
+
+    emitCopies(BB, False);
+    if (False != Next)
+        emitJump(False);
+}
+
+void CodeGen::emitReturnInst(const ReturnInst *I) {
+    if (const Value *RV = I->getReturnValue()) {
+        bool FP;
+        isSupportedType(RV->getValueType(), FP);
+        if (FP)
+            loadXMM(XMM0, RV);
+        else
+            loadGPR(RAX, RV);
+    }
+
+    emitEpilogue();
+}
+
+bool CodeGen::run() {
+    if (!isSupported())
+        return false;
+
+    computeIntervals();
+    allocateRegisters();
+    emitPrologue();
+
+    unsigned N = DT.size();
+    Labels.resize(N);
+
+    auto Split = SplitMoves.begin();
+    std::vector<Move> Moves;
+
+    for (unsigned b = 0; b != N; ++b) {
+        const BasicBlock *BB = DT.getBlock(b);
+        Labels[b] = Asm.size();
+        Pos = BlockStarts[b];
+
+        const CmpInst *Fused = nullptr;
+        for (auto It = BB->begin(), E = BB->end(); It != E; ++It, ++Pos) {
+            const Instruction *I = *It;
+
+            Moves.clear();
+            for (; Split != SplitMoves.end() && Split->first == Pos; ++Split)
+                Moves.push_back(Split->second);
+            emitParallelMoves(Moves);
+
+            if (const BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I)) {
+                if (const IntegerType *IT =
+                        dyn_cast<IntegerType>(I->getValueType()))
+                    emitIntegerBinaryOperator(BinOp, IT->getBitWidth());
+                else
+                    emitFloatBinaryOperator(BinOp);
+            } else if (const CmpInst *Cmp = dyn_cast<CmpInst>(I)) {
+                if (isFusedCompare(It, E))
+                    Fused = Cmp;
+                else
+                    emitCmpInst(Cmp);
+            } else if (const BranchInst *Br = dyn_cast<BranchInst>(I))
+                emitBranchInst(Br, b, Fused);
+            else if (const ReturnInst *Ret = dyn_cast<ReturnInst>(I))
+                emitReturnInst(Ret);
+        }
+
+        if (!BB->getTerminator())
+            Asm.ud2();
+    }
+
+    for (unsigned i = 0; i != Stubs.size(); ++i) {
+        Stub S = Stubs[i];
+        Asm.patch32(S.Offset, Asm.size() - (S.Offset + 4));
+        emitCopies(S.From, S.To);
+        emitJump(S.To);
+    }
+
+    for (const Jump &J : Jumps)
+        Asm.patch32(J.Offset, Labels[J.Block] - (J.Offset + 4));
+
+    return true;
+}
+
+} // end anonymous namespace
+
+// \brief Compiles \p Fn to x86-64 code.
+bool kaiju::compileToX86(Function &Fn, X86MachineCode &Code) {
+    Code = X86MachineCode();
+    return CodeGen(Fn, Code).run();
+}
+
+// \brief Appends an entry point taking GenericValue arguments.
+uint32_t kaiju::appendX86GenericEntry(const Function &Fn,
+                                      X86MachineCode &Code) {
+    static_assert(sizeof(GenericValue) == 16, "unexpected GenericValue size.");
+
+    X86Assembler Asm(Code.Text);
+    uint32_t Entry = Asm.size();
+
+    // RBX keeps the result pointer across the call, pushing it also aligns
+    // the stack for the call.
+    Asm.push(RBX);
+    Asm.mov(Operand::reg(RBX), RSI);
+    Asm.mov(Operand::reg(RAX), RDI);
+
+    unsigned NumInts = 0, NumFloats = 0;
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i) {
+        const Type *Ty = Fn.getArg(i)->getValueType();
+        Operand Src = Operand::mem(RAX, 16 * i);
+
+        bool FP;
+        isSupportedType(Ty, FP);
+        if (FP)
+            Asm.movsse(isDouble(Ty), XMM(NumFloats++), Src);
+        else
+            Asm.mov(IntegerArgRegs[NumInts++], Src);
+    }
+
+    std::size_t Disp = Asm.call();
+    Asm.patch32(Disp, -(int32_t)(Disp + 4));
+
+    const Type *RetTy = Fn.getReturnType();
+    if (RetTy->getTypeID() != Type::VoidTyID) {
+        bool FP;
+        isSupportedType(RetTy, FP);
+
+        if (FP)
+            Asm.movsse(isDouble(RetTy), Operand::mem(RBX, 0), XMM0);
+        else {
+            Asm.mov(Operand::mem(RBX, 0), RAX);
+            Asm.movImm32(Operand::mem(RBX, 8), 0);
+        }
+    }
+
+    Asm.pop(RBX);
+    Asm.ret();
+    return Entry;
+}
@@ -1,26 +1,62 @@
 
-#include <iostream>
+#include <cstdlib>
+#include <cstring>
 
 #include "kaiju/IR/IR.h"
 #include "kaiju/Parse/Lexer.h"
 
 using namespace kaiju;
 
+namespace {
+
+// \brief The number of errors shown when -ferror-limit is not given.
+const unsigned DefaultErrorLimit = 20;
+
+} // end anonymous namespace
+
 int main(int argc, char const *argv[]) {
-    if (argc < 2)
+    const char *input = nullptr;
+    unsigned errorLimit = DefaultErrorLimit;
+    bool jsonDiagnostics = false;
+    bool showCarets = true;
+
+    // -ferror-limit=N stops after N errors, 0 never stops.
+    // -fdiagnostics-format=json prints diagnostics as JSON lines.
+    // -fno-caret-diagnostics leaves the source out of text diagnostics.
+    for (int i = 1; i < argc; ++i) {
+        const char *flag = "-ferror-limit=";
+        if (std::strncmp(argv[i], flag, std::strlen(flag)) == 0)
+            errorLimit = std::strtoul(argv[i] + std::strlen(flag), nullptr, 10);
+        else if (std::strcmp(argv[i], "-fdiagnostics-format=json") == 0)
+            jsonDiagnostics = true;
+        else if (std::strcmp(argv[i], "-fno-caret-diagnostics") == 0)
+            showCarets = false;
+        else
+            input = argv[i];
+    }
+
+    if (!input)
         exit(1);
 
-    std::optional<MemoryBuffer> maybeBuffer = MemoryBuffer::read(argv[1]);
-    Path path(argv[1]);
+    std::optional<MemoryBuffer> maybeBuffer = MemoryBuffer::read(input);
+    Path path(input);
 
     if (!maybeBuffer)
         exit(1);
 
     TranslationUnit unit(path, *maybeBuffer);
-    DiagnosticBuilder db(unit);
-
-    Lexer lexer(unit, db);
-    std::cout << lexer.scan() << std::endl;
+    raw_fd_ostream diagStream(2, false);
+    TextDiagnosticPrinter textPrinter(diagStream, showCarets);
+    JSONDiagnosticPrinter jsonPrinter(diagStream);
+    DiagnosticConsumer &printer = jsonDiagnostics
+        ? static_cast<DiagnosticConsumer &>(jsonPrinter) : textPrinter;
+    DiagnosticEngine engine(printer, errorLimit);
+    DiagnosticBuilder db(unit, engine);
+
+    Lexer lexer(unit, db, getGlobalContext().Identifiers);
+    for (Token tok = lexer.scan(); tok.isNot(tok::eof); tok = lexer.scan())
+        outs() << tok << '\n';
+    engine.emitDiagnostics();
 
     return 0;
 }
@@ -0,0 +1,544 @@
+
+#include "kaiju/Exec/BatchInterpreter.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/CmpInst.h"
+#include "kaiju/IR/Constants.h"
+#include "kaiju/IR/ReturnInst.h"
+
+namespace {
+
+using Step = BatchInterpreter::Step;
+
+// \brief Returns the size in bytes of a lane of type \p Lane.
+unsigned getLaneSize(uint8_t Lane) {
+    static const unsigned char Sizes[] = { 1, 2, 4, 8, 16, 4, 8 };
+    return Sizes[Lane];
+}
+
+// \brief Sets \p Lane to the lane type values of \p Ty are held in and
+// \p Width to its integer width. Returns false for types without lanes.
+bool getLaneType(Type *Ty, uint8_t &Lane, uint16_t &Width) {
+    Width = 0;
+
+    if (IntegerType *IT = dyn_cast<IntegerType>(Ty)) {
+        unsigned W = IT->getBitWidth();
+        Width = W;
+        Lane = W <= 8  ? BatchInterpreter::I8
+             : W <= 16 ? BatchInterpreter::I16
+             : W <= 32 ? BatchInterpreter::I32
+             : W <= 64 ? BatchInterpreter::I64
+                       : BatchInterpreter::I128;
+        return true;
+    }
+
+    switch (Ty->getTypeID()) {
+    case Type::HalfTyID:
+    case Type::FloatTyID:
+        Lane = BatchInterpreter::F32;
+        return true;
+
+    case Type::DoubleTyID:
+        Lane = BatchInterpreter::F64;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+// \brief Types to compute on integer lanes of type T in. U is unsigned and
+// at least as wide as unsigned int, so arithmetic never promotes to int, S
+// is the signed type of T's width, and WideU and WideS hold the product of
+// two lanes.
+template <typename T> struct Lane;
+
+template <> struct Lane<uint8_t> {
+    using U = uint32_t;
+    using S = int8_t;
+    using WideU = uint64_t;
+    using WideS = int64_t;
+};
+
+template <> struct Lane<uint16_t> {
+    using U = uint32_t;
+    using S = int16_t;
+    using WideU = uint64_t;
+    using WideS = int64_t;
+};
+
+template <> struct Lane<uint32_t> {
+    using U = uint32_t;
+    using S = int32_t;
+    using WideU = uint64_t;
+    using WideS = int64_t;
+};
+
+template <> struct Lane<uint64_t> {
+    using U = uint64_t;
+    using S = int64_t;
+    using WideU = uint128_t;
+    using WideS = int128_t;
+};
+
+template <> struct Lane<uint128_t> {
+    using U = uint128_t;
+    using S = int128_t;
+};
+
+// \brief Sign extends the low \p W bits of a lane of type T.
+template <typename T>
+typename Lane<T>::S sext(typename Lane<T>::U V, unsigned W) {
+    unsigned Shift = 8 * sizeof(T) - W;
+    return (typename Lane<T>::S)(T)(V << Shift) >> Shift;
+}
+
+// \brief Returns the high \p W bits of the 2 * W bit product of \p X and
+// \p Y.
+template <typename T>
+T mulHU(T X, T Y, unsigned W) {
+    return T((typename Lane<T>::WideU)X * Y >> W);
+}
+
+template <>
+uint128_t mulHU(uint128_t X, uint128_t Y, unsigned W) {
+    return mulHighUnsigned(X, Y, W);
+}
+
+template <typename T>
+T mulHS(T X, T Y, unsigned W) {
+    using WideS = typename Lane<T>::WideS;
+    return T((WideS)sext<T>(X, W) * sext<T>(Y, W) >> W);
+}
+
+template <>
+uint128_t mulHS(uint128_t X, uint128_t Y, unsigned W) {
+    return mulHighSigned(X, Y, W);
+}
+
+// Kernels always process whole chunks. With a trip count known at compile
+// time the loops need no scalar epilogue, which is what lets compilers
+// vectorize them at -O2. Lanes past the last row hold stale values from an
+// earlier chunk, or zero, and their results are ignored.
+const unsigned N = BatchInterpreter::ChunkSize;
+
+// \brief Sets every lane of \p D to \p Op of the lanes of \p A and \p B.
+template <typename T, typename R, typename OpTy>
+void apply(R *KAIJU_RESTRICT D, const T *KAIJU_RESTRICT A,
+           const T *KAIJU_RESTRICT B, OpTy Op) {
+    for (unsigned i = 0; i != N; ++i)
+        D[i] = Op(A[i], B[i]);
+}
+
+// \brief Like apply() for operations without a defined result on some
+// inputs. Lanes where \p IsFault holds are flagged in \p Fault and computed
+// with \p Safe in place of the lane of \p B, so every lane is computed
+// without branching or trapping the host.
+template <typename T, typename FaultTy, typename OpTy>
+void applyChecked(T *KAIJU_RESTRICT D, const T *KAIJU_RESTRICT A,
+                  const T *KAIJU_RESTRICT B, uint8_t *KAIJU_RESTRICT Fault,
+                  T Safe, FaultTy IsFault, OpTy Op) {
+    for (unsigned i = 0; i != N; ++i) {
+        bool Bad = IsFault(A[i], B[i]);
+        Fault[i] |= Bad;
+        D[i] = Op(A[i], Bad ? Safe : B[i]);
+    }
+}
+
+template <typename T>
+T *getColumn(unsigned char *Frame, uint32_t Offset) {
+    return reinterpret_cast<T *>(Frame + Offset);
+}
+
+template <typename T>
+void runCompare(const Step &S, unsigned char *Frame) {
+    using U = typename Lane<T>::U;
+    uint8_t *D = getColumn<uint8_t>(Frame, S.Dst);
+    const T *A = getColumn<T>(Frame, S.A), *B = getColumn<T>(Frame, S.B);
+    unsigned W = S.Width;
+
+#define COMPARE(Expr)                                                          \
+    return apply(D, A, B, [=](U X, U Y) { return uint8_t(Expr); })
+
+    switch (S.Op) {
+    case CmpInst::EQ:  COMPARE(X == Y);
+    case CmpInst::NE:  COMPARE(X != Y);
+    case CmpInst::ULT: COMPARE(X < Y);
+    case CmpInst::ULE: COMPARE(X <= Y);
+    case CmpInst::UGT: COMPARE(X > Y);
+    case CmpInst::UGE: COMPARE(X >= Y);
+    case CmpInst::SLT: COMPARE(sext<T>(X, W) < sext<T>(Y, W));
+    case CmpInst::SLE: COMPARE(sext<T>(X, W) <= sext<T>(Y, W));
+    case CmpInst::SGT: COMPARE(sext<T>(X, W) > sext<T>(Y, W));
+    case CmpInst::SGE: COMPARE(sext<T>(X, W) >= sext<T>(Y, W));
+    }
+
+#undef COMPARE
+}
+
+template <typename T>
+void runInteger(const Step &S, unsigned char *Frame, uint8_t *Fault) {
+    if (S.Compare)
+        return runCompare<T>(S, Frame);
+
+    using U = typename Lane<T>::U;
+    T *D = getColumn<T>(Frame, S.Dst);
+    const T *A = getColumn<T>(Frame, S.A), *B = getColumn<T>(Frame, S.B);
+    unsigned W = S.Width;
+    T Mask = T(~U(0) >> (8 * sizeof(U) - W));
+    T SignBit = T(U(1) << (W - 1));
+
+    // X and Y are the lanes of the operands, results are truncated to W
+    // bits. The faults are those Interpreter::run() traps on.
+#define LANES(Expr)                                                            \
+    return apply(D, A, B, [=](U X, U Y) { return T((Expr) & Mask); })
+#define CHECKED(IsFault, Safe, Expr)                                           \
+    return applyChecked(D, A, B, Fault, T(Safe),                               \
+        [=](U X, U Y) { (void)X; (void)Y; return bool(IsFault); },             \
+        [=](U X, U Y) { return T((Expr) & Mask); })
+
+#define DIVZERO     (Y == 0)
+#define SDIVFAULT   (Y == 0 || (X == SignBit && Y == Mask))
+#define SHIFTFAULT  (Y >= W)
+
+    switch (S.Op) {
+    case Instruction::Add:   LANES(X + Y);
+    case Instruction::Sub:   LANES(X - Y);
+    case Instruction::Mul:   LANES(X * Y);
+    case Instruction::Div:   CHECKED(SDIVFAULT, 1,
+                                     U(sext<T>(X, W) / sext<T>(Y, W)));
+    case Instruction::Rem:   CHECKED(SDIVFAULT, 1,
+                                     U(sext<T>(X, W) % sext<T>(Y, W)));
+    case Instruction::UDiv:  CHECKED(DIVZERO, 1, X / Y);
+    case Instruction::URem:  CHECKED(DIVZERO, 1, X % Y);
+    case Instruction::Shl:   CHECKED(SHIFTFAULT, 0, X << Y);
+    case Instruction::LShr:  CHECKED(SHIFTFAULT, 0, X >> Y);
+    case Instruction::AShr:  CHECKED(SHIFTFAULT, 0, U(sext<T>(X, W) >> Y));
+    case Instruction::And:   LANES(X & Y);
+    case Instruction::MulHS: LANES(mulHS<T>(X, Y, W));
+    case Instruction::MulHU: LANES(mulHU<T>(X, Y, W));
+    }
+
+#undef SHIFTFAULT
+#undef SDIVFAULT
+#undef DIVZERO
+#undef CHECKED
+#undef LANES
+}
+
+template <typename T>
+void runFloat(const Step &S, unsigned char *Frame) {
+    T *D = getColumn<T>(Frame, S.Dst);
+    const T *A = getColumn<T>(Frame, S.A), *B = getColumn<T>(Frame, S.B);
+
+#define LANES(Expr) return apply(D, A, B, [](T X, T Y) { return (Expr); })
+
+    switch (S.Op) {
+    case Instruction::Add: LANES(X + Y);
+    case Instruction::Sub: LANES(X - Y);
+    case Instruction::Mul: LANES(X * Y);
+    case Instruction::Div: LANES(X / Y);
+    case Instruction::Rem: LANES(std::fmod(X, Y));
+    }
+
+#undef LANES
+}
+
+// \brief Fills the first \p Rows lanes of column \p C with
+// \p Src[i * Stride].
+template <typename T>
+void gatherInts(T *C, const GenericValue *Src, std::size_t Stride,
+                unsigned Rows, unsigned W) {
+    using U = typename Lane<T>::U;
+    T Mask = T(~U(0) >> (8 * sizeof(U) - W));
+    for (unsigned i = 0; i != Rows; ++i)
+        C[i] = T(Src[i * Stride].IntVal) & Mask;
+}
+
+void gather(unsigned char *Frame, const BatchInterpreter::Column &C,
+            const GenericValue *Src, std::size_t Stride, unsigned Rows) {
+    switch (C.Lane) {
+    case BatchInterpreter::I8:
+        return gatherInts(getColumn<uint8_t>(Frame, C.Offset), Src, Stride,
+                          Rows, C.Width);
+    case BatchInterpreter::I16:
+        return gatherInts(getColumn<uint16_t>(Frame, C.Offset), Src, Stride,
+                          Rows, C.Width);
+    case BatchInterpreter::I32:
+        return gatherInts(getColumn<uint32_t>(Frame, C.Offset), Src, Stride,
+                          Rows, C.Width);
+    case BatchInterpreter::I64:
+        return gatherInts(getColumn<uint64_t>(Frame, C.Offset), Src, Stride,
+                          Rows, C.Width);
+    case BatchInterpreter::I128:
+        return gatherInts(getColumn<uint128_t>(Frame, C.Offset), Src, Stride,
+                          Rows, C.Width);
+
+    case BatchInterpreter::F32: {
+        float *F = getColumn<float>(Frame, C.Offset);
+        for (unsigned i = 0; i != Rows; ++i)
+            F[i] = Src[i * Stride].FloatVal;
+        return;
+    }
+
+    case BatchInterpreter::F64: {
+        double *F = getColumn<double>(Frame, C.Offset);
+        for (unsigned i = 0; i != Rows; ++i)
+            F[i] = Src[i * Stride].DoubleVal;
+        return;
+    }
+    }
+}
+
+template <typename T>
+void scatterInts(const T *C, GenericValue *Dst, unsigned Rows) {
+    for (unsigned i = 0; i != Rows; ++i)
+        Dst[i] = GenericValue::getInt(C[i]);
+}
+
+void scatter(unsigned char *Frame, const BatchInterpreter::Column &C,
+             GenericValue *Dst, unsigned Rows) {
+    switch (C.Lane) {
+    case BatchInterpreter::I8:
+        return scatterInts(getColumn<uint8_t>(Frame, C.Offset), Dst, Rows);
+    case BatchInterpreter::I16:
+        return scatterInts(getColumn<uint16_t>(Frame, C.Offset), Dst, Rows);
+    case BatchInterpreter::I32:
+        return scatterInts(getColumn<uint32_t>(Frame, C.Offset), Dst, Rows);
+    case BatchInterpreter::I64:
+        return scatterInts(getColumn<uint64_t>(Frame, C.Offset), Dst, Rows);
+    case BatchInterpreter::I128:
+        return scatterInts(getColumn<uint128_t>(Frame, C.Offset), Dst, Rows);
+
+    case BatchInterpreter::F32: {
+        const float *F = getColumn<float>(Frame, C.Offset);
+        for (unsigned i = 0; i != Rows; ++i)
+            Dst[i] = GenericValue::getFloat(F[i]);
+        return;
+    }
+
+    case BatchInterpreter::F64: {
+        const double *F = getColumn<double>(Frame, C.Offset);
+        for (unsigned i = 0; i != Rows; ++i)
+            Dst[i] = GenericValue::getDouble(F[i]);
+        return;
+    }
+    }
+}
+
+template <typename T>
+void fillColumn(T *C, T V) {
+    std::fill_n(C, N, V);
+}
+
+// \brief Fills a whole column with the value of constant \p C.
+void fill(unsigned char *Frame, const BatchInterpreter::ConstantColumn &C) {
+    switch (C.Lane) {
+    case BatchInterpreter::I8:
+        return fillColumn(getColumn<uint8_t>(Frame, C.Offset),
+                          (uint8_t)C.Value.IntVal);
+    case BatchInterpreter::I16:
+        return fillColumn(getColumn<uint16_t>(Frame, C.Offset),
+                          (uint16_t)C.Value.IntVal);
+    case BatchInterpreter::I32:
+        return fillColumn(getColumn<uint32_t>(Frame, C.Offset),
+                          (uint32_t)C.Value.IntVal);
+    case BatchInterpreter::I64:
+        return fillColumn(getColumn<uint64_t>(Frame, C.Offset),
+                          (uint64_t)C.Value.IntVal);
+    case BatchInterpreter::I128:
+        return fillColumn(getColumn<uint128_t>(Frame, C.Offset),
+                          C.Value.IntVal);
+    case BatchInterpreter::F32:
+        return fillColumn(getColumn<float>(Frame, C.Offset),
+                          C.Value.FloatVal);
+    case BatchInterpreter::F64:
+        return fillColumn(getColumn<double>(Frame, C.Offset),
+                          C.Value.DoubleVal);
+    }
+}
+
+} // end anonymous namespace
+
+// ctor, translates \p Fn.
+BatchInterpreter::BatchInterpreter(const Function &Fn)
+     : Interp(Fn), Vectorized(false), ResultColumn(), ReturnsValue(false),
+       FrameSize(0) {
+    Vectorized = translate(Fn);
+
+    if (!Vectorized) {
+        Steps.clear();
+        Constants.clear();
+        ArgColumns.clear();
+    }
+}
+
+bool BatchInterpreter::translate(const Function &Fn) {
+    if (Fn.size() != 1)
+        return false;
+
+    std::map<const Value *, uint32_t> Offsets;
+
+    auto allocate = [this](uint8_t Lane) {
+        uint32_t Offset = FrameSize;
+        FrameSize += ChunkSize * getLaneSize(Lane);
+        return Offset;
+    };
+
+    // Constants get a column of their own, filled once per run.
+    auto getOperand = [&](const Value *V, uint32_t &Offset) {
+        auto It = Offsets.find(V);
+        if (It != Offsets.end()) {
+            Offset = It->second;
+            return true;
+        }
+
+        uint8_t Lane;
+        uint16_t Width;
+        if (!getLaneType(V->getValueType(), Lane, Width))
+            return false;
+
+        GenericValue GV = GenericValue::getInt(0);
+        if (const ConstantInt *CI = dyn_cast<ConstantInt>(V))
+            GV.IntVal = CI->getZExtValue();
+        else if (const ConstantFP *CF = dyn_cast<ConstantFP>(V))
+            GV = Lane == F64 ? GenericValue::getDouble(CF->getValue())
+                             : GenericValue::getFloat((float)CF->getValue());
+        else if (!isa<UndefValue>(V))
+            return false;
+
+        Offset = Offsets[V] = allocate(Lane);
+        Constants.push_back(ConstantColumn { Offset, Lane, GV });
+        return true;
+    };
+
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i) {
+        Column C;
+        if (!getLaneType(Fn.getArg(i)->getValueType(), C.Lane, C.Width))
+            return false;
+
+        C.Offset = Offsets[Fn.getArg(i)] = allocate(C.Lane);
+        ArgColumns.push_back(C);
+    }
+
+    for (const Instruction *I : *Fn.getEntryBlock()) {
+        Step S;
+
+        if (const BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I)) {
+            if (!getLaneType(I->getValueType(), S.Lane, S.Width))
+                return false;
+            if (S.Lane >= F32 && BinOp->getOpcode() > Instruction::Rem)
+                return false;
+
+            S.Op = BinOp->getOpcode();
+            S.Compare = false;
+            if (!getOperand(BinOp->getLHS(), S.A)
+             || !getOperand(BinOp->getRHS(), S.B))
+                return false;
+            S.Dst = Offsets[I] = allocate(S.Lane);
+        } else if (const CmpInst *Cmp = dyn_cast<CmpInst>(I)) {
+            if (!getLaneType(Cmp->getLHS()->getValueType(), S.Lane, S.Width)
+             || S.Lane >= F32)
+                return false;
+
+            S.Op = Cmp->getPredicate();
+            S.Compare = true;
+            if (!getOperand(Cmp->getLHS(), S.A)
+             || !getOperand(Cmp->getRHS(), S.B))
+                return false;
+            S.Dst = Offsets[I] = allocate(I8);
+        } else if (const ReturnInst *Ret = dyn_cast<ReturnInst>(I)) {
+            Value *RV = Ret->getReturnValue();
+            if (!RV)
+                return true;
+
+            ReturnsValue = true;
+            return getLaneType(RV->getValueType(), ResultColumn.Lane,
+                               ResultColumn.Width)
+                && getOperand(RV, ResultColumn.Offset);
+        } else
+            return false;
+
+        Steps.push_back(S);
+    }
+
+    // The block has no terminator, every row traps.
+    return false;
+}
+
+// \brief Runs the steps on a chunk of rows whose arguments are in place.
+void BatchInterpreter::execute(unsigned char *Frame, uint8_t *Fault) const {
+    for (const Step &S : Steps) {
+        switch (S.Lane) {
+        case I8:   runInteger<uint8_t>(S, Frame, Fault); break;
+        case I16:  runInteger<uint16_t>(S, Frame, Fault); break;
+        case I32:  runInteger<uint32_t>(S, Frame, Fault); break;
+        case I64:  runInteger<uint64_t>(S, Frame, Fault); break;
+        case I128: runInteger<uint128_t>(S, Frame, Fault); break;
+        case F32:  runFloat<float>(S, Frame); break;
+        case F64:  runFloat<double>(S, Frame); break;
+        }
+    }
+}
+
+// \brief Calls the function once per row of \p Args.
+bool BatchInterpreter::run(const GenericValue *Args, std::size_t NumRows,
+                           GenericValue *Results, bool *Completed) const {
+    std::size_t NumArgs = getNumArgs();
+    bool AllCompleted = true;
+
+    if (!Vectorized) {
+        for (std::size_t Row = 0; Row != NumRows; ++Row) {
+            GenericValue Ignored;
+            bool Done = Interp.run(Args + Row * NumArgs,
+                                   Results ? Results[Row] : Ignored);
+            if (Completed)
+                Completed[Row] = Done;
+            AllCompleted &= Done;
+        }
+
+        return AllCompleted;
+    }
+
+    // Zeroed, so lanes past the last row of a chunk are never indeterminate.
+    std::unique_ptr<uint128_t[]> Storage(new uint128_t[FrameSize / 16]());
+    unsigned char *Frame = reinterpret_cast<unsigned char *>(Storage.get());
+    uint8_t Fault[ChunkSize];
+
+    // Steps never write constant columns, so they are filled only once.
+    for (const ConstantColumn &C : Constants)
+        fill(Frame, C);
+
+    for (std::size_t Row = 0; Row < NumRows; Row += ChunkSize) {
+        unsigned Rows = std::min<std::size_t>(ChunkSize, NumRows - Row);
+
+        for (unsigned i = 0; i != NumArgs; ++i)
+            gather(Frame, ArgColumns[i], Args + Row * NumArgs + i, NumArgs,
+                   Rows);
+
+        std::memset(Fault, 0, ChunkSize);
+        execute(Frame, Fault);
+
+        if (ReturnsValue && Results)
+            scatter(Frame, ResultColumn, Results + Row, Rows);
+
+        uint8_t AnyFault = 0;
+        for (unsigned i = 0; i != Rows; ++i)
+            AnyFault |= Fault[i];
+        AllCompleted &= !AnyFault;
+
+        if (Completed)
+            for (unsigned i = 0; i != Rows; ++i)
+                Completed[Row + i] = !Fault[i];
+    }
+
+    return AllCompleted;
+}
@@ -0,0 +1,618 @@
+
+#include "kaiju/Exec/Interpreter.h"
+
+using namespace kaiju;
+
+#include <cmath>
+#include <map>
+#include <memory>
+
+#include "kaiju/IR/AllocaInst.h"
+#include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/BranchInst.h"
+#include "kaiju/IR/CmpInst.h"
+#include "kaiju/IR/Constants.h"
+#include "kaiju/IR/LoadInst.h"
+#include "kaiju/IR/PhiNode.h"
+#include "kaiju/IR/ReturnInst.h"
+#include "kaiju/IR/StoreInst.h"
+
+// The translation below relies on the integer opcodes being listed in the
+// order of Instruction::BinaryOpTy and CmpInst::Predicate.
+static_assert(Interpreter::MulHU - Interpreter::Add
+                  == Instruction::MulHU - Instruction::Add
+           && Interpreter::WMulHU - Interpreter::WAdd
+                  == Instruction::MulHU - Instruction::Add,
+              "integer opcodes out of BinaryOpTy order.");
+static_assert(Interpreter::ICmpSGE - Interpreter::ICmpEQ
+                  == CmpInst::SGE - CmpInst::EQ
+           && Interpreter::WICmpSGE - Interpreter::WICmpEQ
+                  == CmpInst::SGE - CmpInst::EQ,
+              "comparison opcodes out of Predicate order.");
+
+namespace {
+
+// Class Translator
+//
+// \brief Translates a Function into Interpreter bytecode.
+//
+// Registers are laid out as constants, arguments, instruction results, then
+// the scratch registers used to copy phi operands in parallel. Stack slots
+// follow the registers.
+//
+class Translator {
+    using Inst = Interpreter::Inst;
+
+    const Function &Fn;
+    std::vector<Inst> &Code;
+    std::vector<GenericValue> &Constants;
+
+    std::map<const Value *, uint32_t> Regs;
+    std::map<const Value *, uint32_t> Slots;
+    std::map<const BasicBlock *, uint32_t> BlockStarts;
+
+    // \brief A field of an emitted instruction that must be patched with the
+    // start of a block once it is known.
+    struct Fixup {
+        std::size_t Index;
+        uint32_t Inst::*Field;
+        const BasicBlock *Target;
+    };
+
+    // \brief An edge whose phi copies are emitted out of line, after the
+    // function body.
+    struct Stub {
+        std::size_t Index;
+        uint32_t Inst::*Field;
+        const BasicBlock *From;
+        const BasicBlock *To;
+        bool BackEdge;
+    };
+
+    std::vector<Fixup> Fixups;
+    std::vector<Stub> Stubs;
+
+    uint32_t FirstTemp;
+
+public:
+    uint32_t FirstArg;
+    uint32_t NumRegisters;
+    uint32_t NumSlots;
+
+private:
+    uint32_t getReg(const Value *V) const {
+        auto It = Regs.find(V);
+        assert(It != Regs.end() && "value has no register.");
+        return It->second;
+    }
+
+    void emit(uint16_t Op, unsigned Width, uint32_t Dst, uint32_t A,
+              uint32_t B) {
+        Code.push_back(Inst { Op, (uint16_t)Width, Dst, A, B });
+    }
+
+    void addConstant(const Value *V);
+    void assignRegisters();
+
+    // \brief Returns whether \p To has phi nodes with an entry for \p From.
+    bool needsCopies(const BasicBlock *From, const BasicBlock *To) const;
+
+    // \brief Emits the copies into the phi nodes of \p To along the edge
+    // from \p From.
+    void emitCopies(const BasicBlock *From, const BasicBlock *To);
+
+    void emitBinaryOperator(const BinaryOperator *I);
+    void emitCmpInst(const CmpInst *I);
+    void emitBranchInst(const BranchInst *I, const BasicBlock *Next);
+
+    // \brief Returns whether a jump to \p To goes backwards, which is how
+    // the bytecode marks the back edges it counts.
+    bool isBackEdge(const BasicBlock *To) const {
+        return BlockStarts.count(To);
+    }
+
+    // \brief Emits a branch target, either directly or through a stub.
+    // Returns whether the jump it patches is a back edge.
+    uint16_t emitTarget(std::size_t Index, uint32_t Inst::*Field,
+                    const BasicBlock *From, const BasicBlock *To);
+
+public:
+    Translator(const Function &F, std::vector<Inst> &C,
+               std::vector<GenericValue> &K)
+         : Fn(F), Code(C), Constants(K), FirstTemp(0),
+           FirstArg(0), NumRegisters(0), NumSlots(0) { /* empty */ }
+
+    void run(std::vector<unsigned> &ArgWidths);
+};
+
+void Translator::addConstant(const Value *V) {
+    if (Regs.count(V))
+        return;
+
+    GenericValue GV = GenericValue::getInt(0);
+
+    if (const ConstantInt *CI = dyn_cast<ConstantInt>(V))
+        GV.IntVal = CI->getZExtValue();
+    else if (const ConstantFP *CF = dyn_cast<ConstantFP>(V))
+        GV = CF->getValueType()->getTypeID() == Type::DoubleTyID
+           ? GenericValue::getDouble(CF->getValue())
+           : GenericValue::getFloat((float)CF->getValue());
+    else if (!isa<UndefValue>(V))
+        return;
+
+    Regs[V] = Constants.size();
+    Constants.push_back(GV);
+}
+
+void Translator::assignRegisters() {
+    for (const BasicBlock *BB : Fn)
+        for (const Instruction *I : *BB)
+            for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i)
+                addConstant(I->getOperand(i));
+
+    uint32_t Next = Constants.size();
+
+    FirstArg = Next;
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i)
+        Regs[Fn.getArg(i)] = Next++;
+
+    unsigned MaxPhis = 0;
+    for (const BasicBlock *BB : Fn) {
+        unsigned NumPhis = 0;
+
+        for (const Instruction *I : *BB) {
+            if (isa<PhiNode>(I))
+                ++NumPhis;
+            if (isa<AllocaInst>(I))
+                Slots[I] = NumSlots++;
+            if (I->getValueType()->getTypeID() != Type::VoidTyID)
+                Regs[I] = Next++;
+        }
+
+        MaxPhis = std::max(MaxPhis, NumPhis);
+    }
+
+    FirstTemp = Next;
+    NumRegisters = Next + MaxPhis;
+}
+
+bool Translator::needsCopies(const BasicBlock *From,
+                             const BasicBlock *To) const {
+    for (const Instruction *I : *To) {
+        const PhiNode *Phi = dyn_cast<PhiNode>(I);
+        if (!Phi)
+            return false;
+
+        for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i)
+            if (Phi->getIncomingBlock(i) == From)
+                return true;
+    }
+
+    return false;
+}
+
+void Translator::emitCopies(const BasicBlock *From, const BasicBlock *To) {
+    std::vector<std::pair<uint32_t, uint32_t>> Copies;
+    uint32_t FirstPhi = ~0u, LastPhi = 0;
+
+    for (const Instruction *I : *To) {
+        const PhiNode *Phi = dyn_cast<PhiNode>(I);
+        if (!Phi)
+            break;
+
+        uint32_t Dst = getReg(Phi);
+        FirstPhi = std::min(FirstPhi, Dst);
+        LastPhi = std::max(LastPhi, Dst);
+
+        for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i) {
+            if (Phi->getIncomingBlock(i) != From)
+                continue;
+
+            Copies.push_back(std::make_pair(Dst,
+                getReg(Phi->getIncomingValue(i))));
+            break;
+        }
+    }
+
+    // The phi nodes of a block have consecutive registers. The copies are
+    // parallel, so if one reads a phi another writes, go through scratch
+    // registers.
+    bool Overlap = false;
+    for (auto &Copy : Copies)
+        Overlap |= Copy.second >= FirstPhi && Copy.second <= LastPhi
+                && Copy.second != Copy.first;
+
+    if (!Overlap) {
+        for (auto &Copy : Copies)
+            if (Copy.first != Copy.second)
+                emit(Interpreter::Mov, 0, Copy.first, Copy.second, 0);
+        return;
+    }
+
+    for (unsigned i = 0, e = Copies.size(); i != e; ++i)
+        emit(Interpreter::Mov, 0, FirstTemp + i, Copies[i].second, 0);
+    for (unsigned i = 0, e = Copies.size(); i != e; ++i)
+        emit(Interpreter::Mov, 0, Copies[i].first, FirstTemp + i, 0);
+}
+
+void Translator::emitBinaryOperator(const BinaryOperator *I) {
+    Type *Ty = I->getValueType();
+    uint32_t Dst = getReg(I), A = getReg(I->getLHS()), B = getReg(I->getRHS());
+
+    if (IntegerType *IT = dyn_cast<IntegerType>(Ty)) {
+        unsigned W = IT->getBitWidth();
+        unsigned Base = W <= 64 ? Interpreter::Add : Interpreter::WAdd;
+        return emit(Base + (I->getOpcode() - Instruction::Add), W, Dst, A, B);
+    }
+
+    bool Double = Ty->getTypeID() == Type::DoubleTyID;
+    assert((Double || Ty->getTypeID() == Type::FloatTyID
+                   || Ty->getTypeID() == Type::HalfTyID)
+        && "unsupported operand type.");
+
+    uint16_t Op;
+    switch (I->getOpcode()) {
+    case Instruction::Add: Op = Double ? Interpreter::FAdd64
+                                       : Interpreter::FAdd32; break;
+    case Instruction::Sub: Op = Double ? Interpreter::FSub64
+                                       : Interpreter::FSub32; break;
+    case Instruction::Mul: Op = Double ? Interpreter::FMul64
+                                       : Interpreter::FMul32; break;
+    case Instruction::Div: Op = Double ? Interpreter::FDiv64
+                                       : Interpreter::FDiv32; break;
+    case Instruction::Rem: Op = Double ? Interpreter::FRem64
+                                       : Interpreter::FRem32; break;
+    default:
+        assert(false && "invalid floating point operation.");
+        Op = Interpreter::Trap;
+        break;
+    }
+
+    emit(Op, 0, Dst, A, B);
+}
+
+void Translator::emitCmpInst(const CmpInst *I) {
+    unsigned W = cast<IntegerType>(I->getLHS()->getValueType())->getBitWidth();
+    unsigned Base = W <= 64 ? Interpreter::ICmpEQ : Interpreter::WICmpEQ;
+
+    emit(Base + (I->getPredicate() - CmpInst::EQ), W,
+         getReg(I), getReg(I->getLHS()), getReg(I->getRHS()));
+}
+
+uint16_t Translator::emitTarget(std::size_t Index, uint32_t Inst::*Field,
+                                const BasicBlock *From, const BasicBlock *To) {
+    // Edges through a stub are counted by the stub's jump.
+    if (needsCopies(From, To)) {
+        Stubs.push_back(Stub { Index, Field, From, To, isBackEdge(To) });
+        return 0;
+    }
+
+    Fixups.push_back(Fixup { Index, Field, To });
+    return isBackEdge(To);
+}
+
+void Translator::emitBranchInst(const BranchInst *I, const BasicBlock *Next) {
+    const BasicBlock *BB = I->getParent();
+
+    if (I->isUnconditional()) {
+        const BasicBlock *Dest = I->getSuccessor(0);
+        emitCopies(BB, Dest);
+
+        // Fall through into the next block.
+        if (Dest == Next)
+            return;
+
+        Fixups.push_back(Fixup { Code.size(), &Inst::A, Dest });
+        return emit(Interpreter::Br, isBackEdge(Dest), 0, 0, 0);
+    }
+
+    std::size_t Index = Code.size();
+    emit(Interpreter::CondBr, 0, 0, getReg(I->getCondition()), 0);
+
+    uint16_t True = emitTarget(Index, &Inst::Dst, BB, I->getSuccessor(0));
+    uint16_t False = emitTarget(Index, &Inst::B, BB, I->getSuccessor(1));
+    Code[Index].Width = True | False << 1;
+}
+
+void Translator::run(std::vector<unsigned> &ArgWidths) {
+    assignRegisters();
+
+    for (unsigned i = 0, e = Fn.arg_size(); i != e; ++i) {
+        IntegerType *IT = dyn_cast<IntegerType>(Fn.getArg(i)->getValueType());
+        ArgWidths.push_back(IT ? IT->getBitWidth() : 0);
+    }
+
+    for (auto It = Fn.begin(), E = Fn.end(); It != E; ++It) {
+        const BasicBlock *BB = *It;
+        const BasicBlock *Next = It + 1 != E ? *(It + 1) : nullptr;
+        BlockStarts[BB] = Code.size();
+
+        for (const Instruction *I : *BB) {
+            if (const BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I))
+                emitBinaryOperator(BinOp);
+            else if (const CmpInst *Cmp = dyn_cast<CmpInst>(I))
+                emitCmpInst(Cmp);
+            else if (const BranchInst *Br = dyn_cast<BranchInst>(I))
+                emitBranchInst(Br, Next);
+            else if (const ReturnInst *Ret = dyn_cast<ReturnInst>(I)) {
+                if (Value *RV = Ret->getReturnValue())
+                    emit(Interpreter::Ret, 0, 0, getReg(RV), 0);
+                else
+                    emit(Interpreter::RetVoid, 0, 0, 0, 0);
+            } else if (isa<AllocaInst>(I))
+                emit(Interpreter::Alloca, 0, getReg(I), Slots[I], 0);
+            else if (const LoadInst *LI = dyn_cast<LoadInst>(I))
+                emit(Interpreter::Load, 0, getReg(I),
+                     getReg(LI->getPointerOperand()), 0);
+            else if (const StoreInst *SI = dyn_cast<StoreInst>(I))
+                emit(Interpreter::Store, 0, 0,
+                     getReg(SI->getValueOperand()),
+                     getReg(SI->getPointerOperand()));
+            else
+                assert(isa<PhiNode>(I) && "unsupported instruction.");
+        }
+
+        if (!BB->getTerminator())
+            emit(Interpreter::Trap, 0, 0, 0, 0);
+    }
+
+    for (const Stub &S : Stubs) {
+        Code[S.Index].*S.Field = Code.size();
+        emitCopies(S.From, S.To);
+        Fixups.push_back(Fixup { Code.size(), &Inst::A, S.To });
+        emit(Interpreter::Br, S.BackEdge, 0, 0, 0);
+    }
+
+    for (const Fixup &F : Fixups)
+        Code[F.Index].*F.Field = BlockStarts[F.Target];
+
+    // Stack slot registers are addressed past the value registers.
+    for (Inst &I : Code)
+        if (I.Op == Interpreter::Alloca)
+            I.A += NumRegisters;
+}
+
+// \brief Returns a mask of the low \p W bits, for widths of 1 to 64.
+inline uint64_t mask64(unsigned W) {
+    return ~uint64_t(0) >> (64 - W);
+}
+
+// \brief Sign extends the low \p W bits of \p V, for widths of 1 to 64.
+inline int64_t sext64(uint64_t V, unsigned W) {
+    return (int64_t)(V << (64 - W)) >> (64 - W);
+}
+
+} // end anonymous namespace
+
+// ctor, translates \p Fn.
+Interpreter::Interpreter(const Function &Fn)
+     : NumCalls(0), NumBackEdges(0) {
+    Translator T(Fn, Code, Constants);
+    T.run(ArgWidths);
+
+    FirstArg = T.FirstArg;
+    NumRegisters = T.NumRegisters;
+    NumSlots = T.NumSlots;
+}
+
+// \brief Calls the function with \p Args.
+bool Interpreter::run(const GenericValue *Args, GenericValue &Result) const {
+    // Frames of typical functions live on the native stack.
+    GenericValue Small[256];
+    std::unique_ptr<GenericValue[]> Large;
+
+    GenericValue *R = Small;
+    unsigned Size = NumRegisters + NumSlots;
+    if (Size > 256) {
+        Large.reset(new GenericValue[Size]);
+        R = Large.get();
+    }
+
+    NumCalls.store(NumCalls.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+
+    std::copy(Constants.begin(), Constants.end(), R);
+
+    for (unsigned i = 0, e = ArgWidths.size(); i != e; ++i) {
+        R[FirstArg + i] = Args[i];
+        if (ArgWidths[i])
+            R[FirstArg + i].IntVal = truncateToWidth(Args[i].IntVal,
+                                                     ArgWidths[i]);
+    }
+
+    return execute(R, Result);
+}
+
+// \brief Runs the bytecode on the initialized frame \p R.
+bool Interpreter::execute(GenericValue *R, GenericValue &Result) const {
+    const Inst *const Base = Code.data();
+    const Inst *I = Base;
+
+    // Back edges are counted locally and published when execution ends,
+    // however it ends.
+    struct Counter {
+        std::atomic<uint64_t> &Total;
+        uint64_t N;
+
+        ~Counter() {
+            Total.store(Total.load(std::memory_order_relaxed) + N,
+                        std::memory_order_relaxed);
+        }
+    } BackEdges { NumBackEdges, 0 };
+
+#if KAIJU_HAS_COMPUTED_GOTO
+    static const void *const Labels[] = {
+#define OPCODE(Name) &&Op_##Name,
+#include "kaiju/Exec/Opcodes.def"
+    };
+
+#define CASE(Name) Op_##Name:
+#define DISPATCH() goto *Labels[I->Op]
+#else
+#define CASE(Name) case Name:
+#define DISPATCH() goto Dispatch
+#endif
+
+#define NEXT() do { ++I; DISPATCH(); } while (0)
+#define JUMP(Target) do { I = Base + (Target); DISPATCH(); } while (0)
+
+    // Integer operations on at most 64 bits. X and Y are the operands, W the
+    // width, execution traps if Fault holds.
+#define NARROW(Name, Fault, Expr)                                              \
+    CASE(Name) {                                                               \
+        uint64_t X = (uint64_t)R[I->A].IntVal;                                 \
+        uint64_t Y = (uint64_t)R[I->B].IntVal;                                 \
+        unsigned W = I->Width;                                                 \
+        if (KAIJU_UNLIKELY(Fault))                                             \
+            return false;                                                      \
+        R[I->Dst].IntVal = (uint64_t)(Expr) & mask64(W);                       \
+        NEXT();                                                                \
+    }
+
+#define WIDE(Name, Fault, Expr)                                                \
+    CASE(Name) {                                                               \
+        uint128_t X = R[I->A].IntVal, Y = R[I->B].IntVal;                      \
+        unsigned W = I->Width;                                                 \
+        if (KAIJU_UNLIKELY(Fault))                                             \
+            return false;                                                      \
+        R[I->Dst].IntVal = truncateToWidth((uint128_t)(Expr), W);              \
+        NEXT();                                                                \
+    }
+
+    // Division by zero, the one signed division that overflows, and shifts
+    // by the width or more have no defined result.
+#define DIVZERO     (Y == 0)
+#define SDIVFAULT   (Y == 0 || (X == (uint128_t(1) << (W - 1))                 \
+                                && Y == maskTrailingOnes(W)))
+#define SHIFTFAULT  (Y >= W)
+
+#define FLOAT(Name, Member, Expr)                                              \
+    CASE(Name) {                                                               \
+        auto X = R[I->A].Member, Y = R[I->B].Member;                           \
+        R[I->Dst].Member = (Expr);                                             \
+        NEXT();                                                                \
+    }
+
+#if KAIJU_HAS_COMPUTED_GOTO
+    DISPATCH();
+#else
+Dispatch:
+    switch (I->Op) {
+#endif
+
+    CASE(Trap)
+        return false;
+
+    CASE(Ret)
+        Result = R[I->A];
+        return true;
+
+    CASE(RetVoid)
+        return true;
+
+    CASE(Br)
+        BackEdges.N += I->Width;
+        JUMP(I->A);
+
+    CASE(CondBr)
+        if (R[I->A].IntVal) {
+            BackEdges.N += I->Width & 1;
+            JUMP(I->Dst);
+        }
+
+        BackEdges.N += I->Width >> 1;
+        JUMP(I->B);
+
+    CASE(Mov)
+        R[I->Dst] = R[I->A];
+        NEXT();
+
+    NARROW(Add, false, X + Y)
+    NARROW(Sub, false, X - Y)
+    NARROW(Mul, false, X * Y)
+    NARROW(UDiv, DIVZERO, X / Y)
+    NARROW(URem, DIVZERO, X % Y)
+    NARROW(Shl, SHIFTFAULT, X << Y)
+    NARROW(LShr, SHIFTFAULT, X >> Y)
+    NARROW(AShr, SHIFTFAULT, sext64(X, W) >> Y)
+    NARROW(And, false, X & Y)
+    NARROW(MulHU, false, ((uint128_t)X * Y) >> W)
+    NARROW(MulHS, false, ((int128_t)sext64(X, W) * sext64(Y, W)) >> W)
+    NARROW(SDiv, SDIVFAULT, sext64(X, W) / sext64(Y, W))
+    NARROW(SRem, SDIVFAULT, sext64(X, W) % sext64(Y, W))
+    NARROW(ICmpEQ, false, X == Y)
+    NARROW(ICmpNE, false, X != Y)
+    NARROW(ICmpULT, false, X < Y)
+    NARROW(ICmpULE, false, X <= Y)
+    NARROW(ICmpUGT, false, X > Y)
+    NARROW(ICmpUGE, false, X >= Y)
+    NARROW(ICmpSLT, false, sext64(X, W) < sext64(Y, W))
+    NARROW(ICmpSLE, false, sext64(X, W) <= sext64(Y, W))
+    NARROW(ICmpSGT, false, sext64(X, W) > sext64(Y, W))
+    NARROW(ICmpSGE, false, sext64(X, W) >= sext64(Y, W))
+
+    WIDE(WAdd, false, X + Y)
+    WIDE(WSub, false, X - Y)
+    WIDE(WMul, false, X * Y)
+    WIDE(WUDiv, DIVZERO, X / Y)
+    WIDE(WURem, DIVZERO, X % Y)
+    WIDE(WShl, SHIFTFAULT, X << Y)
+    WIDE(WLShr, SHIFTFAULT, X >> Y)
+    WIDE(WAShr, SHIFTFAULT, signExtend(X, W) >> Y)
+    WIDE(WAnd, false, X & Y)
+    WIDE(WMulHU, false, mulHighUnsigned(X, Y, W))
+    WIDE(WMulHS, false, mulHighSigned(X, Y, W))
+    WIDE(WSDiv, SDIVFAULT, signExtend(X, W) / signExtend(Y, W))
+    WIDE(WSRem, SDIVFAULT, signExtend(X, W) % signExtend(Y, W))
+    WIDE(WICmpEQ, false, X == Y)
+    WIDE(WICmpNE, false, X != Y)
+    WIDE(WICmpULT, false, X < Y)
+    WIDE(WICmpULE, false, X <= Y)
+    WIDE(WICmpUGT, false, X > Y)
+    WIDE(WICmpUGE, false, X >= Y)
+    WIDE(WICmpSLT, false, signExtend(X, W) < signExtend(Y, W))
+    WIDE(WICmpSLE, false, signExtend(X, W) <= signExtend(Y, W))
+    WIDE(WICmpSGT, false, signExtend(X, W) > signExtend(Y, W))
+    WIDE(WICmpSGE, false, signExtend(X, W) >= signExtend(Y, W))
+
+    FLOAT(FAdd32, FloatVal, X + Y)
+    FLOAT(FSub32, FloatVal, X - Y)
+    FLOAT(FMul32, FloatVal, X * Y)
+    FLOAT(FDiv32, FloatVal, X / Y)
+    FLOAT(FRem32, FloatVal, std::fmod(X, Y))
+    FLOAT(FAdd64, DoubleVal, X + Y)
+    FLOAT(FSub64, DoubleVal, X - Y)
+    FLOAT(FMul64, DoubleVal, X * Y)
+    FLOAT(FDiv64, DoubleVal, X / Y)
+    FLOAT(FRem64, DoubleVal, std::fmod(X, Y))
+
+    CASE(Alloca)
+        R[I->Dst].PointerVal = &R[I->A];
+        NEXT();
+
+    CASE(Load)
+        R[I->Dst] = *static_cast<GenericValue *>(R[I->A].PointerVal);
+        NEXT();
+
+    CASE(Store)
+        *static_cast<GenericValue *>(R[I->B].PointerVal) = R[I->A];
+        NEXT();
+
+#if !KAIJU_HAS_COMPUTED_GOTO
+    }
+
+    assert(false && "invalid opcode.");
+    return false;
+#endif
+
+#undef SHIFTFAULT
+#undef SDIVFAULT
+#undef DIVZERO
+#undef FLOAT
+#undef WIDE
+#undef NARROW
+#undef JUMP
+#undef NEXT
+#undef DISPATCH
+#undef CASE
+}
@@ -0,0 +1,70 @@
+
+#include "kaiju/Exec/JIT.h"
+
+using namespace kaiju;
+
+#include <cstring>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#define KAIJU_JIT_SUPPORTED 1
+#else
+#define KAIJU_JIT_SUPPORTED 0
+#endif
+
+#include "kaiju/CodeGen/X86CodeGen.h"
+
+JITFunction::~JITFunction() {
+#if KAIJU_JIT_SUPPORTED
+    munmap(Memory, Size);
+#endif
+}
+
+// \brief Compiles \p Fn to native code.
+JITFunction *JITFunction::compile(Function &Fn) {
+#if KAIJU_JIT_SUPPORTED
+    X86MachineCode Code;
+    if (!compileToX86(Fn, Code))
+        return nullptr;
+
+    uint32_t GenericEntry = appendX86GenericEntry(Fn, Code);
+
+    // The constant pool follows the code, eight byte aligned.
+    std::size_t PoolStart = (Code.Text.size() + 7) & ~std::size_t(7);
+    std::size_t Used = PoolStart + 8 * Code.Constants.size();
+
+    std::size_t PageSize = sysconf(_SC_PAGESIZE);
+    std::size_t Size = (Used + PageSize - 1) / PageSize * PageSize;
+
+    void *Memory = mmap(nullptr, Size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (Memory == MAP_FAILED)
+        return nullptr;
+
+    uint8_t *Bytes = static_cast<uint8_t *>(Memory);
+    std::memcpy(Bytes, Code.Text.data(), Code.Text.size());
+    if (!Code.Constants.empty())
+        std::memcpy(Bytes + PoolStart, Code.Constants.data(),
+                    8 * Code.Constants.size());
+
+    // Displacements are relative to the end of their instruction, which
+    // they end.
+    for (const X86MachineCode::ConstantRef &Ref : Code.ConstantRefs) {
+        int32_t Disp = (int32_t)(PoolStart + 8 * Ref.Index)
+                     - (int32_t)(Ref.Offset + 4);
+        std::memcpy(Bytes + Ref.Offset, &Disp, sizeof(Disp));
+    }
+
+    if (mprotect(Memory, Size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(Memory, Size);
+        return nullptr;
+    }
+
+    return new JITFunction(Memory, Size,
+        reinterpret_cast<GenericEntryTy *>(Bytes + GenericEntry));
+#else
+    (void)Fn;
+    return nullptr;
+#endif
+}
@@ -0,0 +1,143 @@
+
+#include "kaiju/Exec/TieredEngine.h"
+
+using namespace kaiju;
+
+#include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/Constants.h"
+
+namespace {
+
+// \brief Returns whether \p Fn may do something the Interpreter traps on:
+// divide by zero, overflow a signed division, shift by the width or more,
+// or reach the end of a block without a terminator. Native code would fault
+// or compute a value instead, so such functions stay interpreted.
+bool mayTrap(const Function &Fn) {
+    for (const BasicBlock *BB : Fn) {
+        if (!BB->getTerminator())
+            return true;
+
+        for (const Instruction *I : *BB) {
+            const BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I);
+            if (!BinOp)
+                continue;
+
+            const IntegerType *Ty = dyn_cast<IntegerType>(I->getValueType());
+            if (!Ty)
+                continue;
+
+            const ConstantInt *C = dyn_cast<ConstantInt>(BinOp->getRHS());
+
+            switch (BinOp->getOpcode()) {
+            case Instruction::UDiv: case Instruction::URem:
+                if (!C || C->isZero())
+                    return true;
+                break;
+
+            case Instruction::Div: case Instruction::Rem:
+                if (!C || C->isZero() || C->isAllOnes())
+                    return true;
+                break;
+
+            case Instruction::Shl: case Instruction::LShr:
+            case Instruction::AShr:
+                if (!C || C->getZExtValue() >= Ty->getBitWidth())
+                    return true;
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    return false;
+}
+
+} // end anonymous namespace
+
+// \brief Calls the function with \p Args.
+bool TieredFunction::run(const GenericValue *Args, GenericValue &Result) {
+    if (JITFunction *J = Native.load(std::memory_order_acquire)) {
+        J->call(Args, Result);
+        return true;
+    }
+
+    bool Completed = Interp.run(Args, Result);
+
+    if (!Queued.load(std::memory_order_relaxed)
+     && (Interp.getNumCalls() >= Engine.CallThreshold
+      || Interp.getNumBackEdges() >= Engine.BackEdgeThreshold)
+     && !Queued.exchange(true))
+        Engine.enqueue(this);
+
+    return Completed;
+}
+
+TieredEngine::~TieredEngine() {
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+        Stopping = true;
+    }
+
+    Wakeup.notify_all();
+    if (Worker.joinable())
+        Worker.join();
+}
+
+// \brief Returns the tiered version of \p Fn.
+TieredFunction *TieredEngine::getFunction(Function &Fn) {
+    std::lock_guard<std::mutex> Guard(Lock);
+
+    std::unique_ptr<TieredFunction> &TF = Functions[&Fn];
+    if (!TF)
+        TF.reset(new TieredFunction(*this, Fn));
+    return TF.get();
+}
+
+void TieredEngine::enqueue(TieredFunction *TF) {
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+        if (Stopping)
+            return;
+
+        Queue.push_back(TF);
+        ++NumPending;
+
+        if (!Worker.joinable())
+            Worker = std::thread(&TieredEngine::compileLoop, this);
+    }
+
+    Wakeup.notify_one();
+}
+
+void TieredEngine::compileLoop() {
+    std::unique_lock<std::mutex> Guard(Lock);
+
+    for (;;) {
+        Wakeup.wait(Guard, [this] { return Stopping || !Queue.empty(); });
+        if (Stopping)
+            return;
+
+        TieredFunction *TF = Queue.front();
+        Queue.pop_front();
+
+        // Compile without holding the lock, callers keep interpreting
+        // meanwhile.
+        Guard.unlock();
+        JITFunction *J = mayTrap(TF->Fn) ? nullptr
+                                         : JITFunction::compile(TF->Fn);
+        if (J)
+            TF->Native.store(J, std::memory_order_release);
+        Guard.lock();
+
+        if (--NumPending == 0)
+            Idle.notify_all();
+    }
+}
+
+// \brief Waits until every queued function has been compiled.
+void TieredEngine::waitForCompiles() {
+    std::unique_lock<std::mutex> Guard(Lock);
+    Idle.wait(Guard, [this] { return NumPending == 0 || Stopping; });
+}
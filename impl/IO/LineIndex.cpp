@@ -0,0 +1,56 @@
+
+#include "kaiju/IO/LineIndex.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+
+LineIndex::LineIndex(const MemoryBuffer &Buffer)
+     : Begin(Buffer.begin()), End(Buffer.end()), Scanned(Buffer.begin()),
+       LastLine(0) {
+    LineStarts.push_back(Begin);
+}
+
+void LineIndex::scanTo(const char *Loc) {
+    for (; Scanned < Loc; ++Scanned) {
+        if (*Scanned == '\n' || *Scanned == '\r')
+            LineStarts.push_back(Scanned + 1);
+    }
+}
+
+std::size_t LineIndex::findLine(const char *Loc) {
+    assert(Loc >= Begin && Loc <= End
+        && "The memory address provided is not contained within this buffer.");
+    scanTo(Loc);
+
+    // Diagnostics tend to come in order, so try the last line and the next.
+    const std::size_t NumLines = LineStarts.size();
+    for (std::size_t Line = LastLine; Line < NumLines && Line <= LastLine + 1;
+         ++Line) {
+        if (LineStarts[Line] <= Loc
+            && (Line + 1 == NumLines || Loc < LineStarts[Line + 1]))
+            return LastLine = Line;
+    }
+
+    auto It = std::upper_bound(LineStarts.begin(), LineStarts.end(), Loc);
+    return LastLine = (It - LineStarts.begin()) - 1;
+}
+
+std::pair<std::size_t, std::size_t>
+LineIndex::getLineAndColumn(const char *Loc) {
+    std::size_t Line = findLine(Loc);
+    return { Line + 1, std::size_t(Loc - LineStarts[Line]) + 1 };
+}
+
+StringRef LineIndex::getLineFromLoc(const char *Loc) {
+    const char *LineBegin = LineStarts[findLine(Loc)];
+
+    // Buffers from MemoryBuffer::read() end in a null, which is no part of
+    // the last line.
+    const char *LineEnd = std::max(Loc, LineBegin);
+    while (LineEnd != End && *LineEnd != '\n' && *LineEnd != '\r'
+        && *LineEnd != '\0')
+        ++LineEnd;
+
+    return StringRef(LineBegin, std::size_t(LineEnd - LineBegin));
+}
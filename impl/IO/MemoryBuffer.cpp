@@ -3,6 +3,16 @@
 
 #include <fstream>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define KAIJU_MMAP_SUPPORTED 1
+#else
+#define KAIJU_MMAP_SUPPORTED 0
+#endif
+
 using namespace kaiju;
 
 // \brief Attempts to read in a file of the specified path, returns null
@@ -43,6 +53,40 @@ std::optional<MemoryBuffer> MemoryBuffer::read(const Path &path) {
     return MemoryBuffer(&memory[0], &memory[fsize + 1]);
 }
 
+// \brief Maps the file of the specified path read-only, returns null if it
+// could not be mapped. Like read(), the memory is never released.
+std::optional<MemoryBuffer> MemoryBuffer::map(const Path &path) {
+#if KAIJU_MMAP_SUPPORTED
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return read(path);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return read(path);
+    }
+
+    // Empty files cannot be mapped.
+    if (st.st_size == 0) {
+        static const char empty = '\0';
+        close(fd);
+        return MemoryBuffer(&empty, &empty);
+    }
+
+    void *memory = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (memory == MAP_FAILED)
+        return read(path);
+
+    const char *begin = static_cast<const char *>(memory);
+    return MemoryBuffer(begin, begin + st.st_size);
+#else
+    return read(path);
+#endif
+}
+
 // \brief Get's this specified offsets line number and column number.
 std::pair<std::size_t, std::size_t>
 MemoryBuffer::getPositionalData(const char *loc) const {
@@ -0,0 +1,192 @@
+
+#include "kaiju/IO/raw_ostream.h"
+
+using namespace kaiju;
+
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <fcntl.h>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#else
+#include <io.h>
+#include <sys/stat.h>
+#endif
+
+raw_ostream::~raw_ostream() {
+    assert(BufferCur == BufferStart
+        && "raw_ostream destroyed with unflushed output.");
+    delete[] BufferStart;
+}
+
+void raw_ostream::setBufferSize(std::size_t Size) {
+    flush();
+    delete[] BufferStart;
+
+    BufferStart = Size ? new char[Size] : nullptr;
+    BufferEnd = BufferStart + Size;
+    BufferCur = BufferStart;
+}
+
+void raw_ostream::flush_nonempty() {
+    assert(BufferCur > BufferStart && "flushing an empty buffer.");
+    std::size_t Size = BufferCur - BufferStart;
+    BufferCur = BufferStart;
+    write_impl(BufferStart, Size);
+}
+
+void raw_ostream::write_slow(const char *Ptr, std::size_t Size) {
+    // Unbuffered streams and writes at least as large as the buffer skip the
+    // copy once the buffer is empty.
+    if (BufferStart == BufferEnd) {
+        write_impl(Ptr, Size);
+        return;
+    }
+
+    std::size_t Room = BufferEnd - BufferCur;
+    std::memcpy(BufferCur, Ptr, Room);
+    BufferCur = BufferEnd;
+    flush_nonempty();
+    Ptr += Room;
+    Size -= Room;
+
+    if (Size >= std::size_t(BufferEnd - BufferStart)) {
+        write_impl(Ptr, Size);
+        return;
+    }
+
+    std::memcpy(BufferCur, Ptr, Size);
+    BufferCur += Size;
+}
+
+raw_ostream &raw_ostream::write_integer(uint128_t V, bool Negative) {
+    char Buffer[41];
+    char *End = Buffer + sizeof(Buffer);
+    char *P = End;
+
+    // 128-bit division is a library call, only the top digits need it.
+    while (V > UINT64_MAX) {
+        *--P = '0' + unsigned(V % 10);
+        V /= 10;
+    }
+
+    uint64_t N = uint64_t(V);
+    do {
+        *--P = '0' + unsigned(N % 10);
+        N /= 10;
+    } while (N);
+
+    if (Negative)
+        *--P = '-';
+    return write(P, End - P);
+}
+
+raw_ostream &raw_ostream::operator<<(double D) {
+    char Buffer[32];
+    auto Result = std::to_chars(Buffer, Buffer + sizeof(Buffer), D);
+    assert(Result.ec == std::errc() && "buffer too small for a double.");
+    return write(Buffer, Result.ptr - Buffer);
+}
+
+raw_ostream &raw_ostream::operator<<(const void *P) {
+    write("0x", 2);
+    return write_hex(uintptr_t(P));
+}
+
+raw_ostream &raw_ostream::write_hex(uint64_t N, unsigned Width) {
+    char Buffer[16];
+    char *End = Buffer + sizeof(Buffer);
+    char *P = End;
+    do {
+        *--P = "0123456789ABCDEF"[N & 15];
+        N >>= 4;
+    } while (N);
+
+    for (unsigned Digits = End - P; Digits < Width; ++Digits)
+        *this << '0';
+    return write(P, End - P);
+}
+
+raw_ostream &raw_ostream::indent(unsigned N) {
+    static const char Spaces[] = "                                ";
+    const unsigned Chunk = sizeof(Spaces) - 1;
+    for (; N > Chunk; N -= Chunk)
+        write(Spaces, Chunk);
+    return write(Spaces, N);
+}
+
+raw_fd_ostream::raw_fd_ostream(int fd, bool shouldClose,
+                               std::size_t bufferSize)
+     : FD(fd), ShouldClose(shouldClose), Error(false), Colors(false) {
+    setBufferSize(bufferSize);
+
+    // Windows consoles are colored through their own API, not escapes.
+#if !defined(_WIN32)
+    Colors = ::isatty(FD) && !getenv("NO_COLOR");
+#endif
+}
+
+raw_fd_ostream::~raw_fd_ostream() {
+    flush();
+    if (ShouldClose) {
+#if !defined(_WIN32)
+        ::close(FD);
+#else
+        ::_close(FD);
+#endif
+    }
+}
+
+raw_fd_ostream *raw_fd_ostream::open(const Path &path) {
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+#else
+    int fd = ::_open(path.c_str(),
+                     _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                     _S_IREAD | _S_IWRITE);
+#endif
+    if (fd < 0)
+        return nullptr;
+
+    return new raw_fd_ostream(fd, true);
+}
+
+void raw_fd_ostream::write_impl(const char *Ptr, std::size_t Size) {
+    while (Size && !Error) {
+#if !defined(_WIN32)
+        ssize_t Written = ::write(FD, Ptr, Size);
+#else
+        int Written = ::_write(FD, Ptr, unsigned(std::min<std::size_t>(
+                                            Size, 1u << 30)));
+#endif
+        if (Written < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            Error = true;
+            break;
+        }
+
+        Ptr += Written;
+        Size -= Written;
+    }
+}
+
+raw_os_ostream::raw_os_ostream(std::ostream &O) : OS(O) {
+    setBufferSize(raw_fd_ostream::DefaultBufferSize);
+}
+
+raw_os_ostream::~raw_os_ostream() {
+    flush();
+}
+
+raw_ostream &kaiju::outs() {
+    static raw_fd_ostream S(1, false);
+    return S;
+}
+
+raw_ostream &kaiju::errs() {
+    static raw_fd_ostream S(2, false, 0);
+    return S;
+}
@@ -2,3 +2,30 @@
 #include "kaiju/IR/BasicBlock.h"
 
 using namespace kaiju;
+
+#include "kaiju/IR/BranchInst.h"
+
+// \brief Returns the number of blocks control may transfer to from this block.
+unsigned BasicBlock::getNumSuccessors() const {
+    if (BranchInst *Br = dyn_cast_or_null<BranchInst>(getTerminator()))
+        return Br->getNumSuccessors();
+    return 0;
+}
+
+// \brief Returns the successor at index \p i.
+BasicBlock *BasicBlock::getSuccessor(unsigned i) const {
+    return cast<BranchInst>(getTerminator())->getSuccessor(i);
+}
+
+// \brief Replaces the instructions of this block with \p Insts.
+void BasicBlock::setInstructions(SmallVectorImpl<Instruction *> &&Insts) {
+    for (Instruction *I : InstList)
+        I->Parent = nullptr;
+
+    for (Instruction *I : Insts) {
+        assert(!I->Parent && "Instruction already inserted in a block.");
+        I->Parent = this;
+    }
+
+    InstList = std::move(Insts);
+}
@@ -0,0 +1,582 @@
+
+#include "kaiju/IR/BinaryIR.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define KAIJU_MMAP_SUPPORTED 1
+#else
+#define KAIJU_MMAP_SUPPORTED 0
+#endif
+
+#include "kaiju/IR/Constants.h"
+#include "kaiju/IR/FlatFunction.h"
+
+namespace {
+
+// The header, followed by the function index, the type table, the string
+// table and the function bodies.
+const char Magic[4] = { 'K', 'J', 'I', 'R' };
+const uint32_t Version = 1;
+
+const unsigned HeaderSize = 48;
+const unsigned IndexEntrySize = 24;
+
+// Fields of the header.
+const unsigned HdrVersion = 4;
+const unsigned HdrNumTypes = 8;
+const unsigned HdrNumFunctions = 12;
+const unsigned HdrTypesOffset = 16;
+const unsigned HdrStringsOffset = 24;
+const unsigned HdrStringsSize = 32;
+const unsigned HdrIndexOffset = 40;
+
+// Fields of a function index entry.
+const unsigned IdxNameOffset = 0;
+const unsigned IdxNameSize = 4;
+const unsigned IdxBodyOffset = 8;
+const unsigned IdxBodySize = 16;
+
+// Kinds of constants in a function body.
+enum ConstantKind {
+    ConstInt,
+    ConstFP,
+    ConstUndef,
+};
+
+void write32(std::vector<uint8_t> &Out, std::size_t Offset, uint32_t V) {
+    for (unsigned i = 0; i != 4; ++i)
+        Out[Offset + i] = V >> (8 * i);
+}
+
+void write64(std::vector<uint8_t> &Out, std::size_t Offset, uint64_t V) {
+    for (unsigned i = 0; i != 8; ++i)
+        Out[Offset + i] = V >> (8 * i);
+}
+
+uint32_t read32(const uint8_t *P) {
+    uint32_t V = 0;
+    for (unsigned i = 0; i != 4; ++i)
+        V |= uint32_t(P[i]) << (8 * i);
+    return V;
+}
+
+uint64_t read64(const uint8_t *P) {
+    uint64_t V = 0;
+    for (unsigned i = 0; i != 8; ++i)
+        V |= uint64_t(P[i]) << (8 * i);
+    return V;
+}
+
+// \brief Appends \p V to \p Out as an unsigned LEB128 varint.
+void writeVarint(std::vector<uint8_t> &Out, uint128_t V) {
+    while (V >= 0x80) {
+        Out.push_back(uint8_t(V) | 0x80);
+        V >>= 7;
+    }
+    Out.push_back(uint8_t(V));
+}
+
+// Class Cursor
+//
+// \brief Reads varints and bytes from a range of memory, failing rather than
+// reading past its end. Once failed, every read returns zero.
+//
+class Cursor {
+    const uint8_t *Ptr;
+    const uint8_t *End;
+    bool Failed;
+
+public:
+    // ctor.
+    Cursor(const uint8_t *Begin, std::size_t Size)
+         : Ptr(Begin), End(Begin + Size), Failed(false) { /* empty */ }
+
+    bool failed() const { return Failed; }
+    std::size_t remaining() const { return End - Ptr; }
+
+    uint8_t readByte() {
+        if (Ptr == End) {
+            Failed = true;
+            return 0;
+        }
+        return *Ptr++;
+    }
+
+    uint128_t readVarint() {
+        uint128_t V = 0;
+        for (unsigned Shift = 0; Shift < 128 && Ptr != End; Shift += 7) {
+            uint8_t B = *Ptr++;
+            V |= uint128_t(B & 0x7F) << Shift;
+            if (!(B & 0x80))
+                return V;
+        }
+
+        Failed = true;
+        return 0;
+    }
+
+    // \brief Reads a varint that must be below \p Limit.
+    uint32_t readIndex(uint64_t Limit) {
+        uint128_t V = readVarint();
+        if (V >= Limit) {
+            Failed = true;
+            return 0;
+        }
+        return uint32_t(V);
+    }
+
+    // \brief Reads a count of items each at least a byte long.
+    uint32_t readCount() { return readIndex(remaining() + 1); }
+
+    uint64_t readFixed64() {
+        if (remaining() < 8) {
+            Failed = true;
+            return 0;
+        }
+        Ptr += 8;
+        return read64(Ptr - 8);
+    }
+};
+
+// Class Writer
+//
+// \brief Encodes the functions of a TranslationUnit. Types and names are
+// numbered across the whole unit as bodies are encoded.
+//
+class Writer {
+    std::unordered_map<const Type *, uint32_t> TypeNumbers;
+    std::map<StringRef, uint32_t> StringOffsets;
+
+public:
+    std::vector<uint8_t> Types;
+    std::vector<uint8_t> Strings;
+    uint32_t NumTypes;
+
+    // ctor.
+    Writer() : NumTypes(0) { /* empty */ }
+
+    uint32_t getType(const Type *Ty);
+    uint32_t getString(StringRef S);
+
+    void writeName(std::vector<uint8_t> &Out, StringRef S) {
+        writeVarint(Out, S.size());
+        if (!S.empty())
+            writeVarint(Out, getString(S));
+    }
+
+    void writeBody(const FlatFunction &FF, std::vector<uint8_t> &Out);
+};
+
+uint32_t Writer::getType(const Type *Ty) {
+    auto It = TypeNumbers.find(Ty);
+    if (It != TypeNumbers.end())
+        return It->second;
+
+    writeVarint(Types, Ty->getTypeID());
+    switch (Ty->getTypeID()) {
+    case Type::IntegerTyID:
+        writeVarint(Types, cast<IntegerType>(Ty)->getBitWidth());
+        break;
+    case Type::VoidTyID:
+    case Type::HalfTyID:
+    case Type::FloatTyID:
+    case Type::DoubleTyID:
+    case Type::LabelTyID:
+    case Type::PointerTyID:
+        break;
+    default:
+        assert(false && "type cannot be serialized.");
+    }
+
+    TypeNumbers[Ty] = NumTypes;
+    return NumTypes++;
+}
+
+uint32_t Writer::getString(StringRef S) {
+    auto It = StringOffsets.find(S);
+    if (It != StringOffsets.end())
+        return It->second;
+
+    assert(Strings.size() + S.size() <= UINT32_MAX
+        && "string table too large.");
+    uint32_t Offset = Strings.size();
+    Strings.insert(Strings.end(), S.begin(), S.end());
+    StringOffsets[S] = Offset;
+    return Offset;
+}
+
+void Writer::writeBody(const FlatFunction &FF, std::vector<uint8_t> &Out) {
+    writeVarint(Out, getType(FF.getReturnType()));
+
+    writeVarint(Out, FF.getNumArguments());
+    for (unsigned i = 0, e = FF.getNumArguments(); i != e; ++i) {
+        uint32_t V = FF.getFirstArgument() + i;
+        writeVarint(Out, getType(FF.getValueType(V)));
+        writeName(Out, FF.getName(V));
+    }
+
+    writeVarint(Out, FF.getNumBlocks());
+    for (unsigned b = 0, e = FF.getNumBlocks(); b != e; ++b) {
+        writeName(Out, FF.getName(FF.getFirstBlock() + b));
+        writeVarint(Out, FF.getBlockEnd(b) - FF.getBlockBegin(b));
+    }
+
+    writeVarint(Out, FF.getNumConstants());
+    for (unsigned i = 0, e = FF.getNumConstants(); i != e; ++i) {
+        const Value *C = FF.getConstant(FF.getFirstConstant() + i);
+
+        if (const ConstantInt *CI = dyn_cast<ConstantInt>(C)) {
+            Out.push_back(ConstInt);
+            writeVarint(Out, getType(C->getValueType()));
+            writeVarint(Out, CI->getZExtValue());
+        } else if (const ConstantFP *CF = dyn_cast<ConstantFP>(C)) {
+            Out.push_back(ConstFP);
+            writeVarint(Out, getType(C->getValueType()));
+
+            uint64_t Bits;
+            double V = CF->getValue();
+            std::memcpy(&Bits, &V, sizeof(Bits));
+            Out.resize(Out.size() + 8);
+            write64(Out, Out.size() - 8, Bits);
+        } else {
+            Out.push_back(ConstUndef);
+            writeVarint(Out, getType(C->getValueType()));
+        }
+    }
+
+    for (unsigned i = 0, e = FF.getNumInstructions(); i != e; ++i) {
+        const FlatFunction::Inst &R = FF.getInst(i);
+        Out.push_back(R.Opcode);
+        if (R.Opcode == Instruction::BinaryOpInstTy
+         || R.Opcode == Instruction::CmpInstTy)
+            Out.push_back(R.SubOpcode);
+
+        writeVarint(Out, getType(FF.getType(R.Type)));
+        writeName(Out, FF.getName(i));
+
+        auto Ops = FF.getOperands(i);
+        writeVarint(Out, Ops.end() - Ops.begin());
+        for (uint32_t V : Ops)
+            writeVarint(Out, V);
+    }
+}
+
+} // end anonymous namespace
+
+void kaiju::writeBinaryIR(const TranslationUnit &TU,
+                          std::vector<uint8_t> &Buffer) {
+    Writer W;
+    std::vector<uint8_t> Bodies;
+    std::vector<uint64_t> BodyOffsets;
+    std::vector<uint32_t> NameOffsets;
+
+    // The symbol table is sorted by name, which the index relies on.
+    for (auto &Entry : TU.getFunctions()) {
+        NameOffsets.push_back(W.getString(Entry.first));
+        BodyOffsets.push_back(Bodies.size());
+        W.writeBody(FlatFunction(*Entry.second), Bodies);
+    }
+    BodyOffsets.push_back(Bodies.size());
+
+    uint32_t NumFunctions = NameOffsets.size();
+    uint64_t TypesOffset = HeaderSize + NumFunctions * IndexEntrySize;
+    uint64_t StringsOffset = TypesOffset + W.Types.size();
+    uint64_t BodiesOffset = StringsOffset + W.Strings.size();
+
+    Buffer.assign(BodiesOffset, 0);
+    std::memcpy(Buffer.data(), Magic, sizeof(Magic));
+    write32(Buffer, HdrVersion, Version);
+    write32(Buffer, HdrNumTypes, W.NumTypes);
+    write32(Buffer, HdrNumFunctions, NumFunctions);
+    write64(Buffer, HdrTypesOffset, TypesOffset);
+    write64(Buffer, HdrStringsOffset, StringsOffset);
+    write64(Buffer, HdrStringsSize, W.Strings.size());
+    write64(Buffer, HdrIndexOffset, HeaderSize);
+
+    unsigned i = 0;
+    for (auto &Entry : TU.getFunctions()) {
+        std::size_t E = HeaderSize + i * IndexEntrySize;
+        write32(Buffer, E + IdxNameOffset, NameOffsets[i]);
+        write32(Buffer, E + IdxNameSize, Entry.first.size());
+        write64(Buffer, E + IdxBodyOffset, BodiesOffset + BodyOffsets[i]);
+        write64(Buffer, E + IdxBodySize, BodyOffsets[i + 1] - BodyOffsets[i]);
+        ++i;
+    }
+
+    std::copy(W.Types.begin(), W.Types.end(), Buffer.begin() + TypesOffset);
+    std::copy(W.Strings.begin(), W.Strings.end(),
+              Buffer.begin() + StringsOffset);
+    Buffer.insert(Buffer.end(), Bodies.begin(), Bodies.end());
+}
+
+BinaryIRReader::~BinaryIRReader() {
+#if KAIJU_MMAP_SUPPORTED
+    if (Mapped) {
+        munmap(const_cast<uint8_t *>(Data), Size);
+        return;
+    }
+#endif
+    delete[] Data;
+}
+
+BinaryIRReader *BinaryIRReader::open(const Path &P, TranslationUnit &TU,
+                                     Context &C) {
+    BinaryIRReader *R = new BinaryIRReader(TU, C);
+
+#if KAIJU_MMAP_SUPPORTED
+    int FD = ::open(P.c_str(), O_RDONLY);
+    if (FD >= 0) {
+        struct stat S;
+        if (fstat(FD, &S) == 0 && S.st_size > 0) {
+            void *M = mmap(nullptr, S.st_size, PROT_READ, MAP_PRIVATE, FD, 0);
+            if (M != MAP_FAILED) {
+                R->Data = static_cast<const uint8_t *>(M);
+                R->Size = S.st_size;
+                R->Mapped = true;
+            }
+        }
+        close(FD);
+    }
+#else
+    std::ifstream Stream(P.c_str(), std::ios::ate | std::ios::binary);
+    if (Stream.is_open()) {
+        std::size_t Size = Stream.tellg();
+        uint8_t *Copy = new uint8_t[Size];
+        Stream.seekg(0, Stream.beg);
+        Stream.read(reinterpret_cast<char *>(Copy), Size);
+        R->Data = Copy;
+        R->Size = Size;
+    }
+#endif
+
+    if (!R->Data || !R->readHeader()) {
+        delete R;
+        return nullptr;
+    }
+
+    return R;
+}
+
+bool BinaryIRReader::readHeader() {
+    if (Size < HeaderSize || std::memcmp(Data, Magic, sizeof(Magic)) != 0
+     || read32(Data + HdrVersion) != Version)
+        return false;
+
+    uint32_t NumTypes = read32(Data + HdrNumTypes);
+    uint64_t TypesOffset = read64(Data + HdrTypesOffset);
+    uint64_t StringsOffset = read64(Data + HdrStringsOffset);
+    uint64_t IndexOffset = read64(Data + HdrIndexOffset);
+    StringsSize = read64(Data + HdrStringsSize);
+    NumFunctions = read32(Data + HdrNumFunctions);
+
+    if (TypesOffset > Size || StringsOffset > Size
+     || StringsSize > Size - StringsOffset || IndexOffset > Size
+     || NumFunctions > (Size - IndexOffset) / IndexEntrySize
+     || NumTypes > 65536)
+        return false;
+
+    Strings = Data + StringsOffset;
+    Index = Data + IndexOffset;
+    Functions.assign(NumFunctions, nullptr);
+
+    Cursor Cur(Data + TypesOffset, Size - TypesOffset);
+    for (uint32_t i = 0; i != NumTypes; ++i) {
+        Type *Ty = nullptr;
+        switch (Cur.readVarint()) {
+        case Type::VoidTyID:    Ty = Type::getVoidTy(Ctx);      break;
+        case Type::HalfTyID:    Ty = Type::getHalfTy(Ctx);      break;
+        case Type::FloatTyID:   Ty = Type::getFloatTy(Ctx);     break;
+        case Type::DoubleTyID:  Ty = Type::getDoubleTy(Ctx);    break;
+        case Type::LabelTyID:   Ty = Type::getLabelTy(Ctx);     break;
+        case Type::PointerTyID: Ty = Type::getPointerTy(Ctx);   break;
+        case Type::IntegerTyID: {
+            uint32_t Width = Cur.readIndex(129);
+            if (Width)
+                Ty = IntegerType::get(Ctx, Width);
+            break;
+        }
+        default:
+            break;
+        }
+
+        if (!Ty || Cur.failed())
+            return false;
+        Types.push_back(Ty);
+    }
+
+    return true;
+}
+
+StringRef BinaryIRReader::getFunctionName(unsigned I) const {
+    assert(I < NumFunctions && "function index out of range.");
+    const uint8_t *E = Index + I * IndexEntrySize;
+    uint64_t Offset = read32(E + IdxNameOffset);
+    uint64_t Length = read32(E + IdxNameSize);
+    if (Offset + Length > StringsSize)
+        return StringRef();
+
+    return StringRef(reinterpret_cast<const char *>(Strings + Offset),
+                     Length);
+}
+
+Function *BinaryIRReader::getFunction(unsigned I) {
+    assert(I < NumFunctions && "function index out of range.");
+    if (Functions[I])
+        return Functions[I];
+
+    FlatFunction FF;
+    if (!readBody(I, FF))
+        return nullptr;
+
+    Functions[I] = FF.build(TU, getFunctionName(I));
+    return Functions[I];
+}
+
+Function *BinaryIRReader::getFunction(StringRef Name) {
+    unsigned Lo = 0, Hi = NumFunctions;
+    while (Lo < Hi) {
+        unsigned Mid = Lo + (Hi - Lo) / 2;
+        if (getFunctionName(Mid) < Name)
+            Lo = Mid + 1;
+        else
+            Hi = Mid;
+    }
+
+    if (Lo == NumFunctions || getFunctionName(Lo) != Name)
+        return nullptr;
+    return getFunction(Lo);
+}
+
+bool BinaryIRReader::materializeAll() {
+    for (unsigned i = 0; i != NumFunctions; ++i)
+        if (!getFunction(i))
+            return false;
+    return true;
+}
+
+bool BinaryIRReader::readBody(unsigned I, FlatFunction &FF) const {
+    const uint8_t *E = Index + I * IndexEntrySize;
+    uint64_t Offset = read64(E + IdxBodyOffset);
+    uint64_t BodySize = read64(E + IdxBodySize);
+    if (Offset > Size || BodySize > Size - Offset || Types.empty())
+        return false;
+
+    Cursor Cur(Data + Offset, BodySize);
+    uint64_t NumTypes = Types.size();
+
+    auto ReadName = [&]() {
+        uint128_t Length = Cur.readVarint();
+        if (!Length)
+            return StringRef();
+
+        uint128_t At = Cur.readVarint();
+        if (At > StringsSize || Length > StringsSize - At) {
+            Cur.readIndex(0);
+            return StringRef();
+        }
+        return StringRef(reinterpret_cast<const char *>(Strings + At),
+                         std::size_t(Length));
+    };
+
+    FF.Types = Types;
+    FF.ReturnType = Cur.readIndex(NumTypes);
+
+    std::vector<StringRef> ArgNames;
+    uint32_t NumArgs = Cur.readCount();
+    for (uint32_t i = 0; i != NumArgs && !Cur.failed(); ++i) {
+        FF.ArgTypes.push_back(Cur.readIndex(NumTypes));
+        ArgNames.push_back(ReadName());
+    }
+
+    std::vector<StringRef> BlockNames;
+    uint64_t NumInsts = 0;
+    uint32_t NumBlocks = Cur.readCount();
+    for (uint32_t b = 0; b != NumBlocks && !Cur.failed(); ++b) {
+        BlockNames.push_back(ReadName());
+        FF.BlockBegins.push_back(NumInsts);
+        NumInsts += Cur.readCount();
+    }
+    FF.BlockBegins.push_back(NumInsts);
+
+    // Every instruction takes at least three bytes.
+    if (Cur.failed() || NumInsts > Cur.remaining() / 3)
+        return false;
+
+    uint32_t NumConstants = Cur.readCount();
+    for (uint32_t i = 0; i != NumConstants && !Cur.failed(); ++i) {
+        uint8_t Kind = Cur.readByte();
+        Type *Ty = Types[Cur.readIndex(NumTypes)];
+
+        switch (Kind) {
+        case ConstInt: {
+            uint128_t V = Cur.readVarint();
+            if (!isa<IntegerType>(Ty))
+                return false;
+            FF.Constants.push_back(ConstantInt::get(cast<IntegerType>(Ty), V));
+            break;
+        }
+        case ConstFP: {
+            uint64_t Bits = Cur.readFixed64();
+            double V;
+            std::memcpy(&V, &Bits, sizeof(V));
+            if (Ty->getTypeID() != Type::HalfTyID
+             && Ty->getTypeID() != Type::FloatTyID
+             && Ty->getTypeID() != Type::DoubleTyID)
+                return false;
+            FF.Constants.push_back(ConstantFP::get(Ty, V));
+            break;
+        }
+        case ConstUndef:
+            FF.Constants.push_back(UndefValue::get(Ty));
+            break;
+        default:
+            return false;
+        }
+    }
+
+    uint64_t NumValues = NumInsts + NumArgs + NumBlocks + NumConstants;
+    FF.Names.resize(NumInsts);
+    FF.Insts.reserve(NumInsts + 1);
+
+    for (uint64_t i = 0; i != NumInsts && !Cur.failed(); ++i) {
+        FlatFunction::Inst R = { Cur.readByte(), 0, 0,
+                                 uint32_t(FF.Operands.size()) };
+        if (R.Opcode == Instruction::BinaryOpInstTy
+         || R.Opcode == Instruction::CmpInstTy)
+            R.SubOpcode = Cur.readByte();
+
+        R.Type = Cur.readIndex(NumTypes);
+        FF.Names[i] = ReadName();
+        FF.Insts.push_back(R);
+
+        uint32_t NumOps = Cur.readCount();
+        for (uint32_t k = 0; k != NumOps; ++k)
+            FF.Operands.push_back(Cur.readIndex(NumValues));
+    }
+
+    if (Cur.failed())
+        return false;
+
+    FF.Insts.push_back(FlatFunction::Inst { 0, 0, 0,
+                                            uint32_t(FF.Operands.size()) });
+    FF.Names.insert(FF.Names.end(), ArgNames.begin(), ArgNames.end());
+    FF.Names.insert(FF.Names.end(), BlockNames.begin(), BlockNames.end());
+
+    Type *PtrTy = Type::getPointerTy(Ctx);
+    for (unsigned t = 0, e = Types.size(); t != e; ++t)
+        if (Types[t] == PtrTy)
+            FF.PointerTy = t;
+
+    return FF.verify();
+}
@@ -0,0 +1,116 @@
+
+#include "kaiju/IR/ConstantFold.h"
+
+using namespace kaiju;
+
+#include <cmath>
+
+// \brief Folds an integer binary operation, see constantFoldBinaryOp.
+static Value *foldInt(Instruction::BinaryOpTy Op, ConstantInt *LHS,
+                      ConstantInt *RHS) {
+    IntegerType *Ty = LHS->getType();
+    unsigned W = Ty->getBitWidth();
+    uint128_t A = LHS->getZExtValue(), B = RHS->getZExtValue();
+    uint128_t SignedMin = uint128_t(1) << (W - 1);
+
+    switch (Op) {
+    case Instruction::Add: return ConstantInt::get(Ty, A + B);
+    case Instruction::Sub: return ConstantInt::get(Ty, A - B);
+    case Instruction::Mul: return ConstantInt::get(Ty, A * B);
+    case Instruction::And: return ConstantInt::get(Ty, A & B);
+
+    case Instruction::UDiv:
+        return B ? ConstantInt::get(Ty, A / B) : nullptr;
+    case Instruction::URem:
+        return B ? ConstantInt::get(Ty, A % B) : nullptr;
+
+    case Instruction::Div:
+    case Instruction::Rem: {
+        if (!B || (A == SignedMin && RHS->isAllOnes()))
+            return nullptr;
+
+        int128_t SA = LHS->getSExtValue(), SB = RHS->getSExtValue();
+        return ConstantInt::get(Ty, static_cast<uint128_t>(
+            Op == Instruction::Div ? SA / SB : SA % SB));
+    }
+
+    case Instruction::Shl:
+        return B < W ? ConstantInt::get(Ty, A << B) : nullptr;
+    case Instruction::LShr:
+        return B < W ? ConstantInt::get(Ty, A >> B) : nullptr;
+    case Instruction::AShr:
+        return B < W ? ConstantInt::get(Ty,
+            static_cast<uint128_t>(LHS->getSExtValue() >> B)) : nullptr;
+
+    case Instruction::MulHU:
+        return ConstantInt::get(Ty, mulHighUnsigned(A, B, W));
+    case Instruction::MulHS:
+        return ConstantInt::get(Ty, mulHighSigned(A, B, W));
+    }
+
+    return nullptr;
+}
+
+// \brief Folds a floating point binary operation, see constantFoldBinaryOp.
+static Value *foldFP(Instruction::BinaryOpTy Op, ConstantFP *LHS,
+                     ConstantFP *RHS) {
+    Type *Ty = LHS->getValueType();
+    double A = LHS->getValue(), B = RHS->getValue(), R;
+
+    switch (Op) {
+    case Instruction::Add: R = A + B;           break;
+    case Instruction::Sub: R = A - B;           break;
+    case Instruction::Mul: R = A * B;           break;
+    case Instruction::Div: R = A / B;           break;
+    case Instruction::Rem: R = std::fmod(A, B); break;
+    default:
+        return nullptr;
+    }
+
+    // Round to the precision of the operation's type.
+    if (Ty->getTypeID() != Type::DoubleTyID)
+        R = static_cast<float>(R);
+
+    return ConstantFP::get(Ty, R);
+}
+
+// \brief Evaluates \p Op on two constants of the same type.
+Value *kaiju::constantFoldBinaryOp(Instruction::BinaryOpTy Op, Value *LHS,
+                                   Value *RHS) {
+    if (isa<ConstantInt>(LHS) && isa<ConstantInt>(RHS))
+        return foldInt(Op, cast<ConstantInt>(LHS), cast<ConstantInt>(RHS));
+
+    if (isa<ConstantFP>(LHS) && isa<ConstantFP>(RHS))
+        return foldFP(Op, cast<ConstantFP>(LHS), cast<ConstantFP>(RHS));
+
+    return nullptr;
+}
+
+// \brief Evaluates the comparison \p Pred on two integer constants.
+ConstantInt *kaiju::constantFoldCmp(CmpInst::Predicate Pred, Value *LHS,
+                                    Value *RHS) {
+    ConstantInt *L = dyn_cast<ConstantInt>(LHS);
+    ConstantInt *R = dyn_cast<ConstantInt>(RHS);
+    if (!L || !R)
+        return nullptr;
+
+    uint128_t UA = L->getZExtValue(), UB = R->getZExtValue();
+    int128_t  SA = L->getSExtValue(), SB = R->getSExtValue();
+    bool Result = false;
+
+    switch (Pred) {
+    case CmpInst::EQ:  Result = UA == UB; break;
+    case CmpInst::NE:  Result = UA != UB; break;
+    case CmpInst::ULT: Result = UA <  UB; break;
+    case CmpInst::ULE: Result = UA <= UB; break;
+    case CmpInst::UGT: Result = UA >  UB; break;
+    case CmpInst::UGE: Result = UA >= UB; break;
+    case CmpInst::SLT: Result = SA <  SB; break;
+    case CmpInst::SLE: Result = SA <= SB; break;
+    case CmpInst::SGT: Result = SA >  SB; break;
+    case CmpInst::SGE: Result = SA >= SB; break;
+    }
+
+    return ConstantInt::get(IntegerType::getInt1Ty(L->getType()->getContext()),
+                            Result);
+}
@@ -0,0 +1,53 @@
+
+#include "kaiju/IR/Constants.h"
+
+using namespace kaiju;
+
+#include <cstring>
+
+#include "kaiju/IR/Context.h"
+
+// \brief Primary way of constructing a ConstantInt. Constants are uniqued
+// within their Context, \p V is truncated to the width of \p Ty.
+ConstantInt *ConstantInt::get(IntegerType *Ty, uint128_t V) {
+    V = truncateToWidth(V, Ty->getBitWidth());
+
+    Context &C = Ty->getContext();
+    ConstantInt *&Slot = C.IntConstants[std::make_pair(Ty, V)];
+
+    if (!Slot)
+        Slot = new ConstantInt(Ty, V);
+
+    return Slot;
+}
+
+// \brief Primary way of constructing a ConstantFP. Constants are uniqued
+// within their Context by type and bit pattern.
+ConstantFP *ConstantFP::get(Type *Ty, double V) {
+    assert((Ty->getTypeID() == Type::FloatTyID
+         || Ty->getTypeID() == Type::DoubleTyID
+         || Ty->getTypeID() == Type::HalfTyID)
+        && "ConstantFP must have a floating point type.");
+
+    uint64_t Bits;
+    std::memcpy(&Bits, &V, sizeof(Bits));
+
+    Context &C = Ty->getContext();
+    ConstantFP *&Slot = C.FPConstants[std::make_pair(Ty, Bits)];
+
+    if (!Slot)
+        Slot = new ConstantFP(Ty, V);
+
+    return Slot;
+}
+
+// \brief Primary way of constructing an UndefValue. There is one UndefValue
+// per type within a Context.
+UndefValue *UndefValue::get(Type *Ty) {
+    UndefValue *&Slot = Ty->getContext().UndefValues[Ty];
+
+    if (!Slot)
+        Slot = new UndefValue(Ty);
+
+    return Slot;
+}
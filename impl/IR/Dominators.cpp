@@ -0,0 +1,189 @@
+
+#include "kaiju/IR/Dominators.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <set>
+
+namespace {
+
+// \brief Marks a block whose immediate dominator is not known yet.
+const unsigned Undefined = ~0u;
+
+} // end anonymous namespace
+
+// ctor, numbers the reachable blocks and solves for immediate dominators.
+DominatorTree::DominatorTree(Function &Fn) {
+    BasicBlock *Entry = Fn.getEntryBlock();
+    if (!Entry)
+        return;
+
+    // Depth first search for the post order, with an explicit stack so deep
+    // CFGs cannot overflow the native one.
+    std::vector<std::pair<BasicBlock *, unsigned>> Stack;
+    std::set<BasicBlock *> Seen;
+
+    Seen.insert(Entry);
+    Stack.push_back(std::make_pair(Entry, 0u));
+
+    while (!Stack.empty()) {
+        BasicBlock *BB = Stack.back().first;
+        unsigned Next = Stack.back().second;
+
+        if (Next == BB->getNumSuccessors()) {
+            Blocks.push_back(BB);
+            Stack.pop_back();
+            continue;
+        }
+
+        ++Stack.back().second;
+
+        BasicBlock *Succ = BB->getSuccessor(Next);
+        if (Seen.insert(Succ).second)
+            Stack.push_back(std::make_pair(Succ, 0u));
+    }
+
+    std::reverse(Blocks.begin(), Blocks.end());
+
+    unsigned N = Blocks.size();
+    for (unsigned i = 0; i != N; ++i)
+        Numbers[Blocks[i]] = i;
+
+    Preds.resize(N);
+    Succs.resize(N);
+
+    for (unsigned i = 0; i != N; ++i) {
+        for (unsigned s = 0, e = Blocks[i]->getNumSuccessors(); s != e; ++s) {
+            unsigned Succ = Numbers[Blocks[i]->getSuccessor(s)];
+            Succs[i].push_back(Succ);
+            Preds[Succ].push_back(i);
+        }
+    }
+
+    // Walk the predecessors in reverse post order until nothing changes.
+    // Every block other than the entry has a predecessor numbered before it,
+    // so each sweep finds a candidate for every block.
+    IDoms.assign(N, Undefined);
+    IDoms[0] = 0;
+
+    auto Intersect = [&](unsigned A, unsigned B) {
+        while (A != B) {
+            while (A > B) A = IDoms[A];
+            while (B > A) B = IDoms[B];
+        }
+        return A;
+    };
+
+    for (bool Changed = true; Changed; ) {
+        Changed = false;
+
+        for (unsigned i = 1; i != N; ++i) {
+            unsigned NewIDom = Undefined;
+
+            for (unsigned P : Preds[i]) {
+                if (IDoms[P] == Undefined)
+                    continue;
+                NewIDom = NewIDom == Undefined ? P : Intersect(P, NewIDom);
+            }
+
+            if (IDoms[i] != NewIDom) {
+                IDoms[i] = NewIDom;
+                Changed = true;
+            }
+        }
+    }
+
+    // Immediate dominators are numbered before the blocks they dominate.
+    Levels.assign(N, 0);
+    Children.resize(N);
+
+    for (unsigned i = 1; i != N; ++i) {
+        Levels[i] = Levels[IDoms[i]] + 1;
+        Children[IDoms[i]].push_back(i);
+    }
+}
+
+// \brief Returns whether block \p A dominates block \p B.
+bool DominatorTree::dominates(unsigned A, unsigned B) const {
+    while (Levels[B] > Levels[A])
+        B = IDoms[B];
+    return A == B;
+}
+
+// ctor.
+IDFCalculator::IDFCalculator(const DominatorTree &Tree)
+     : DT(Tree),
+       Defining(Tree.size(), 0), LiveIn(Tree.size(), 0),
+       Visited(Tree.size(), 0), InFrontier(Tree.size(), 0),
+       Query(0), Buckets(Tree.size()) { /* empty */ }
+
+// \brief Computes the iterated dominance frontier of \p DefBlocks into \p IDF.
+void IDFCalculator::calculate(const std::vector<unsigned> &DefBlocks,
+                              const std::vector<unsigned> *LiveInBlocks,
+                              std::vector<unsigned> &IDF) {
+    ++Query;
+    IDF.clear();
+
+    unsigned MaxLevel = 0;
+    for (unsigned D : DefBlocks) {
+        if (Defining[D] == Query)
+            continue;
+
+        Defining[D] = Query;
+        Buckets[DT.Levels[D]].push_back(D);
+        MaxLevel = std::max(MaxLevel, DT.Levels[D]);
+    }
+
+    if (LiveInBlocks)
+        for (unsigned L : *LiveInBlocks)
+            LiveIn[L] = Query;
+
+    std::vector<unsigned> Worklist;
+
+    // Frontier blocks found while exploring a root are never deeper than the
+    // root, so the buckets drain in a single downwards sweep.
+    for (unsigned Level = MaxLevel + 1; Level-- != 0; ) {
+        std::vector<unsigned> &Bucket = Buckets[Level];
+
+        while (!Bucket.empty()) {
+            unsigned Root = Bucket.back();
+            Bucket.pop_back();
+
+            Visited[Root] = Query;
+            Worklist.push_back(Root);
+
+            while (!Worklist.empty()) {
+                unsigned Node = Worklist.back();
+                Worklist.pop_back();
+
+                // Join edges leave the subtree, their targets are frontier
+                // candidates when no deeper than the root.
+                for (unsigned Succ : DT.Succs[Node]) {
+                    if (DT.IDoms[Succ] == Node && Succ != Node)
+                        continue;
+                    if (DT.Levels[Succ] > Level || InFrontier[Succ] == Query)
+                        continue;
+
+                    InFrontier[Succ] = Query;
+                    if (LiveInBlocks && LiveIn[Succ] != Query)
+                        continue;
+
+                    IDF.push_back(Succ);
+                    if (Defining[Succ] != Query)
+                        Buckets[DT.Levels[Succ]].push_back(Succ);
+                }
+
+                for (unsigned Child : DT.Children[Node]) {
+                    if (Visited[Child] == Query)
+                        continue;
+
+                    Visited[Child] = Query;
+                    Worklist.push_back(Child);
+                }
+            }
+        }
+    }
+
+    std::sort(IDF.begin(), IDF.end());
+}
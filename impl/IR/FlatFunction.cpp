@@ -0,0 +1,314 @@
+
+#include "kaiju/IR/FlatFunction.h"
+
+using namespace kaiju;
+
+#include <unordered_map>
+
+#include "kaiju/IR/Constants.h"
+#include "kaiju/IR/TranslationUnit.h"
+
+namespace {
+
+// Class Flattener
+//
+// \brief Numbers the values of a Function and fills the arrays of a
+// FlatFunction. Constants and types are numbered on first use.
+//
+class Flattener {
+    std::unordered_map<const Value *, uint32_t> Numbers;
+    std::unordered_map<const Type *, uint16_t> TypeNumbers;
+
+    std::vector<Type *> &Types;
+    std::vector<Value *> &Constants;
+    uint32_t FirstConstant;
+
+public:
+    // ctor.
+    Flattener(std::vector<Type *> &Ts, std::vector<Value *> &Cs)
+         : Types(Ts), Constants(Cs), FirstConstant(0) { /* empty */ }
+
+    void setNumber(const Value *V, uint32_t N) { Numbers[V] = N; }
+    void setFirstConstant(uint32_t N) { FirstConstant = N; }
+
+    uint16_t getType(Type *Ty) {
+        auto It = TypeNumbers.find(Ty);
+        if (It != TypeNumbers.end())
+            return It->second;
+
+        assert(Types.size() <= UINT16_MAX && "too many types.");
+        TypeNumbers[Ty] = Types.size();
+        Types.push_back(Ty);
+        return Types.size() - 1;
+    }
+
+    uint32_t getValue(Value *V) {
+        auto It = Numbers.find(V);
+        if (It != Numbers.end())
+            return It->second;
+
+        assert((isa<ConstantInt>(V) || isa<ConstantFP>(V)
+             || isa<UndefValue>(V)) && "operand of another function.");
+        uint32_t N = FirstConstant + Constants.size();
+        Numbers[V] = N;
+        Constants.push_back(V);
+        return N;
+    }
+};
+
+} // end anonymous namespace
+
+FlatFunction::FlatFunction(const Function &Fn) : ReturnType(0), PointerTy(0) {
+    Flattener F(Types, Constants);
+
+    unsigned NumInsts = 0;
+    for (const BasicBlock *BB : Fn)
+        NumInsts += BB->size();
+
+    // Instructions take the first numbers, then the arguments and the
+    // blocks.
+    unsigned NumArgs = Fn.arg_size();
+    Names.resize(NumInsts + NumArgs + Fn.size());
+    Insts.reserve(NumInsts + 1);
+    BlockBegins.reserve(Fn.size() + 1);
+
+    uint32_t N = 0;
+    for (const BasicBlock *BB : Fn)
+        for (const Instruction *I : *BB) {
+            F.setNumber(I, N);
+            if (I->hasNameBinding())
+                Names[N] = I->getName();
+            ++N;
+        }
+
+    ReturnType = F.getType(Fn.getReturnType());
+    for (unsigned i = 0; i != NumArgs; ++i) {
+        const Argument *Arg = Fn.getArg(i);
+        F.setNumber(Arg, N);
+        Names[N++] = Arg->getName();
+        ArgTypes.push_back(F.getType(Arg->getValueType()));
+    }
+
+    for (const BasicBlock *BB : Fn) {
+        F.setNumber(BB, N);
+        Names[N++] = BB->getName();
+    }
+
+    F.setFirstConstant(N);
+
+    for (const BasicBlock *BB : Fn) {
+        BlockBegins.push_back(Insts.size());
+
+        for (const Instruction *I : *BB) {
+            Inst R = { uint8_t(I->getInstructionID()), 0,
+                       F.getType(I->getValueType()),
+                       uint32_t(Operands.size()) };
+
+            if (const BinaryOperator *BO = dyn_cast<BinaryOperator>(I))
+                R.SubOpcode = BO->getOpcode();
+            else if (const CmpInst *Cmp = dyn_cast<CmpInst>(I))
+                R.SubOpcode = Cmp->getPredicate();
+            else if (const AllocaInst *AI = dyn_cast<AllocaInst>(I)) {
+                PointerTy = R.Type;
+                R.Type = F.getType(AI->getAllocatedType());
+            }
+
+            Insts.push_back(R);
+            for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i)
+                Operands.push_back(F.getValue(I->getOperand(i)));
+        }
+    }
+
+    BlockBegins.push_back(Insts.size());
+    Insts.push_back(Inst { 0, 0, 0, uint32_t(Operands.size()) });
+}
+
+Type *FlatFunction::getValueType(uint32_t V) const {
+    if (isInstruction(V))
+        return Types[getOpcode(V) == Instruction::AllocaInstTy
+                         ? PointerTy : Insts[V].Type];
+    if (isArgument(V))
+        return Types[ArgTypes[V - getFirstArgument()]];
+    if (isBlock(V))
+        return Type::getLabelTy(Types[ReturnType]->getContext());
+    return getConstant(V)->getValueType();
+}
+
+bool FlatFunction::verify() const {
+    if (Types.empty() || ReturnType >= Types.size()
+     || PointerTy >= Types.size() || Insts.empty()
+     || BlockBegins.empty() || BlockBegins.back() != getNumInstructions()
+     || Names.size() > getFirstConstant())
+        return false;
+
+    for (uint16_t T : ArgTypes)
+        if (T >= Types.size())
+            return false;
+
+    for (unsigned b = 0, e = getNumBlocks(); b != e; ++b)
+        if (BlockBegins[b] > BlockBegins[b + 1])
+            return false;
+
+    unsigned NumValues = getNumValues();
+    for (uint32_t V : Operands)
+        if (V >= NumValues)
+            return false;
+
+    for (unsigned i = 0, e = getNumInstructions(); i != e; ++i)
+        if (Insts[i].Type >= Types.size()
+         || Insts[i].OperandBegin > Insts[i + 1].OperandBegin
+         || Insts[i + 1].OperandBegin > Operands.size())
+            return false;
+
+    Type *PtrTy = Type::getPointerTy(Types[0]->getContext());
+
+    for (unsigned i = 0, e = getNumInstructions(); i != e; ++i) {
+        const Inst &R = Insts[i];
+        const uint32_t *Ops = Operands.data() + R.OperandBegin;
+        unsigned NumOps = Insts[i + 1].OperandBegin - R.OperandBegin;
+
+        auto IsValue = [&](unsigned k, Type *Ty) {
+            return !isBlock(Ops[k]) && (!Ty || getValueType(Ops[k]) == Ty);
+        };
+
+        bool Valid = false;
+        switch (R.Opcode) {
+        case Instruction::BinaryOpInstTy:
+            Valid = R.SubOpcode <= Instruction::MulHU && NumOps == 2
+                 && IsValue(0, Types[R.Type]) && IsValue(1, Types[R.Type]);
+            break;
+        case Instruction::CmpInstTy:
+            Valid = R.SubOpcode <= CmpInst::SGE && NumOps == 2
+                 && IsValue(0, nullptr)
+                 && isa<IntegerType>(getValueType(Ops[0]))
+                 && IsValue(1, getValueType(Ops[0]));
+            break;
+        case Instruction::BranchInstTy:
+            Valid = (NumOps == 1 && isBlock(Ops[0]))
+                 || (NumOps == 3 && IsValue(0, nullptr)
+                  && isBlock(Ops[1]) && isBlock(Ops[2]));
+            break;
+        case Instruction::ReturnInstTy:
+            Valid = NumOps == 0 || (NumOps == 1 && IsValue(0, nullptr));
+            break;
+        case Instruction::AllocaInstTy:
+            Valid = NumOps == 0 && Types[PointerTy] == PtrTy;
+            break;
+        case Instruction::LoadInstTy:
+            Valid = NumOps == 1 && IsValue(0, PtrTy);
+            break;
+        case Instruction::StoreInstTy:
+            Valid = NumOps == 2 && IsValue(0, nullptr) && IsValue(1, PtrTy);
+            break;
+        case Instruction::PhiNodeTy:
+            Valid = NumOps % 2 == 0;
+            for (unsigned k = 0; k < NumOps && Valid; k += 2)
+                Valid = IsValue(k, Types[R.Type]) && isBlock(Ops[k + 1]);
+            break;
+        }
+
+        if (!Valid)
+            return false;
+    }
+
+    return true;
+}
+
+Function *FlatFunction::build(TranslationUnit &TU, StringRef Name) const {
+    Type *RetTy = Types[ReturnType];
+    Context &C = RetTy->getContext();
+    Function *Fn = cast<Function>(TU.createFunc(RetTy, Name));
+
+    std::vector<Value *> Values(getNumValues());
+
+    for (unsigned i = 0, e = getNumArguments(); i != e; ++i) {
+        uint32_t V = getFirstArgument() + i;
+        Values[V] = TU.createArg(Types[ArgTypes[i]], Fn, getName(V));
+    }
+
+    for (unsigned b = 0, e = getNumBlocks(); b != e; ++b) {
+        uint32_t V = getFirstBlock() + b;
+        Values[V] = TU.createBlock(C, getName(V), Fn);
+    }
+
+    for (unsigned i = 0, e = getNumConstants(); i != e; ++i)
+        Values[getFirstConstant() + i] = Constants[i];
+
+    // Operands may be defined further down, so instructions are created
+    // with undefined operands of the right type, which are replaced once
+    // every instruction exists.
+    auto Placeholder = [&](uint32_t V) -> Value * {
+        if (isBlock(V))
+            return Values[V];
+        return UndefValue::get(getValueType(V));
+    };
+
+    for (unsigned b = 0, e = getNumBlocks(); b != e; ++b) {
+        BasicBlock *BB = cast<BasicBlock>(Values[getFirstBlock() + b]);
+
+        for (unsigned i = getBlockBegin(b), n = getBlockEnd(b); i != n; ++i) {
+            const Inst &R = Insts[i];
+            const uint32_t *Ops = Operands.data() + R.OperandBegin;
+            unsigned NumOps = Insts[i + 1].OperandBegin - R.OperandBegin;
+            Instruction *I = nullptr;
+
+            switch (getOpcode(i)) {
+            case Instruction::BinaryOpInstTy:
+                I = BinaryOperator::get(
+                    Instruction::BinaryOpTy(R.SubOpcode),
+                    Placeholder(Ops[0]), Placeholder(Ops[1]));
+                break;
+            case Instruction::CmpInstTy:
+                I = CmpInst::get(CmpInst::Predicate(R.SubOpcode),
+                                 Placeholder(Ops[0]), Placeholder(Ops[1]));
+                break;
+            case Instruction::BranchInstTy:
+                if (NumOps == 1)
+                    I = BranchInst::get(cast<BasicBlock>(Values[Ops[0]]));
+                else
+                    I = BranchInst::get(Placeholder(Ops[0]),
+                                        cast<BasicBlock>(Values[Ops[1]]),
+                                        cast<BasicBlock>(Values[Ops[2]]));
+                break;
+            case Instruction::ReturnInstTy:
+                if (NumOps)
+                    I = ReturnInst::get(Placeholder(Ops[0]));
+                else
+                    I = ReturnInst::get(C);
+                break;
+            case Instruction::AllocaInstTy:
+                I = AllocaInst::get(Types[R.Type]);
+                break;
+            case Instruction::LoadInstTy:
+                I = LoadInst::get(Types[R.Type], Placeholder(Ops[0]));
+                break;
+            case Instruction::StoreInstTy:
+                I = StoreInst::get(Placeholder(Ops[0]), Placeholder(Ops[1]));
+                break;
+            case Instruction::PhiNodeTy: {
+                PhiNode *Phi = PhiNode::get(Types[R.Type]);
+                for (unsigned k = 0; k != NumOps; k += 2)
+                    Phi->addIncoming(Placeholder(Ops[k]),
+                                     cast<BasicBlock>(Values[Ops[k + 1]]));
+                I = Phi;
+                break;
+            }
+            }
+
+            if (!getName(i).empty())
+                I->setName(getName(i));
+
+            BB->push_back(I);
+            Values[i] = I;
+        }
+    }
+
+    for (unsigned i = 0, e = getNumInstructions(); i != e; ++i) {
+        Instruction *I = cast<Instruction>(Values[i]);
+        unsigned k = 0;
+        for (uint32_t V : getOperands(i))
+            I->setOperand(k++, Values[V]);
+    }
+
+    return Fn;
+}
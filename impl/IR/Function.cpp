@@ -0,0 +1,30 @@
+
+#include "kaiju/IR/Function.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <set>
+
+// \brief Unlinks every block in \p BBs from this function and deletes them
+// along with their instructions.
+void Function::eraseBlocks(const std::vector<BasicBlock *> &BBs) {
+    std::set<BasicBlock *> Erased(BBs.begin(), BBs.end());
+
+    auto NewEnd = std::remove_if(Blocks.begin(), Blocks.end(),
+        [&](BasicBlock *BB) { return Erased.count(BB) != 0; });
+    assert((std::size_t)(Blocks.end() - NewEnd) == Erased.size()
+        && "Block does not belong to this function.");
+    Blocks.erase(NewEnd, Blocks.end());
+
+    for (BasicBlock *BB : Erased) {
+        // Erase from the back, which keeps removal constant time.
+        while (!BB->empty()) {
+            Instruction *I = *(BB->end() - 1);
+            BB->remove(BB->end() - 1);
+            delete I;
+        }
+
+        delete BB;
+    }
+}
@@ -0,0 +1,682 @@
+
+#include "kaiju/IR/IRParser.h"
+
+using namespace kaiju;
+
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#include "kaiju/IR/Constants.h"
+#include "kaiju/IR/FlatFunction.h"
+
+namespace kaiju {
+
+// Class IRParser
+//
+// \brief Reads the textual IR one function at a time into a FlatFunction,
+// which then builds the function.
+//
+// Local names are resolved through a symbol table, where a name used before
+// its definition is entered with the type of its first use, checked once the
+// definition is seen. Operands refer to symbols, or to constants with the
+// top bit set, until the end of the function, when they are renumbered the
+// way FlatFunction numbers values.
+//
+class IRParser {
+    const char *Begin;
+    const char *Cur;
+    const char *End;
+
+    TranslationUnit &TU;
+    Context &Ctx;
+    std::string &Error;
+
+    enum SymbolKind {
+        Undefined,
+        InstSym,
+        ArgSym,
+        BlockSym,
+    };
+
+    // \brief A local name, with the type of its definition or of its first
+    // use, and the place of either for errors.
+    struct Symbol {
+        SymbolKind Kind;
+        uint32_t Index;
+        Type *Ty;
+        const char *Loc;
+    };
+
+    static const uint32_t ConstantBit = 1u << 31;
+
+    // The arrays are reused from function to function.
+    FlatFunction FF;
+    std::vector<Symbol> Symbols;
+    std::unordered_map<std::string_view, uint32_t> Named;
+    std::vector<uint32_t> Numbered;
+    IntegerType *IntegerTypes[129] = {};
+    std::unordered_map<const Value *, uint32_t> ConstantNumbers;
+    std::vector<StringRef> ArgNames, BlockNames;
+
+    bool error(const char *Loc, const char *Message);
+
+    void skipSpace() {
+        while (Cur != End) {
+            char C = *Cur;
+            if (C == ' ' || C == '\t' || C == '\n' || C == '\r') {
+                ++Cur;
+            } else if (C == ';') {
+                while (Cur != End && *Cur != '\n')
+                    ++Cur;
+            } else {
+                break;
+            }
+        }
+    }
+
+    static bool isIdentifierChar(char C) {
+        return (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z')
+            || (C >= '0' && C <= '9') || C == '.' || C == '_' || C == '$'
+            || C == '-';
+    }
+
+    // \brief Skips spaces and consumes \p C if it comes next.
+    bool consume(char C) {
+        skipSpace();
+        if (Cur == End || *Cur != C)
+            return false;
+        ++Cur;
+        return true;
+    }
+
+    bool expect(char C, const char *Message) {
+        return consume(C) || error(Cur, Message);
+    }
+
+    // \brief Reads a run of identifier characters.
+    StringRef lexWord() {
+        skipSpace();
+        const char *Start = Cur;
+        while (Cur != End && isIdentifierChar(*Cur))
+            ++Cur;
+        return StringRef(Start, Cur - Start);
+    }
+
+    bool expectWord(const char *Word, const char *Message) {
+        const char *Loc = (skipSpace(), Cur);
+        return lexWord() == Word || error(Loc, Message);
+    }
+
+    // \brief Reads a name after its sigil, quoted or not, or a number into
+    // \p Number, which is ~0 for names.
+    bool lexName(StringRef &Name, uint64_t &Number);
+
+    bool parseType(Type *&Ty);
+
+    uint16_t getTypeIndex(Type *Ty);
+
+    // \brief Returns the symbol of local \p Name or \p Number, entering it
+    // as used with type \p Ty at \p Loc if it is new.
+    uint32_t getSymbol(StringRef Name, uint64_t Number, Type *Ty,
+                       const char *Loc);
+
+    // \brief Defines the local named after the sigil at the cursor.
+    bool defineSymbol(SymbolKind Kind, uint32_t Index, Type *Ty,
+                      StringRef &Name);
+
+    bool parseValue(Type *Ty, uint32_t &Op);
+    bool parseTypedValue(Type *&Ty, uint32_t &Op);
+    bool parseBlockRef(uint32_t &Op);
+    bool parseLabelRef(uint32_t &Op);
+
+    bool parseInstruction();
+    bool parseFunction();
+
+public:
+    // ctor.
+    IRParser(StringRef Text, TranslationUnit &T, Context &C, std::string &E)
+         : Begin(Text.begin()), Cur(Text.begin()), End(Text.end()), TU(T),
+           Ctx(C), Error(E) { /* empty */ }
+
+    bool run();
+};
+
+} // namespace kaiju
+
+bool IRParser::error(const char *Loc, const char *Message) {
+    unsigned Line = 1, Column = 1;
+    for (const char *P = Begin; P != Loc; ++P) {
+        if (*P == '\n') {
+            ++Line;
+            Column = 1;
+        } else {
+            ++Column;
+        }
+    }
+
+    Error = std::to_string(Line) + ":" + std::to_string(Column) + ": "
+          + Message;
+    return false;
+}
+
+bool IRParser::lexName(StringRef &Name, uint64_t &Number) {
+    Number = ~uint64_t(0);
+
+    if (Cur != End && *Cur == '"') {
+        const char *Start = ++Cur;
+        while (Cur != End && *Cur != '"' && *Cur != '\n')
+            ++Cur;
+        if (Cur == End || *Cur != '"')
+            return error(Start - 1, "unterminated quoted name");
+        Name = StringRef(Start, Cur++ - Start);
+        return true;
+    }
+
+    // Numbers index a table, a function cannot define more values than the
+    // text has characters.
+    if (Cur != End && *Cur >= '0' && *Cur <= '9') {
+        const char *Start = Cur;
+        uint64_t N = 0;
+        while (Cur != End && *Cur >= '0' && *Cur <= '9') {
+            N = N * 10 + (*Cur++ - '0');
+            if (N >= uint64_t(End - Begin))
+                return error(Start, "value number too large");
+        }
+        Number = N;
+        Name = StringRef();
+        return true;
+    }
+
+    const char *Start = Cur;
+    while (Cur != End && isIdentifierChar(*Cur))
+        ++Cur;
+    if (Cur == Start)
+        return error(Start, "expected a name");
+
+    Name = StringRef(Start, Cur - Start);
+    return true;
+}
+
+bool IRParser::parseType(Type *&Ty) {
+    const char *Loc = (skipSpace(), Cur);
+    StringRef Word = lexWord();
+
+    if (Word.size() > 1 && Word[0] == 'i') {
+        unsigned Width = 0;
+        for (std::size_t i = 1; i != Word.size() && Width <= 128; ++i) {
+            if (Word[i] < '0' || Word[i] > '9')
+                return error(Loc, "expected a type");
+            Width = Width * 10 + (Word[i] - '0');
+        }
+
+        if (Width == 0 || Width > 128)
+            return error(Loc, "integer width must be between 1 and 128");
+        if (!IntegerTypes[Width])
+            IntegerTypes[Width] = IntegerType::get(Ctx, Width);
+        Ty = IntegerTypes[Width];
+        return true;
+    }
+
+    if (Word == "void")
+        Ty = Type::getVoidTy(Ctx);
+    else if (Word == "ptr")
+        Ty = Type::getPointerTy(Ctx);
+    else if (Word == "f64")
+        Ty = Type::getDoubleTy(Ctx);
+    else if (Word == "f32")
+        Ty = Type::getFloatTy(Ctx);
+    else if (Word == "f16")
+        Ty = Type::getHalfTy(Ctx);
+    else if (Word == "label")
+        Ty = Type::getLabelTy(Ctx);
+    else
+        return error(Loc, "expected a type");
+    return true;
+}
+
+uint16_t IRParser::getTypeIndex(Type *Ty) {
+    for (std::size_t i = 0, e = FF.Types.size(); i != e; ++i)
+        if (FF.Types[i] == Ty)
+            return i;
+
+    FF.Types.push_back(Ty);
+    return FF.Types.size() - 1;
+}
+
+uint32_t IRParser::getSymbol(StringRef Name, uint64_t Number, Type *Ty,
+                             const char *Loc) {
+    uint32_t *Slot;
+    if (Number == ~uint64_t(0))
+        Slot = &Named.emplace(std::string_view(Name.data(), Name.size()),
+                              ~0u).first->second;
+    else
+    {
+        if (Number >= Numbered.size())
+            Numbered.resize(Number + 1, ~0u);
+        Slot = &Numbered[Number];
+    }
+
+    if (*Slot == ~0u) {
+        *Slot = Symbols.size();
+        Symbols.push_back(Symbol { Undefined, 0, Ty, Loc });
+    }
+    return *Slot;
+}
+
+bool IRParser::defineSymbol(SymbolKind Kind, uint32_t Index, Type *Ty,
+                            StringRef &Name) {
+    const char *Loc = Cur;
+    uint64_t Number;
+    if (!lexName(Name, Number))
+        return false;
+
+    Symbol &S = Symbols[getSymbol(Name, Number, Ty, Loc)];
+    if (S.Kind != Undefined)
+        return error(Loc, "redefinition of a local name");
+    if (S.Ty != Ty)
+        return error(Loc, "definition does not match the type of the uses");
+
+    S.Kind = Kind;
+    S.Index = Index;
+    S.Loc = Loc;
+    return true;
+}
+
+bool IRParser::parseValue(Type *Ty, uint32_t &Op) {
+    skipSpace();
+    const char *Loc = Cur;
+    if (Cur == End)
+        return error(Loc, "expected a value");
+
+    if (*Cur == '%') {
+        ++Cur;
+        StringRef Name;
+        uint64_t Number;
+        if (!lexName(Name, Number))
+            return false;
+
+        Op = getSymbol(Name, Number, Ty, Loc);
+        const Symbol &S = Symbols[Op];
+        if (S.Ty != Ty)
+            return error(Loc, "value used with a type other than its own");
+        return true;
+    }
+
+    Value *C = nullptr;
+    if (*Cur == '-' || (*Cur >= '0' && *Cur <= '9')) {
+        bool Negative = consume('-');
+        bool Hex = End - Cur > 2 && Cur[0] == '0' && (Cur[1] == 'x');
+        Cur += Hex ? 2 : 0;
+
+        const char *Digits = Cur;
+        uint128_t V = 0;
+        unsigned Base = Hex ? 16 : 10;
+        for (; Cur != End; ++Cur) {
+            unsigned D;
+            if (*Cur >= '0' && *Cur <= '9')
+                D = *Cur - '0';
+            else if (Hex && *Cur >= 'A' && *Cur <= 'F')
+                D = *Cur - 'A' + 10;
+            else if (Hex && *Cur >= 'a' && *Cur <= 'f')
+                D = *Cur - 'a' + 10;
+            else
+                break;
+
+            if (V > (~uint128_t(0) - D) / Base)
+                return error(Loc, "constant too large");
+            V = V * Base + D;
+        }
+
+        if (Cur == Digits)
+            return error(Loc, "expected a value");
+
+        if (IntegerType *ITy = dyn_cast<IntegerType>(Ty)) {
+            C = ConstantInt::get(ITy, Negative ? 0 - V : V);
+        } else if (Ty->getTypeID() == Type::DoubleTyID
+                || Ty->getTypeID() == Type::FloatTyID
+                || Ty->getTypeID() == Type::HalfTyID) {
+            double D;
+            if (Hex && !Negative) {
+                uint64_t Bits = uint64_t(V);
+                if (V != Bits)
+                    return error(Loc, "constant too large");
+                std::memcpy(&D, &Bits, sizeof(D));
+            } else {
+                // Decimal literals may carry a fraction and an exponent.
+                while (Cur != End && (isIdentifierChar(*Cur) || *Cur == '+'))
+                    ++Cur;
+                std::string Literal(Loc, Cur);
+                char *LiteralEnd;
+                D = std::strtod(Literal.c_str(), &LiteralEnd);
+                if (*LiteralEnd)
+                    return error(Loc, "malformed floating point constant");
+            }
+            C = ConstantFP::get(Ty, D);
+        } else {
+            return error(Loc, "constant of a type without constants");
+        }
+    } else if (lexWord() == "undef") {
+        if (Ty->getTypeID() == Type::LabelTyID
+         || Ty->getTypeID() == Type::VoidTyID)
+            return error(Loc, "undef of a type without values");
+        C = UndefValue::get(Ty);
+    } else {
+        return error(Loc, "expected a value");
+    }
+
+    auto It = ConstantNumbers.emplace(C, FF.Constants.size()).first;
+    if (It->second == FF.Constants.size())
+        FF.Constants.push_back(C);
+    Op = It->second | ConstantBit;
+    return true;
+}
+
+bool IRParser::parseTypedValue(Type *&Ty, uint32_t &Op) {
+    if (!parseType(Ty))
+        return false;
+    if (Ty->getTypeID() == Type::VoidTyID
+     || Ty->getTypeID() == Type::LabelTyID)
+        return error(Cur, "expected a value type");
+    return parseValue(Ty, Op);
+}
+
+bool IRParser::parseBlockRef(uint32_t &Op) {
+    skipSpace();
+    if (Cur == End || *Cur != '%')
+        return error(Cur, "expected a block");
+    return parseValue(Type::getLabelTy(Ctx), Op);
+}
+
+bool IRParser::parseLabelRef(uint32_t &Op) {
+    return expectWord("label", "expected 'label'") && parseBlockRef(Op);
+}
+
+bool IRParser::parseInstruction() {
+    uint32_t Index = FF.Insts.size();
+    const char *Loc = Cur;
+
+    // The result name, defined once the type of the result is known.
+    const char *ResultLoc = nullptr;
+    if (*Cur == '%') {
+        ResultLoc = ++Cur;
+        StringRef Name;
+        uint64_t Number;
+        if (!lexName(Name, Number) || !expect('=', "expected '='"))
+            return false;
+    }
+
+    const char *OpLoc = (skipSpace(), Cur);
+    StringRef Op = lexWord();
+
+    FlatFunction::Inst R = { 0, 0, 0, uint32_t(FF.Operands.size()) };
+    Type *Ty = nullptr, *OpTy = nullptr;
+    uint32_t Ops[3];
+    unsigned NumOps = 0;
+
+    if (Op == "icmp") {
+        StringRef Pred = lexWord();
+        unsigned P = 0;
+        while (P <= CmpInst::SGE
+            && Pred != CmpInst::getPredicateName(CmpInst::Predicate(P)))
+            ++P;
+        if (P > CmpInst::SGE)
+            return error(Pred.data(), "unknown comparison predicate");
+
+        R.Opcode = Instruction::CmpInstTy;
+        R.SubOpcode = P;
+        if (!parseTypedValue(OpTy, Ops[0])
+         || !expect(',', "expected ','") || !parseValue(OpTy, Ops[1]))
+            return false;
+        if (!isa<IntegerType>(OpTy))
+            return error(OpLoc, "only integers can be compared");
+
+        Ty = IntegerType::getInt1Ty(Ctx);
+        NumOps = 2;
+    } else if (Op == "br") {
+        R.Opcode = Instruction::BranchInstTy;
+        Ty = Type::getVoidTy(Ctx);
+
+        if (!parseType(OpTy))
+            return false;
+        if (OpTy->getTypeID() == Type::LabelTyID) {
+            if (!parseBlockRef(Ops[0]))
+                return false;
+            NumOps = 1;
+        } else {
+            if (!parseValue(OpTy, Ops[0]) || !expect(',', "expected ','")
+             || !parseLabelRef(Ops[1]) || !expect(',', "expected ','")
+             || !parseLabelRef(Ops[2]))
+                return false;
+            NumOps = 3;
+        }
+    } else if (Op == "ret") {
+        R.Opcode = Instruction::ReturnInstTy;
+        Ty = Type::getVoidTy(Ctx);
+
+        if (!parseType(OpTy))
+            return false;
+        if (OpTy->getTypeID() != Type::VoidTyID) {
+            if (!parseValue(OpTy, Ops[0]))
+                return false;
+            NumOps = 1;
+        }
+    } else if (Op == "alloca") {
+        R.Opcode = Instruction::AllocaInstTy;
+        if (!parseType(OpTy))
+            return false;
+        Ty = Type::getPointerTy(Ctx);
+        FF.PointerTy = getTypeIndex(Ty);
+    } else if (Op == "load") {
+        R.Opcode = Instruction::LoadInstTy;
+        if (!parseType(Ty) || !expect(',', "expected ','")
+         || !parseTypedValue(OpTy, Ops[0]))
+            return false;
+        if (OpTy != Type::getPointerTy(Ctx))
+            return error(OpLoc, "loads must be from a pointer");
+        NumOps = 1;
+    } else if (Op == "store") {
+        R.Opcode = Instruction::StoreInstTy;
+        Ty = Type::getVoidTy(Ctx);
+        if (!parseTypedValue(OpTy, Ops[0]) || !expect(',', "expected ','")
+         || !parseTypedValue(OpTy, Ops[1]))
+            return false;
+        if (OpTy != Type::getPointerTy(Ctx))
+            return error(OpLoc, "stores must be to a pointer");
+        NumOps = 2;
+    } else if (Op == "phi") {
+        R.Opcode = Instruction::PhiNodeTy;
+        if (!parseType(Ty))
+            return false;
+
+        do {
+            uint32_t V, BB;
+            if (!expect('[', "expected '['") || !parseValue(Ty, V)
+             || !expect(',', "expected ','") || !parseBlockRef(BB)
+             || !expect(']', "expected ']'"))
+                return false;
+            FF.Operands.push_back(V);
+            FF.Operands.push_back(BB);
+        } while (consume(','));
+    } else {
+        unsigned B = 0;
+        while (B <= Instruction::MulHU
+            && Op != BinaryOperator::getOpcodeName(Instruction::BinaryOpTy(B)))
+            ++B;
+        if (B > Instruction::MulHU)
+            return error(OpLoc, "unknown instruction");
+
+        R.Opcode = Instruction::BinaryOpInstTy;
+        R.SubOpcode = B;
+        if (!parseTypedValue(Ty, Ops[0]) || !expect(',', "expected ','")
+         || !parseValue(Ty, Ops[1]))
+            return false;
+        NumOps = 2;
+    }
+
+    FF.Operands.insert(FF.Operands.end(), Ops, Ops + NumOps);
+
+    bool HasResult = Ty->getTypeID() != Type::VoidTyID;
+    if (HasResult != (ResultLoc != nullptr))
+        return error(Loc, HasResult ? "instruction result must be named"
+                                    : "instruction has no result to name");
+
+    R.Type = getTypeIndex(R.Opcode == Instruction::AllocaInstTy ? OpTy : Ty);
+    FF.Insts.push_back(R);
+    FF.Names.push_back(StringRef());
+
+    if (ResultLoc) {
+        const char *After = Cur;
+        Cur = ResultLoc;
+        if (!defineSymbol(InstSym, Index, Ty, FF.Names.back()))
+            return false;
+        Cur = After;
+    }
+    return true;
+}
+
+bool IRParser::parseFunction() {
+    FF.Types.clear();
+    FF.ArgTypes.clear();
+    FF.Constants.clear();
+    FF.Insts.clear();
+    FF.Operands.clear();
+    FF.BlockBegins.clear();
+    FF.Names.clear();
+    FF.ReturnType = FF.PointerTy = 0;
+    Symbols.clear();
+    Named.clear();
+    Numbered.clear();
+    ConstantNumbers.clear();
+    ArgNames.clear();
+    BlockNames.clear();
+
+    Type *RetTy;
+    if (!parseType(RetTy) || !expect('@', "expected a function name"))
+        return false;
+    FF.ReturnType = getTypeIndex(RetTy);
+
+    StringRef FnName;
+    if (Cur != End && *Cur == '"') {
+        const char *Start = ++Cur;
+        while (Cur != End && *Cur != '"' && *Cur != '\n')
+            ++Cur;
+        if (Cur == End || *Cur != '"')
+            return error(Start - 1, "unterminated quoted name");
+        FnName = StringRef(Start, Cur++ - Start);
+    } else {
+        FnName = lexWord();
+        if (FnName.empty())
+            return error(Cur, "expected a function name");
+    }
+
+    if (!expect('(', "expected '('"))
+        return false;
+
+    if (!consume(')')) {
+        do {
+            Type *Ty;
+            if (!parseType(Ty) || !expect('%', "expected an argument name"))
+                return false;
+            if (Ty->getTypeID() == Type::VoidTyID
+             || Ty->getTypeID() == Type::LabelTyID)
+                return error(Cur, "expected a value type");
+
+            ArgNames.push_back(StringRef());
+            FF.ArgTypes.push_back(getTypeIndex(Ty));
+            if (!defineSymbol(ArgSym, ArgNames.size() - 1, Ty,
+                              ArgNames.back()))
+                return false;
+        } while (consume(','));
+
+        if (!expect(')', "expected ')'"))
+            return false;
+    }
+
+    if (!expect('{', "expected '{'"))
+        return false;
+
+    // Every block starts with its label.
+    Type *LabelTy = Type::getLabelTy(Ctx);
+    for (;;) {
+        skipSpace();
+        if (Cur == End)
+            return error(Cur, "expected '}'");
+        if (*Cur == '}')
+            break;
+
+        bool IsLabel = *Cur == '"' || (*Cur >= '0' && *Cur <= '9');
+        if (!IsLabel && *Cur != '%') {
+            const char *P = Cur;
+            while (P != End && isIdentifierChar(*P))
+                ++P;
+            IsLabel = P != End && *P == ':';
+        }
+
+        if (IsLabel) {
+            BlockNames.push_back(StringRef());
+            FF.BlockBegins.push_back(FF.Insts.size());
+            if (!defineSymbol(BlockSym, BlockNames.size() - 1, LabelTy,
+                              BlockNames.back())
+             || !expect(':', "expected ':'"))
+                return false;
+            continue;
+        }
+
+        if (BlockNames.empty())
+            return error(Cur, "expected a block label");
+        if (!parseInstruction())
+            return false;
+    }
+    ++Cur;
+
+    // Renumber operands: instructions first, then arguments, blocks and
+    // constants.
+    uint32_t NumInsts = FF.Insts.size();
+    uint32_t FirstBlock = NumInsts + ArgNames.size();
+    uint32_t FirstConstant = FirstBlock + BlockNames.size();
+
+    std::vector<uint32_t> Numbers(Symbols.size());
+    for (std::size_t i = 0, e = Symbols.size(); i != e; ++i) {
+        const Symbol &S = Symbols[i];
+        switch (S.Kind) {
+        case Undefined:
+            return error(S.Loc, "use of an undefined local name");
+        case InstSym:   Numbers[i] = S.Index;               break;
+        case ArgSym:    Numbers[i] = NumInsts + S.Index;    break;
+        case BlockSym:  Numbers[i] = FirstBlock + S.Index;  break;
+        }
+    }
+
+    for (uint32_t &Op : FF.Operands)
+        Op = Op & ConstantBit ? FirstConstant + (Op & ~ConstantBit)
+                              : Numbers[Op];
+
+    FF.Insts.push_back(FlatFunction::Inst { 0, 0, 0,
+                                            uint32_t(FF.Operands.size()) });
+    FF.BlockBegins.push_back(NumInsts);
+    FF.Names.insert(FF.Names.end(), ArgNames.begin(), ArgNames.end());
+    FF.Names.insert(FF.Names.end(), BlockNames.begin(), BlockNames.end());
+
+    if (!FF.verify())
+        return error(FnName.data(), "malformed function");
+
+    FF.build(TU, FnName);
+    return true;
+}
+
+bool IRParser::run() {
+    for (;;) {
+        skipSpace();
+        if (Cur == End)
+            return true;
+        if (!expectWord("define", "expected 'define'") || !parseFunction())
+            return false;
+    }
+}
+
+bool kaiju::parseIR(StringRef Text, TranslationUnit &TU, Context &C,
+                    std::string &Error) {
+    return IRParser(Text, TU, C, Error).run();
+}
@@ -0,0 +1,256 @@
+
+#include "kaiju/IR/IRPrinter.h"
+
+using namespace kaiju;
+
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#include "kaiju/IR/Constants.h"
+#include "kaiju/IR/FlatFunction.h"
+
+namespace {
+
+bool isIdentifierChar(char C) {
+    return (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z')
+        || (C >= '0' && C <= '9') || C == '.' || C == '_' || C == '$'
+        || C == '-';
+}
+
+// \brief Returns whether \p Name can be printed as is. Names starting with a
+// digit are left to numbered values.
+bool isIdentifier(StringRef Name) {
+    if (Name.empty() || (Name[0] >= '0' && Name[0] <= '9') || Name[0] == '-')
+        return false;
+
+    for (char C : Name)
+        if (!isIdentifierChar(C))
+            return false;
+    return true;
+}
+
+// \brief Returns whether \p Name can be printed between quotes, which the
+// parser takes as they are, without escapes.
+bool isQuotable(StringRef Name) {
+    for (char C : Name)
+        if ((unsigned char)C < 0x20 || C == '"')
+            return false;
+    return !Name.empty();
+}
+
+void printName(raw_ostream &OS, char Sigil, StringRef Name) {
+    OS << Sigil;
+    if (isIdentifier(Name))
+        OS << Name;
+    else
+        OS << '"' << Name << '"';
+}
+
+// Class FunctionPrinter
+//
+// \brief Prints a function from its FlatFunction.
+//
+class FunctionPrinter {
+    FlatFunction FF;
+    raw_ostream &OS;
+
+    // \brief The number every value is printed with, ~0u for values printed
+    // by name.
+    std::vector<uint32_t> Numbers;
+
+    void printValue(uint32_t V);
+
+    void printTypedValue(uint32_t V) {
+        FF.getValueType(V)->dump(OS) << ' ';
+        printValue(V);
+    }
+
+    void printInst(unsigned I);
+
+public:
+    // ctor.
+    FunctionPrinter(const Function &Fn, raw_ostream &O)
+         : FF(Fn), OS(O) { /* empty */ }
+
+    void run(StringRef Name);
+};
+
+void FunctionPrinter::printValue(uint32_t V) {
+    if (FF.isConstant(V)) {
+        const Value *C = FF.getConstant(V);
+        if (const ConstantInt *CI = dyn_cast<ConstantInt>(C)) {
+            OS << CI->getZExtValue();
+        } else if (const ConstantFP *CF = dyn_cast<ConstantFP>(C)) {
+            uint64_t Bits;
+            double D = CF->getValue();
+            std::memcpy(&Bits, &D, sizeof(Bits));
+            OS.write("0x", 2).write_hex(Bits, 16);
+        } else {
+            OS << "undef";
+        }
+        return;
+    }
+
+    if (Numbers[V] == ~0u)
+        printName(OS, '%', FF.getName(V));
+    else
+        OS << '%' << Numbers[V];
+}
+
+void FunctionPrinter::printInst(unsigned I) {
+    const FlatFunction::Inst &R = FF.getInst(I);
+    const uint32_t *Ops = FF.getOperands(I).begin();
+    unsigned NumOps = FF.getOperands(I).end() - Ops;
+
+    OS << "  ";
+    if (FF.getValueType(I)->getTypeID() != Type::VoidTyID) {
+        printValue(I);
+        OS << " = ";
+    }
+
+    switch (FF.getOpcode(I)) {
+    case Instruction::BinaryOpInstTy:
+        OS << BinaryOperator::getOpcodeName(
+                  Instruction::BinaryOpTy(R.SubOpcode)) << ' ';
+        printTypedValue(Ops[0]);
+        OS << ", ";
+        printValue(Ops[1]);
+        break;
+    case Instruction::CmpInstTy:
+        OS << "icmp "
+           << CmpInst::getPredicateName(CmpInst::Predicate(R.SubOpcode))
+           << ' ';
+        printTypedValue(Ops[0]);
+        OS << ", ";
+        printValue(Ops[1]);
+        break;
+    case Instruction::BranchInstTy:
+        OS << "br ";
+        for (unsigned i = 0; i != NumOps; ++i) {
+            OS << (i ? ", " : "");
+            printTypedValue(Ops[i]);
+        }
+        break;
+    case Instruction::ReturnInstTy:
+        OS << "ret ";
+        if (NumOps)
+            printTypedValue(Ops[0]);
+        else
+            OS << "void";
+        break;
+    case Instruction::AllocaInstTy:
+        FF.getType(R.Type)->dump(OS << "alloca ");
+        break;
+    case Instruction::LoadInstTy:
+        FF.getType(R.Type)->dump(OS << "load ") << ", ";
+        printTypedValue(Ops[0]);
+        break;
+    case Instruction::StoreInstTy:
+        OS << "store ";
+        printTypedValue(Ops[0]);
+        OS << ", ";
+        printTypedValue(Ops[1]);
+        break;
+    case Instruction::PhiNodeTy:
+        FF.getType(R.Type)->dump(OS << "phi ");
+        for (unsigned i = 0; i != NumOps; i += 2) {
+            OS << (i ? ", [ " : " [ ");
+            printValue(Ops[i]);
+            OS << ", ";
+            printValue(Ops[i + 1]);
+            OS << " ]";
+        }
+        break;
+    }
+
+    OS << '\n';
+}
+
+void FunctionPrinter::run(StringRef Name) {
+    // Names used more than once are replaced by numbers.
+    unsigned NumLocals = FF.getFirstConstant();
+    std::unordered_map<std::string_view, unsigned> Uses;
+    for (uint32_t V = 0; V != NumLocals; ++V) {
+        StringRef N = FF.getName(V);
+        if (!N.empty())
+            ++Uses[std::string_view(N.data(), N.size())];
+    }
+
+    Numbers.assign(NumLocals, 0);
+    auto IsNamed = [&](uint32_t V) {
+        StringRef N = FF.getName(V);
+        return isQuotable(N) && Uses[std::string_view(N.data(), N.size())] == 1;
+    };
+
+    uint32_t Next = 0;
+    auto Number = [&](uint32_t V) {
+        Numbers[V] = IsNamed(V) ? ~0u : Next++;
+    };
+
+    for (unsigned i = 0, e = FF.getNumArguments(); i != e; ++i)
+        Number(FF.getFirstArgument() + i);
+    for (unsigned b = 0, e = FF.getNumBlocks(); b != e; ++b) {
+        Number(FF.getFirstBlock() + b);
+        for (unsigned i = FF.getBlockBegin(b), n = FF.getBlockEnd(b); i != n;
+             ++i)
+            if (FF.getValueType(i)->getTypeID() != Type::VoidTyID)
+                Number(i);
+    }
+
+    FF.getReturnType()->dump(OS << "define ") << ' ';
+
+    // Function names can only be printed as identifiers or quoted.
+    if (isIdentifier(Name) || isQuotable(Name) || Name.empty()) {
+        printName(OS, '@', Name);
+    } else {
+        std::string Safe = Name.str();
+        for (char &C : Safe)
+            if ((unsigned char)C < 0x20 || C == '"')
+                C = '_';
+        printName(OS, '@', Safe);
+    }
+
+    OS << '(';
+    for (unsigned i = 0, e = FF.getNumArguments(); i != e; ++i) {
+        OS << (i ? ", " : "");
+        printTypedValue(FF.getFirstArgument() + i);
+    }
+    OS << ") {\n";
+
+    for (unsigned b = 0, e = FF.getNumBlocks(); b != e; ++b) {
+        uint32_t V = FF.getFirstBlock() + b;
+        if (Numbers[V] == ~0u) {
+            StringRef N = FF.getName(V);
+            if (isIdentifier(N))
+                OS << N;
+            else
+                OS << '"' << N << '"';
+        } else {
+            OS << Numbers[V];
+        }
+        OS << ":\n";
+
+        for (unsigned i = FF.getBlockBegin(b), n = FF.getBlockEnd(b); i != n;
+             ++i)
+            printInst(i);
+    }
+
+    OS << "}\n";
+}
+
+} // end anonymous namespace
+
+void kaiju::printFunction(const Function &Fn, raw_ostream &OS) {
+    FunctionPrinter(Fn, OS).run(Fn.getName());
+}
+
+void kaiju::printIR(const TranslationUnit &TU, raw_ostream &OS) {
+    bool First = true;
+    for (auto &Entry : TU.getFunctions()) {
+        if (!First)
+            OS << '\n';
+        First = false;
+        FunctionPrinter(*Entry.second, OS).run(Entry.first);
+    }
+}
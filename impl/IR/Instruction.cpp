@@ -0,0 +1,38 @@
+
+#include "kaiju/IR/Instruction.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+
+#include "kaiju/IR/BasicBlock.h"
+#include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/CmpInst.h"
+
+// \brief Unlinks this instruction from its block and deletes it.
+void Instruction::eraseFromParent() {
+    if (Parent) {
+        auto Pos = std::find(Parent->begin(), Parent->end(), this);
+        assert(Pos != Parent->end() && "Instruction not found in its parent.");
+        Parent->remove(Pos);
+    }
+
+    delete this;
+}
+
+// \brief Returns the mnemonic of \p Op in the textual IR.
+const char *BinaryOperator::getOpcodeName(BinaryOpTy Op) {
+    static const char *const Names[] = {
+        "add", "sub", "mul", "sdiv", "srem", "udiv", "urem", "shl", "lshr",
+        "ashr", "and", "mulhs", "mulhu",
+    };
+    return Names[Op];
+}
+
+// \brief Returns the mnemonic of \p P in the textual IR.
+const char *CmpInst::getPredicateName(Predicate P) {
+    static const char *const Names[] = {
+        "eq", "ne", "ult", "ule", "ugt", "uge", "slt", "sle", "sgt", "sge",
+    };
+    return Names[P];
+}
@@ -20,13 +20,14 @@ Type *Type::getPointerTy(Context &C)    { return &C.impl->PointerTy;      }
 
 // \brief A method for dumping the contents of this function into a
 // output stream.
-std::ostream &Type::dump(std::ostream &os) const {
+raw_ostream &Type::dump(raw_ostream &os) const {
     switch (ID) {
     case TypeID::VoidTyID:      return os << "void";
     case TypeID::HalfTyID:      return os << "f16";
     case TypeID::FloatTyID:     return os << "f32";
     case TypeID::DoubleTyID:    return os << "f64";
     case TypeID::LabelTyID:     return os << "label";
+    case TypeID::PointerTyID:   return os << "ptr";
     case TypeID::IntegerTyID:
         return cast<IntegerType>(this)->dump(os);
 
@@ -36,7 +37,6 @@ std::ostream &Type::dump(std::ostream &os) const {
     /* TODO:
     case TypeID::StructTyID:
     case TypeID::ArrayTyID:
-    case TypeID::PointerTyID:
     */
     }
 }
@@ -87,12 +87,10 @@ IntegerType *IntegerType::get(Context &C, unsigned width) {
         break;
     }
 
-    IntegerType *IntType = C.IntegerTypes[width];
+    IntegerType *&IntType = C.IntegerTypes[width];
 
-    if (!IntType) {
+    if (!IntType)
         IntType = new IntegerType(C, width);
-        C.IntegerTypes.insert(std::make_pair(width, IntType));
-    }
 
     return IntType;
 }
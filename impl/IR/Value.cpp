@@ -19,7 +19,14 @@ StringRef Value::getName() const {
     assert (query != Ctx.ValueNames.end()
         && "No name bound, there should be...");
 
-    return query->second;
+    return query->second->getName();
+}
+
+// \brief Returns the interned name of this value, null if it has none.
+IdentifierInfo *Value::getIdentifier() const {
+    if (!hasName)
+        return nullptr;
+    return ValueType->getContext().ValueNames.lookup(this);
 }
 
 /// \brief Change the name of the value.
@@ -30,6 +37,12 @@ StringRef Value::getName() const {
 void Value::setName(StringRef name) {
     assert(!hasNameBinding() && "hasName out of sync.");
     Context &Ctx = ValueType->getContext();
-    auto query = Ctx.ValueNames[this] = name;
+    Ctx.ValueNames[this] = &Ctx.Identifiers.get(name);
     hasName = true;
 }
+
+// dtor, releases this value's name binding.
+Value::~Value() {
+    if (hasName)
+        ValueType->getContext().ValueNames.erase(this);
+}
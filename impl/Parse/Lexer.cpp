@@ -5,6 +5,16 @@ using namespace kaiju;
 
 #include "kaiju/Parse/Token.h"
 
+namespace {
+
+// \brief Returns whether \p C can continue an identifier.
+inline bool isIdentifierChar(char C) {
+    return (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z')
+        || (C >= '0' && C <= '9') || C == '_';
+}
+
+} // end anonymous namespace
+
 // \brief Forms a new token of the specified kind. The lexeme is a string
 // range from the current lexer's indicator position to the indicator's
 // position plus the len specified.
@@ -26,12 +36,14 @@ Token Lexer::scanStringLiteral() {
 
     while (*look() != '\"') {
         if (look() == End) {
-            Builder.create(err::lex_extranous_eof);
+            Builder.create<err::lex_extranous_eof>(look());
             Builder.flush();
+            break;
         }
 
         if (*look() == '\0' || *look() == '\n' || *look() == '\r') {
-            Builder.create(err::lex_unterminated_string_literal);
+            Builder.create<err::lex_unterminated_string_literal>(start - 1)
+                .setRange(SourceRange(start - 1, look()));
             Builder.flush();
             break;
         }
@@ -47,13 +59,22 @@ Token Lexer::scanStringLiteral() {
     return Token(tok::string_literal, text);
 }
 
-// \brief Scans a new character literal from this lexer's buffer.
+// \brief Scans a new character literal from this lexer's buffer. The
+// lexeme is the character between the quotes, escape sequences kept as
+// written.
 Token Lexer::scanCharacterLiteral() {
     assert(*look() == '\''
         && "invalid state for scanCharacterLiteral subroutine.");
 
     // skip the \' character denoting the start of this literal.
-    consume();
+    const char *start = consume();
+
+    if (*look() == '\'') {
+        Builder.create<err::lex_empty_character_constant>(look());
+        Builder.flush();
+        consume();
+        return Token(tok::character_literal, StringRef(start, 0));
+    }
 
     if (*look() == '\\') {
         switch (*consume()) {
@@ -64,19 +85,21 @@ Token Lexer::scanCharacterLiteral() {
             break;
 
         default:
-            Builder.create(err::lex_unknown_escape_sequence,
-                StringRef(look() - 1, 2));
+            Builder.create<err::lex_unknown_escape_sequence>(
+                look() - 1, StringRef(look() - 1, 2))
+                .setRange(SourceRange(look() - 1, 2));
             Builder.flush();
         }
+    }
 
-        consume();
-    } else if (*look() == '\'') {
-        Builder.create(err::lex_empty_character_constant);
+    if (*look() == '\0' || *look() == '\r' || *look() == '\n') {
+        Builder.create<err::lex_unterminated_character_literal>(look());
         Builder.flush();
+        return Token(tok::character_literal, StringRef(start, look() - start));
     }
 
-    StringRef text(look(), 1);
     consume();
+    StringRef text(start, look() - start);
 
     if (*look() != '\'') {
         while (*look() != '\'' && *look() != '\0'
@@ -85,24 +108,41 @@ Token Lexer::scanCharacterLiteral() {
         }
 
         if (*look() == '\'') {
-            Builder.create(err::lex_multiple_characters_in_character_literal);
+            Builder.create<err::lex_multiple_characters_in_character_literal>(
+                look());
             Builder.flush();
         } else {
-            Builder.create(err::lex_unterminated_character_literal);
+            Builder.create<err::lex_unterminated_character_literal>(look());
             Builder.flush();
         }
     }
 
+    // skip the \' character closing this literal.
+    if (*look() == '\'')
+        consume();
+
     return Token(tok::character_literal, text);
 }
 
-// \brief Lexer subroutine for scanning identifiers.
+// \brief Lexer subroutine for scanning identifiers. The name is interned,
+// which also tells whether it is a keyword.
 Token Lexer::scanIdentifier() {
-    
+    const char *start = look();
+    while (isIdentifierChar(*look()))
+        consume();
+
+    StringRef text(start, look() - start);
+    IdentifierInfo &II = Identifiers.get(text);
+    return Token(II.getTokenKind(), text, &II);
 }
 
 // \brief Scans the next token from this Lexer's buffer.
 Token Lexer::scan() {
+    // Once no more errors will be shown, the rest of the input is skipped.
+    if (Builder.hasReachedErrorLimit()) {
+        Pointer = End;
+        return Token(tok::eof, StringRef(End, 0));
+    }
 
 RESTART:
     switch (*look()) {
@@ -131,8 +171,19 @@ RESTART:
     case '\0':
         return form(tok::eof, 0);
 
+    case 'a': case 'b': case 'c': case 'd': case 'e': case 'f': case 'g':
+    case 'h': case 'i': case 'j': case 'k': case 'l': case 'm': case 'n':
+    case 'o': case 'p': case 'q': case 'r': case 's': case 't': case 'u':
+    case 'v': case 'w': case 'x': case 'y': case 'z':
+    case 'A': case 'B': case 'C': case 'D': case 'E': case 'F': case 'G':
+    case 'H': case 'I': case 'J': case 'K': case 'L': case 'M': case 'N':
+    case 'O': case 'P': case 'Q': case 'R': case 'S': case 'T': case 'U':
+    case 'V': case 'W': case 'X': case 'Y': case 'Z':
+    case '_':
+        return scanIdentifier();
+
     default:
-        Builder.create(err::lex_malformed_character, *look());
+        Builder.create<err::lex_malformed_character>(look(), *look());
         Builder.flush();
 
         return form(tok::none, 1);
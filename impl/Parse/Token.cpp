@@ -7,6 +7,6 @@ namespace kaiju::tok {
 
 } // namespace tok
 
-std::ostream &kaiju::operator<<(std::ostream &os, const Token &tok) {
-    return os << tok.getText().str();
+raw_ostream &kaiju::operator<<(raw_ostream &os, const Token &tok) {
+    return os << tok.getText();
 }
@@ -7,68 +7,90 @@ namespace kaiju {
 
 namespace detail {
 
-// \brief Template specialization for a cast to integral types.
-template<typename T,
-    typename = std::enable_if<std::is_integral<T>::value>>
-T cast_argument(Argument &val) {
-    if (val.type_info == SignedIntType)
-        throw "bad cast_argument";
+template<>
+int64_t cast_argument<int64_t>(const Argument &val) {
+    assert(val.type_info == SignedIntType && "bad cast_argument");
     return val.signed_integer;
-};
+}
+
+template<>
+uint64_t cast_argument<uint64_t>(const Argument &val) {
+    assert(val.type_info == UnsignedIntType && "bad cast_argument");
+    return val.unsigned_integer;
+}
 
 // \brief StringRef specialization
 template<>
-StringRef cast_argument<StringRef>(Argument &val) {
-    if (val.type_info == StringRefType)
-        throw "bad cast_argument";
+StringRef cast_argument<StringRef>(const Argument &val) {
+    assert(val.type_info == StringRefType && "bad cast_argument");
     return val.string_ref;
 }
 
 // \brief Signed character specialization.
 template<>
-char cast_argument<char>(Argument &val) {
-    if (val.type_info == SignedCharType)
-        throw "bad cast_argument";
+char cast_argument<char>(const Argument &val) {
+    assert(val.type_info == SignedCharType && "bad cast_argument");
     return val.signed_char;
 }
 
-// \brief Casts to strings.
-template<>
-std::string cast_argument<std::string>(Argument &val) {
-    switch (val.type_info) {
-    case SignedIntType:
-        return std::to_string(val.signed_integer);
-
-    case UnsignedIntType:
-        return std::to_string(val.unsigned_integer);
-
-    case SignedCharType:
-        return std::string(1, val.signed_char);
-
-    case StringRefType:
-        return val.string_ref.str();
+void invalidFormat(const char *Reason) {
+    assert(false && Reason);
+}
 
-    case VoidPointerType:
-        return "nullptr";
+raw_ostream &operator<<(raw_ostream &os, const Argument &val) {
+    switch (val.type_info) {
+    case SignedIntType:     return os << val.signed_integer;
+    case UnsignedIntType:   return os << val.unsigned_integer;
+    case SignedCharType:    return os << val.signed_char;
+    case UnsignedCharType:  return os << val.unsigned_char;
+    case StringRefType:     return os << val.string_ref;
+    case VoidPointerType:   break;
     }
-}
 
+    return os << "nullptr";
 }
 
+} // namespace detail
+
 namespace err {
 
-// Diagnostic messages
-static const char *messages[] = {
+// \brief Get the Diagnostic Message mapped to the specified error code.
+const char *message(ErrorID id) {
+    return Formats[static_cast<int>(id)].Text;
+}
+
+const char *name(ErrorID id) {
+    static const char *const Names[] = {
 #define DIAGNOSTIC(DIAGTYPE, DIAGID, TEXT) \
-    TEXT,
+        #DIAGID,
 #include "kaiju/Support/DiagnosticCodes.def"
-};
+    };
+    return Names[id];
+}
 
-// \brief Get the Diagnostic Message mapped to the specified error code.
-const char *message(ErrorID id) {
-    return messages[static_cast<int>(id)];
+const char *severityName(Severity s) {
+    switch (s) {
+    case Error:     return "error";
+    case Warning:   return "warning";
+    case Note:      return "note";
+    }
+    return "error";
 }
 
 } // namespace err
 
 } // namespace kaiju
+
+// \brief Writes the message of this Diagnostic with its arguments, in a
+// single pass over the pieces of the message.
+void Diagnostic::print(raw_ostream &os) const {
+    const detail::FormatString &F = err::Formats[ErrorCode];
+
+    for (unsigned i = 0; i != F.NumPieces; ++i) {
+        const detail::FormatPiece &P = F.Pieces[i];
+        if (P.Arg < 0)
+            os.write(F.Text + P.Begin, P.Length);
+        else
+            os << Arguments[P.Arg];
+    }
+}
@@ -0,0 +1,234 @@
+
+#include "kaiju/Support/DiagnosticConsumer.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+
+namespace {
+
+// ANSI escapes, as written by the manipulators of kaiju/IO/Console.h.
+const char Reset[] = "\033[00m";
+const char Bold[] = "\033[1m";
+const char BoldRed[] = "\033[1m\033[91m";
+const char BoldGreen[] = "\033[1m\033[92m";
+
+// \brief Writes the four decimal digits of \p Code.
+void writeCode(raw_ostream &OS, unsigned Code) {
+    char Digits[4];
+    for (int i = 3; i >= 0; --i, Code /= 10)
+        Digits[i] = '0' + Code % 10;
+    OS.write(Digits, 4);
+}
+
+// \brief Returns the length of the well-formed UTF-8 sequence starting with
+// the byte at or above 0x80 at \p P, or 0 when there is none. Overlong
+// forms, surrogates and code points past U+10FFFF are not well-formed.
+unsigned getUTF8SequenceLength(const char *P, const char *End) {
+    unsigned char C = *P;
+    unsigned Len;
+    unsigned char Low = 0x80, High = 0xBF;
+    if (C >= 0xC2 && C <= 0xDF)
+        Len = 2;
+    else if (C >= 0xE0 && C <= 0xEF) {
+        Len = 3;
+        if (C == 0xE0)
+            Low = 0xA0;
+        else if (C == 0xED)
+            High = 0x9F;
+    } else if (C >= 0xF0 && C <= 0xF4) {
+        Len = 4;
+        if (C == 0xF0)
+            Low = 0x90;
+        else if (C == 0xF4)
+            High = 0x8F;
+    } else {
+        return 0;
+    }
+
+    if (std::size_t(End - P) < Len)
+        return 0;
+
+    // Only the second byte has a narrower range.
+    unsigned char Next = P[1];
+    if (Next < Low || Next > High)
+        return 0;
+    for (unsigned i = 2; i != Len; ++i)
+        if ((P[i] & 0xC0) != 0x80)
+            return 0;
+    return Len;
+}
+
+// \brief Writes \p Str as a quoted JSON string. Bytes which are not part
+// of well-formed UTF-8 are written as U+FFFD, so the output always is.
+void writeJSONString(raw_ostream &OS, StringRef Str) {
+    OS << '"';
+    const char *Run = Str.begin();
+    for (const char *P = Str.begin(); P != Str.end(); ++P) {
+        unsigned char C = *P;
+        if (C >= 0x80) {
+            if (unsigned Len = getUTF8SequenceLength(P, Str.end())) {
+                P += Len - 1;
+                continue;
+            }
+        } else if (C >= 0x20 && C != '"' && C != '\\')
+            continue;
+
+        OS.write(Run, P - Run);
+        Run = P + 1;
+        switch (C) {
+        case '"':   OS << "\\\""; break;
+        case '\\':  OS << "\\\\"; break;
+        case '\n':  OS << "\\n"; break;
+        case '\r':  OS << "\\r"; break;
+        case '\t':  OS << "\\t"; break;
+        default:
+            OS << "\\u";
+            OS.write_hex(C < 0x80 ? C : 0xFFFD, 4);
+        }
+    }
+    OS.write(Run, Str.end() - Run);
+    OS << '"';
+}
+
+// \brief Writes \p Arg as a JSON number, string or null.
+void writeJSONArgument(raw_ostream &OS, const detail::Argument &Arg) {
+    switch (Arg.type_info) {
+    case detail::SignedIntType:
+    case detail::UnsignedIntType:
+        OS << Arg;
+        return;
+    case detail::SignedCharType:
+        writeJSONString(OS, StringRef(&Arg.signed_char, 1));
+        return;
+    case detail::UnsignedCharType:
+        writeJSONString(OS, StringRef((const char *)&Arg.unsigned_char, 1));
+        return;
+    case detail::StringRefType:
+        writeJSONString(OS, Arg.string_ref);
+        return;
+    case detail::VoidPointerType:
+        break;
+    }
+    OS << "null";
+}
+
+} // end anonymous namespace
+
+DiagnosticConsumer::~DiagnosticConsumer() { /* empty */ }
+
+LineIndex &DiagnosticConsumer::getLineIndex(const TranslationUnit &Unit) {
+    if (!Lines || !Lines->indexes(Unit.getMemoryBuffer()))
+        Lines.emplace(Unit.getMemoryBuffer());
+    return *Lines;
+}
+
+TextDiagnosticPrinter::~TextDiagnosticPrinter() {
+    OS.flush();
+}
+
+void TextDiagnosticPrinter::handleDiagnostic(const TranslationUnit &Unit,
+                                             const Diagnostic &D) {
+    if (UseColors)
+        OS << Bold;
+    OS << Unit.getPath().c_str();
+    if (const char *Loc = D.getLoc().get()) {
+        std::pair<std::size_t, std::size_t> LC =
+            getLineIndex(Unit).getLineAndColumn(Loc);
+        OS << ':' << LC.first << ':' << LC.second;
+    }
+    OS << ": ";
+
+    // Codes are printed as ERR and four decimal digits.
+    if (UseColors)
+        OS << Reset << BoldRed;
+    OS << "ERR";
+    writeCode(OS, D.getErrorCode());
+    OS << ": ";
+
+    if (UseColors)
+        OS << Reset;
+    D.print(OS);
+    OS << '\n';
+
+    if (ShowCarets && D.getLoc().isValid())
+        printSnippet(Unit, D);
+}
+
+void TextDiagnosticPrinter::printSnippet(const TranslationUnit &Unit,
+                                         const Diagnostic &D) {
+    const char *Loc = D.getLoc().get();
+    StringRef Line = getLineIndex(Unit).getLineFromLoc(Loc);
+
+    // Control characters would garble the terminal and are shown as spaces.
+    // Tabs are kept, in the caret line too, so the caret lines up.
+    const char *Run = Line.begin();
+    for (const char *P = Line.begin(); P != Line.end(); ++P) {
+        if ((unsigned char)*P >= 0x20 || *P == '\t')
+            continue;
+        OS.write(Run, P - Run) << ' ';
+        Run = P + 1;
+    }
+    OS.write(Run, Line.end() - Run) << '\n';
+
+    // The range is clipped to the line, and always covers the caret.
+    const char *UnderlineBegin = Loc;
+    const char *UnderlineEnd = Loc + 1;
+    if (D.hasRange()) {
+        SourceRange R = D.getRange();
+        UnderlineBegin = std::min(std::max(R.begin().get(), Line.begin()), Loc);
+        UnderlineEnd = std::max(std::min(R.end().get(), Line.end()), Loc + 1);
+    }
+
+    if (UseColors)
+        OS << BoldGreen;
+    for (const char *P = Line.begin(); P != UnderlineEnd; ++P) {
+        if (P == Loc)
+            OS << '^';
+        else if (P >= UnderlineBegin)
+            OS << '~';
+        else if (P < Line.end() && *P == '\t')
+            OS << '\t';
+        else
+            OS << ' ';
+    }
+    if (UseColors)
+        OS << Reset;
+    OS << '\n';
+}
+
+JSONDiagnosticPrinter::~JSONDiagnosticPrinter() {
+    OS.flush();
+}
+
+void JSONDiagnosticPrinter::handleDiagnostic(const TranslationUnit &Unit,
+                                             const Diagnostic &D) {
+    OS << "{\"code\":\"ERR";
+    writeCode(OS, D.getErrorCode());
+    OS << "\",\"name\":\"" << err::name(D.getErrorCode())
+       << "\",\"severity\":\"" << err::severityName(D.getSeverity())
+       << "\",\"file\":";
+    writeJSONString(OS, Unit.getPath().c_str());
+
+    if (const char *Loc = D.getLoc().get()) {
+        std::pair<std::size_t, std::size_t> LC =
+            getLineIndex(Unit).getLineAndColumn(Loc);
+        std::size_t Offset = Loc - Unit.getMemoryBuffer().begin();
+        OS << ",\"offset\":" << Offset << ",\"line\":" << LC.first
+           << ",\"column\":" << LC.second;
+    }
+
+    Message.clear();
+    raw_string_ostream MS(Message);
+    D.print(MS);
+    OS << ",\"message\":";
+    writeJSONString(OS, Message);
+
+    OS << ",\"args\":[";
+    for (std::size_t i = 0; i != D.getNumArguments(); ++i) {
+        if (i)
+            OS << ',';
+        writeJSONArgument(OS, D.getArgument(i));
+    }
+    OS << "]}\n";
+}
@@ -0,0 +1,159 @@
+
+#include "kaiju/Support/DiagnosticEngine.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace {
+
+// \brief A diagnostic together with the unit it was reported in.
+struct DiagnosticRecord {
+    const TranslationUnit *Unit;
+    Diagnostic Diag;
+};
+
+// \brief Hands out the IDs of engines, never reused.
+std::atomic<uint64_t> NextEngineID(1);
+
+// \brief Orders \p L and \p R by their kind and value.
+int compareArguments(const detail::Argument &L, const detail::Argument &R) {
+    if (L.type_info != R.type_info)
+        return L.type_info < R.type_info ? -1 : 1;
+
+    switch (L.type_info) {
+    case detail::SignedIntType:
+        return (L.signed_integer > R.signed_integer)
+             - (L.signed_integer < R.signed_integer);
+    case detail::UnsignedIntType:
+        return (L.unsigned_integer > R.unsigned_integer)
+             - (L.unsigned_integer < R.unsigned_integer);
+    case detail::SignedCharType:
+        return L.signed_char - R.signed_char;
+    case detail::UnsignedCharType:
+        return L.unsigned_char - R.unsigned_char;
+    case detail::StringRefType:
+        return L.string_ref.compare(R.string_ref);
+    case detail::VoidPointerType:
+        break;
+    }
+    return std::less<const void *>()(L.void_pointer, R.void_pointer) ? -1
+         : std::less<const void *>()(R.void_pointer, L.void_pointer);
+}
+
+// \brief The order diagnostics are emitted in: by file, then diagnostics
+// without a location, then by offset, code and arguments. It does not
+// depend on which thread reported what first.
+bool emittedBefore(const DiagnosticRecord &L, const DiagnosticRecord &R) {
+    if (L.Unit != R.Unit) {
+        if (int C = std::strcmp(L.Unit->getPath().c_str(),
+                                R.Unit->getPath().c_str()))
+            return C < 0;
+    }
+
+    const char *LLoc = L.Diag.getLoc().get();
+    const char *RLoc = R.Diag.getLoc().get();
+    if (!LLoc != !RLoc)
+        return !LLoc;
+    if (LLoc) {
+        std::size_t LOff = LLoc - L.Unit->getMemoryBuffer().begin();
+        std::size_t ROff = RLoc - R.Unit->getMemoryBuffer().begin();
+        if (LOff != ROff)
+            return LOff < ROff;
+    }
+
+    if (L.Diag.getErrorCode() != R.Diag.getErrorCode())
+        return L.Diag.getErrorCode() < R.Diag.getErrorCode();
+
+    std::size_t N = std::min(L.Diag.getNumArguments(),
+                             R.Diag.getNumArguments());
+    for (std::size_t i = 0; i != N; ++i) {
+        if (int C = compareArguments(L.Diag.getArgument(i),
+                                     R.Diag.getArgument(i)))
+            return C < 0;
+    }
+    return L.Diag.getNumArguments() < R.Diag.getNumArguments();
+}
+
+} // end anonymous namespace
+
+// \brief The diagnostics one thread reported to an engine.
+struct DiagnosticEngine::ThreadQueue {
+    std::vector<DiagnosticRecord> Records;
+    ThreadQueue *Next = nullptr;
+};
+
+DiagnosticEngine::DiagnosticEngine(DiagnosticConsumer &C, unsigned errorLimit)
+     : Consumer(C), ErrorLimit(errorLimit),
+       ID(NextEngineID.fetch_add(1, std::memory_order_relaxed)),
+       Queues(nullptr), NumErrors(0), NumEmittedErrors(0) { /* empty */ }
+
+DiagnosticEngine::~DiagnosticEngine() {
+    ThreadQueue *Q = Queues.load(std::memory_order_acquire);
+    while (Q) {
+        ThreadQueue *Next = Q->Next;
+        delete Q;
+        Q = Next;
+    }
+}
+
+DiagnosticEngine::ThreadQueue &DiagnosticEngine::getQueue() {
+    // Each thread remembers its queues of the last few engines it reported
+    // to. Forgetting one only costs registering another queue.
+    struct CacheEntry {
+        uint64_t EngineID;
+        ThreadQueue *Queue;
+    };
+    static const unsigned CacheSize = 4;
+    thread_local CacheEntry Cache[CacheSize] = {};
+    thread_local unsigned NextVictim = 0;
+
+    for (CacheEntry &E : Cache) {
+        if (E.EngineID == ID)
+            return *E.Queue;
+    }
+
+    ThreadQueue *Q = new ThreadQueue();
+    Q->Next = Queues.load(std::memory_order_relaxed);
+    while (!Queues.compare_exchange_weak(Q->Next, Q,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed))
+        ;
+
+    Cache[NextVictim] = { ID, Q };
+    NextVictim = (NextVictim + 1) % CacheSize;
+    return *Q;
+}
+
+void DiagnosticEngine::report(const TranslationUnit &Unit,
+                              const Diagnostic &D) {
+    if (D.getSeverity() == err::Error)
+        NumErrors.fetch_add(1, std::memory_order_relaxed);
+    getQueue().Records.push_back({ &Unit, D });
+}
+
+void DiagnosticEngine::emitDiagnostics() {
+    std::vector<DiagnosticRecord> All;
+    ThreadQueue *Head = Queues.load(std::memory_order_acquire);
+    for (ThreadQueue *Q = Head; Q; Q = Q->Next)
+        All.insert(All.end(), Q->Records.begin(), Q->Records.end());
+
+    std::sort(All.begin(), All.end(), emittedBefore);
+
+    for (const DiagnosticRecord &R : All) {
+        if (R.Diag.getSeverity() == err::Error) {
+            if (ErrorLimit && NumEmittedErrors == ErrorLimit)
+                continue;
+            ++NumEmittedErrors;
+        }
+        Consumer.handleDiagnostic(*R.Unit, R.Diag);
+    }
+
+    // The queues stay registered, their storage is reused by the next phase.
+    for (ThreadQueue *Q = Head; Q; Q = Q->Next)
+        Q->Records.clear();
+    Consumer.finish();
+}
@@ -0,0 +1,56 @@
+
+#include "kaiju/Support/IdentifierTable.h"
+
+using namespace kaiju;
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+IdentifierTable::IdentifierTable() : SlabCur(nullptr), SlabEnd(nullptr) {
+#define KEYWORD(name, str) \
+    create(str, tok::kw_ ## name);
+#include "kaiju/Parse/TokenTypes.def"
+}
+
+IdentifierTable::~IdentifierTable() {
+    for (char *Slab : Slabs)
+        delete[] Slab;
+}
+
+void *IdentifierTable::allocate(std::size_t Size) {
+    const std::size_t Align = alignof(IdentifierInfo);
+    Size = (Size + Align - 1) & ~(Align - 1);
+
+    if (Size > std::size_t(SlabEnd - SlabCur)) {
+        // Names larger than a slab get a slab of their own, keeping the
+        // rest of the current one.
+        if (Size > SlabSize / 4) {
+            Slabs.push_back(new char[Size]);
+            return Slabs.back();
+        }
+
+        Slabs.push_back(new char[SlabSize]);
+        SlabCur = Slabs.back();
+        SlabEnd = SlabCur + SlabSize;
+    }
+
+    void *Memory = SlabCur;
+    SlabCur += Size;
+    return Memory;
+}
+
+IdentifierInfo &IdentifierTable::create(StringRef Name, tok::Type Kind) {
+    assert(!Names.count(Name) && "identifier interned twice.");
+
+    void *Memory = allocate(sizeof(IdentifierInfo) + Name.size() + 1);
+    IdentifierInfo *II = new (Memory) IdentifierInfo(Name.size(), Kind);
+
+    char *Chars = reinterpret_cast<char *>(II + 1);
+    if (!Name.empty())
+        std::memcpy(Chars, Name.data(), Name.size());
+    Chars[Name.size()] = '\0';
+
+    Names.try_emplace(II->getName(), II);
+    return *II;
+}
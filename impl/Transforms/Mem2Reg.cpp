@@ -0,0 +1,329 @@
+
+#include "kaiju/Transforms/Mem2Reg.h"
+
+using namespace kaiju;
+
+#include <map>
+#include <vector>
+
+#include "kaiju/IR/AllocaInst.h"
+#include "kaiju/IR/Constants.h"
+#include "kaiju/IR/Dominators.h"
+#include "kaiju/IR/LoadInst.h"
+#include "kaiju/IR/PhiNode.h"
+#include "kaiju/IR/StoreInst.h"
+#include "kaiju/Transforms/Utils.h"
+
+namespace {
+
+// \brief What the promotion needs to know about a single alloca. Blocks are
+// identified by their dominator tree number.
+struct AllocaInfo {
+    AllocaInst *Alloca;
+
+    // \brief Blocks storing to the slot.
+    std::vector<unsigned> DefBlocks;
+
+    // \brief Blocks entered with the slot live, initially those reading the
+    // slot before storing to it.
+    std::vector<unsigned> LiveInBlocks;
+};
+
+// Class PromoteMem2Reg
+//
+// \brief Driver for the promotion of the allocas of a single function.
+//
+class PromoteMem2Reg {
+    Function &Fn;
+    DominatorTree DT;
+
+    std::vector<AllocaInfo> Allocas;
+    std::map<const Value *, unsigned> AllocaIndex;
+
+    // \brief The alloca each inserted phi node stands for.
+    std::map<const PhiNode *, unsigned> PhiToAlloca;
+
+    ValueReplacementMap Replacements;
+    std::vector<Instruction *> Dead;
+
+    // \brief Returns the index of the promoted alloca \p Ptr refers to, or
+    // -1 if it is not one.
+    int getAllocaIndex(const Value *Ptr) const {
+        auto It = AllocaIndex.find(Ptr);
+        return It == AllocaIndex.end() ? -1 : (int)It->second;
+    }
+
+    // \brief Finds the allocas of the entry block whose address does not
+    // escape, returns whether there are any.
+    bool collectAllocas();
+
+    // \brief Records the blocks defining each slot and those reading it
+    // before any store.
+    void analyzeUses();
+
+    // \brief Extends the live-in blocks of \p Info up to its definitions.
+    void computeLiveIn(AllocaInfo &Info, unsigned Stamp,
+                       std::vector<unsigned> &Live,
+                       std::vector<unsigned> &Defs);
+
+    // \brief Inserts the phi nodes needed by every slot.
+    void placePhis();
+
+    // \brief Replaces loads with the reaching definitions and fills in the
+    // incoming values of the inserted phi nodes.
+    void rename();
+
+public:
+    explicit PromoteMem2Reg(Function &F) : Fn(F), DT(F) { /* empty */ }
+
+    bool run();
+};
+
+bool PromoteMem2Reg::collectAllocas() {
+    BasicBlock *Entry = Fn.getEntryBlock();
+    if (!Entry)
+        return false;
+
+    std::map<const Value *, bool> Promotable;
+    for (Instruction *I : *Entry)
+        if (isa<AllocaInst>(I))
+            Promotable[I] = true;
+
+    if (Promotable.empty())
+        return false;
+
+    // Any use other than the address of a load or store of the allocated
+    // type lets the address escape.
+    for (BasicBlock *BB : Fn) {
+        for (Instruction *I : *BB) {
+            for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+                auto It = Promotable.find(I->getOperand(i));
+                if (It == Promotable.end())
+                    continue;
+
+                Type *Ty = cast<AllocaInst>(I->getOperand(i))
+                    ->getAllocatedType();
+
+                bool Ok = false;
+                if (isa<LoadInst>(I))
+                    Ok = I->getValueType() == Ty;
+                else if (StoreInst *SI = dyn_cast<StoreInst>(I))
+                    Ok = i == 1 && SI->getValueOperand()->getValueType() == Ty;
+
+                if (!Ok)
+                    It->second = false;
+            }
+        }
+    }
+
+    for (Instruction *I : *Entry) {
+        if (!isa<AllocaInst>(I) || !Promotable[I])
+            continue;
+
+        AllocaIndex[I] = Allocas.size();
+        Allocas.push_back(AllocaInfo { cast<AllocaInst>(I), {}, {} });
+    }
+
+    return !Allocas.empty();
+}
+
+void PromoteMem2Reg::analyzeUses() {
+    // The last block each slot was accessed and stored in, to record every
+    // block once and only the first access of a block as live-in.
+    std::vector<unsigned> LastAccess(Allocas.size(), ~0u);
+    std::vector<unsigned> LastDef(Allocas.size(), ~0u);
+
+    for (unsigned N = 0, E = DT.size(); N != E; ++N) {
+        for (Instruction *I : *DT.getBlock(N)) {
+            if (LoadInst *LI = dyn_cast<LoadInst>(I)) {
+                int A = getAllocaIndex(LI->getPointerOperand());
+                if (A < 0 || LastAccess[A] == N)
+                    continue;
+
+                LastAccess[A] = N;
+                Allocas[A].LiveInBlocks.push_back(N);
+            } else if (StoreInst *SI = dyn_cast<StoreInst>(I)) {
+                int A = getAllocaIndex(SI->getPointerOperand());
+                if (A < 0)
+                    continue;
+
+                LastAccess[A] = N;
+                if (LastDef[A] != N) {
+                    LastDef[A] = N;
+                    Allocas[A].DefBlocks.push_back(N);
+                }
+            }
+        }
+    }
+}
+
+void PromoteMem2Reg::computeLiveIn(AllocaInfo &Info, unsigned Stamp,
+                                   std::vector<unsigned> &Live,
+                                   std::vector<unsigned> &Defs) {
+    for (unsigned D : Info.DefBlocks)
+        Defs[D] = Stamp;
+
+    std::vector<unsigned> Worklist(Info.LiveInBlocks);
+    for (unsigned L : Worklist)
+        Live[L] = Stamp;
+
+    // A slot live into a block is live out of its predecessors, and into
+    // those that do not store to it.
+    while (!Worklist.empty()) {
+        unsigned N = Worklist.back();
+        Worklist.pop_back();
+
+        for (unsigned P : DT.getPredecessors(N)) {
+            if (Live[P] == Stamp || Defs[P] == Stamp)
+                continue;
+
+            Live[P] = Stamp;
+            Info.LiveInBlocks.push_back(P);
+            Worklist.push_back(P);
+        }
+    }
+}
+
+void PromoteMem2Reg::placePhis() {
+    IDFCalculator IDF(DT);
+    std::vector<unsigned> Live(DT.size(), 0), Defs(DT.size(), 0);
+    std::vector<unsigned> PhiBlocks;
+
+    for (unsigned A = 0, E = Allocas.size(); A != E; ++A) {
+        AllocaInfo &Info = Allocas[A];
+        computeLiveIn(Info, A + 1, Live, Defs);
+        IDF.calculate(Info.DefBlocks, &Info.LiveInBlocks, PhiBlocks);
+
+        for (unsigned N : PhiBlocks) {
+            BasicBlock *BB = DT.getBlock(N);
+            PhiNode *Phi = PhiNode::get(Info.Alloca->getAllocatedType());
+            BB->insert(BB->begin(), Phi);
+            PhiToAlloca[Phi] = A;
+        }
+    }
+}
+
+// \brief An entry of the dominator tree walk. Exit entries unwind the value
+// stacks to their size when the block was entered.
+struct RenameItem {
+    unsigned Block;
+    std::size_t LogSize;
+    bool Exit;
+};
+
+void PromoteMem2Reg::rename() {
+    // The reaching definition of every slot is the top of its stack. The log
+    // records which stacks were pushed, so leaving a subtree can pop them.
+    std::vector<std::vector<Value *>> Stacks(Allocas.size());
+    std::vector<unsigned> Log;
+
+    for (unsigned A = 0, E = Allocas.size(); A != E; ++A)
+        Stacks[A].push_back(
+            UndefValue::get(Allocas[A].Alloca->getAllocatedType()));
+
+    std::vector<RenameItem> Worklist;
+    Worklist.push_back(RenameItem { 0, 0, false });
+
+    while (!Worklist.empty()) {
+        RenameItem Item = Worklist.back();
+        Worklist.pop_back();
+
+        if (Item.Exit) {
+            for (; Log.size() > Item.LogSize; Log.pop_back())
+                Stacks[Log.back()].pop_back();
+            continue;
+        }
+
+        Worklist.push_back(RenameItem { Item.Block, Log.size(), true });
+        BasicBlock *BB = DT.getBlock(Item.Block);
+
+        for (Instruction *I : *BB) {
+            if (PhiNode *Phi = dyn_cast<PhiNode>(I)) {
+                auto It = PhiToAlloca.find(Phi);
+                if (It == PhiToAlloca.end())
+                    continue;
+
+                Stacks[It->second].push_back(Phi);
+                Log.push_back(It->second);
+            } else if (LoadInst *LI = dyn_cast<LoadInst>(I)) {
+                int A = getAllocaIndex(LI->getPointerOperand());
+                if (A < 0)
+                    continue;
+
+                Replacements[LI] = Stacks[A].back();
+                Dead.push_back(LI);
+            } else if (StoreInst *SI = dyn_cast<StoreInst>(I)) {
+                int A = getAllocaIndex(SI->getPointerOperand());
+                if (A < 0)
+                    continue;
+
+                Stacks[A].push_back(
+                    getReplacement(Replacements, SI->getValueOperand()));
+                Log.push_back(A);
+                Dead.push_back(SI);
+            }
+        }
+
+        // Phi nodes lead their block, so stop at the first other instruction.
+        for (unsigned Succ : DT.getSuccessors(Item.Block)) {
+            for (Instruction *I : *DT.getBlock(Succ)) {
+                PhiNode *Phi = dyn_cast<PhiNode>(I);
+                if (!Phi)
+                    break;
+
+                auto It = PhiToAlloca.find(Phi);
+                if (It != PhiToAlloca.end())
+                    Phi->addIncoming(Stacks[It->second].back(), BB);
+            }
+        }
+
+        const SmallVectorImpl<unsigned> &Children = DT.getChildren(Item.Block);
+        for (auto It = Children.rbegin(); It != Children.rend(); ++It)
+            Worklist.push_back(RenameItem { *It, 0, false });
+    }
+}
+
+bool PromoteMem2Reg::run() {
+    if (!collectAllocas())
+        return false;
+
+    analyzeUses();
+    placePhis();
+    rename();
+
+    // Accesses in unreachable blocks were not renamed, nothing reaches them.
+    for (BasicBlock *BB : Fn) {
+        if (DT.isReachable(BB))
+            continue;
+
+        for (Instruction *I : *BB) {
+            Value *Ptr = nullptr;
+            if (LoadInst *LI = dyn_cast<LoadInst>(I))
+                Ptr = LI->getPointerOperand();
+            else if (StoreInst *SI = dyn_cast<StoreInst>(I))
+                Ptr = SI->getPointerOperand();
+
+            if (!Ptr || getAllocaIndex(Ptr) < 0)
+                continue;
+
+            if (isa<LoadInst>(I))
+                Replacements[I] = UndefValue::get(I->getValueType());
+            Dead.push_back(I);
+        }
+    }
+
+    for (const AllocaInfo &Info : Allocas)
+        Dead.push_back(Info.Alloca);
+
+    replaceAllUsesWith(Fn, Replacements);
+    eraseInstructions(Dead);
+
+    return true;
+}
+
+} // end anonymous namespace
+
+// \brief Promotes stack slots to SSA registers.
+bool kaiju::promoteMemoryToRegister(Function &Fn) {
+    return PromoteMem2Reg(Fn).run();
+}
@@ -0,0 +1,288 @@
+
+#include "kaiju/Transforms/Reassociate.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+#include "kaiju/ADT/DenseMap.h"
+#include "kaiju/ADT/SmallVector.h"
+#include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/Constants.h"
+#include "kaiju/Transforms/Utils.h"
+
+namespace {
+
+// \brief Returns whether \p Op is associative and commutative over integers.
+bool isReassociable(Instruction::BinaryOpTy Op) {
+    return Op == Instruction::Add
+        || Op == Instruction::Mul
+        || Op == Instruction::And;
+}
+
+// \brief Returns the identity element of \p Op for a \p W bit integer.
+uint128_t getIdentity(Instruction::BinaryOpTy Op, unsigned W) {
+    switch (Op) {
+    case Instruction::Add: return 0;
+    case Instruction::Mul: return 1;
+    default:               return maskTrailingOnes(W);
+    }
+}
+
+// \brief Returns whether \p V absorbs every other operand of \p Op.
+bool isAbsorbing(Instruction::BinaryOpTy Op, uint128_t V) {
+    return V == 0 && (Op == Instruction::Mul || Op == Instruction::And);
+}
+
+// \brief Folds two \p W bit constants.
+uint128_t fold(Instruction::BinaryOpTy Op, uint128_t A, uint128_t B,
+               unsigned W) {
+    switch (Op) {
+    case Instruction::Add: return truncateToWidth(A + B, W);
+    case Instruction::Mul: return truncateToWidth(A * B, W);
+    default:               return A & B;
+    }
+}
+
+// \brief A leaf of a flattened expression tree.
+struct Leaf {
+    Value *V;
+
+    // \brief The depth of the computation producing V, lower ranks are
+    // available sooner.
+    unsigned Rank;
+
+    // \brief Position of this leaf in the flattened tree, to keep the
+    // rebuilt tree deterministic between equal ranks.
+    unsigned Order;
+};
+
+// \brief Orders the leaf heap so the lowest rank is on top.
+struct LaterLeaf {
+    bool operator()(const Leaf &A, const Leaf &B) const {
+        return A.Rank != B.Rank ? A.Rank > B.Rank : A.Order > B.Order;
+    }
+};
+
+using LeafQueue = std::priority_queue<Leaf, std::vector<Leaf>, LaterLeaf>;
+
+// \brief Returns the rank of the tree built by repeatedly combining the two
+// lowest ranked leaves of \p Leaves.
+unsigned getCombinedRank(LeafQueue Leaves) {
+    while (Leaves.size() > 1) {
+        unsigned A = Leaves.top().Rank; Leaves.pop();
+        unsigned B = Leaves.top().Rank; Leaves.pop();
+        Leaves.push(Leaf { nullptr, std::max(A, B) + 1, 0 });
+    }
+
+    return Leaves.empty() ? 0 : Leaves.top().Rank;
+}
+
+// Class Reassociator
+//
+// \brief Driver for the reassociation of a single function body.
+//
+class Reassociator {
+    Function &Fn;
+
+    // \brief Rank of every instruction visited so far, see Leaf::Rank. A
+    // rewritten root takes the rank of its replacement.
+    DenseMap<const Value *, unsigned> Ranks;
+
+    // \brief Number of operand slots referencing each instruction.
+    DenseMap<const Value *, unsigned> UseCounts;
+
+    // \brief The user of every instruction that has exactly one use.
+    DenseMap<const Value *, BinaryOperator *> SoleUser;
+
+    ValueReplacementMap Replacements;
+    std::vector<Instruction *> Dead;
+
+    unsigned getRank(Value *V) const { return Ranks.lookup(V); }
+
+    // \brief Returns whether \p V is an inner node of a tree of \p Op rooted
+    // in \p Block.
+    bool isInterior(Value *V, Instruction::BinaryOpTy Op,
+                    const BasicBlock *Block) const {
+        BinaryOperator *BinOp = dyn_cast<BinaryOperator>(V);
+        if (!BinOp || BinOp->getOpcode() != Op || BinOp->getParent() != Block)
+            return false;
+
+        return UseCounts.lookup(V) == 1;
+    }
+
+    // \brief Returns whether \p I is the root of an expression tree.
+    bool isRoot(BinaryOperator *I) const {
+        if (!isReassociable(I->getOpcode()) || !isa<IntegerType>(I->getValueType()))
+            return false;
+
+        auto It = SoleUser.find(I);
+        return It == SoleUser.end()
+            || It->second->getOpcode() != I->getOpcode()
+            || It->second->getParent() != I->getParent();
+    }
+
+    // \brief Collects the leaves and inner nodes of the tree rooted at
+    // \p Root.
+    void linearize(BinaryOperator *Root, SmallVectorImpl<Value *> &Leaves,
+                   SmallVectorImpl<Instruction *> &Nodes);
+
+    // \brief Rewrites the tree rooted at \p Root, appending the new tree to
+    // \p Insts.
+    void rewrite(SmallVectorImpl<Instruction *> &Insts, BinaryOperator *Root);
+
+    // \brief Rewrites the trees rooted in \p Block.
+    void runOnBlock(BasicBlock &Block);
+
+public:
+    explicit Reassociator(Function &F) : Fn(F) {
+        for (BasicBlock *BB : Fn) {
+            for (Instruction *I : *BB) {
+                for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+                    Value *Op = I->getOperand(i);
+                    if (!isa<Instruction>(Op))
+                        continue;
+
+                    if (++UseCounts[Op] == 1 && isa<BinaryOperator>(I))
+                        SoleUser[Op] = cast<BinaryOperator>(I);
+                    else
+                        SoleUser.erase(Op);
+                }
+            }
+        }
+    }
+
+    bool run();
+};
+
+void Reassociator::linearize(BinaryOperator *Root,
+                             SmallVectorImpl<Value *> &Leaves,
+                             SmallVectorImpl<Instruction *> &Nodes) {
+    // Generated reductions can be many thousands of nodes deep, so walk the
+    // tree with an explicit stack.
+    SmallVector<BinaryOperator *, 8> Worklist(1, Root);
+
+    while (!Worklist.empty()) {
+        BinaryOperator *Node = Worklist.back();
+        Worklist.pop_back();
+        Nodes.push_back(Node);
+
+        for (unsigned i = 2; i-- != 0; ) {
+            Value *Op = Node->getOperand(i);
+
+            if (isInterior(Op, Root->getOpcode(), Root->getParent()))
+                Worklist.push_back(cast<BinaryOperator>(Op));
+            else
+                Leaves.push_back(getReplacement(Replacements, Op));
+        }
+    }
+}
+
+void Reassociator::rewrite(SmallVectorImpl<Instruction *> &Insts,
+                           BinaryOperator *Root) {
+    Instruction::BinaryOpTy Op = Root->getOpcode();
+    IntegerType *Ty = cast<IntegerType>(Root->getValueType());
+    unsigned W = Ty->getBitWidth();
+
+    SmallVector<Value *, 8> Operands;
+    SmallVector<Instruction *, 8> Nodes;
+    linearize(Root, Operands, Nodes);
+
+    // Fold the constant leaves together and queue the others by rank.
+    LeafQueue Leaves;
+    uint128_t Constant = getIdentity(Op, W);
+    unsigned NumConstants = 0;
+
+    for (Value *V : Operands) {
+        if (ConstantInt *C = dyn_cast<ConstantInt>(V)) {
+            Constant = fold(Op, Constant, C->getZExtValue(), W);
+            ++NumConstants;
+        } else {
+            Leaves.push(Leaf { V, getRank(V), (unsigned)Leaves.size() });
+        }
+    }
+
+    // The folded constant is available immediately, so it joins the leaves
+    // with the lowest possible rank.
+    bool HasConstant = Constant != getIdentity(Op, W);
+    if (HasConstant)
+        Leaves.push(Leaf { ConstantInt::get(Ty, Constant), 0,
+                           (unsigned)Leaves.size() });
+
+    // Leave trees alone that have no constants to fold and whose critical
+    // path would not get any shorter.
+    if (NumConstants <= (HasConstant ? 1 : 0)
+            && getCombinedRank(Leaves) >= getRank(Root))
+        return;
+
+    Value *Result = nullptr;
+    unsigned Rank = 0;
+
+    if (isAbsorbing(Op, Constant) || Leaves.empty()) {
+        Result = ConstantInt::get(Ty, Constant);
+    } else {
+        unsigned Order = Leaves.size();
+
+        while (Leaves.size() > 1) {
+            Leaf A = Leaves.top(); Leaves.pop();
+            Leaf B = Leaves.top(); Leaves.pop();
+
+            Instruction *I = BinaryOperator::get(Op, A.V, B.V);
+            Insts.push_back(I);
+            unsigned NewRank = std::max(A.Rank, B.Rank) + 1;
+            Ranks[I] = NewRank;
+            Leaves.push(Leaf { I, NewRank, Order++ });
+        }
+
+        Result = Leaves.top().V;
+        Rank = Leaves.top().Rank;
+    }
+
+    Ranks[Root] = Rank;
+    Replacements[Root] = Result;
+    Dead.insert(Dead.end(), Nodes.begin(), Nodes.end());
+}
+
+void Reassociator::runOnBlock(BasicBlock &Block) {
+    // The block is rebuilt in a single sweep, with every rewritten tree in
+    // front of its root. The old trees stay until they are erased.
+    SmallVector<Instruction *, 8> Insts;
+    Insts.reserve(Block.size());
+    std::size_t NumDead = Dead.size();
+
+    for (Instruction *I : Block) {
+        unsigned Rank = 0;
+
+        for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i)
+            Rank = std::max(Rank, getRank(I->getOperand(i)) + 1);
+
+        Ranks[I] = Rank;
+
+        BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I);
+        if (BinOp && isRoot(BinOp))
+            rewrite(Insts, BinOp);
+        Insts.push_back(I);
+    }
+
+    if (Dead.size() != NumDead)
+        Block.setInstructions(std::move(Insts));
+}
+
+bool Reassociator::run() {
+    for (BasicBlock *BB : Fn)
+        runOnBlock(*BB);
+
+    replaceAllUsesWith(Fn, Replacements);
+    eraseInstructions(Dead);
+
+    return !Dead.empty();
+}
+
+} // end anonymous namespace
+
+// \brief Reassociates chains of integer Add, Mul and And operations in \p Fn.
+bool kaiju::reassociate(Function &Fn) {
+    return Reassociator(Fn).run();
+}
@@ -0,0 +1,423 @@
+
+#include "kaiju/Transforms/SCCP.h"
+
+using namespace kaiju;
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "kaiju/IR/BranchInst.h"
+#include "kaiju/IR/ConstantFold.h"
+#include "kaiju/IR/PhiNode.h"
+#include "kaiju/IR/ReturnInst.h"
+#include "kaiju/Transforms/Utils.h"
+
+namespace {
+
+// Class LatticeVal
+//
+// \brief The value of an SSA register in the constant propagation lattice.
+// Values only ever move down the lattice: Undefined -> Constant ->
+// Overdefined.
+//
+class LatticeVal {
+public:
+    enum State {
+        Undefined,      //< No executable definition seen yet.
+        Constant,       //< Always evaluates to Const.
+        Overdefined,    //< Not provably constant.
+    };
+
+private:
+    State St;
+    Value *Const;
+
+public:
+    LatticeVal() : St(Undefined), Const(nullptr) { /* empty */ }
+
+    bool isUndefined()   const { return St == Undefined;   }
+    bool isConstant()    const { return St == Constant;    }
+    bool isOverdefined() const { return St == Overdefined; }
+
+    Value *getConstant() const {
+        assert(isConstant() && "lattice value is not a constant.");
+        return Const;
+    }
+
+    // \brief Lowers this value to the constant \p C, returns whether this
+    // value changed.
+    bool markConstant(Value *C) {
+        if (isConstant() && Const == C)
+            return false;
+        if (isOverdefined())
+            return false;
+        if (isConstant())
+            return markOverdefined();
+
+        St = Constant;
+        Const = C;
+        return true;
+    }
+
+    // \brief Lowers this value to overdefined, returns whether this value
+    // changed.
+    bool markOverdefined() {
+        if (isOverdefined())
+            return false;
+
+        St = Overdefined;
+        Const = nullptr;
+        return true;
+    }
+};
+
+// Class SCCPSolver
+//
+// \brief Solves the lattice for a function using one worklist of SSA values
+// whose lattice value changed and one of blocks that became executable.
+//
+class SCCPSolver {
+    Function &Fn;
+
+    // \brief Lattice values of the instructions in Fn.
+    std::map<Value *, LatticeVal> Values;
+
+    // \brief Instructions using each value.
+    std::map<Value *, std::vector<Instruction *>> Users;
+
+    // \brief Blocks and CFG edges proven to be executable.
+    std::set<BasicBlock *> Executable;
+    std::set<std::pair<BasicBlock *, BasicBlock *>> ExecutableEdges;
+
+    std::vector<BasicBlock *> BlockWorklist;
+    std::vector<Value *> ValueWorklist;
+
+    // \brief Returns the lattice value of \p V.
+    LatticeVal getValue(Value *V) {
+        LatticeVal LV;
+
+        if (isa<ConstantInt>(V) || isa<ConstantFP>(V))
+            LV.markConstant(V);
+        else if (isa<Instruction>(V))
+            LV = Values[V];
+        else
+            LV.markOverdefined();
+
+        return LV;
+    }
+
+    void markConstant(Instruction *I, Value *C) {
+        if (Values[I].markConstant(C))
+            ValueWorklist.push_back(I);
+    }
+
+    void markOverdefined(Instruction *I) {
+        if (Values[I].markOverdefined())
+            ValueWorklist.push_back(I);
+    }
+
+    bool isEdgeExecutable(BasicBlock *From, BasicBlock *To) const {
+        return ExecutableEdges.count(std::make_pair(From, To)) != 0;
+    }
+
+    void markEdgeExecutable(BasicBlock *From, BasicBlock *To) {
+        if (!ExecutableEdges.insert(std::make_pair(From, To)).second)
+            return;
+
+        if (Executable.insert(To).second) {
+            BlockWorklist.push_back(To);
+            return;
+        }
+
+        // The block was already visited, only its phi nodes can observe the
+        // new edge.
+        for (Instruction *I : *To) {
+            PhiNode *Phi = dyn_cast<PhiNode>(I);
+            if (!Phi)
+                break;
+            visitPhiNode(Phi);
+        }
+    }
+
+    void visitPhiNode(PhiNode *I);
+    void visitBinaryOperator(BinaryOperator *I);
+    void visitCmpInst(CmpInst *I);
+    void visitBranchInst(BranchInst *I);
+
+    void visit(Instruction *I) {
+        if (PhiNode *Phi = dyn_cast<PhiNode>(I))
+            visitPhiNode(Phi);
+        else if (BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I))
+            visitBinaryOperator(BinOp);
+        else if (CmpInst *Cmp = dyn_cast<CmpInst>(I))
+            visitCmpInst(Cmp);
+        else if (BranchInst *Br = dyn_cast<BranchInst>(I))
+            visitBranchInst(Br);
+    }
+
+public:
+    explicit SCCPSolver(Function &F) : Fn(F) {
+        for (BasicBlock *BB : Fn)
+            for (Instruction *I : *BB)
+                for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i)
+                    Users[I->getOperand(i)].push_back(I);
+    }
+
+    // \brief Lowers what the fixed point left undefined, returns whether the
+    // solver has new work.
+    bool resolveUndefined();
+
+    // \brief Processes the worklists until they are empty.
+    void solveWorklists();
+
+    // \brief Runs the solver to a fixed point.
+    void solve();
+
+    // \brief Rewrites the function using the solved lattice.
+    bool rewrite();
+};
+
+void SCCPSolver::visitPhiNode(PhiNode *I) {
+    BasicBlock *BB = I->getParent();
+    Value *Const = nullptr;
+
+    // Merge the values flowing in along executable edges. Undefined values
+    // may be assumed to equal whatever the other edges carry.
+    for (unsigned i = 0, e = I->getNumIncomingValues(); i != e; ++i) {
+        if (!isEdgeExecutable(I->getIncomingBlock(i), BB))
+            continue;
+
+        Value *V = I->getIncomingValue(i);
+        if (isa<UndefValue>(V))
+            continue;
+
+        LatticeVal LV = getValue(V);
+        if (LV.isUndefined())
+            continue;
+
+        if (LV.isOverdefined() || (Const && Const != LV.getConstant()))
+            return markOverdefined(I);
+
+        Const = LV.getConstant();
+    }
+
+    if (Const)
+        markConstant(I, Const);
+}
+
+void SCCPSolver::visitBinaryOperator(BinaryOperator *I) {
+    LatticeVal L = getValue(I->getLHS()), R = getValue(I->getRHS());
+
+    if (L.isOverdefined() || R.isOverdefined()) {
+        // A zero operand still decides the result of these operations.
+        switch (I->getOpcode()) {
+        case Instruction::Mul: case Instruction::And:
+        case Instruction::MulHS: case Instruction::MulHU: {
+            LatticeVal &Other = L.isOverdefined() ? R : L;
+            ConstantInt *Zero = Other.isConstant()
+                ? dyn_cast<ConstantInt>(Other.getConstant()) : nullptr;
+
+            if (Zero && Zero->isZero())
+                return markConstant(I, Zero);
+            if (Other.isUndefined())
+                return;
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        return markOverdefined(I);
+    }
+
+    if (L.isUndefined() || R.isUndefined())
+        return;
+
+    if (Value *C = constantFoldBinaryOp(I->getOpcode(),
+                                        L.getConstant(), R.getConstant()))
+        return markConstant(I, C);
+
+    markOverdefined(I);
+}
+
+void SCCPSolver::visitCmpInst(CmpInst *I) {
+    LatticeVal L = getValue(I->getLHS()), R = getValue(I->getRHS());
+
+    if (L.isOverdefined() || R.isOverdefined())
+        return markOverdefined(I);
+
+    if (L.isUndefined() || R.isUndefined())
+        return;
+
+    markConstant(I, constantFoldCmp(I->getPredicate(),
+                                    L.getConstant(), R.getConstant()));
+}
+
+void SCCPSolver::visitBranchInst(BranchInst *I) {
+    BasicBlock *BB = I->getParent();
+
+    if (I->isUnconditional())
+        return markEdgeExecutable(BB, I->getSuccessor(0));
+
+    LatticeVal Cond = getValue(I->getCondition());
+
+    if (Cond.isUndefined())
+        return;
+
+    if (Cond.isConstant()) {
+        ConstantInt *C = cast<ConstantInt>(Cond.getConstant());
+        return markEdgeExecutable(BB, I->getSuccessor(C->isZero() ? 1 : 0));
+    }
+
+    markEdgeExecutable(BB, I->getSuccessor(0));
+    markEdgeExecutable(BB, I->getSuccessor(1));
+}
+
+bool SCCPSolver::resolveUndefined() {
+    // A phi whose executable incoming values are all undef, or only flow
+    // around a cycle of such phis, never gets a value. Lower these first,
+    // since their users may then decide the branches below.
+    bool Resolved = false;
+
+    for (BasicBlock *BB : Fn) {
+        if (!Executable.count(BB))
+            continue;
+
+        for (Instruction *I : *BB) {
+            PhiNode *Phi = dyn_cast<PhiNode>(I);
+            if (!Phi)
+                break;
+
+            if (Values[Phi].isUndefined()) {
+                markOverdefined(Phi);
+                Resolved = true;
+            }
+        }
+    }
+
+    if (Resolved)
+        return true;
+
+    // A branch on a condition which is still undefined has no executable
+    // successor, yet the code after it must be kept. Take both ways.
+    for (BasicBlock *BB : Fn) {
+        if (!Executable.count(BB))
+            continue;
+
+        BranchInst *Br = dyn_cast_or_null<BranchInst>(BB->getTerminator());
+        if (!Br || !Br->isConditional()
+                || !getValue(Br->getCondition()).isUndefined())
+            continue;
+
+        markEdgeExecutable(BB, Br->getSuccessor(0));
+        markEdgeExecutable(BB, Br->getSuccessor(1));
+    }
+
+    return !BlockWorklist.empty() || !ValueWorklist.empty();
+}
+
+void SCCPSolver::solve() {
+    BasicBlock *Entry = Fn.getEntryBlock();
+    if (!Entry)
+        return;
+
+    Executable.insert(Entry);
+    BlockWorklist.push_back(Entry);
+
+    do {
+        solveWorklists();
+    } while (resolveUndefined());
+}
+
+void SCCPSolver::solveWorklists() {
+    while (!BlockWorklist.empty() || !ValueWorklist.empty()) {
+        // Drain the value worklist first, it is cheap and tends to settle
+        // branch conditions before more blocks are explored.
+        while (!ValueWorklist.empty()) {
+            Value *V = ValueWorklist.back();
+            ValueWorklist.pop_back();
+
+            for (Instruction *User : Users[V])
+                if (Executable.count(User->getParent()))
+                    visit(User);
+        }
+
+        while (!BlockWorklist.empty()) {
+            BasicBlock *BB = BlockWorklist.back();
+            BlockWorklist.pop_back();
+
+            for (Instruction *I : *BB)
+                visit(I);
+        }
+    }
+}
+
+bool SCCPSolver::rewrite() {
+    ValueReplacementMap Replacements;
+    std::vector<Instruction *> Dead;
+    std::vector<BasicBlock *> Unreachable;
+    bool Changed = false;
+
+    for (BasicBlock *BB : Fn) {
+        if (!Executable.count(BB)) {
+            Unreachable.push_back(BB);
+            continue;
+        }
+
+        for (Instruction *I : *BB) {
+            auto It = Values.find(I);
+            if (It == Values.end() || !It->second.isConstant())
+                continue;
+
+            Replacements[I] = It->second.getConstant();
+            Dead.push_back(I);
+        }
+
+        // Drop the phi entries of edges that can never execute, which are
+        // the edges removed below or leaving blocks that are deleted.
+        for (Instruction *I : *BB) {
+            PhiNode *Phi = dyn_cast<PhiNode>(I);
+            if (!Phi)
+                break;
+
+            for (unsigned i = Phi->getNumIncomingValues(); i-- != 0; ) {
+                if (isEdgeExecutable(Phi->getIncomingBlock(i), BB))
+                    continue;
+
+                Phi->removeIncomingValue(i);
+                Changed = true;
+            }
+        }
+
+        BranchInst *Br = dyn_cast_or_null<BranchInst>(BB->getTerminator());
+        if (!Br || !Br->isConditional())
+            continue;
+
+        LatticeVal Cond = getValue(Br->getCondition());
+        if (!Cond.isConstant())
+            continue;
+
+        bool Taken = !cast<ConstantInt>(Cond.getConstant())->isZero();
+        Br->makeUnconditional(Br->getSuccessor(Taken ? 0 : 1));
+        Changed = true;
+    }
+
+    replaceAllUsesWith(Fn, Replacements);
+    eraseInstructions(Dead);
+
+    if (!Unreachable.empty())
+        Fn.eraseBlocks(Unreachable);
+
+    return Changed || !Dead.empty() || !Unreachable.empty();
+}
+
+} // end anonymous namespace
+
+// \brief Sparse conditional constant propagation.
+bool kaiju::runSCCP(Function &Fn) {
+    SCCPSolver Solver(Fn);
+    Solver.solve();
+    return Solver.rewrite();
+}
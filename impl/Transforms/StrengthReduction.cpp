@@ -0,0 +1,335 @@
+
+#include "kaiju/Transforms/StrengthReduction.h"
+
+using namespace kaiju;
+
+#include <vector>
+
+#include "kaiju/ADT/SmallVector.h"
+#include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/Constants.h"
+#include "kaiju/Transforms/Utils.h"
+
+// \brief Computes the magic number for unsigned division of a \p Width bit
+// integer by \p Divisor. All arithmetic is performed modulo 2^Width.
+UnsignedMagic kaiju::computeUnsignedMagic(uint128_t D, unsigned W) {
+    assert(W >= 2 && D > 1 && D <= maskTrailingOnes(W)
+        && "invalid divisor for unsigned magic number.");
+
+    const uint128_t Mask      = maskTrailingOnes(W);
+    const uint128_t SignedMin = uint128_t(1) << (W - 1);
+    const uint128_t SignedMax = SignedMin - 1;
+
+    bool NeedsAdd = false;
+    uint128_t NC = Mask - (Mask - D) % D;
+    unsigned P = W - 1;
+
+    uint128_t Q1 = SignedMin / NC, R1 = SignedMin - Q1 * NC;
+    uint128_t Q2 = SignedMax / D,  R2 = SignedMax - Q2 * D;
+    uint128_t Delta;
+
+    do {
+        ++P;
+
+        if (R1 >= ((NC - R1) & Mask)) {
+            Q1 = (Q1 + Q1 + 1) & Mask;
+            R1 = (R1 + R1 - NC) & Mask;
+        } else {
+            Q1 = (Q1 + Q1) & Mask;
+            R1 = (R1 + R1) & Mask;
+        }
+
+        if (((R2 + 1) & Mask) >= ((D - R2) & Mask)) {
+            if (Q2 >= SignedMax)
+                NeedsAdd = true;
+            Q2 = (Q2 + Q2 + 1) & Mask;
+            R2 = (R2 + R2 + 1 - D) & Mask;
+        } else {
+            if (Q2 >= SignedMin)
+                NeedsAdd = true;
+            Q2 = (Q2 + Q2) & Mask;
+            R2 = (R2 + R2 + 1) & Mask;
+        }
+
+        Delta = (D - 1 - R2) & Mask;
+    } while (P < 2 * W && (Q1 < Delta || (Q1 == Delta && R1 == 0)));
+
+    return UnsignedMagic { (Q2 + 1) & Mask, NeedsAdd, P - W };
+}
+
+// \brief Computes the magic number for signed division of a \p Width bit
+// integer by \p Divisor. All arithmetic is performed modulo 2^Width.
+SignedMagic kaiju::computeSignedMagic(uint128_t D, unsigned W) {
+    const uint128_t Mask      = maskTrailingOnes(W);
+    const uint128_t SignedMin = uint128_t(1) << (W - 1);
+
+    D &= Mask;
+    bool Negative = isNegative(D, W);
+    uint128_t AD = Negative ? (-D & Mask) : D;
+    assert(W >= 2 && AD > 1 && "invalid divisor for signed magic number.");
+
+    uint128_t T   = SignedMin + (Negative ? 1 : 0);
+    uint128_t ANC = T - 1 - T % AD;
+    unsigned P = W - 1;
+
+    uint128_t Q1 = SignedMin / ANC, R1 = SignedMin - Q1 * ANC;
+    uint128_t Q2 = SignedMin / AD,  R2 = SignedMin - Q2 * AD;
+    uint128_t Delta;
+
+    do {
+        ++P;
+
+        Q1 = (Q1 << 1) & Mask;
+        R1 = (R1 << 1) & Mask;
+        if (R1 >= ANC) {
+            Q1 = (Q1 + 1) & Mask;
+            R1 = (R1 - ANC) & Mask;
+        }
+
+        Q2 = (Q2 << 1) & Mask;
+        R2 = (R2 << 1) & Mask;
+        if (R2 >= AD) {
+            Q2 = (Q2 + 1) & Mask;
+            R2 = (R2 - AD) & Mask;
+        }
+
+        Delta = (AD - R2) & Mask;
+    } while (Q1 < Delta || (Q1 == Delta && R1 == 0));
+
+    uint128_t M = (Q2 + 1) & Mask;
+    if (Negative)
+        M = -M & Mask;
+
+    return SignedMagic { M, P - W };
+}
+
+namespace {
+
+// Class Reducer
+//
+// \brief Emits the reduced form of a single BinaryOperator. New instructions
+// are appended to the list the block is being rebuilt into, in front of the
+// instruction being replaced.
+//
+class Reducer {
+    // \brief The instructions of the block being rebuilt.
+    SmallVectorImpl<Instruction *> &Insts;
+
+    // \brief The type of the values being operated on.
+    IntegerType *Ty;
+
+    // \brief The width of Ty.
+    unsigned W;
+
+public:
+    Reducer(SmallVectorImpl<Instruction *> &Out, IntegerType *IT)
+         : Insts(Out), Ty(IT), W(IT->getBitWidth()) { /* empty */ }
+
+    ConstantInt *constant(uint128_t V) { return ConstantInt::get(Ty, V); }
+
+    // \brief Appends a new binary operation to the rebuilt block.
+    Value *emit(Instruction::BinaryOpTy Op, Value *LHS, Value *RHS) {
+        Insts.push_back(BinaryOperator::get(Op, LHS, RHS));
+        return Insts.back();
+    }
+
+    // \brief Emits a shift, eliding shifts by zero.
+    Value *shift(Instruction::BinaryOpTy Op, Value *V, unsigned Amount) {
+        return Amount ? emit(Op, V, constant(Amount)) : V;
+    }
+
+    Value *negate(Value *V) { return emit(Instruction::Sub, constant(0), V); }
+
+    // \brief x * C.
+    Value *mul(Value *X, ConstantInt *C) {
+        uint128_t V = C->getZExtValue();
+
+        if (V == 0)
+            return C;
+        if (V == 1)
+            return X;
+        if (isPowerOf2(V))
+            return shift(Instruction::Shl, X, log2(V));
+
+        uint128_t Neg = -V & maskTrailingOnes(W);
+        if (isPowerOf2(Neg))
+            return negate(shift(Instruction::Shl, X, log2(Neg)));
+
+        return nullptr;
+    }
+
+    // \brief x udiv C, with C non-zero.
+    Value *udiv(Value *X, ConstantInt *C) {
+        uint128_t D = C->getZExtValue();
+
+        if (D == 1)
+            return X;
+        if (isPowerOf2(D))
+            return shift(Instruction::LShr, X, log2(D));
+
+        UnsignedMagic Magic = computeUnsignedMagic(D, W);
+        Value *Q = emit(Instruction::MulHU, X, constant(Magic.Multiplier));
+
+        if (!Magic.NeedsAdd)
+            return shift(Instruction::LShr, Q, Magic.Shift);
+
+        Value *T = emit(Instruction::Sub, X, Q);
+        T = shift(Instruction::LShr, T, 1);
+        T = emit(Instruction::Add, T, Q);
+        return shift(Instruction::LShr, T, Magic.Shift - 1);
+    }
+
+    // \brief x urem C, with C non-zero.
+    Value *urem(Value *X, ConstantInt *C) {
+        uint128_t D = C->getZExtValue();
+
+        if (D == 1)
+            return constant(0);
+        if (isPowerOf2(D))
+            return emit(Instruction::And, X, constant(D - 1));
+
+        Value *Q = udiv(X, C);
+        return emit(Instruction::Sub, X, emit(Instruction::Mul, Q, C));
+    }
+
+    // \brief Returns (x < 0 ? 2^K - 1 : 0), the bias that makes an arithmetic
+    // shift by K round towards zero.
+    Value *roundingBias(Value *X, unsigned K) {
+        Value *Sign = shift(Instruction::AShr, X, W - 1);
+        return shift(Instruction::LShr, Sign, W - K);
+    }
+
+    // \brief x sdiv C, with C non-zero.
+    Value *sdiv(Value *X, ConstantInt *C) {
+        uint128_t D = C->getZExtValue();
+
+        if (D == 1)
+            return X;
+        if (C->isAllOnes())
+            return negate(X);
+
+        bool Negative = C->isNegative();
+        uint128_t AD = Negative ? (-D & maskTrailingOnes(W)) : D;
+
+        if (isPowerOf2(AD)) {
+            unsigned K = log2(AD);
+            Value *T = emit(Instruction::Add, X, roundingBias(X, K));
+            Value *Q = shift(Instruction::AShr, T, K);
+            return Negative ? negate(Q) : Q;
+        }
+
+        SignedMagic Magic = computeSignedMagic(D, W);
+        Value *Q = emit(Instruction::MulHS, X, constant(Magic.Multiplier));
+
+        bool MagicNegative = isNegative(Magic.Multiplier, W);
+        if (!Negative && MagicNegative)
+            Q = emit(Instruction::Add, Q, X);
+        else if (Negative && !MagicNegative && Magic.Multiplier)
+            Q = emit(Instruction::Sub, Q, X);
+
+        Q = shift(Instruction::AShr, Q, Magic.Shift);
+        return emit(Instruction::Add, Q,
+            shift(Instruction::LShr, Q, W - 1));
+    }
+
+    // \brief x srem C, with C non-zero.
+    Value *srem(Value *X, ConstantInt *C) {
+        uint128_t D = C->getZExtValue();
+
+        if (D == 1 || C->isAllOnes())
+            return constant(0);
+
+        uint128_t AD = C->isNegative() ? (-D & maskTrailingOnes(W)) : D;
+
+        // The sign of the remainder follows the dividend, so only the
+        // magnitude of the divisor matters: ((x + bias) & (|C| - 1)) - bias.
+        if (isPowerOf2(AD)) {
+            Value *Bias = roundingBias(X, log2(AD));
+            Value *T = emit(Instruction::Add, X, Bias);
+            T = emit(Instruction::And, T, constant(AD - 1));
+            return emit(Instruction::Sub, T, Bias);
+        }
+
+        Value *Q = sdiv(X, C);
+        return emit(Instruction::Sub, X, emit(Instruction::Mul, Q, C));
+    }
+};
+
+} // end anonymous namespace
+
+// \brief Appends the reduced form of \p I to \p Insts, returning the value
+// replacing \p I, or null if \p I is left as it is.
+static Value *reduceInstruction(Instruction *I,
+                                SmallVectorImpl<Instruction *> &Insts) {
+    BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I);
+    if (!BinOp)
+        return nullptr;
+
+    IntegerType *Ty = dyn_cast<IntegerType>(BinOp->getValueType());
+    if (!Ty)
+        return nullptr;
+
+    Value *X = BinOp->getLHS();
+    ConstantInt *C = dyn_cast<ConstantInt>(BinOp->getRHS());
+
+    if (!C && BinOp->getOpcode() == Instruction::Mul) {
+        X = BinOp->getRHS();
+        C = dyn_cast<ConstantInt>(BinOp->getLHS());
+    }
+
+    // Division by zero is left for the program to trap on.
+    if (!C || (C->isZero() && BinOp->getOpcode() != Instruction::Mul))
+        return nullptr;
+
+    Reducer R(Insts, Ty);
+
+    switch (BinOp->getOpcode()) {
+    case Instruction::Mul:  return R.mul(X, C);
+    case Instruction::UDiv: return R.udiv(X, C);
+    case Instruction::URem: return R.urem(X, C);
+    case Instruction::Div:  return R.sdiv(X, C);
+    case Instruction::Rem:  return R.srem(X, C);
+    default:
+        return nullptr;
+    }
+}
+
+// \brief Reduces the instructions of \p Block, recording the replaced
+// instructions in \p Replacements and \p Dead. The block is rebuilt in a
+// single sweep, replaced instructions stay in it until they are erased.
+static void reduceBlock(BasicBlock &Block, ValueReplacementMap &Replacements,
+                        std::vector<Instruction *> &Dead) {
+    SmallVector<Instruction *, 8> Insts;
+    Insts.reserve(Block.size());
+    bool Changed = false;
+
+    for (Instruction *I : Block) {
+        if (Value *Replacement = reduceInstruction(I, Insts)) {
+            Replacements[I] = Replacement;
+            Dead.push_back(I);
+            Changed = true;
+        }
+        Insts.push_back(I);
+    }
+
+    if (Changed)
+        Block.setInstructions(std::move(Insts));
+}
+
+// \brief Rewrites integer multiplications, divisions and remainders by
+// constants in \p Fn into cheaper shift, mask and multiply-high sequences.
+bool kaiju::reduceStrength(Function &Fn) {
+    ValueReplacementMap Replacements;
+    std::vector<Instruction *> Dead;
+
+    for (BasicBlock *Block : Fn)
+        reduceBlock(*Block, Replacements, Dead);
+
+    replaceAllUsesWith(Fn, Replacements);
+
+    // Erase only after every use was rewritten, so that no new instruction can
+    // be allocated at the address of a key in Replacements.
+    eraseInstructions(Dead);
+
+    return !Dead.empty();
+}
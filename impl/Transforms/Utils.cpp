@@ -0,0 +1,50 @@
+
+#include "kaiju/Transforms/Utils.h"
+
+using namespace kaiju;
+
+#include <set>
+
+// \brief Returns the value \p V is finally replaced with in \p Replacements.
+Value *kaiju::getReplacement(const ValueReplacementMap &Replacements,
+                             Value *V) {
+    for (auto It = Replacements.find(V); It != Replacements.end();
+              It = Replacements.find(V))
+        V = It->second;
+
+    return V;
+}
+
+// \brief Rewrites every operand of every instruction in \p Fn according to
+// \p Replacements.
+void kaiju::replaceAllUsesWith(Function &Fn,
+                               const ValueReplacementMap &Replacements) {
+    if (Replacements.empty())
+        return;
+
+    for (BasicBlock *BB : Fn)
+        for (Instruction *I : *BB)
+            for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i)
+                I->setOperand(i,
+                    getReplacement(Replacements, I->getOperand(i)));
+}
+
+// \brief Unlinks and deletes every instruction in \p Dead, sweeping each
+// affected block once.
+void kaiju::eraseInstructions(const std::vector<Instruction *> &Dead) {
+    std::set<Instruction *> DeadSet;
+    std::set<BasicBlock *> Blocks;
+
+    for (Instruction *I : Dead) {
+        if (!I->getParent()) {
+            delete I;
+            continue;
+        }
+
+        DeadSet.insert(I);
+        Blocks.insert(I->getParent());
+    }
+
+    for (BasicBlock *BB : Blocks)
+        BB->eraseIf([&](Instruction *I) { return DeadSet.count(I) != 0; });
+}
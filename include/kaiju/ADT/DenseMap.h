@@ -0,0 +1,484 @@
+
+#ifndef KAIJU_ADT_DENSEMAP_H
+#define KAIJU_ADT_DENSEMAP_H
+
+#include "kaiju/ADT/Hashing.h"
+#include "kaiju/ADT/StringRef.h"
+#include "kaiju/Support/MathExtras.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace kaiju {
+
+/// DenseMapInfo - Tells a DenseMap how to hash and compare its keys, and
+/// which two key values mark empty and erased buckets. Those two values can
+/// never be inserted into a map.
+template <typename T> struct DenseMapInfo {
+  // static T getEmptyKey();
+  // static T getTombstoneKey();
+  // static uint64_t getHashValue(const T &Val);
+  // static bool isEqual(const T &LHS, const T &RHS);
+};
+
+/// Pointers use addresses no allocation can return as their markers.
+template <typename T> struct DenseMapInfo<T *> {
+  static T *getEmptyKey() {
+    return reinterpret_cast<T *>(~uintptr_t(0) << 12);
+  }
+
+  static T *getTombstoneKey() {
+    return reinterpret_cast<T *>(~uintptr_t(1) << 12);
+  }
+
+  static uint64_t getHashValue(const T *Ptr) {
+    return hash_integer(uintptr_t(Ptr));
+  }
+
+  static bool isEqual(const T *LHS, const T *RHS) { return LHS == RHS; }
+};
+
+namespace detail {
+
+  /// Integers give up their two largest values as markers.
+  template <typename T> struct IntegerDenseMapInfo {
+    static T getEmptyKey() { return std::numeric_limits<T>::max(); }
+    static T getTombstoneKey() { return std::numeric_limits<T>::max() - 1; }
+    static uint64_t getHashValue(const T &Val) {
+      return hash_integer(uint64_t(Val));
+    }
+    static bool isEqual(const T &LHS, const T &RHS) { return LHS == RHS; }
+  };
+
+} // end namespace detail
+
+template <> struct DenseMapInfo<int>
+    : detail::IntegerDenseMapInfo<int> {};
+template <> struct DenseMapInfo<unsigned>
+    : detail::IntegerDenseMapInfo<unsigned> {};
+template <> struct DenseMapInfo<unsigned long>
+    : detail::IntegerDenseMapInfo<unsigned long> {};
+template <> struct DenseMapInfo<unsigned long long>
+    : detail::IntegerDenseMapInfo<unsigned long long> {};
+
+template <> struct DenseMapInfo<uint128_t> {
+  static uint128_t getEmptyKey() { return ~uint128_t(0); }
+  static uint128_t getTombstoneKey() { return ~uint128_t(0) - 1; }
+  static uint64_t getHashValue(const uint128_t &Val) {
+    return hash_combine(hash_integer(uint64_t(Val)), uint64_t(Val >> 64));
+  }
+  static bool isEqual(const uint128_t &LHS, const uint128_t &RHS) {
+    return LHS == RHS;
+  }
+};
+
+/// StringRefs mark buckets with data pointers no string can have, and are
+/// only compared by their characters when neither is a marker.
+template <> struct DenseMapInfo<StringRef> {
+  static StringRef getEmptyKey() {
+    return StringRef(reinterpret_cast<const char *>(~uintptr_t(0)), 0);
+  }
+
+  static StringRef getTombstoneKey() {
+    return StringRef(reinterpret_cast<const char *>(~uintptr_t(1)), 0);
+  }
+
+  static uint64_t getHashValue(StringRef Val) { return hash_value(Val); }
+
+  static bool isEqual(StringRef LHS, StringRef RHS) {
+    if (RHS.data() == getEmptyKey().data() ||
+        RHS.data() == getTombstoneKey().data())
+      return LHS.data() == RHS.data();
+    return LHS == RHS;
+  }
+};
+
+/// Pairs are markers when both halves are.
+template <typename T, typename U> struct DenseMapInfo<std::pair<T, U>> {
+  using Pair = std::pair<T, U>;
+  using FirstInfo = DenseMapInfo<T>;
+  using SecondInfo = DenseMapInfo<U>;
+
+  static Pair getEmptyKey() {
+    return Pair(FirstInfo::getEmptyKey(), SecondInfo::getEmptyKey());
+  }
+
+  static Pair getTombstoneKey() {
+    return Pair(FirstInfo::getTombstoneKey(), SecondInfo::getTombstoneKey());
+  }
+
+  static uint64_t getHashValue(const Pair &Val) {
+    return hash_combine(FirstInfo::getHashValue(Val.first),
+                        SecondInfo::getHashValue(Val.second));
+  }
+
+  static bool isEqual(const Pair &LHS, const Pair &RHS) {
+    return FirstInfo::isEqual(LHS.first, RHS.first) &&
+           SecondInfo::isEqual(LHS.second, RHS.second);
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, bool IsConst>
+class DenseMapIterator;
+
+/// DenseMap - An open addressing hash table keeping its keys and values
+/// inline, in a single array of buckets.
+///
+/// Lookups hash the key once and probe neighbouring buckets, so a lookup
+/// usually touches one cache line and inserting allocates nothing until the
+/// table grows. The number of buckets is a power of two; the table doubles
+/// once it is three quarters full, and erased buckets are left as
+/// tombstones which are dropped when the table is rebuilt. Inserting or
+/// erasing invalidates iterators and references into the map, and the
+/// order of iteration is unspecified.
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>>
+class DenseMap {
+public:
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = std::pair<KeyT, ValueT>;
+  using size_type = unsigned;
+  using iterator = DenseMapIterator<KeyT, ValueT, KeyInfoT, false>;
+  using const_iterator = DenseMapIterator<KeyT, ValueT, KeyInfoT, true>;
+
+private:
+  using BucketT = value_type;
+
+  BucketT *Buckets = nullptr;
+  unsigned NumEntries = 0;
+  unsigned NumTombstones = 0;
+  unsigned NumBuckets = 0;
+
+  /// The fewest buckets a table is allocated with.
+  static constexpr unsigned MinBuckets = 16;
+
+  static KeyT getEmptyKey() { return KeyInfoT::getEmptyKey(); }
+  static KeyT getTombstoneKey() { return KeyInfoT::getTombstoneKey(); }
+
+  static bool isLive(const BucketT &B) {
+    return !KeyInfoT::isEqual(B.first, getEmptyKey()) &&
+           !KeyInfoT::isEqual(B.first, getTombstoneKey());
+  }
+
+  /// Allocates \p Num empty buckets, a power of two.
+  void allocateBuckets(unsigned Num) {
+    NumBuckets = Num;
+    NumEntries = NumTombstones = 0;
+    if (!Num) {
+      Buckets = nullptr;
+      return;
+    }
+
+    Buckets = static_cast<BucketT *>(::operator new(sizeof(BucketT) * Num));
+    const KeyT Empty = getEmptyKey();
+    for (unsigned i = 0; i != Num; ++i)
+      ::new (&Buckets[i].first) KeyT(Empty);
+  }
+
+  /// Destroys every bucket and frees the table.
+  void destroyBuckets() {
+    for (unsigned i = 0; i != NumBuckets; ++i) {
+      if (isLive(Buckets[i]))
+        Buckets[i].second.~ValueT();
+      Buckets[i].first.~KeyT();
+    }
+    ::operator delete(Buckets);
+    Buckets = nullptr;
+  }
+
+  /// Looks for \p Key, returning its bucket in \p Found if it is present.
+  /// Otherwise \p Found is the bucket to insert it into, preferring the
+  /// first tombstone passed on the way, or null if there are no buckets.
+  bool lookupBucketFor(const KeyT &Key, BucketT *&Found) const {
+    if (!NumBuckets) {
+      Found = nullptr;
+      return false;
+    }
+
+    assert(!KeyInfoT::isEqual(Key, getEmptyKey()) &&
+           !KeyInfoT::isEqual(Key, getTombstoneKey()) &&
+           "Empty or tombstone value used as a DenseMap key!");
+
+    const KeyT Empty = getEmptyKey();
+    const KeyT Tombstone = getTombstoneKey();
+    BucketT *FoundTombstone = nullptr;
+    unsigned Mask = NumBuckets - 1;
+    unsigned Bucket = unsigned(KeyInfoT::getHashValue(Key)) & Mask;
+
+    // Triangular probing visits every bucket of a power of two table.
+    for (unsigned Probe = 1;; ++Probe) {
+      BucketT *B = Buckets + Bucket;
+      if (KeyInfoT::isEqual(Key, B->first)) {
+        Found = B;
+        return true;
+      }
+
+      if (KeyInfoT::isEqual(B->first, Empty)) {
+        Found = FoundTombstone ? FoundTombstone : B;
+        return false;
+      }
+
+      if (!FoundTombstone && KeyInfoT::isEqual(B->first, Tombstone))
+        FoundTombstone = B;
+
+      Bucket = (Bucket + Probe) & Mask;
+    }
+  }
+
+  /// Rebuilds the table with at least \p AtLeast buckets, moving every
+  /// entry over and dropping the tombstones.
+  void grow(unsigned AtLeast) {
+    BucketT *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+
+    unsigned Num = MinBuckets;
+    while (Num < AtLeast)
+      Num *= 2;
+    allocateBuckets(Num);
+
+    for (unsigned i = 0; i != OldNumBuckets; ++i) {
+      BucketT &Old = OldBuckets[i];
+      if (isLive(Old)) {
+        BucketT *Dest;
+        bool Present = lookupBucketFor(Old.first, Dest);
+        (void)Present;
+        assert(!Present && "Key already in new map?");
+        Dest->first = std::move(Old.first);
+        ::new (&Dest->second) ValueT(std::move(Old.second));
+        ++NumEntries;
+        Old.second.~ValueT();
+      }
+      Old.first.~KeyT();
+    }
+
+    ::operator delete(OldBuckets);
+  }
+
+  /// Makes room for one more entry and returns the bucket \p Key goes to,
+  /// \p TheBucket being where the lookup left off.
+  BucketT *insertIntoBucketImpl(const KeyT &Key, BucketT *TheBucket) {
+    // Grow at three quarters full. Rebuild at the same size when fewer than
+    // an eighth of the buckets are empty, so lookups of missing keys end.
+    unsigned NewNumEntries = NumEntries + 1;
+    if (NewNumEntries * 4 >= NumBuckets * 3) {
+      grow(NumBuckets * 2);
+      lookupBucketFor(Key, TheBucket);
+    } else if (NumBuckets - (NewNumEntries + NumTombstones) <=
+               NumBuckets / 8) {
+      grow(NumBuckets);
+      lookupBucketFor(Key, TheBucket);
+    }
+
+    ++NumEntries;
+    if (!KeyInfoT::isEqual(TheBucket->first, getEmptyKey()))
+      --NumTombstones;
+    return TheBucket;
+  }
+
+  iterator makeIterator(BucketT *B) {
+    return iterator(B, Buckets + NumBuckets);
+  }
+
+  const_iterator makeConstIterator(const BucketT *B) const {
+    return const_iterator(B, Buckets + NumBuckets);
+  }
+
+public:
+  /// Creates a map with room for \p InitialReserve entries before it grows.
+  explicit DenseMap(unsigned InitialReserve = 0) {
+    if (InitialReserve)
+      reserve(InitialReserve);
+  }
+
+  DenseMap(const DenseMap &Other) {
+    reserve(Other.size());
+    for (const value_type &KV : Other)
+      insert(KV);
+  }
+
+  DenseMap(DenseMap &&Other) { swap(Other); }
+
+  ~DenseMap() { destroyBuckets(); }
+
+  DenseMap &operator=(DenseMap Other) {
+    swap(Other);
+    return *this;
+  }
+
+  void swap(DenseMap &Other) {
+    std::swap(Buckets, Other.Buckets);
+    std::swap(NumEntries, Other.NumEntries);
+    std::swap(NumTombstones, Other.NumTombstones);
+    std::swap(NumBuckets, Other.NumBuckets);
+  }
+
+  iterator begin() { return makeIterator(Buckets); }
+  iterator end() { return makeIterator(Buckets + NumBuckets); }
+  const_iterator begin() const { return makeConstIterator(Buckets); }
+  const_iterator end() const { return makeConstIterator(Buckets + NumBuckets); }
+
+  bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grows the table so \p NumEntries entries fit without growing again.
+  void reserve(unsigned NumEntries) {
+    unsigned Needed = NumEntries * 4 / 3 + 1;
+    if (Needed > NumBuckets)
+      grow(Needed);
+  }
+
+  /// Erases every entry, keeping the table.
+  void clear() {
+    if (NumEntries == 0 && NumTombstones == 0)
+      return;
+
+    const KeyT Empty = getEmptyKey();
+    for (unsigned i = 0; i != NumBuckets; ++i) {
+      if (isLive(Buckets[i]))
+        Buckets[i].second.~ValueT();
+      Buckets[i].first = Empty;
+    }
+    NumEntries = NumTombstones = 0;
+  }
+
+  /// Returns 1 if \p Key is in the map, 0 otherwise.
+  unsigned count(const KeyT &Key) const {
+    BucketT *B;
+    return lookupBucketFor(Key, B) ? 1 : 0;
+  }
+
+  iterator find(const KeyT &Key) {
+    BucketT *B;
+    return lookupBucketFor(Key, B) ? makeIterator(B) : end();
+  }
+
+  const_iterator find(const KeyT &Key) const {
+    BucketT *B;
+    return lookupBucketFor(Key, B) ? makeConstIterator(B) : end();
+  }
+
+  /// Returns the value of \p Key, or a default constructed value if it is
+  /// not in the map.
+  ValueT lookup(const KeyT &Key) const {
+    BucketT *B;
+    return lookupBucketFor(Key, B) ? B->second : ValueT();
+  }
+
+  /// Inserts \p Key with a value built from \p Args if it is not in the map
+  /// yet. Returns the entry of \p Key and whether it was inserted.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    BucketT *B;
+    if (lookupBucketFor(Key, B))
+      return std::make_pair(makeIterator(B), false);
+
+    B = insertIntoBucketImpl(Key, B);
+    B->first = Key;
+    ::new (&B->second) ValueT(std::forward<Ts>(Args)...);
+    return std::make_pair(makeIterator(B), true);
+  }
+
+  std::pair<iterator, bool> insert(const value_type &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+
+  std::pair<iterator, bool> insert(value_type &&KV) {
+    return try_emplace(KV.first, std::move(KV.second));
+  }
+
+  /// Returns the value of \p Key, inserting a default constructed one if
+  /// it is not in the map.
+  ValueT &operator[](const KeyT &Key) {
+    return try_emplace(Key).first->second;
+  }
+
+  /// Erases \p Key, returning whether it was in the map.
+  bool erase(const KeyT &Key) {
+    BucketT *B;
+    if (!lookupBucketFor(Key, B))
+      return false;
+
+    B->second.~ValueT();
+    B->first = getTombstoneKey();
+    --NumEntries;
+    ++NumTombstones;
+    return true;
+  }
+
+  void erase(iterator I) {
+    BucketT *B = &*I;
+    B->second.~ValueT();
+    B->first = getTombstoneKey();
+    --NumEntries;
+    ++NumTombstones;
+  }
+};
+
+/// DenseMapIterator - Walks the live buckets of a DenseMap.
+template <typename KeyT, typename ValueT, typename KeyInfoT, bool IsConst>
+class DenseMapIterator {
+  friend class DenseMapIterator<KeyT, ValueT, KeyInfoT, true>;
+
+  using BucketT = std::pair<KeyT, ValueT>;
+
+public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = typename std::conditional<IsConst, const BucketT,
+                                               BucketT>::type;
+  using pointer = value_type *;
+  using reference = value_type &;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  pointer Ptr = nullptr;
+  pointer End = nullptr;
+
+  void advancePastEmptyBuckets() {
+    const KeyT Empty = KeyInfoT::getEmptyKey();
+    const KeyT Tombstone = KeyInfoT::getTombstoneKey();
+    while (Ptr != End && (KeyInfoT::isEqual(Ptr->first, Empty) ||
+                          KeyInfoT::isEqual(Ptr->first, Tombstone)))
+      ++Ptr;
+  }
+
+public:
+  DenseMapIterator() = default;
+
+  DenseMapIterator(pointer Pos, pointer E) : Ptr(Pos), End(E) {
+    advancePastEmptyBuckets();
+  }
+
+  /// Converts an iterator to a const_iterator.
+  template <bool WasConst,
+            typename = typename std::enable_if<IsConst && !WasConst>::type>
+  DenseMapIterator(const DenseMapIterator<KeyT, ValueT, KeyInfoT, WasConst> &I)
+      : Ptr(I.Ptr), End(I.End) {}
+
+  reference operator*() const { return *Ptr; }
+  pointer operator->() const { return Ptr; }
+
+  bool operator==(const DenseMapIterator &RHS) const { return Ptr == RHS.Ptr; }
+  bool operator!=(const DenseMapIterator &RHS) const { return Ptr != RHS.Ptr; }
+
+  DenseMapIterator &operator++() {
+    ++Ptr;
+    advancePastEmptyBuckets();
+    return *this;
+  }
+
+  DenseMapIterator operator++(int) {
+    DenseMapIterator Tmp = *this;
+    ++*this;
+    return Tmp;
+  }
+};
+
+} // end namespace kaiju
+
+#endif // KAIJU_ADT_DENSEMAP_H
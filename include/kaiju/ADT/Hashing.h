@@ -0,0 +1,124 @@
+
+#ifndef KAIJU_ADT_HASHING_H
+#define KAIJU_ADT_HASHING_H
+
+#include "kaiju/ADT/StringRef.h"
+#include "kaiju/Support/MathExtras.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace kaiju {
+
+namespace hashing {
+namespace detail {
+
+  /// The constants mixed into every hash, odd and with balanced bits.
+  constexpr uint64_t Secret0 = 0xa0761d6478bd642fULL;
+  constexpr uint64_t Secret1 = 0xe7037ed1a0b428dbULL;
+  constexpr uint64_t Secret2 = 0x8ebc6af09c88c6e3ULL;
+  constexpr uint64_t Secret3 = 0x589965cc75374cc3ULL;
+
+  /// Multiplies \p A and \p B to 128 bits and folds the halves together.
+  inline uint64_t mix(uint64_t A, uint64_t B) {
+    uint128_t R = uint128_t(A) * B;
+    return uint64_t(R) ^ uint64_t(R >> 64);
+  }
+
+  inline uint64_t read64(const char *P) {
+    uint64_t V;
+    std::memcpy(&V, P, sizeof(V));
+    return V;
+  }
+
+  inline uint64_t read32(const char *P) {
+    uint32_t V;
+    std::memcpy(&V, P, sizeof(V));
+    return V;
+  }
+
+  /// Reads 1 to 3 bytes into one word, every byte at least once.
+  inline uint64_t readSmall(const char *P, size_t Length) {
+    return (uint64_t(uint8_t(P[0])) << 16) |
+           (uint64_t(uint8_t(P[Length >> 1])) << 8) |
+           uint64_t(uint8_t(P[Length - 1]));
+  }
+
+} // end namespace detail
+} // end namespace hashing
+
+/// Hashes \p Length bytes at \p Data, after the design of wyhash.
+///
+/// This is a fast non-cryptographic hash for hash tables, not for anything
+/// which must withstand an attacker. Inputs up to 16 bytes, which is most
+/// symbol names, are hashed with two multiplications and no loop. The
+/// result is the same on every run, but not across byte orders.
+inline uint64_t hash_bytes(const char *Data, size_t Length,
+                           uint64_t Seed = 0) {
+  using namespace hashing::detail;
+
+  Seed ^= mix(Seed ^ Secret0, Secret1);
+  uint64_t A, B;
+  if (Length <= 16) {
+    if (Length >= 4) {
+      size_t Mid = (Length >> 3) << 2;
+      A = (read32(Data) << 32) | read32(Data + Mid);
+      B = (read32(Data + Length - 4) << 32) | read32(Data + Length - 4 - Mid);
+    } else if (Length > 0) {
+      A = readSmall(Data, Length);
+      B = 0;
+    } else {
+      A = B = 0;
+    }
+  } else {
+    const char *P = Data;
+    size_t Left = Length;
+    if (Left > 48) {
+      uint64_t See1 = Seed, See2 = Seed;
+      do {
+        Seed = mix(read64(P) ^ Secret1, read64(P + 8) ^ Seed);
+        See1 = mix(read64(P + 16) ^ Secret2, read64(P + 24) ^ See1);
+        See2 = mix(read64(P + 32) ^ Secret3, read64(P + 40) ^ See2);
+        P += 48;
+        Left -= 48;
+      } while (Left > 48);
+      Seed ^= See1 ^ See2;
+    }
+    while (Left > 16) {
+      Seed = mix(read64(P) ^ Secret1, read64(P + 8) ^ Seed);
+      P += 16;
+      Left -= 16;
+    }
+    A = read64(P + Left - 16);
+    B = read64(P + Left - 8);
+  }
+
+  A ^= Secret1;
+  B ^= Seed;
+  uint128_t R = uint128_t(A) * B;
+  A = uint64_t(R);
+  B = uint64_t(R >> 64);
+  return hashing::detail::mix(A ^ Secret0 ^ Length, B ^ Secret1);
+}
+
+/// Hashes the characters of \p S.
+inline uint64_t hash_value(StringRef S) {
+  return hash_bytes(S.data(), S.size());
+}
+
+/// Hashes an integer, spreading every input bit over the whole result so
+/// the low bits can index a power of two sized table.
+inline uint64_t hash_integer(uint64_t V) {
+  using namespace hashing::detail;
+  return mix(V ^ Secret0, Secret1);
+}
+
+/// Combines the hashes \p A and \p B, in an order dependent way.
+inline uint64_t hash_combine(uint64_t A, uint64_t B) {
+  using namespace hashing::detail;
+  return mix(A ^ Secret2, B ^ Secret3);
+}
+
+} // end namespace kaiju
+
+#endif // KAIJU_ADT_HASHING_H
@@ -0,0 +1,537 @@
+
+#ifndef KAIJU_ADT_SMALLVECTOR_H
+#define KAIJU_ADT_SMALLVECTOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace kaiju {
+
+/// SmallVectorBase - The part of a SmallVector which does not depend on the
+/// element type: where the elements are, how many there are and how many
+/// fit before the vector must grow.
+class SmallVectorBase {
+protected:
+  void *BeginX;
+  unsigned Size = 0, Capacity;
+
+  SmallVectorBase(void *FirstEl, size_t TotalCapacity)
+      : BeginX(FirstEl), Capacity(unsigned(TotalCapacity)) {}
+
+public:
+  size_t size() const { return Size; }
+  size_t capacity() const { return Capacity; }
+  bool empty() const { return !Size; }
+};
+
+/// Lays out a SmallVectorBase followed by an element the way SmallVector
+/// lays out its bases, to find where the inline elements start.
+template <typename T> struct SmallVectorAlignmentAndSize {
+  alignas(SmallVectorBase) char Base[sizeof(SmallVectorBase)];
+  alignas(T) char FirstEl[sizeof(T)];
+};
+
+/// SmallVectorImpl - The operations of a SmallVector, independent of its
+/// inline capacity.
+///
+/// Functions taking or filling a vector should take a SmallVectorImpl<T> &,
+/// so that each caller picks the inline capacity that suits it. Elements
+/// live in the inline buffer of the SmallVector until they outgrow it, and
+/// on the heap from then on. Trivially copyable elements are relocated with
+/// memcpy when the vector grows, others are moved and destroyed one by one.
+/// As with std::vector, growing invalidates iterators and references.
+template <typename T> class SmallVectorImpl : public SmallVectorBase {
+  static constexpr bool IsPod = std::is_trivially_copyable<T>::value;
+
+  static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                "Over aligned elements are not supported!");
+
+public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using iterator = T *;
+  using const_iterator = const T *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+protected:
+  explicit SmallVectorImpl(unsigned N) : SmallVectorBase(getFirstEl(), N) {}
+
+  ~SmallVectorImpl() {
+    destroyRange(begin(), end());
+    if (!isSmall())
+      ::operator delete(BeginX);
+  }
+
+  /// Returns the first inline element, which follows this object.
+  void *getFirstEl() const {
+    return const_cast<void *>(reinterpret_cast<const void *>(
+        reinterpret_cast<const char *>(this) +
+        offsetof(SmallVectorAlignmentAndSize<T>, FirstEl)));
+  }
+
+  /// Returns whether the elements are in the inline buffer.
+  bool isSmall() const { return BeginX == getFirstEl(); }
+
+  /// Forgets a heap buffer taken by another vector. The inline buffer is
+  /// then treated as empty, so the next element grows the vector.
+  void resetToSmall() {
+    BeginX = getFirstEl();
+    Size = Capacity = 0;
+  }
+
+  static void destroyRange(T *S, T *E) {
+    if (!IsPod) {
+      while (S != E) {
+        --E;
+        E->~T();
+      }
+    }
+  }
+
+  /// Allocates room for at least \p MinSize elements, and for at least one
+  /// more than the current capacity.
+  T *allocateForGrow(size_t MinSize, size_t &NewCapacity) {
+    NewCapacity = std::max<size_t>(2 * size_t(Capacity) + 1, MinSize);
+    assert(NewCapacity <= UINT32_MAX && "SmallVector capacity overflow!");
+    return static_cast<T *>(::operator new(NewCapacity * sizeof(T)));
+  }
+
+  /// Relocates the elements to \p NewElts, leaving the old ones destroyed.
+  void moveElementsForGrow(T *NewElts) {
+    if constexpr (IsPod) {
+      if (Size)
+        std::memcpy(static_cast<void *>(NewElts), BeginX, Size * sizeof(T));
+    } else {
+      std::uninitialized_move(begin(), end(), NewElts);
+      destroyRange(begin(), end());
+    }
+  }
+
+  /// Frees the old buffer, if it was on the heap, and adopts \p NewElts.
+  void takeAllocationForGrow(T *NewElts, size_t NewCapacity) {
+    if (!isSmall())
+      ::operator delete(BeginX);
+    BeginX = NewElts;
+    Capacity = unsigned(NewCapacity);
+  }
+
+  /// Moves the elements to a heap buffer with room for at least \p MinSize
+  /// of them.
+  void grow(size_t MinSize = 0) {
+    size_t NewCapacity;
+    T *NewElts = allocateForGrow(MinSize, NewCapacity);
+    moveElementsForGrow(NewElts);
+    takeAllocationForGrow(NewElts, NewCapacity);
+  }
+
+  /// Grows the vector and appends an element built from \p Args. The new
+  /// element is built before the old ones move, as \p Args may refer to
+  /// one of them.
+  template <typename... ArgTypes> T &growAndEmplaceBack(ArgTypes &&... Args) {
+    size_t NewCapacity;
+    T *NewElts = allocateForGrow(0, NewCapacity);
+    ::new (static_cast<void *>(NewElts + Size))
+        T(std::forward<ArgTypes>(Args)...);
+    moveElementsForGrow(NewElts);
+    takeAllocationForGrow(NewElts, NewCapacity);
+    ++Size;
+    return back();
+  }
+
+  template <typename ArgType> iterator insertOne(iterator I, ArgType &&Elt) {
+    if (I == end()) {
+      push_back(std::forward<ArgType>(Elt));
+      return end() - 1;
+    }
+    assert(I >= begin() && I < end() && "Insertion iterator is out of bounds!");
+
+    // Take the value before shifting, \p Elt may be one of the elements.
+    size_t Index = I - begin();
+    T Copy(std::forward<ArgType>(Elt));
+    if (Size == Capacity)
+      grow();
+    I = begin() + Index;
+
+    ::new (static_cast<void *>(end())) T(std::move(back()));
+    std::move_backward(I, end() - 1, end());
+    ++Size;
+    *I = std::move(Copy);
+    return I;
+  }
+
+public:
+  SmallVectorImpl(const SmallVectorImpl &) = delete;
+
+  iterator begin() { return static_cast<T *>(BeginX); }
+  const_iterator begin() const { return static_cast<const T *>(BeginX); }
+  iterator end() { return begin() + Size; }
+  const_iterator end() const { return begin() + Size; }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  pointer data() { return begin(); }
+  const_pointer data() const { return begin(); }
+
+  reference operator[](size_t Idx) {
+    assert(Idx < size() && "Index out of range!");
+    return begin()[Idx];
+  }
+  const_reference operator[](size_t Idx) const {
+    assert(Idx < size() && "Index out of range!");
+    return begin()[Idx];
+  }
+
+  reference front() {
+    assert(!empty() && "front() on an empty vector!");
+    return begin()[0];
+  }
+  const_reference front() const {
+    assert(!empty() && "front() on an empty vector!");
+    return begin()[0];
+  }
+
+  reference back() {
+    assert(!empty() && "back() on an empty vector!");
+    return end()[-1];
+  }
+  const_reference back() const {
+    assert(!empty() && "back() on an empty vector!");
+    return end()[-1];
+  }
+
+  void push_back(const T &Elt) {
+    if (Size == Capacity) {
+      growAndEmplaceBack(Elt);
+      return;
+    }
+    ::new (static_cast<void *>(end())) T(Elt);
+    ++Size;
+  }
+
+  void push_back(T &&Elt) {
+    if (Size == Capacity) {
+      growAndEmplaceBack(std::move(Elt));
+      return;
+    }
+    ::new (static_cast<void *>(end())) T(std::move(Elt));
+    ++Size;
+  }
+
+  template <typename... ArgTypes> reference emplace_back(ArgTypes &&... Args) {
+    if (Size == Capacity)
+      return growAndEmplaceBack(std::forward<ArgTypes>(Args)...);
+    ::new (static_cast<void *>(end())) T(std::forward<ArgTypes>(Args)...);
+    ++Size;
+    return back();
+  }
+
+  void pop_back() {
+    assert(!empty() && "pop_back() on an empty vector!");
+    --Size;
+    end()->~T();
+  }
+
+  T pop_back_val() {
+    T Result = std::move(back());
+    pop_back();
+    return Result;
+  }
+
+  void clear() {
+    destroyRange(begin(), end());
+    Size = 0;
+  }
+
+  /// Makes room for \p N elements without growing again.
+  void reserve(size_t N) {
+    if (N > Capacity)
+      grow(N);
+  }
+
+  /// Drops the elements past the first \p N.
+  void truncate(size_t N) {
+    assert(N <= size() && "Cannot increase size with truncate!");
+    destroyRange(begin() + N, end());
+    Size = unsigned(N);
+  }
+
+  /// Resizes to \p N elements, value initializing the new ones.
+  void resize(size_t N) {
+    if (N <= Size) {
+      truncate(N);
+      return;
+    }
+    reserve(N);
+    for (T *I = end(), *E = begin() + N; I != E; ++I)
+      ::new (static_cast<void *>(I)) T();
+    Size = unsigned(N);
+  }
+
+  void resize(size_t N, const T &NV) {
+    if (N <= Size)
+      truncate(N);
+    else
+      append(N - Size, NV);
+  }
+
+  /// Appends the elements of [\p In, \p InEnd), which must not be part of
+  /// this vector.
+  template <typename ItTy,
+            typename = typename std::enable_if<std::is_convertible<
+                typename std::iterator_traits<ItTy>::iterator_category,
+                std::input_iterator_tag>::value>::type>
+  void append(ItTy In, ItTy InEnd) {
+    size_t NumInputs = std::distance(In, InEnd);
+    reserve(size() + NumInputs);
+    std::uninitialized_copy(In, InEnd, end());
+    Size += unsigned(NumInputs);
+  }
+
+  /// Appends \p NumInputs copies of \p Elt.
+  void append(size_t NumInputs, const T &Elt) {
+    if (NumInputs > Capacity - Size) {
+      // Growing would free \p Elt if it is one of the elements.
+      T Copy(Elt);
+      reserve(size() + NumInputs);
+      std::uninitialized_fill_n(end(), NumInputs, Copy);
+    } else {
+      std::uninitialized_fill_n(end(), NumInputs, Elt);
+    }
+    Size += unsigned(NumInputs);
+  }
+
+  void append(std::initializer_list<T> IL) { append(IL.begin(), IL.end()); }
+
+  void assign(size_t NumElts, const T &Elt) {
+    T Copy(Elt);
+    clear();
+    append(NumElts, Copy);
+  }
+
+  template <typename ItTy,
+            typename = typename std::enable_if<std::is_convertible<
+                typename std::iterator_traits<ItTy>::iterator_category,
+                std::input_iterator_tag>::value>::type>
+  void assign(ItTy In, ItTy InEnd) {
+    clear();
+    append(In, InEnd);
+  }
+
+  void assign(std::initializer_list<T> IL) { assign(IL.begin(), IL.end()); }
+
+  iterator insert(iterator I, const T &Elt) { return insertOne(I, Elt); }
+  iterator insert(iterator I, T &&Elt) { return insertOne(I, std::move(Elt)); }
+
+  /// Inserts \p NumToInsert copies of \p Elt before \p I.
+  iterator insert(iterator I, size_t NumToInsert, const T &Elt) {
+    assert(I >= begin() && I <= end() && "Insertion iterator out of bounds!");
+    size_t Index = I - begin(), OldSize = size();
+    append(NumToInsert, Elt);
+    std::rotate(begin() + Index, begin() + OldSize, end());
+    return begin() + Index;
+  }
+
+  /// Inserts the elements of [\p From, \p To), which must not be part of
+  /// this vector, before \p I.
+  template <typename ItTy,
+            typename = typename std::enable_if<std::is_convertible<
+                typename std::iterator_traits<ItTy>::iterator_category,
+                std::input_iterator_tag>::value>::type>
+  iterator insert(iterator I, ItTy From, ItTy To) {
+    assert(I >= begin() && I <= end() && "Insertion iterator out of bounds!");
+    size_t Index = I - begin(), OldSize = size();
+    append(From, To);
+    std::rotate(begin() + Index, begin() + OldSize, end());
+    return begin() + Index;
+  }
+
+  iterator insert(iterator I, std::initializer_list<T> IL) {
+    return insert(I, IL.begin(), IL.end());
+  }
+
+  iterator erase(const_iterator CI) {
+    iterator I = const_cast<iterator>(CI);
+    assert(I >= begin() && I < end() && "Erasing out of bounds!");
+    std::move(I + 1, end(), I);
+    pop_back();
+    return I;
+  }
+
+  iterator erase(const_iterator CS, const_iterator CE) {
+    iterator S = const_cast<iterator>(CS);
+    iterator E = const_cast<iterator>(CE);
+    assert(S >= begin() && S <= E && E <= end() && "Erasing out of bounds!");
+    // Moving the tail onto itself would leave it in a moved-from state.
+    if (S == E)
+      return S;
+    iterator NewEnd = std::move(E, end(), S);
+    destroyRange(NewEnd, end());
+    Size = unsigned(NewEnd - begin());
+    return S;
+  }
+
+  void swap(SmallVectorImpl &RHS) {
+    if (this == &RHS)
+      return;
+
+    // Two heap buffers are swapped without touching the elements.
+    if (!isSmall() && !RHS.isSmall()) {
+      std::swap(BeginX, RHS.BeginX);
+      std::swap(Size, RHS.Size);
+      std::swap(Capacity, RHS.Capacity);
+      return;
+    }
+
+    reserve(RHS.size());
+    RHS.reserve(size());
+
+    size_t NumShared = std::min(size(), RHS.size());
+    for (size_t i = 0; i != NumShared; ++i)
+      std::swap((*this)[i], RHS[i]);
+
+    SmallVectorImpl &Longer = size() > RHS.size() ? *this : RHS;
+    SmallVectorImpl &Shorter = size() > RHS.size() ? RHS : *this;
+    Shorter.append(std::make_move_iterator(Longer.begin() + NumShared),
+                   std::make_move_iterator(Longer.end()));
+    Longer.truncate(NumShared);
+  }
+
+  SmallVectorImpl &operator=(const SmallVectorImpl &RHS) {
+    if (this != &RHS)
+      assign(RHS.begin(), RHS.end());
+    return *this;
+  }
+
+  SmallVectorImpl &operator=(SmallVectorImpl &&RHS) {
+    if (this == &RHS)
+      return *this;
+
+    // A heap buffer is taken over, inline elements have to be moved.
+    if (!RHS.isSmall()) {
+      destroyRange(begin(), end());
+      if (!isSmall())
+        ::operator delete(BeginX);
+      BeginX = RHS.BeginX;
+      Size = RHS.Size;
+      Capacity = RHS.Capacity;
+      RHS.resetToSmall();
+      return *this;
+    }
+
+    clear();
+    reserve(RHS.size());
+    std::uninitialized_move(RHS.begin(), RHS.end(), begin());
+    Size = RHS.Size;
+    RHS.clear();
+    return *this;
+  }
+
+  bool operator==(const SmallVectorImpl &RHS) const {
+    return size() == RHS.size() && std::equal(begin(), end(), RHS.begin());
+  }
+  bool operator!=(const SmallVectorImpl &RHS) const { return !(*this == RHS); }
+
+  bool operator<(const SmallVectorImpl &RHS) const {
+    return std::lexicographical_compare(begin(), end(), RHS.begin(),
+                                        RHS.end());
+  }
+};
+
+/// SmallVectorStorage - The inline buffer of a SmallVector, placed right
+/// after its SmallVectorImpl.
+template <typename T, unsigned N> struct SmallVectorStorage {
+  alignas(T) char InlineElts[N * sizeof(T)];
+};
+
+/// SmallVector - A vector holding up to N elements without allocating.
+///
+/// Most IR lists are short: a function has a few parameters, an instruction
+/// two or three operands, a block one or two successors. Keeping those in
+/// the object saves an allocation and a pointer chase per list. Past N
+/// elements the vector moves to the heap and behaves like std::vector.
+/// APIs should take the elements as a SmallVectorImpl<T> &.
+template <typename T, unsigned N>
+class SmallVector : public SmallVectorImpl<T>, SmallVectorStorage<T, N> {
+  static_assert(N > 0, "SmallVector needs room for an inline element!");
+
+public:
+  SmallVector() : SmallVectorImpl<T>(N) {}
+
+  explicit SmallVector(size_t NumElts, const T &Value = T())
+      : SmallVectorImpl<T>(N) {
+    this->assign(NumElts, Value);
+  }
+
+  template <typename ItTy,
+            typename = typename std::enable_if<std::is_convertible<
+                typename std::iterator_traits<ItTy>::iterator_category,
+                std::input_iterator_tag>::value>::type>
+  SmallVector(ItTy S, ItTy E) : SmallVectorImpl<T>(N) {
+    this->append(S, E);
+  }
+
+  SmallVector(std::initializer_list<T> IL) : SmallVectorImpl<T>(N) {
+    this->append(IL);
+  }
+
+  SmallVector(const SmallVector &RHS) : SmallVectorImpl<T>(N) {
+    if (!RHS.empty())
+      SmallVectorImpl<T>::operator=(RHS);
+  }
+
+  SmallVector(SmallVector &&RHS) : SmallVectorImpl<T>(N) {
+    if (!RHS.empty())
+      SmallVectorImpl<T>::operator=(std::move(RHS));
+  }
+
+  SmallVector(SmallVectorImpl<T> &&RHS) : SmallVectorImpl<T>(N) {
+    if (!RHS.empty())
+      SmallVectorImpl<T>::operator=(std::move(RHS));
+  }
+
+  SmallVector &operator=(const SmallVector &RHS) {
+    SmallVectorImpl<T>::operator=(RHS);
+    return *this;
+  }
+
+  SmallVector &operator=(SmallVector &&RHS) {
+    SmallVectorImpl<T>::operator=(std::move(RHS));
+    return *this;
+  }
+
+  SmallVector &operator=(SmallVectorImpl<T> &&RHS) {
+    SmallVectorImpl<T>::operator=(std::move(RHS));
+    return *this;
+  }
+
+  SmallVector &operator=(std::initializer_list<T> IL) {
+    this->assign(IL);
+    return *this;
+  }
+};
+
+} // end namespace kaiju
+
+#endif // KAIJU_ADT_SMALLVECTOR_H
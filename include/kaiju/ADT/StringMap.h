@@ -0,0 +1,372 @@
+
+#ifndef KAIJU_ADT_STRINGMAP_H
+#define KAIJU_ADT_STRINGMAP_H
+
+#include "kaiju/ADT/Hashing.h"
+#include "kaiju/ADT/StringRef.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace kaiju {
+
+/// StringMapEntry - An entry of a StringMap: the value followed by its own
+/// copy of the key, in one allocation.
+template <typename ValueTy> class StringMapEntry {
+  size_t KeyLength;
+
+public:
+  ValueTy second;
+
+private:
+  template <typename... Ts>
+  StringMapEntry(size_t Length, Ts &&... Args)
+      : KeyLength(Length), second(std::forward<Ts>(Args)...) {}
+
+  /// Returns the characters of the key, stored right after the entry.
+  char *getKeyStorage() { return reinterpret_cast<char *>(this + 1); }
+
+public:
+  StringMapEntry(const StringMapEntry &) = delete;
+  StringMapEntry &operator=(const StringMapEntry &) = delete;
+
+  StringRef getKey() const {
+    return StringRef(reinterpret_cast<const char *>(this + 1), KeyLength);
+  }
+
+  /// The key, as the first half of the pair an entry behaves like.
+  StringRef first() const { return getKey(); }
+
+  const ValueTy &getValue() const { return second; }
+  ValueTy &getValue() { return second; }
+
+  /// Allocates an entry holding a copy of \p Key and a value built from
+  /// \p Args. The key is null terminated.
+  template <typename... Ts>
+  static StringMapEntry *create(StringRef Key, Ts &&... Args) {
+    void *Memory = ::operator new(sizeof(StringMapEntry) + Key.size() + 1);
+
+    StringMapEntry *E =
+        ::new (Memory) StringMapEntry(Key.size(), std::forward<Ts>(Args)...);
+    char *Storage = E->getKeyStorage();
+    if (!Key.empty())
+      std::memcpy(Storage, Key.data(), Key.size());
+    Storage[Key.size()] = '\0';
+    return E;
+  }
+
+  /// Destroys and frees this entry.
+  void destroy() {
+    this->~StringMapEntry();
+    ::operator delete(static_cast<void *>(this));
+  }
+};
+
+template <typename ValueTy, bool IsConst> class StringMapIterator;
+
+/// StringMap - An open addressing hash table from strings to values, which
+/// owns copies of its keys.
+///
+/// Each bucket holds a pointer to its entry next to the full hash of the
+/// key, so probing compares hashes in the table and only follows the
+/// pointer of a likely match. An entry keeps its key inline after the
+/// value, in a single allocation which never moves, so references to
+/// entries stay valid until they are erased. The number of buckets is a
+/// power of two; the table doubles once it is three quarters full, and
+/// erased buckets are left as tombstones which are dropped when the table
+/// is rebuilt. The order of iteration is unspecified.
+template <typename ValueTy> class StringMap {
+public:
+  using MapEntryTy = StringMapEntry<ValueTy>;
+  using iterator = StringMapIterator<ValueTy, false>;
+  using const_iterator = StringMapIterator<ValueTy, true>;
+
+private:
+  friend class StringMapIterator<ValueTy, false>;
+  friend class StringMapIterator<ValueTy, true>;
+
+  struct Bucket {
+    MapEntryTy *Entry;
+    uint64_t FullHash;
+  };
+
+  Bucket *Buckets = nullptr;
+  unsigned NumEntries = 0;
+  unsigned NumTombstones = 0;
+  unsigned NumBuckets = 0;
+
+  /// The fewest buckets a table is allocated with.
+  static constexpr unsigned MinBuckets = 16;
+
+  /// Marks a bucket whose entry was erased.
+  static MapEntryTy *getTombstone() {
+    return reinterpret_cast<MapEntryTy *>(~uintptr_t(0) << 3);
+  }
+
+  static bool isLive(const Bucket &B) {
+    return B.Entry && B.Entry != getTombstone();
+  }
+
+  /// Looks for \p Key with hash \p FullHash. Returns its bucket if it is
+  /// present, otherwise the bucket to insert it into, preferring the first
+  /// tombstone passed on the way. There must be at least one bucket.
+  Bucket *lookupBucketFor(StringRef Key, uint64_t FullHash) const {
+    assert(NumBuckets && "Looking up in a map without buckets!");
+    Bucket *FoundTombstone = nullptr;
+    unsigned Mask = NumBuckets - 1;
+    unsigned Index = unsigned(FullHash) & Mask;
+
+    // Triangular probing visits every bucket of a power of two table.
+    for (unsigned Probe = 1;; ++Probe) {
+      Bucket *B = Buckets + Index;
+      if (!B->Entry)
+        return FoundTombstone ? FoundTombstone : B;
+
+      if (B->Entry == getTombstone()) {
+        if (!FoundTombstone)
+          FoundTombstone = B;
+      } else if (B->FullHash == FullHash && B->Entry->getKey() == Key) {
+        return B;
+      }
+
+      Index = (Index + Probe) & Mask;
+    }
+  }
+
+  /// Returns the bucket of \p Key, or null if it is not in the map.
+  Bucket *findBucket(StringRef Key) const {
+    if (!NumEntries)
+      return nullptr;
+    Bucket *B = lookupBucketFor(Key, hash_value(Key));
+    return isLive(*B) ? B : nullptr;
+  }
+
+  /// Rebuilds the table with at least \p AtLeast buckets, dropping the
+  /// tombstones. Entries are not moved, only the pointers to them.
+  void grow(unsigned AtLeast) {
+    Bucket *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+
+    unsigned Num = MinBuckets;
+    while (Num < AtLeast)
+      Num *= 2;
+
+    Buckets = new Bucket[Num]();
+    NumBuckets = Num;
+    NumTombstones = 0;
+
+    for (unsigned i = 0; i != OldNumBuckets; ++i) {
+      const Bucket &Old = OldBuckets[i];
+      if (isLive(Old))
+        *lookupBucketFor(Old.Entry->getKey(), Old.FullHash) = Old;
+    }
+    delete[] OldBuckets;
+  }
+
+  iterator makeIterator(Bucket *B) {
+    return iterator(B, Buckets + NumBuckets);
+  }
+
+  const_iterator makeConstIterator(const Bucket *B) const {
+    return const_iterator(B, Buckets + NumBuckets);
+  }
+
+public:
+  StringMap() = default;
+
+  /// Creates a map with room for \p InitialReserve entries before it grows.
+  explicit StringMap(unsigned InitialReserve) {
+    if (InitialReserve)
+      grow(InitialReserve * 4 / 3 + 1);
+  }
+
+  StringMap(const StringMap &Other) {
+    if (Other.NumEntries)
+      grow(Other.NumEntries * 4 / 3 + 1);
+    for (const MapEntryTy &E : Other)
+      try_emplace(E.getKey(), E.getValue());
+  }
+
+  StringMap(StringMap &&Other) { swap(Other); }
+
+  ~StringMap() {
+    clear();
+    delete[] Buckets;
+  }
+
+  StringMap &operator=(StringMap Other) {
+    swap(Other);
+    return *this;
+  }
+
+  void swap(StringMap &Other) {
+    std::swap(Buckets, Other.Buckets);
+    std::swap(NumEntries, Other.NumEntries);
+    std::swap(NumTombstones, Other.NumTombstones);
+    std::swap(NumBuckets, Other.NumBuckets);
+  }
+
+  iterator begin() { return makeIterator(Buckets); }
+  iterator end() { return makeIterator(Buckets + NumBuckets); }
+  const_iterator begin() const { return makeConstIterator(Buckets); }
+  const_iterator end() const { return makeConstIterator(Buckets + NumBuckets); }
+
+  bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Erases every entry, keeping the table.
+  void clear() {
+    for (unsigned i = 0; i != NumBuckets; ++i) {
+      if (isLive(Buckets[i]))
+        Buckets[i].Entry->destroy();
+      Buckets[i].Entry = nullptr;
+    }
+    NumEntries = NumTombstones = 0;
+  }
+
+  /// Returns 1 if \p Key is in the map, 0 otherwise.
+  unsigned count(StringRef Key) const { return findBucket(Key) ? 1 : 0; }
+
+  iterator find(StringRef Key) {
+    Bucket *B = findBucket(Key);
+    return B ? makeIterator(B) : end();
+  }
+
+  const_iterator find(StringRef Key) const {
+    Bucket *B = findBucket(Key);
+    return B ? makeConstIterator(B) : end();
+  }
+
+  /// Returns the value of \p Key, or a default constructed value if it is
+  /// not in the map.
+  ValueTy lookup(StringRef Key) const {
+    Bucket *B = findBucket(Key);
+    return B ? B->Entry->getValue() : ValueTy();
+  }
+
+  /// Inserts \p Key with a value built from \p Args if it is not in the map
+  /// yet. Returns the entry of \p Key and whether it was inserted.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(StringRef Key, Ts &&... Args) {
+    uint64_t FullHash = hash_value(Key);
+    if (!NumBuckets)
+      grow(MinBuckets);
+
+    Bucket *B = lookupBucketFor(Key, FullHash);
+    if (isLive(*B))
+      return std::make_pair(makeIterator(B), false);
+
+    // Grow at three quarters full. Rebuild at the same size when fewer than
+    // an eighth of the buckets are empty, so lookups of missing keys end.
+    unsigned NewNumEntries = NumEntries + 1;
+    if (NewNumEntries * 4 >= NumBuckets * 3) {
+      grow(NumBuckets * 2);
+      B = lookupBucketFor(Key, FullHash);
+    } else if (NumBuckets - (NewNumEntries + NumTombstones) <=
+               NumBuckets / 8) {
+      grow(NumBuckets);
+      B = lookupBucketFor(Key, FullHash);
+    }
+
+    if (B->Entry == getTombstone())
+      --NumTombstones;
+    B->Entry = MapEntryTy::create(Key, std::forward<Ts>(Args)...);
+    B->FullHash = FullHash;
+    ++NumEntries;
+    return std::make_pair(makeIterator(B), true);
+  }
+
+  std::pair<iterator, bool> insert(std::pair<StringRef, ValueTy> KV) {
+    return try_emplace(KV.first, std::move(KV.second));
+  }
+
+  /// Returns the value of \p Key, inserting a default constructed one if
+  /// it is not in the map.
+  ValueTy &operator[](StringRef Key) {
+    return try_emplace(Key).first->getValue();
+  }
+
+  /// Erases \p Key, returning whether it was in the map.
+  bool erase(StringRef Key) {
+    Bucket *B = findBucket(Key);
+    if (!B)
+      return false;
+
+    B->Entry->destroy();
+    B->Entry = getTombstone();
+    --NumEntries;
+    ++NumTombstones;
+    return true;
+  }
+
+  void erase(iterator I) { erase(I->getKey()); }
+};
+
+/// StringMapIterator - Walks the entries of a StringMap.
+template <typename ValueTy, bool IsConst> class StringMapIterator {
+  friend class StringMapIterator<ValueTy, true>;
+
+  using MapEntryTy = StringMapEntry<ValueTy>;
+  using BucketT = typename StringMap<ValueTy>::Bucket;
+
+public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = typename std::conditional<IsConst, const MapEntryTy,
+                                               MapEntryTy>::type;
+  using pointer = value_type *;
+  using reference = value_type &;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  const BucketT *Ptr = nullptr;
+  const BucketT *End = nullptr;
+
+  void advancePastEmptyBuckets() {
+    while (Ptr != End && !StringMap<ValueTy>::isLive(*Ptr))
+      ++Ptr;
+  }
+
+public:
+  StringMapIterator() = default;
+
+  StringMapIterator(const BucketT *Pos, const BucketT *E) : Ptr(Pos), End(E) {
+    advancePastEmptyBuckets();
+  }
+
+  /// Converts an iterator to a const_iterator.
+  template <bool WasConst,
+            typename = typename std::enable_if<IsConst && !WasConst>::type>
+  StringMapIterator(const StringMapIterator<ValueTy, WasConst> &I)
+      : Ptr(I.Ptr), End(I.End) {}
+
+  reference operator*() const { return *Ptr->Entry; }
+  pointer operator->() const { return Ptr->Entry; }
+
+  bool operator==(const StringMapIterator &RHS) const {
+    return Ptr == RHS.Ptr;
+  }
+  bool operator!=(const StringMapIterator &RHS) const {
+    return Ptr != RHS.Ptr;
+  }
+
+  StringMapIterator &operator++() {
+    ++Ptr;
+    advancePastEmptyBuckets();
+    return *this;
+  }
+
+  StringMapIterator operator++(int) {
+    StringMapIterator Tmp = *this;
+    ++*this;
+    return Tmp;
+  }
+};
+
+} // end namespace kaiju
+
+#endif // KAIJU_ADT_STRINGMAP_H
@@ -0,0 +1,40 @@
+
+#ifndef KAIJU_CODEGEN_CBACKEND_H
+#define KAIJU_CODEGEN_CBACKEND_H
+
+#include <vector>
+
+#include "kaiju/IO/raw_ostream.h"
+#include "kaiju/IR/Function.h"
+#include "kaiju/IR/TranslationUnit.h"
+
+namespace kaiju {
+
+// \brief Writes \p Fns to \p OS as a C99 source file, to be compiled ahead
+// of time by the system C compiler, e.g. with cc -O2 -shared -fPIC ... -lm,
+// and loaded with dlopen.
+//
+// Every function becomes an external C function. In its name letters and
+// digits are kept, underscores doubled and every other byte written as an
+// underscore and two upper case hex digits, so f.x becomes f_2Ex and f_x
+// becomes f__x. Names which then are empty, start with a digit, an
+// underscore, kaiju_ or KAIJU_, or are a C keyword, main or a name from
+// <math.h> or <stdlib.h>, get the prefix kaiju_fn_, so int becomes
+// kaiju_fn_int. Different names never share an identifier.
+//
+// Integer arguments and results have the <stdint.h> type of the next power
+// of two of at least 8 bits, unsigned __int128 above 64 bits; f16 and f32
+// values are float and computed in single precision as by the Interpreter,
+// f64 values double, pointers void *. Integer arithmetic goes through
+// helpers that wrap around at the integer's width and never rely on
+// behavior C leaves undefined; operations the Interpreter traps on call
+// KAIJU_TRAP(), abort() unless the including build defines it. The output
+// needs a compiler supporting unsigned __int128, such as GCC or Clang.
+void emitC(const std::vector<const Function *> &Fns, raw_ostream &OS);
+
+// \brief Writes the functions of \p TU to \p OS, see above.
+void emitC(const TranslationUnit &TU, raw_ostream &OS);
+
+} // namespace kaiju
+
+#endif // KAIJU_CODEGEN_CBACKEND_H
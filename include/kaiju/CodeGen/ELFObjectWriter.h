@@ -0,0 +1,31 @@
+
+#ifndef KAIJU_CODEGEN_ELFOBJECTWRITER_H
+#define KAIJU_CODEGEN_ELFOBJECTWRITER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "kaiju/IR/Function.h"
+#include "kaiju/IR/TranslationUnit.h"
+
+namespace kaiju {
+
+// \brief Compiles \p Fns with the x86-64 code generator and writes them to
+// \p Buffer as an ELF64 relocatable object, ready for the system linker.
+//
+// The code of every function goes to .text under a global function symbol
+// of its name, and the constant pools to .rodata, addressed through
+// R_X86_64_PC32 relocations against the section. Sizes are computed before
+// anything is written, so the object is built in a single allocation of
+// \p Buffer, without going through assembly text. Returns false, with
+// \p Buffer left empty, if the code generator does not support one of the
+// functions, see compileToX86().
+bool writeELFObject(const std::vector<Function *> &Fns,
+                    std::vector<uint8_t> &Buffer);
+
+// \brief Writes the functions of \p TU, in the order of its symbol table.
+bool writeELFObject(const TranslationUnit &TU, std::vector<uint8_t> &Buffer);
+
+} // namespace kaiju
+
+#endif // KAIJU_CODEGEN_ELFOBJECTWRITER_H
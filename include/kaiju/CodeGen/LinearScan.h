@@ -0,0 +1,123 @@
+
+#ifndef KAIJU_CODEGEN_LINEARSCAN_H
+#define KAIJU_CODEGEN_LINEARSCAN_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "kaiju/ADT/iterator_range.h"
+
+namespace kaiju {
+
+// Class LinearScan
+//
+// \brief Assigns registers and spill slots to live intervals over a linear
+// numbering of program positions.
+//
+// Every interval is a single range of positions in one register class,
+// along with the positions it is used at. Intervals are visited in order of
+// their start, as in the linear scan of Wimmer and Moessenboeck; when every
+// register of the class is taken, either the current interval or the
+// active one whose next use is furthest away goes to memory up to its next
+// use, where the rest is split off and visited again. Splits only happen at
+// the positions the client declares, where it moves values between the
+// locations of consecutive parts; locations across control flow edges are
+// for the client to reconcile. Spilled intervals whose ranges do not
+// overlap share slots. An interval may name another one whose register it
+// takes when that one ends just as it starts, such as the left operand of a
+// two address instruction, saving a copy.
+//
+// Pending intervals are kept in a heap and the number of registers is
+// bounded, so allocation takes O(n log n) for n intervals and uses.
+//
+class LinearScan {
+public:
+    // \brief Where an interval lives from position \p Start up to the start
+    // of its next part.
+    struct Part {
+        unsigned Start;
+        bool InReg;
+        uint8_t Reg;
+        unsigned Slot;
+    };
+
+private:
+    struct Interval {
+        unsigned Class;
+        unsigned Start;
+        unsigned End;
+        unsigned UseBegin;
+        unsigned UseEnd;
+        unsigned Hint;
+    };
+
+    // \brief A part of an interval under allocation.
+    struct Piece {
+        unsigned Interval;
+        unsigned Start;
+        unsigned End;
+        bool InReg;
+        uint8_t Reg;
+    };
+
+    std::vector<std::vector<uint8_t>> Registers;
+    std::vector<Interval> Intervals;
+    std::vector<unsigned> Uses;
+    std::vector<unsigned> SplitPositions;
+
+    std::vector<Piece> Pieces;
+    std::vector<Part> Parts;
+    std::vector<unsigned> PartBegins;
+    unsigned NumSlots;
+
+    // \brief Returns the first use of piece \p P at or after \p Pos, ~0u if
+    // there is none.
+    unsigned getNextUse(const Piece &P, unsigned Pos) const;
+
+    void collectParts();
+    void assignSlots();
+
+public:
+    // ctor. \p Regs lists the registers of every register class in order
+    // of preference.
+    explicit LinearScan(const std::vector<std::vector<uint8_t>> &Regs)
+        : Registers(Regs), NumSlots(0) { /* empty */ }
+
+    // \brief Adds an interval of class \p Class from \p Start to \p End
+    // inclusive, used at the increasing positions in [\p UseBegin,
+    // \p UseEnd), all of which must be split positions, preferring the
+    // register of interval \p Hint, if any. Returns its number, starting at
+    // zero.
+    unsigned addInterval(unsigned Class, unsigned Start, unsigned End,
+                         const unsigned *UseBegin, const unsigned *UseEnd,
+                         unsigned Hint = ~0u);
+
+    // \brief Declares that the client can insert moves at \p Pos. Positions
+    // are declared in increasing order.
+    void addSplitPosition(unsigned Pos) {
+        assert((SplitPositions.empty() || SplitPositions.back() < Pos)
+               && "split positions out of order.");
+        SplitPositions.push_back(Pos);
+    }
+
+    // \brief Allocates every interval.
+    void run();
+
+    // \brief Returns the parts of interval \p I in order of position. No two
+    // consecutive parts share a location.
+    iterator_range<const Part *> getParts(unsigned I) const {
+        return make_range(Parts.data() + PartBegins[I],
+                          Parts.data() + PartBegins[I + 1]);
+    }
+
+    // \brief Returns the part of interval \p I at \p Pos, the last one
+    // starting at or before it. \p Pos must not precede the interval.
+    const Part &getPart(unsigned I, unsigned Pos) const;
+
+    unsigned getNumSlots() const { return NumSlots; }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_CODEGEN_LINEARSCAN_H
@@ -0,0 +1,180 @@
+
+#ifndef KAIJU_CODEGEN_X86ASSEMBLER_H
+#define KAIJU_CODEGEN_X86ASSEMBLER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace kaiju {
+
+namespace X86 {
+
+// \brief General purpose registers, numbered as in the instruction encoding.
+enum GPR : uint8_t {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8,  R9,  R10, R11, R12, R13, R14, R15,
+};
+
+// \brief SSE registers, numbered as in the instruction encoding.
+enum XMM : uint8_t {
+    XMM0, XMM1, XMM2,  XMM3,  XMM4,  XMM5,  XMM6,  XMM7,
+    XMM8, XMM9, XMM10, XMM11, XMM12, XMM13, XMM14, XMM15,
+};
+
+// \brief Condition codes, as encoded in Jcc and SETcc.
+enum CondCode : uint8_t {
+    CC_B  = 0x2,    //< Unsigned less than.
+    CC_AE = 0x3,    //< Unsigned greater or equal.
+    CC_E  = 0x4,
+    CC_NE = 0x5,
+    CC_BE = 0x6,    //< Unsigned less or equal.
+    CC_A  = 0x7,    //< Unsigned greater than.
+    CC_L  = 0xC,    //< Signed less than.
+    CC_GE = 0xD,    //< Signed greater or equal.
+    CC_LE = 0xE,    //< Signed less or equal.
+    CC_G  = 0xF,    //< Signed greater than.
+};
+
+// \brief Two operand integer operations sharing the classic ALU encodings.
+enum ALUOp : uint8_t {
+    ALU_ADD = 0,
+    ALU_AND = 4,
+    ALU_SUB = 5,
+    ALU_XOR = 6,
+    ALU_CMP = 7,
+};
+
+// \brief Shift operations, the value is the ModRM reg field.
+enum ShiftOp : uint8_t {
+    SHIFT_SHL = 4,
+    SHIFT_SHR = 5,
+    SHIFT_SAR = 7,
+};
+
+// \brief Scalar SSE arithmetic, the value is the second opcode byte.
+enum SSEOp : uint8_t {
+    SSE_ADD = 0x58,
+    SSE_MUL = 0x59,
+    SSE_SUB = 0x5C,
+    SSE_DIV = 0x5E,
+};
+
+// \brief A register or a memory operand. Memory operands are either
+// [Register + Disp] or, for constants, [RIP + disp32] to be patched later.
+struct Operand {
+    enum KindTy : uint8_t { Reg, Memory, RIPRelative } Kind;
+    uint8_t Register;
+    int32_t Disp;
+
+    static Operand reg(uint8_t R)        { return Operand { Reg, R, 0 }; }
+    static Operand mem(GPR B, int32_t D) { return Operand { Memory, B, D }; }
+    static Operand frame(int32_t D)      { return mem(RBP, D); }
+    static Operand rip() { return Operand { RIPRelative, 0, 0 }; }
+
+    bool isReg() const { return Kind == Reg; }
+};
+
+} // namespace X86
+
+// Class X86Assembler
+//
+// \brief Encodes x86-64 instructions into a byte buffer. All integer
+// operations are 64 bits wide unless their name says otherwise.
+//
+// Instructions with a RIP relative operand end with its 32 bit displacement,
+// getLastDispOffset() returns where it was written so it can be patched
+// once the target is placed.
+//
+class X86Assembler {
+    std::vector<uint8_t> &Buffer;
+    std::size_t LastDisp;
+
+    void byte(uint8_t B) { Buffer.push_back(B); }
+    void imm32(int32_t V);
+    void imm64(uint64_t V);
+
+    // \brief Emits a REX prefix if needed, \p Force emits it even when no
+    // bits are set, which selects SPL to DIL for byte operations.
+    void rex(bool W, uint8_t Reg, const X86::Operand &RM, bool Force = false);
+
+    // \brief Emits the ModRM byte and displacement addressing \p RM.
+    void modrm(uint8_t Reg, const X86::Operand &RM);
+
+public:
+    explicit X86Assembler(std::vector<uint8_t> &B)
+         : Buffer(B), LastDisp(0) { /* empty */ }
+
+    std::size_t size() const { return Buffer.size(); }
+
+    // \brief Returns the offset of the displacement of the last instruction
+    // with a RIP relative operand.
+    std::size_t getLastDispOffset() const { return LastDisp; }
+
+    // \brief Writes \p V at \p Offset, used to resolve jumps.
+    void patch32(std::size_t Offset, int32_t V);
+
+    void push(X86::GPR R);
+    void pop(X86::GPR R);
+    void ret();
+    void ud2();
+
+    // mov Dst, Src.
+    void mov(X86::GPR Dst, const X86::Operand &Src);
+    void mov(const X86::Operand &Dst, X86::GPR Src);
+    void movImm(X86::GPR Dst, uint64_t V);
+    void movImm32(const X86::Operand &Dst, int32_t V);
+
+    // \brief Zero extends the low 32 bits of \p Src into \p Dst.
+    void mov32(X86::GPR Dst, X86::GPR Src);
+
+    void movzx8(X86::GPR Dst, X86::GPR Src);
+    void movzx16(X86::GPR Dst, X86::GPR Src);
+    void movsx8(X86::GPR Dst, X86::GPR Src);
+    void movsx16(X86::GPR Dst, X86::GPR Src);
+    void movsx32(X86::GPR Dst, X86::GPR Src);
+
+    // lea Dst, [RBP + Disp].
+    void leaFrame(X86::GPR Dst, int32_t Disp);
+
+    void alu(X86::ALUOp Op, X86::GPR Dst, const X86::Operand &Src);
+    void aluImm(X86::ALUOp Op, const X86::Operand &Dst, int32_t V);
+
+    void imul(X86::GPR Dst, const X86::Operand &Src);
+    void imulImm(X86::GPR Dst, const X86::Operand &Src, int32_t V);
+
+    // \brief RDX:RAX = RAX * Src, unsigned and signed.
+    void mul(const X86::Operand &Src);
+    void imul1(const X86::Operand &Src);
+
+    // \brief Divides RDX:RAX by Src, unsigned and signed.
+    void div(const X86::Operand &Src);
+    void idiv(const X86::Operand &Src);
+
+    // \brief Sign extends RAX into RDX.
+    void cqo();
+
+    void shiftCL(X86::ShiftOp Op, X86::GPR Dst);
+    void shiftImm(X86::ShiftOp Op, X86::GPR Dst, uint8_t Amount);
+
+    // \brief Dst = low 64 bits of (Src:Dst >> Amount).
+    void shrd(X86::GPR Dst, X86::GPR Src, uint8_t Amount);
+
+    void test(X86::GPR A, X86::GPR B);
+    void setcc(X86::CondCode CC, X86::GPR Dst);
+
+    // \brief Emits a jump or call with a zero displacement and returns the
+    // offset of the displacement, to be resolved with patch32().
+    std::size_t jcc(X86::CondCode CC);
+    std::size_t jmp();
+    std::size_t call();
+
+    // Scalar SSE, \p Double selects the sd over the ss forms.
+    void movsse(bool Double, X86::XMM Dst, const X86::Operand &Src);
+    void movsse(bool Double, const X86::Operand &Dst, X86::XMM Src);
+    void movaps(X86::XMM Dst, X86::XMM Src);
+    void sse(X86::SSEOp Op, bool Double, X86::XMM Dst, const X86::Operand &Src);
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_CODEGEN_X86ASSEMBLER_H
@@ -0,0 +1,57 @@
+
+#ifndef KAIJU_CODEGEN_X86CODEGEN_H
+#define KAIJU_CODEGEN_X86CODEGEN_H
+
+#include <cstdint>
+#include <vector>
+
+#include "kaiju/IR/Function.h"
+
+namespace kaiju {
+
+// \brief The x86-64 machine code of one function.
+//
+// The code is position independent except for RIP relative loads from the
+// function's constant pool, which the client places after laying out the
+// code, in the same mapping or a separate section.
+struct X86MachineCode {
+
+    // \brief A 32 bit RIP relative displacement at \p Offset in Text that
+    // must address entry \p Index of Constants. The displacement is the last
+    // field of its instruction.
+    struct ConstantRef {
+        uint32_t Offset;
+        uint32_t Index;
+    };
+
+    std::vector<uint8_t> Text;
+
+    // \brief Eight byte constant pool entries, single precision values use
+    // the low four bytes.
+    std::vector<uint64_t> Constants;
+
+    std::vector<ConstantRef> ConstantRefs;
+};
+
+// \brief Compiles \p Fn to x86-64 code following the System V calling
+// convention, with the values of its instructions assigned to registers by
+// linear scan.
+//
+// Integers of at most 64 bits, float and double values are supported, in up
+// to six integer and eight floating point arguments, along with integer and
+// floating point arithmetic, comparisons, branches, phi nodes and returns.
+// Operations without a defined result, such as division by zero, are not
+// checked. Returns false, with \p Code left unspecified, if \p Fn uses
+// anything else.
+bool compileToX86(Function &Fn, X86MachineCode &Code);
+
+// \brief Appends to \p Code, which must hold the code of \p Fn at offset
+// zero, an entry point of type void(const GenericValue *Args,
+// GenericValue *Result) that calls Fn with one value of \p Args per
+// argument and stores its result in \p Result. Returns the offset of the
+// entry point.
+uint32_t appendX86GenericEntry(const Function &Fn, X86MachineCode &Code);
+
+} // namespace kaiju
+
+#endif // KAIJU_CODEGEN_X86CODEGEN_H
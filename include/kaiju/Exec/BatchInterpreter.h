@@ -0,0 +1,114 @@
+
+#ifndef KAIJU_EXEC_BATCHINTERPRETER_H
+#define KAIJU_EXEC_BATCHINTERPRETER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "kaiju/Exec/Interpreter.h"
+
+namespace kaiju {
+
+// Class BatchInterpreter
+//
+// \brief Runs a Function over many argument tuples in one call, evaluating
+// every instruction for a whole column of rows before the next one.
+//
+// A function made of a single block of arithmetic and comparisons is
+// translated into steps over typed columns. Integers live in the narrowest
+// lane of 8, 16, 32, 64 or 128 bits that holds their width, f16 and f32
+// values in float lanes and f64 values in double lanes, and every step is a
+// tight loop over contiguous lanes the compiler turns into SIMD code. The
+// cost of dispatch is paid once per chunk of ChunkSize rows, small enough
+// for the columns to stay in cache, instead of once per row. Any other
+// function is run row by row in an Interpreter. The function must not be
+// changed while a BatchInterpreter for it exists.
+//
+class BatchInterpreter {
+public:
+    // \brief The number of rows every step processes at once.
+    static constexpr unsigned ChunkSize = 1024;
+
+    enum LaneTy : uint8_t {
+        I8,
+        I16,
+        I32,
+        I64,
+        I128,
+        F32,
+        F64,
+    };
+
+    // \brief A column operation. Dst, A and B are byte offsets of columns
+    // in the frame, Lane the lane type of A and B and Width their integer
+    // width. Comparisons write 8 bit lanes.
+    struct Step {
+        uint8_t Op;         // Instruction::BinaryOpTy or CmpInst::Predicate.
+        uint8_t Lane;
+        bool Compare;
+        uint16_t Width;
+        uint32_t Dst;
+        uint32_t A;
+        uint32_t B;
+    };
+
+    // \brief A column filled with the same value in every row.
+    struct ConstantColumn {
+        uint32_t Offset;
+        uint8_t Lane;
+        GenericValue Value;
+    };
+
+    // \brief The column of an argument or of the returned value.
+    struct Column {
+        uint32_t Offset;
+        uint8_t Lane;
+        uint16_t Width;
+    };
+
+private:
+    Interpreter Interp;
+    bool Vectorized;
+
+    std::vector<Step> Steps;
+    std::vector<ConstantColumn> Constants;
+    std::vector<Column> ArgColumns;
+    Column ResultColumn;
+    bool ReturnsValue;
+
+    // \brief Size of the frame holding every column, in bytes.
+    uint32_t FrameSize;
+
+    // \brief Translates \p Fn into steps. Returns false if it is not a
+    // single block of arithmetic and comparisons.
+    bool translate(const Function &Fn);
+
+    // \brief Runs the steps on a chunk of rows whose arguments are in place.
+    void execute(unsigned char *Frame, uint8_t *Fault) const;
+
+public:
+    // ctor, translates \p Fn.
+    explicit BatchInterpreter(const Function &Fn);
+
+    // \brief Returns the number of arguments the function takes.
+    unsigned getNumArgs() const { return Interp.getNumArgs(); }
+
+    // \brief Returns whether rows are evaluated a column at a time, rather
+    // than one by one in the Interpreter.
+    bool isVectorized() const { return Vectorized; }
+
+    // \brief Calls the function once per row of \p Args, which holds
+    // \p NumRows tuples of getNumArgs() values one after the other, storing
+    // the value returned for row i in \p Results[i], which may be null for
+    // functions returning nothing. If given,
+    // \p Completed[i] tells whether row i ran without trapping, see
+    // Interpreter::run(); the result of a row that trapped is unspecified.
+    // Returns whether every row completed.
+    bool run(const GenericValue *Args, std::size_t NumRows,
+             GenericValue *Results, bool *Completed = nullptr) const;
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_EXEC_BATCHINTERPRETER_H
@@ -0,0 +1,42 @@
+
+#ifndef KAIJU_EXEC_GENERICVALUE_H
+#define KAIJU_EXEC_GENERICVALUE_H
+
+#include "kaiju/Support/MathExtras.h"
+
+namespace kaiju {
+
+// Class GenericValue
+//
+// \brief Holds a single value of any first class type while executing IR.
+// Integers are kept zero-extended to 128 bits, f16 and f32 values are held
+// in FloatVal, f64 values in DoubleVal.
+//
+union GenericValue {
+    uint128_t IntVal;
+    double DoubleVal;
+    float FloatVal;
+    void *PointerVal;
+
+    static GenericValue getInt(uint128_t V) {
+        GenericValue GV;
+        GV.IntVal = V;
+        return GV;
+    }
+
+    static GenericValue getFloat(float V) {
+        GenericValue GV;
+        GV.FloatVal = V;
+        return GV;
+    }
+
+    static GenericValue getDouble(double V) {
+        GenericValue GV;
+        GV.DoubleVal = V;
+        return GV;
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_EXEC_GENERICVALUE_H
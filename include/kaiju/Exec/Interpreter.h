@@ -0,0 +1,107 @@
+
+#ifndef KAIJU_EXEC_INTERPRETER_H
+#define KAIJU_EXEC_INTERPRETER_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "kaiju/Exec/GenericValue.h"
+#include "kaiju/IR/Function.h"
+
+namespace kaiju {
+
+// Class Interpreter
+//
+// \brief Executes a Function by translating it once into a register based
+// bytecode and running that with threaded dispatch.
+//
+// Every constant, argument and SSA value owns a register in a flat frame, and
+// every bytecode instruction is a 16 byte record naming its registers, so
+// four instructions share a cache line and execution never touches the IR.
+// Integer operations are specialized for widths of at most 64 bits. Phi
+// nodes become register copies on their incoming edges. The function must
+// not be changed while an Interpreter for it exists.
+//
+class Interpreter {
+public:
+    enum Opcode : uint16_t {
+#define OPCODE(Name) Name,
+#include "kaiju/Exec/Opcodes.def"
+    };
+
+    // \brief A bytecode instruction, see Opcodes.def for the meaning of the
+    // fields of every opcode.
+    struct Inst {
+        uint16_t Op;
+        uint16_t Width;
+        uint32_t Dst;
+        uint32_t A;
+        uint32_t B;
+    };
+
+private:
+    std::vector<Inst> Code;
+
+    // \brief Initial contents of the constant registers, which come first in
+    // the frame.
+    std::vector<GenericValue> Constants;
+
+    // \brief Width of every integer argument, arguments are truncated to it
+    // on entry. Zero for other types.
+    std::vector<unsigned> ArgWidths;
+
+    // \brief The register of the first argument.
+    unsigned FirstArg;
+
+    // \brief Registers holding values, followed by NumSlots registers of
+    // stack slot storage.
+    unsigned NumRegisters;
+    unsigned NumSlots;
+
+    // \brief Profile counters, see getNumCalls().
+    mutable std::atomic<uint64_t> NumCalls;
+    mutable std::atomic<uint64_t> NumBackEdges;
+
+    // \brief Runs the bytecode on the initialized frame \p R.
+    bool execute(GenericValue *R, GenericValue &Result) const;
+
+public:
+    // ctor, translates \p Fn.
+    explicit Interpreter(const Function &Fn);
+
+    // \brief Returns the number of arguments the function takes.
+    unsigned getNumArgs() const { return ArgWidths.size(); }
+
+    // \brief Returns how many times the function was run, and how many back
+    // edges, jumps to an earlier point in the bytecode, it took. The counters
+    // are bumped without atomic read-modify-write operations to keep them
+    // cheap, so concurrent runs may lose counts.
+    uint64_t getNumCalls() const {
+        return NumCalls.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getNumBackEdges() const {
+        return NumBackEdges.load(std::memory_order_relaxed);
+    }
+
+    // \brief Returns the translated bytecode.
+    const std::vector<Inst> &getCode() const { return Code; }
+
+    // \brief Calls the function with \p Args, which must hold getNumArgs()
+    // values. On return \p Result holds the returned value, if any. Returns
+    // false if execution trapped on division by zero, signed division
+    // overflow, an out of range shift or reaching the end of a block without
+    // a terminator.
+    bool run(const GenericValue *Args, GenericValue &Result) const;
+
+    bool run(const std::vector<GenericValue> &Args,
+             GenericValue &Result) const {
+        assert(Args.size() == getNumArgs() && "wrong number of arguments.");
+        return run(Args.data(), Result);
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_EXEC_INTERPRETER_H
@@ -0,0 +1,65 @@
+
+#ifndef KAIJU_EXEC_JIT_H
+#define KAIJU_EXEC_JIT_H
+
+#include <cstddef>
+
+#include "kaiju/Exec/GenericValue.h"
+#include "kaiju/IR/Function.h"
+
+namespace kaiju {
+
+// Class JITFunction
+//
+// \brief Native code for a Function, compiled by the x86-64 code generator
+// into memory of its own.
+//
+// The code and its constant pool are written to pages mapped read-write,
+// which are then made read-execute, so the memory is never writable and
+// executable at once. The code follows the System V calling convention and
+// does not refer to the IR, which may change or go away once compiled.
+//
+class JITFunction {
+    using GenericEntryTy = void(const GenericValue *, GenericValue *);
+
+    void *Memory;
+    std::size_t Size;
+    GenericEntryTy *GenericEntry;
+
+    // ctor.
+    JITFunction(void *M, std::size_t S, GenericEntryTy *G)
+         : Memory(M), Size(S), GenericEntry(G) { /* empty */ }
+
+    JITFunction(const JITFunction &) = delete;
+    JITFunction &operator=(const JITFunction &) = delete;
+
+public:
+    ~JITFunction();
+
+    // \brief Compiles \p Fn to native code. Returns null if the host is not
+    // x86-64 or the code generator does not support \p Fn, in which case
+    // the Interpreter is the way to run it.
+    static JITFunction *compile(Function &Fn);
+
+    // \brief Returns the address of the function's entry point.
+    void *getAddress() const { return Memory; }
+
+    // \brief Returns the entry point as a pointer to a function of type
+    // \p FnTy, which must match the IR signature, e.g. int64_t(int64_t).
+    // Integers of fewer than 64 bits are returned zero extended.
+    template <typename FnTy>
+    FnTy *getFunction() const {
+        return reinterpret_cast<FnTy *>(Memory);
+    }
+
+    // \brief Calls the function with \p Args, which must hold one value per
+    // argument, storing the returned value, if any, in \p Result. This is
+    // the way to call it when its signature is only known at run time.
+    void call(const GenericValue *Args, GenericValue &Result) const {
+        GenericEntry(Args, &Result);
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_EXEC_JIT_H
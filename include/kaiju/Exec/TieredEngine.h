@@ -0,0 +1,125 @@
+
+#ifndef KAIJU_EXEC_TIEREDENGINE_H
+#define KAIJU_EXEC_TIEREDENGINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "kaiju/Exec/Interpreter.h"
+#include "kaiju/Exec/JIT.h"
+
+namespace kaiju {
+
+class TieredEngine;
+
+// Class TieredFunction
+//
+// \brief A Function that runs in the Interpreter until its profile counters
+// show it is hot, then as native code.
+//
+// Once the Interpreter's call or back edge count crosses the engine's
+// threshold the function is queued for compilation on the engine's
+// background thread, and later calls find the native entry point and use it
+// instead. Native code does not check for traps, so functions which may trap
+// stay interpreted, as do those the code generator does not support. run()
+// thus returns the same result before and after the function is compiled.
+//
+class TieredFunction {
+    TieredEngine &Engine;
+    Function &Fn;
+    Interpreter Interp;
+
+    // \brief The native code, published once compiled.
+    std::atomic<JITFunction *> Native;
+
+    // \brief Set once the function has been queued for compilation.
+    std::atomic<bool> Queued;
+
+    friend class TieredEngine;
+
+    // ctor.
+    TieredFunction(TieredEngine &E, Function &F)
+         : Engine(E), Fn(F), Interp(F), Native(nullptr), Queued(false) {
+        /* empty */
+    }
+
+public:
+    ~TieredFunction() { delete Native.load(); }
+
+    // \brief Returns whether calls run native code.
+    bool isNative() const {
+        return Native.load(std::memory_order_acquire) != nullptr;
+    }
+
+    // \brief Returns the Interpreter, which holds the profile counters.
+    const Interpreter &getInterpreter() const { return Interp; }
+
+    // \brief Calls the function with \p Args, see Interpreter::run().
+    bool run(const GenericValue *Args, GenericValue &Result);
+
+    bool run(const std::vector<GenericValue> &Args, GenericValue &Result) {
+        assert(Args.size() == Interp.getNumArgs()
+            && "wrong number of arguments.");
+        return run(Args.data(), Result);
+    }
+};
+
+// Class TieredEngine
+//
+// \brief Runs functions in tiers, interpreting them until they are hot and
+// compiling only those in the background.
+//
+// Cold functions are never compiled, which keeps startup cheap, while hot
+// ones reach native speed. The compile thread is started the first time a
+// function gets hot. The functions must not be changed while the engine
+// runs them.
+//
+class TieredEngine {
+    uint64_t CallThreshold;
+    uint64_t BackEdgeThreshold;
+
+    std::map<const Function *, std::unique_ptr<TieredFunction>> Functions;
+
+    // \brief Guards Functions and the compile queue.
+    std::mutex Lock;
+    std::condition_variable Wakeup;
+    std::condition_variable Idle;
+    std::deque<TieredFunction *> Queue;
+    unsigned NumPending;
+    bool Stopping;
+    std::thread Worker;
+
+    friend class TieredFunction;
+
+    // \brief Queues \p TF for compilation.
+    void enqueue(TieredFunction *TF);
+
+    // \brief The body of the compile thread.
+    void compileLoop();
+
+public:
+    // ctor, a function is compiled once it was called \p Calls times or took
+    // \p BackEdges back edges.
+    explicit TieredEngine(uint64_t Calls = 1000, uint64_t BackEdges = 100000)
+         : CallThreshold(Calls), BackEdgeThreshold(BackEdges),
+           NumPending(0), Stopping(false) { /* empty */ }
+
+    // \brief Stops the compile thread, dropping queued functions.
+    ~TieredEngine();
+
+    // \brief Returns the tiered version of \p Fn, created on first use.
+    TieredFunction *getFunction(Function &Fn);
+
+    // \brief Waits until every queued function has been compiled.
+    void waitForCompiles();
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_EXEC_TIEREDENGINE_H
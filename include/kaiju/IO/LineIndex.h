@@ -0,0 +1,63 @@
+
+#ifndef KAIJU_IO_LINEINDEX_H
+#define KAIJU_IO_LINEINDEX_H
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "kaiju/ADT/StringRef.h"
+#include "kaiju/IO/MemoryBuffer.h"
+
+namespace kaiju {
+
+// Class LineIndex
+//
+// \brief Maps locations within a MemoryBuffer to their lines and columns.
+//
+// The starts of lines are recorded while the buffer is scanned, and the
+// buffer is only scanned as far as the furthest location asked about, so
+// any number of lookups cost one scan in total. Lookups near the line used
+// last are answered without searching, the others with a binary search.
+// Line breaks are counted like MemoryBuffer::getPositionalData() does.
+//
+class LineIndex {
+    const char *Begin,      //< The beginning
+               *End;        //< and end of the indexed buffer.
+
+    // \brief The start of every line found so far, in order.
+    std::vector<const char *> LineStarts;
+
+    // \brief How far the buffer has been scanned for line breaks.
+    const char *Scanned;
+
+    // \brief The index into LineStarts of the line used last.
+    std::size_t LastLine;
+
+    // \brief Scans for line breaks up to and including \p Loc.
+    void scanTo(const char *Loc);
+
+    // \brief Returns the index into LineStarts of the line of \p Loc.
+    std::size_t findLine(const char *Loc);
+
+public:
+    // ctor. Nothing is scanned until the first lookup.
+    explicit LineIndex(const MemoryBuffer &Buffer);
+
+    // \brief Returns whether \p Buffer is the buffer this index is for.
+    bool indexes(const MemoryBuffer &Buffer) const {
+        return Buffer.begin() == Begin && Buffer.end() == End;
+    }
+
+    // \brief Returns the line and column of \p Loc, both counted from 1.
+    std::pair<std::size_t, std::size_t> getLineAndColumn(const char *Loc);
+
+    // \brief Returns the line \p Loc is on, without its line break. A null
+    // ends the line too, as it ends lexing.
+    StringRef getLineFromLoc(const char *Loc);
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IO_LINEINDEX_H
@@ -39,6 +39,11 @@ public:
     // if an error occured while reading.
     static std::optional<MemoryBuffer> read(const Path &path);
 
+    // \brief Maps the file of the specified path read-only, without copying
+    // it and without a terminating null, returns null if it could not be
+    // mapped. Falls back to read() where files cannot be mapped.
+    static std::optional<MemoryBuffer> map(const Path &path);
+
     // \brief Get's this specified offsets line number and column number.
     std::pair<std::size_t, std::size_t>
     getPositionalData(const char *loc) const;
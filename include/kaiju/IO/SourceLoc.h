@@ -75,6 +75,10 @@ public:
 
     SourceRange(const char *Be, std::size_t Len)
         : SourceRangeBase(SourceLoc(Be), SourceLoc(Be + Len)) { /* empty */ }
+
+    using SourceRangeBase::begin;
+    using SourceRangeBase::end;
+    using SourceRangeBase::length;
 };
 
 } // namespace kaiju
@@ -0,0 +1,226 @@
+
+#ifndef KAIJU_IO_RAW_OSTREAM_H
+#define KAIJU_IO_RAW_OSTREAM_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#include "kaiju/ADT/StringRef.h"
+#include "kaiju/IO/Path.h"
+#include "kaiju/Support/MathExtras.h"
+
+namespace kaiju {
+
+// Class raw_ostream
+//
+// \brief A fast output stream, without the locales, formatting state and
+// sentries of std::ostream.
+//
+// Output is collected in a buffer which is handed to write_impl() once it
+// fills up, so small writes are a bounds check and a copy. Numbers are
+// formatted directly into the buffer. Subclasses provide write_impl() and
+// pick the size of the buffer; a stream without a buffer passes every write
+// straight through.
+//
+class raw_ostream {
+    char *BufferStart;
+    char *BufferEnd;
+    char *BufferCur;
+
+    // \brief Writes \p Size bytes which did not fit in the buffer.
+    void write_slow(const char *Ptr, std::size_t Size);
+
+    // \brief Hands the non-empty buffer to write_impl().
+    void flush_nonempty();
+
+    // \brief Writes the digits of \p V, preceded by a minus if \p Negative.
+    raw_ostream &write_integer(uint128_t V, bool Negative);
+
+protected:
+    // ctor.
+    raw_ostream() : BufferStart(nullptr), BufferEnd(nullptr),
+                    BufferCur(nullptr) { /* empty */ }
+
+    // \brief Writes out \p Size bytes, bypassing the buffer.
+    virtual void write_impl(const char *Ptr, std::size_t Size) = 0;
+
+    // \brief Gives this stream a buffer of \p Size bytes, 0 for none.
+    void setBufferSize(std::size_t Size);
+
+public:
+    raw_ostream(const raw_ostream &) = delete;
+    raw_ostream &operator=(const raw_ostream &) = delete;
+
+    // dtor. Subclasses must flush, write_impl() is gone by now.
+    virtual ~raw_ostream();
+
+    // \brief Returns the number of bytes waiting in the buffer.
+    std::size_t GetNumBytesInBuffer() const { return BufferCur - BufferStart; }
+
+    // \brief Writes out everything in the buffer.
+    void flush() {
+        if (BufferCur != BufferStart)
+            flush_nonempty();
+    }
+
+    raw_ostream &write(const char *Ptr, std::size_t Size) {
+        if (std::size_t(BufferEnd - BufferCur) < Size) {
+            write_slow(Ptr, Size);
+            return *this;
+        }
+
+        if (Size)
+            std::memcpy(BufferCur, Ptr, Size);
+        BufferCur += Size;
+        return *this;
+    }
+
+    raw_ostream &operator<<(char C) {
+        if (BufferCur == BufferEnd)
+            return write(&C, 1);
+        *BufferCur++ = C;
+        return *this;
+    }
+
+    raw_ostream &operator<<(unsigned char C) { return *this << char(C); }
+    raw_ostream &operator<<(signed char C) { return *this << char(C); }
+
+    raw_ostream &operator<<(StringRef Str) {
+        return write(Str.data(), Str.size());
+    }
+
+    raw_ostream &operator<<(const char *Str) {
+        return write(Str, std::strlen(Str));
+    }
+
+    raw_ostream &operator<<(const std::string &Str) {
+        return write(Str.data(), Str.size());
+    }
+
+    raw_ostream &operator<<(unsigned long long N) {
+        return write_integer(N, false);
+    }
+
+    raw_ostream &operator<<(long long N) {
+        return write_integer(N < 0 ? 0 - (unsigned long long)N : N, N < 0);
+    }
+
+    raw_ostream &operator<<(unsigned long N) {
+        return *this << (unsigned long long)N;
+    }
+    raw_ostream &operator<<(long N) { return *this << (long long)N; }
+    raw_ostream &operator<<(unsigned N) {
+        return *this << (unsigned long long)N;
+    }
+    raw_ostream &operator<<(int N) { return *this << (long long)N; }
+
+    raw_ostream &operator<<(uint128_t N) { return write_integer(N, false); }
+
+    // \brief Writes the shortest decimal form of \p D that reads back as
+    // the same double.
+    raw_ostream &operator<<(double D);
+
+    // \brief Writes \p P in hexadecimal, prefixed with 0x.
+    raw_ostream &operator<<(const void *P);
+
+    // \brief Writes \p N in upper case hexadecimal, zero padded to at least
+    // \p Width digits, without a prefix.
+    raw_ostream &write_hex(uint64_t N, unsigned Width = 0);
+
+    // \brief Writes \p N spaces.
+    raw_ostream &indent(unsigned N);
+
+    // \brief Returns whether this stream goes to a terminal which shows ANSI
+    // colors.
+    virtual bool has_colors() const { return false; }
+};
+
+// Class raw_fd_ostream
+//
+// \brief A raw_ostream writing to a file descriptor through a large buffer.
+//
+class raw_fd_ostream : public raw_ostream {
+    int FD;
+    bool ShouldClose;
+    bool Error;
+    bool Colors;
+
+    void write_impl(const char *Ptr, std::size_t Size) override;
+
+public:
+    // \brief The buffer size of streams to files.
+    static const std::size_t DefaultBufferSize = 64 * 1024;
+
+    // ctor. Writes to \p fd, closing it on destruction if \p shouldClose. A
+    // \p bufferSize of 0 makes the stream unbuffered.
+    raw_fd_ostream(int fd, bool shouldClose,
+                   std::size_t bufferSize = DefaultBufferSize);
+
+    // dtor. Flushes the stream.
+    ~raw_fd_ostream() override;
+
+    // \brief Creates or truncates the file at \p path for writing, returns
+    // null if it could not be opened.
+    static raw_fd_ostream *open(const Path &path);
+
+    // \brief Returns whether a write has failed. Later writes are dropped.
+    bool has_error() const { return Error; }
+
+    // \brief Returns whether the descriptor was a terminal when the stream
+    // was created, which is only checked once.
+    bool has_colors() const override { return Colors; }
+};
+
+// Class raw_string_ostream
+//
+// \brief A raw_ostream appending to a std::string. The string is always up
+// to date, this stream has no buffer of its own.
+//
+class raw_string_ostream : public raw_ostream {
+    std::string &OS;
+
+    void write_impl(const char *Ptr, std::size_t Size) override {
+        OS.append(Ptr, Size);
+    }
+
+public:
+    // ctor.
+    explicit raw_string_ostream(std::string &S) : OS(S) { /* empty */ }
+
+    // \brief Returns the string written to.
+    std::string &str() { return OS; }
+};
+
+// Class raw_os_ostream
+//
+// \brief A raw_ostream forwarding to a std::ostream in large blocks, for
+// callers holding a std::ostream.
+//
+class raw_os_ostream : public raw_ostream {
+    std::ostream &OS;
+
+    void write_impl(const char *Ptr, std::size_t Size) override {
+        OS.write(Ptr, Size);
+    }
+
+public:
+    // ctor.
+    explicit raw_os_ostream(std::ostream &O);
+
+    // dtor. Flushes the stream.
+    ~raw_os_ostream() override;
+};
+
+// \brief Returns a buffered stream to standard output, flushed at exit.
+raw_ostream &outs();
+
+// \brief Returns an unbuffered stream to standard error.
+raw_ostream &errs();
+
+} // namespace kaiju
+
+#endif // KAIJU_IO_RAW_OSTREAM_H
@@ -0,0 +1,50 @@
+
+#ifndef KAIJU_IR_ALLOCAINST_H
+#define KAIJU_IR_ALLOCAINST_H
+
+#include "kaiju/IR/Instruction.h"
+
+namespace kaiju {
+
+// Class AllocaInst
+//
+// \brief This class is the itermediate representation for a stack slot local
+// to the function. The value of the instruction is a pointer to the slot,
+// which is accessed with LoadInst and StoreInst.
+//
+class AllocaInst : public Instruction {
+
+    // \brief The type of the value held by the slot.
+    Type *AllocatedType;
+
+protected:
+
+    // ctor.
+    explicit AllocaInst(Type *Ty)
+         : Instruction(Type::getPointerTy(Ty->getContext()),
+                       Instruction::AllocaInstTy),
+           AllocatedType(Ty) { /* empty */ }
+
+public:
+
+    // \brief Primary way of constucting an AllocaInst object.
+    static AllocaInst *get(Type *Ty) {
+        return new AllocaInst(Ty);
+    }
+
+    // \brief Returns the type of the value held by the slot.
+    Type *getAllocatedType() const { return AllocatedType; }
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Instruction *I) {
+        return I->getInstructionID() == Instruction::AllocaInstTy;
+    }
+
+    static bool classof(const Value *V) {
+        return isa<Instruction>(V) && classof(cast<Instruction>(V));
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_ALLOCAINST_H
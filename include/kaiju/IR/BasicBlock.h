@@ -12,7 +12,7 @@ class BasicBlock : public Value {
     friend class TranslationUnit;
 
     // \brief This is a list of instructions within this block.
-    std::vector<Instruction *> InstList;
+    SmallVector<Instruction *, 8> InstList;
 
     // \brief This is the Block's parent;
     Function *Parent;
@@ -24,6 +24,9 @@ class BasicBlock : public Value {
     }
 
 public:
+    using iterator       = SmallVectorImpl<Instruction *>::iterator;
+    using const_iterator = SmallVectorImpl<Instruction *>::const_iterator;
+
     BasicBlock(const BasicBlock &) = delete;
     BasicBlock &operator=(const BasicBlock &) = delete;
 
@@ -32,6 +35,76 @@ public:
         return new BasicBlock(C, Name);
     }
 
+    // \brief Returns the function this block belongs to.
+    const Function *getParent() const { return Parent; }
+          Function *getParent()       { return Parent; }
+
+    // \brief Instruction iteration.
+    iterator       begin()       { return InstList.begin(); }
+    const_iterator begin() const { return InstList.begin(); }
+    iterator       end()         { return InstList.end();   }
+    const_iterator end()   const { return InstList.end();   }
+
+    std::size_t size() const { return InstList.size();  }
+    bool empty()       const { return InstList.empty(); }
+
+    // \brief Returns the instruction ending this block, or null if the block
+    // is not terminated yet.
+    Instruction *getTerminator() const {
+        if (InstList.empty() || !InstList.back()->isTerminator())
+            return nullptr;
+        return InstList.back();
+    }
+
+    // \brief Returns the number of blocks control may transfer to from this
+    // block.
+    unsigned getNumSuccessors() const;
+
+    // \brief Returns the successor at index \p i.
+    BasicBlock *getSuccessor(unsigned i) const;
+
+    // \brief Inserts \p I before \p Pos and returns an iterator to it.
+    iterator insert(iterator Pos, Instruction *I) {
+        assert(!I->Parent && "Instruction already inserted in a block.");
+        I->Parent = this;
+        return InstList.insert(Pos, I);
+    }
+
+    // \brief Appends \p I to the end of this block.
+    void push_back(Instruction *I) { insert(end(), I); }
+
+    // \brief Unlinks the instruction at \p Pos without deleting it, returns
+    // an iterator to the following instruction.
+    iterator remove(iterator Pos) {
+        (*Pos)->Parent = nullptr;
+        return InstList.erase(Pos);
+    }
+
+    // \brief Replaces the instructions of this block with \p Insts, for
+    // passes that rebuild a block in one sweep instead of inserting into it
+    // one instruction at a time. Instructions of the block missing from
+    // \p Insts are unlinked but not deleted, the others must not be in any
+    // other block.
+    void setInstructions(SmallVectorImpl<Instruction *> &&Insts);
+
+    // \brief Unlinks and deletes every instruction satisfying \p Pred in a
+    // single sweep over the block.
+    template <typename PredTy>
+    void eraseIf(PredTy Pred) {
+        auto NewEnd = InstList.begin();
+
+        for (Instruction *I : InstList) {
+            if (Pred(I)) {
+                I->Parent = nullptr;
+                delete I;
+            } else {
+                *NewEnd++ = I;
+            }
+        }
+
+        InstList.erase(NewEnd, InstList.end());
+    }
+
     /// Methods for support type inquiry through isa, cast, and dyn_cast:
     static bool classof(const Value *V) {
         return V->getValueID() == Value::BasicBlockVal;
@@ -0,0 +1,104 @@
+
+#ifndef KAIJU_IR_BINARYIR_H
+#define KAIJU_IR_BINARYIR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "kaiju/ADT/StringRef.h"
+#include "kaiju/IO/Path.h"
+#include "kaiju/IR/Context.h"
+#include "kaiju/IR/Function.h"
+#include "kaiju/IR/TranslationUnit.h"
+
+namespace kaiju {
+
+    class FlatFunction;
+
+// \brief Writes the IR of the functions of \p TU to \p Buffer in kaiju's
+// binary IR format, to be loaded back with BinaryIRReader.
+//
+// A fixed size header locates a table of the distinct types used, a string
+// table holding every name and an index of the functions sorted by name,
+// giving the offset and size of every function body. A body is the
+// FlatFunction of the function, with every number varint encoded and names
+// as offsets into the string table.
+void writeBinaryIR(const TranslationUnit &TU, std::vector<uint8_t> &Buffer);
+
+// Class BinaryIRReader
+//
+// \brief Loads functions from a file in the binary IR format on demand.
+//
+// Opening a file maps it into memory and reads the header and the type
+// table, nothing else. A function body is decoded into the TranslationUnit
+// the first time the function is asked for, so loading a few functions of
+// a large file only touches the pages holding them. Names are copied out
+// of the mapped file as a body is decoded, so loaded functions do not
+// depend on the file or the reader once loaded.
+//
+class BinaryIRReader {
+    TranslationUnit &TU;
+    Context &Ctx;
+
+    const uint8_t *Data;
+    std::size_t Size;
+
+    // \brief Whether Data is a mapping of the file, rather than a copy.
+    bool Mapped;
+
+    std::vector<Type *> Types;
+    const uint8_t *Strings;
+    uint64_t StringsSize;
+    const uint8_t *Index;
+    unsigned NumFunctions;
+
+    // \brief Functions loaded so far, by index.
+    std::vector<Function *> Functions;
+
+    // ctor.
+    BinaryIRReader(TranslationUnit &T, Context &C)
+         : TU(T), Ctx(C), Data(nullptr), Size(0), Mapped(false),
+           Strings(nullptr), StringsSize(0), Index(nullptr), NumFunctions(0) {
+        /* empty */
+    }
+
+    BinaryIRReader(const BinaryIRReader &) = delete;
+    BinaryIRReader &operator=(const BinaryIRReader &) = delete;
+
+    // \brief Reads the header and the type table.
+    bool readHeader();
+
+    // \brief Decodes the body of function \p I into \p FF.
+    bool readBody(unsigned I, FlatFunction &FF) const;
+
+public:
+    ~BinaryIRReader();
+
+    // \brief Opens the binary IR file at \p P, whose functions are loaded into
+    // \p TU, with types from \p C. Returns null if the file cannot be read
+    // or is not in the binary IR format.
+    static BinaryIRReader *open(const Path &P, TranslationUnit &TU,
+                                Context &C);
+
+    // \brief Returns the number of functions in the file.
+    unsigned getNumFunctions() const { return NumFunctions; }
+
+    // \brief Returns the name of function \p I. Functions are sorted by name.
+    StringRef getFunctionName(unsigned I) const;
+
+    // \brief Returns function \p I, loading it on first use. Returns null if
+    // its body is malformed.
+    Function *getFunction(unsigned I);
+
+    // \brief Returns the function named \p Name, loading it on first use, or
+    // null if there is none or its body is malformed.
+    Function *getFunction(StringRef Name);
+
+    // \brief Loads every function. Returns false if a body is malformed.
+    bool materializeAll();
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_BINARYIR_H
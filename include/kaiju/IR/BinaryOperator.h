@@ -15,27 +15,55 @@ class BinaryOperator : public Instruction {
     // \brief The operation being expressed in this Binary Operation.
     BinaryOpTy Operator;
 
-    // \brief This Binary Operation's operand.
-    Value *LHS, //< Left-hand operand.
-          *RHS; //< Right-hand operand.
-
 protected:
 
     // ctor.
-    explicit BinaryOperator(Context &C, BinaryOpTy Oper, Value *LHO, Value *RHO)
-         : Instruction(C, Instruction::BinaryOpInstTy) { /* empty */ }
+    explicit BinaryOperator(BinaryOpTy Oper, Value *LHO, Value *RHO)
+         : Instruction(LHO->getValueType(), Instruction::BinaryOpInstTy),
+           Operator(Oper) {
+        assert(LHO->getValueType() == RHO->getValueType()
+            && "Binary operands must have the same type.");
+        Operands.push_back(LHO);
+        Operands.push_back(RHO);
+    }
 
 public:
 
     // \brief Primary way of constucting a BinaryOperator object.
     static BinaryOperator *get(BinaryOpTy Ty, Value *LHO, Value *RHO) {
-        return new BinaryOperator(LHO->getValueType()->getContext(),
-            Ty, LHO, RHO);
+        return new BinaryOperator(Ty, LHO, RHO);
+    }
+
+    // \brief Returns the operation expressed by this instruction.
+    BinaryOpTy getOpcode() const { return Operator; }
+
+    // \brief Returns the left-hand operand.
+    Value *getLHS() const { return getOperand(0); }
+
+    // \brief Returns the right-hand operand.
+    Value *getRHS() const { return getOperand(1); }
+
+    // \brief Returns the mnemonic of \p Op in the textual IR, e.g. sdiv.
+    static const char *getOpcodeName(BinaryOpTy Op);
+
+    // \brief Returns whether the operation \p Op is commutative.
+    static bool isCommutative(BinaryOpTy Op) {
+        switch (Op) {
+        case Add: case Mul: case And:
+        case MulHS: case MulHU:
+            return true;
+        default:
+            return false;
+        }
     }
 
     /// Methods for support type inquiry through isa, cast, and dyn_cast:
-    static bool classof(const Instruction *V) {
-        return V->getValueID() == Instruction::BinaryOpInstTy;
+    static bool classof(const Instruction *I) {
+        return I->getInstructionID() == Instruction::BinaryOpInstTy;
+    }
+
+    static bool classof(const Value *V) {
+        return isa<Instruction>(V) && classof(cast<Instruction>(V));
     }
 };
 
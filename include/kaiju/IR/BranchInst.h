@@ -0,0 +1,88 @@
+
+#ifndef KAIJU_IR_BRANCHINST_H
+#define KAIJU_IR_BRANCHINST_H
+
+#include "kaiju/IR/BasicBlock.h"
+
+namespace kaiju {
+
+// Class BranchInst
+//
+// \brief This class is the itermediate representation for conditional and
+// unconditional branches.
+//
+// An unconditional branch has its destination as the only operand. A
+// conditional branch has the i1 condition followed by the destinations taken
+// when the condition is true and false.
+//
+class BranchInst : public Instruction {
+protected:
+
+    // ctor.
+    explicit BranchInst(Context &C)
+         : Instruction(Type::getVoidTy(C), Instruction::BranchInstTy) {
+        /* empty */
+    }
+
+public:
+
+    // \brief Constructs an unconditional branch to \p Dest.
+    static BranchInst *get(BasicBlock *Dest) {
+        BranchInst *Br = new BranchInst(Dest->getValueType()->getContext());
+        Br->Operands.push_back(Dest);
+        return Br;
+    }
+
+    // \brief Constructs a branch to \p IfTrue if \p Cond is set and to
+    // \p IfFalse otherwise.
+    static BranchInst *get(Value *Cond, BasicBlock *IfTrue,
+                           BasicBlock *IfFalse) {
+        BranchInst *Br = new BranchInst(Cond->getValueType()->getContext());
+        Br->Operands.push_back(Cond);
+        Br->Operands.push_back(IfTrue);
+        Br->Operands.push_back(IfFalse);
+        return Br;
+    }
+
+    bool isConditional()   const { return Operands.size() == 3; }
+    bool isUnconditional() const { return Operands.size() == 1; }
+
+    // \brief Returns the branch condition of a conditional branch.
+    Value *getCondition() const {
+        assert(isConditional() && "unconditional branches have no condition.");
+        return Operands[0];
+    }
+
+    // \brief Returns the number of blocks this branch may transfer to.
+    unsigned getNumSuccessors() const { return isConditional() ? 2 : 1; }
+
+    // \brief Returns the successor at index \p i. For conditional branches
+    // successor 0 is taken when the condition is true.
+    BasicBlock *getSuccessor(unsigned i) const {
+        assert(i < getNumSuccessors() && "successor index out of range.");
+        return cast<BasicBlock>(Operands[isConditional() ? i + 1 : i]);
+    }
+
+    void setSuccessor(unsigned i, BasicBlock *BB) {
+        assert(i < getNumSuccessors() && "successor index out of range.");
+        Operands[isConditional() ? i + 1 : i] = BB;
+    }
+
+    // \brief Turns this branch into an unconditional branch to \p Dest.
+    void makeUnconditional(BasicBlock *Dest) {
+        Operands.assign(1, Dest);
+    }
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Instruction *I) {
+        return I->getInstructionID() == Instruction::BranchInstTy;
+    }
+
+    static bool classof(const Value *V) {
+        return isa<Instruction>(V) && classof(cast<Instruction>(V));
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_BRANCHINST_H
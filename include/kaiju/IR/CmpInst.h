@@ -0,0 +1,83 @@
+
+#ifndef KAIJU_IR_CMPINST_H
+#define KAIJU_IR_CMPINST_H
+
+#include "kaiju/IR/Instruction.h"
+#include "kaiju/IR/DerivedTypes.h"
+
+namespace kaiju {
+
+// Class CmpInst
+//
+// \brief This class is the itermediate representation for an integer
+// comparison. The result is an i1 which is 1 when the predicate holds.
+//
+class CmpInst : public Instruction {
+public:
+    // \brief The relations that can be tested. The U and S prefixes treat the
+    // operands as unsigned and signed integers respectively.
+    enum Predicate {
+        EQ,
+        NE,
+        ULT,
+        ULE,
+        UGT,
+        UGE,
+        SLT,
+        SLE,
+        SGT,
+        SGE,
+    };
+
+private:
+
+    // \brief The relation tested by this comparison.
+    Predicate Pred;
+
+protected:
+
+    // ctor.
+    explicit CmpInst(Predicate P, Value *LHO, Value *RHO)
+         : Instruction(IntegerType::getInt1Ty(LHO->getValueType()->getContext()),
+                       Instruction::CmpInstTy),
+           Pred(P) {
+        assert(LHO->getValueType() == RHO->getValueType()
+            && "Compared values must have the same type.");
+        assert(isa<IntegerType>(LHO->getValueType())
+            && "Only integers can be compared.");
+        Operands.push_back(LHO);
+        Operands.push_back(RHO);
+    }
+
+public:
+
+    // \brief Primary way of constucting a CmpInst object.
+    static CmpInst *get(Predicate P, Value *LHO, Value *RHO) {
+        return new CmpInst(P, LHO, RHO);
+    }
+
+    // \brief Returns the relation tested by this comparison.
+    Predicate getPredicate() const { return Pred; }
+
+    // \brief Returns the mnemonic of \p P in the textual IR, e.g. slt.
+    static const char *getPredicateName(Predicate P);
+
+    // \brief Returns the left-hand operand.
+    Value *getLHS() const { return getOperand(0); }
+
+    // \brief Returns the right-hand operand.
+    Value *getRHS() const { return getOperand(1); }
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Instruction *I) {
+        return I->getInstructionID() == Instruction::CmpInstTy;
+    }
+
+    static bool classof(const Value *V) {
+        return isa<Instruction>(V) && classof(cast<Instruction>(V));
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_CMPINST_H
@@ -0,0 +1,22 @@
+
+#ifndef KAIJU_IR_CONSTANTFOLD_H
+#define KAIJU_IR_CONSTANTFOLD_H
+
+#include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/CmpInst.h"
+#include "kaiju/IR/Constants.h"
+
+namespace kaiju {
+
+// \brief Evaluates \p Op on two constants of the same type. Returns null when
+// the operands are not both constants or the result is not defined, such as a
+// division by zero, the overflowing signed division or an oversized shift.
+Value *constantFoldBinaryOp(Instruction::BinaryOpTy Op, Value *LHS, Value *RHS);
+
+// \brief Evaluates the comparison \p Pred on two integer constants. Returns
+// null when the operands are not both constants.
+ConstantInt *constantFoldCmp(CmpInst::Predicate Pred, Value *LHS, Value *RHS);
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_CONSTANTFOLD_H
@@ -0,0 +1,115 @@
+
+#ifndef KAIJU_IR_CONSTANTS_H
+#define KAIJU_IR_CONSTANTS_H
+
+#include "kaiju/IR/Value.h"
+#include "kaiju/IR/DerivedTypes.h"
+#include "kaiju/Support/MathExtras.h"
+
+namespace kaiju {
+
+// Class ConstantInt
+//
+// \brief This class represents an integer constant of any IntegerType width.
+// The value is stored zero-extended, signedness is decided by the operations
+// that consume it.
+//
+class ConstantInt : public Value {
+
+    // \brief The bits of this constant, truncated to the type's width.
+    uint128_t Val;
+
+    // ctor.
+    ConstantInt(IntegerType *Ty, uint128_t V)
+         : Value(Ty, Value::ConstantIntVal), Val(V) { /* empty */ }
+
+public:
+    ConstantInt(const ConstantInt &) = delete;
+    ConstantInt &operator=(const ConstantInt &) = delete;
+
+    // \brief Primary way of constructing a ConstantInt. Constants are uniqued
+    // within their Context, \p V is truncated to the width of \p Ty.
+    static ConstantInt *get(IntegerType *Ty, uint128_t V);
+
+    // \brief Returns the IntegerType of this constant.
+    IntegerType *getType() const { return cast<IntegerType>(getValueType()); }
+
+    // \brief Returns the width of this constant in bits.
+    unsigned getBitWidth() const { return getType()->getBitWidth(); }
+
+    // \brief Returns the value zero-extended to 128 bits.
+    uint128_t getZExtValue() const { return Val; }
+
+    // \brief Returns the value sign-extended to 128 bits.
+    int128_t getSExtValue() const { return signExtend(Val, getBitWidth()); }
+
+    bool isZero()     const { return Val == 0; }
+    bool isOne()      const { return Val == 1; }
+    bool isAllOnes()  const { return Val == maskTrailingOnes(getBitWidth()); }
+    bool isNegative() const { return kaiju::isNegative(Val, getBitWidth()); }
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Value *V) {
+        return V->getValueID() == Value::ConstantIntVal;
+    }
+};
+
+// Class ConstantFP
+//
+// \brief This class represents a floating point constant.
+//
+class ConstantFP : public Value {
+
+    // \brief The value of this constant.
+    double Val;
+
+    // ctor.
+    ConstantFP(Type *Ty, double V)
+         : Value(Ty, Value::ConstantFPVal), Val(V) { /* empty */ }
+
+public:
+    ConstantFP(const ConstantFP &) = delete;
+    ConstantFP &operator=(const ConstantFP &) = delete;
+
+    // \brief Primary way of constructing a ConstantFP. Constants are uniqued
+    // within their Context by type and bit pattern.
+    static ConstantFP *get(Type *Ty, double V);
+
+    // \brief Returns the value of this constant.
+    double getValue() const { return Val; }
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Value *V) {
+        return V->getValueID() == Value::ConstantFPVal;
+    }
+};
+
+// Class UndefValue
+//
+// \brief This class represents a value of some type whose bits are
+// unspecified, such as the contents of a stack slot read before it was ever
+// written. Every use may observe a different value.
+//
+class UndefValue : public Value {
+
+    // ctor.
+    explicit UndefValue(Type *Ty)
+         : Value(Ty, Value::UndefValueVal) { /* empty */ }
+
+public:
+    UndefValue(const UndefValue &) = delete;
+    UndefValue &operator=(const UndefValue &) = delete;
+
+    // \brief Primary way of constructing an UndefValue. There is one
+    // UndefValue per type within a Context.
+    static UndefValue *get(Type *Ty);
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Value *V) {
+        return V->getValueID() == Value::UndefValueVal;
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_CONSTANTS_H
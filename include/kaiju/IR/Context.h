@@ -2,25 +2,42 @@
 #ifndef KAIJU_IR_CONTEXT_H
 #define KAIJU_IR_CONTEXT_H
 
+#include "kaiju/ADT/DenseMap.h"
 #include "kaiju/ADT/StringRef.h"
 #include "kaiju/IR/ContextImpl.h"
+#include "kaiju/Support/IdentifierTable.h"
+#include "kaiju/Support/MathExtras.h"
 
 namespace kaiju {
 
     class Type;
     class Value;
+    class ConstantInt;
+    class ConstantFP;
+    class UndefValue;
 
 class Context {
 public:
     ContextImpl *impl;
 
+    // This member interns the identifiers lexed and the names bound to
+    // values within this context, so equal names share one IdentifierInfo.
+    IdentifierTable Identifiers;
+
     // This member tracks all name bindings to values within this context.
-    std::map<const Value *, StringRef> ValueNames;
+    DenseMap<const Value *, IdentifierInfo *> ValueNames;
 
     // This member tracks all non-primitive IntegerTypes allocated within this
     // Context. Refer to IntegerType::get() for a better idea of why this member
     // exists and what it's purpose is.
-    std::map<unsigned, IntegerType *> IntegerTypes;
+    DenseMap<unsigned, IntegerType *> IntegerTypes;
+
+    // These members unique the constants allocated within this Context, see
+    // ConstantInt::get(), ConstantFP::get() and UndefValue::get().
+    DenseMap<std::pair<const IntegerType *, uint128_t>, ConstantInt *>
+        IntConstants;
+    DenseMap<std::pair<const Type *, uint64_t>, ConstantFP *> FPConstants;
+    DenseMap<const Type *, UndefValue *> UndefValues;
 
     Context();
 
@@ -2,6 +2,7 @@
 #ifndef KAIJU_IR_DERIVEDTYPES_H
 #define KAIJU_IR_DERIVEDTYPES_H
 
+#include "kaiju/ADT/SmallVector.h"
 #include "kaiju/IR/Type.h"
 
 namespace kaiju {
@@ -28,10 +29,13 @@ protected:
 public:
     // \brief A method for dumping the contents of this function into a
     // output stream.
-    std::ostream &dump(std::ostream &os) const {
-        return os << "i" << width;
+    raw_ostream &dump(raw_ostream &os) const {
+        return os << 'i' << width;
     }
 
+    // \brief Returns the number of bits in this integer type.
+    unsigned getBitWidth() const { return width; }
+
     static IntegerType *getInt1Ty(Context &C)   ;
     static IntegerType *getInt8Ty(Context &C)   ;
     static IntegerType *getInt16Ty(Context &C)  ;
@@ -59,8 +63,9 @@ class FunctionType : public Type {
     // \brief This is the return type of this function signature.
     Type *Result;
 
-    // \brief This is this functions type signature.
-    std::vector<Argument *> Params;
+    // \brief This is this functions type signature. Most functions take
+    // only a few parameters, which are kept inline.
+    SmallVector<Argument *, 4> Params;
 
     // ctor.
     FunctionType(Context &C, Type *Ret)
@@ -74,7 +79,7 @@ public:
 
     // \brief A method for dumping the contents of this function into a
     // output stream.
-    std::ostream &dump(std::ostream &os) const {
+    raw_ostream &dump(raw_ostream &os) const {
         return Result->dump(os);
     }
 
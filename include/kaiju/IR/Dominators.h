@@ -0,0 +1,124 @@
+
+#ifndef KAIJU_IR_DOMINATORS_H
+#define KAIJU_IR_DOMINATORS_H
+
+#include <map>
+#include <vector>
+
+#include "kaiju/ADT/SmallVector.h"
+#include "kaiju/IR/Function.h"
+
+namespace kaiju {
+
+// Class DominatorTree
+//
+// \brief The dominator tree of the blocks reachable from a function's entry
+// block, built with the iterative algorithm of Cooper, Harvey and Kennedy.
+//
+// Reachable blocks are numbered in reverse post order, with the entry block
+// numbered 0. Since the IR keeps no predecessor lists, the tree also records
+// the CFG edges between reachable blocks for its clients. The tree is a
+// snapshot, it must be rebuilt after the CFG changes.
+//
+class DominatorTree {
+
+    // \brief Reachable blocks in reverse post order.
+    std::vector<BasicBlock *> Blocks;
+
+    // \brief Reverse post order number of every reachable block.
+    std::map<const BasicBlock *, unsigned> Numbers;
+
+    // \brief Immediate dominator and depth in the tree, by block number.
+    std::vector<unsigned> IDoms;
+    std::vector<unsigned> Levels;
+
+    // \brief Tree children and CFG edges, by block number. Blocks rarely
+    // have more than two of either, so the lists are kept inline.
+    std::vector<SmallVector<unsigned, 2>> Children;
+    std::vector<SmallVector<unsigned, 2>> Preds;
+    std::vector<SmallVector<unsigned, 2>> Succs;
+
+    friend class IDFCalculator;
+
+public:
+    explicit DominatorTree(Function &Fn);
+
+    // \brief Returns the number of reachable blocks.
+    unsigned size() const { return Blocks.size(); }
+
+    // \brief Returns whether \p BB is reachable from the entry block.
+    bool isReachable(const BasicBlock *BB) const { return Numbers.count(BB); }
+
+    // \brief Returns the reverse post order number of the reachable block
+    // \p BB, which indexes dense per-block tables.
+    unsigned getNumber(const BasicBlock *BB) const {
+        auto It = Numbers.find(BB);
+        assert(It != Numbers.end() && "Block is not reachable.");
+        return It->second;
+    }
+
+    // \brief Returns the block numbered \p N.
+    BasicBlock *getBlock(unsigned N) const { return Blocks[N]; }
+
+    // \brief Returns the immediate dominator of block \p N. The entry block is
+    // its own immediate dominator.
+    unsigned getIDom(unsigned N) const { return IDoms[N]; }
+
+    // \brief Returns the depth of block \p N in the tree, the entry block is
+    // at level 0.
+    unsigned getLevel(unsigned N) const { return Levels[N]; }
+
+    // \brief Returns the blocks immediately dominated by block \p N.
+    const SmallVectorImpl<unsigned> &getChildren(unsigned N) const {
+        return Children[N];
+    }
+
+    // \brief Returns the reachable predecessors of block \p N, once per edge.
+    const SmallVectorImpl<unsigned> &getPredecessors(unsigned N) const {
+        return Preds[N];
+    }
+
+    // \brief Returns the successors of block \p N, once per edge.
+    const SmallVectorImpl<unsigned> &getSuccessors(unsigned N) const {
+        return Succs[N];
+    }
+
+    // \brief Returns whether block \p A dominates block \p B.
+    bool dominates(unsigned A, unsigned B) const;
+};
+
+// Class IDFCalculator
+//
+// \brief Computes iterated dominance frontiers, the blocks where phi nodes
+// are needed for a variable defined in a given set of blocks.
+//
+// This is the DJ-graph algorithm of Sreedhar and Gao. Roots are drawn from
+// per-level buckets in order of decreasing tree depth, which keeps each
+// query linear in the size of the dominator subtrees it explores. Scratch
+// state is stamped per query so it never needs clearing.
+//
+class IDFCalculator {
+    const DominatorTree &DT;
+
+    // \brief Per-block stamps, equal to Query while a block is a definition,
+    // is live-in, was visited, or was added to the frontier.
+    std::vector<unsigned> Defining, LiveIn, Visited, InFrontier;
+    unsigned Query;
+
+    // \brief Pending roots by tree level.
+    std::vector<std::vector<unsigned>> Buckets;
+
+public:
+    explicit IDFCalculator(const DominatorTree &Tree);
+
+    // \brief Computes the iterated dominance frontier of \p DefBlocks into
+    // \p IDF, sorted by block number. If \p LiveInBlocks is non-null only
+    // blocks where the variable is live-in are reported, giving pruned SSA.
+    void calculate(const std::vector<unsigned> &DefBlocks,
+                   const std::vector<unsigned> *LiveInBlocks,
+                   std::vector<unsigned> &IDF);
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_DOMINATORS_H
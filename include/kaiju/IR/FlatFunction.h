@@ -0,0 +1,171 @@
+
+#ifndef KAIJU_IR_FLATFUNCTION_H
+#define KAIJU_IR_FLATFUNCTION_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "kaiju/ADT/iterator_range.h"
+#include "kaiju/IR/Function.h"
+#include "kaiju/IR/Instruction.h"
+
+namespace kaiju {
+
+    class BinaryIRReader;
+    class IRParser;
+    class TranslationUnit;
+
+// Class FlatFunction
+//
+// \brief A read-only copy of a Function laid out in flat arrays, for
+// analyses that sweep every instruction.
+//
+// Instructions are fixed size records in one contiguous array, in the order
+// of the blocks of the function, and every block is a range of indices into
+// it. Operands are 32-bit value numbers, kept contiguously in a second
+// array. Values are numbered instructions first, so an instruction's value
+// number is its index and dense per-instruction tables can be indexed by
+// operand directly, followed by the arguments, the blocks and the constants
+// used by the function. Types are referred to by their index in a table of
+// the distinct types used.
+//
+// Both directions of the conversion take linear time. The view holds the
+// constants, types and names of the original function, which must outlive
+// it, and it does not follow later changes to the function.
+//
+class FlatFunction {
+public:
+    // \brief An instruction. Opcode is the Instruction::InstructionTy of the
+    // instruction, SubOpcode its BinaryOpTy or CmpInst::Predicate, if any.
+    // Type is the index of the result type, except for allocas, where it is
+    // the allocated type.
+    struct Inst {
+        uint8_t Opcode;
+        uint8_t SubOpcode;
+        uint16_t Type;
+        uint32_t OperandBegin;
+    };
+
+private:
+    // \brief Instructions, followed by a sentinel whose OperandBegin ends the
+    // operands of the last one.
+    std::vector<Inst> Insts;
+    std::vector<uint32_t> Operands;
+
+    // \brief The index of the first instruction of every block, followed by
+    // the number of instructions.
+    std::vector<uint32_t> BlockBegins;
+
+    std::vector<Type *> Types;
+    std::vector<uint16_t> ArgTypes;
+    std::vector<Value *> Constants;
+    uint16_t ReturnType;
+    uint16_t PointerTy;
+
+    // \brief Names of the instructions, arguments and blocks, by value
+    // number.
+    std::vector<StringRef> Names;
+
+    friend class BinaryIRReader;
+    friend class IRParser;
+
+    // ctor for readers filling in the arrays themselves.
+    FlatFunction() : ReturnType(0), PointerTy(0) { /* empty */ }
+
+public:
+    // ctor, flattens \p Fn.
+    explicit FlatFunction(const Function &Fn);
+
+    unsigned getNumInstructions() const { return Insts.size() - 1; }
+    unsigned getNumArguments()    const { return ArgTypes.size(); }
+    unsigned getNumBlocks()       const { return BlockBegins.size() - 1; }
+    unsigned getNumConstants()    const { return Constants.size(); }
+
+    // \brief Returns the number of values, which bounds value numbers.
+    unsigned getNumValues() const {
+        return getNumInstructions() + getNumArguments() + getNumBlocks()
+             + getNumConstants();
+    }
+
+    // \brief Value number ranges, instructions start at zero.
+    unsigned getFirstArgument() const { return getNumInstructions(); }
+    unsigned getFirstBlock()    const {
+        return getFirstArgument() + getNumArguments();
+    }
+    unsigned getFirstConstant() const {
+        return getFirstBlock() + getNumBlocks();
+    }
+
+    bool isInstruction(uint32_t V) const { return V < getFirstArgument(); }
+    bool isArgument(uint32_t V) const {
+        return V >= getFirstArgument() && V < getFirstBlock();
+    }
+    bool isBlock(uint32_t V) const {
+        return V >= getFirstBlock() && V < getFirstConstant();
+    }
+    bool isConstant(uint32_t V) const { return V >= getFirstConstant(); }
+
+    // \brief Returns instruction \p I.
+    const Inst &getInst(unsigned I) const {
+        assert(I < getNumInstructions() && "instruction index out of range.");
+        return Insts[I];
+    }
+
+    Instruction::InstructionTy getOpcode(unsigned I) const {
+        return Instruction::InstructionTy(getInst(I).Opcode);
+    }
+
+    // \brief Returns the value numbers of the operands of instruction \p I,
+    // in the order of Instruction::getOperand().
+    iterator_range<const uint32_t *> getOperands(unsigned I) const {
+        assert(I < getNumInstructions() && "instruction index out of range.");
+        return make_range(Operands.data() + Insts[I].OperandBegin,
+                          Operands.data() + Insts[I + 1].OperandBegin);
+    }
+
+    // \brief Returns the range of instruction indices of block \p B, which
+    // is numbered in the order of the function's blocks.
+    unsigned getBlockBegin(unsigned B) const { return BlockBegins[B]; }
+    unsigned getBlockEnd(unsigned B)   const { return BlockBegins[B + 1]; }
+
+    // \brief Returns the block number of block value \p V.
+    unsigned getBlockIndex(uint32_t V) const {
+        assert(isBlock(V) && "value is not a block.");
+        return V - getFirstBlock();
+    }
+
+    // \brief Returns the type numbered \p T.
+    Type *getType(unsigned T) const { return Types[T]; }
+    unsigned getNumTypes() const { return Types.size(); }
+
+    // \brief Returns the return type of the function.
+    Type *getReturnType() const { return Types[ReturnType]; }
+
+    // \brief Returns the type of value \p V.
+    Type *getValueType(uint32_t V) const;
+
+    // \brief Returns constant \p V.
+    Value *getConstant(uint32_t V) const {
+        assert(isConstant(V) && "value is not a constant.");
+        return Constants[V - getFirstConstant()];
+    }
+
+    // \brief Returns the name of value \p V, empty for constants.
+    StringRef getName(uint32_t V) const {
+        return V < Names.size() ? Names[V] : StringRef();
+    }
+
+    // \brief Returns whether every instruction has the operands its opcode
+    // expects, of the expected kinds and types, which build() relies on.
+    // Views read from outside the program must be checked before building.
+    bool verify() const;
+
+    // \brief Converts this view back to a function named \p Name in \p TU,
+    // with the same blocks and instructions in the same order.
+    Function *build(TranslationUnit &TU, StringRef Name) const;
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_FLATFUNCTION_H
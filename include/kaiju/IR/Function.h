@@ -12,9 +12,9 @@ namespace kaiju {
 class Function : public Value {
     friend class TranslationUnit;
 
-    // \brief This is a vector of all the Instruction classes that belong within
-    // the scope of this function.
-    BasicBlock *InstructionBody;
+    // \brief The blocks making up the body of this function. The first block
+    // is the entry block.
+    std::vector<BasicBlock *> Blocks;
 
     // \brief Assertion to ensure type provided in the Function constructor
     // is a FunctionType.
@@ -27,11 +27,13 @@ class Function : public Value {
     // ctor.
     Function(Type *Ty, StringRef name = "")
          : Value(assertType(Ty), Value::FunctionVal) {
-        InstructionBody = nullptr;
         setName(name);
     };
 
 public:
+    using iterator       = std::vector<BasicBlock *>::iterator;
+    using const_iterator = std::vector<BasicBlock *>::const_iterator;
+
     // Returns the FunctionType for me.
     FunctionType *getFunctionType() const {
         return cast<FunctionType>(getValueType());
@@ -42,6 +44,37 @@ public:
         return getFunctionType()->getReturnType();
     }
 
+    // \brief Returns the block execution starts in, or null if the function
+    // has no body yet.
+    BasicBlock *getEntryBlock() const {
+        return Blocks.empty() ? nullptr : Blocks.front();
+    }
+
+    // \brief Block iteration.
+    iterator       begin()       { return Blocks.begin(); }
+    const_iterator begin() const { return Blocks.begin(); }
+    iterator       end()         { return Blocks.end();   }
+    const_iterator end()   const { return Blocks.end();   }
+
+    std::size_t size() const { return Blocks.size();  }
+    bool empty()       const { return Blocks.empty(); }
+
+    // \brief Unlinks \p BB from this function and deletes it along with its
+    // instructions.
+    void eraseBlock(BasicBlock *BB) { eraseBlocks(std::vector<BasicBlock *>(1, BB)); }
+
+    // \brief Unlinks every block in \p BBs from this function and deletes them
+    // along with their instructions, in a single sweep over the block list.
+    void eraseBlocks(const std::vector<BasicBlock *> &BBs);
+
+    // \brief Returns the number of formal arguments.
+    std::size_t arg_size() const { return getFunctionType()->getNumParams(); }
+
+    // \brief Returns the formal argument at index \p i.
+    Argument *getArg(unsigned i) const {
+        return getFunctionType()->getParam(i);
+    }
+
     // Methods for support type inquiry through isa, cast, and dyn_cast:
     static bool classof(const Value *V) {
         return V->getValueID() == Value::FunctionVal;
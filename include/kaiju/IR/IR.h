@@ -2,13 +2,22 @@
 #ifndef KAIJU_IR_IR_H
 #define KAIJU_IR_IR_H
 
+#include "kaiju/IR/AllocaInst.h"
 #include "kaiju/IR/Argument.h"
 #include "kaiju/IR/BasicBlock.h"
 #include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/BranchInst.h"
+#include "kaiju/IR/CmpInst.h"
+#include "kaiju/IR/Constants.h"
 #include "kaiju/IR/Context.h"
+#include "kaiju/IR/Dominators.h"
+#include "kaiju/IR/FlatFunction.h"
 #include "kaiju/IR/Function.h"
 #include "kaiju/IR/Instruction.h"
+#include "kaiju/IR/LoadInst.h"
+#include "kaiju/IR/PhiNode.h"
 #include "kaiju/IR/ReturnInst.h"
+#include "kaiju/IR/StoreInst.h"
 #include "kaiju/IR/TranslationUnit.h"
 
 #endif // KAIJU_IR_IR_H
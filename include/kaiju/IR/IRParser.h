@@ -0,0 +1,27 @@
+
+#ifndef KAIJU_IR_IRPARSER_H
+#define KAIJU_IR_IRPARSER_H
+
+#include <string>
+
+#include "kaiju/ADT/StringRef.h"
+#include "kaiju/IR/Context.h"
+#include "kaiju/IR/TranslationUnit.h"
+
+namespace kaiju {
+
+// \brief Parses the functions in \p Text, in the format written by
+// printFunction(), into \p TU, with types and constants from \p C.
+//
+// The text is read in a single pass, names looked up as slices of \p Text
+// while parsing; the functions get copies of them, so they do not depend
+// on \p Text, or a buffer from MemoryBuffer::map(), once parsed. Forward
+// references are resolved at the end of each function. Returns false on
+// the first error, with \p Error set to its line, column and description;
+// functions parsed before it remain in \p TU.
+bool parseIR(StringRef Text, TranslationUnit &TU, Context &C,
+             std::string &Error);
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_IRPARSER_H
@@ -0,0 +1,41 @@
+
+#ifndef KAIJU_IR_IRPRINTER_H
+#define KAIJU_IR_IRPRINTER_H
+
+#include "kaiju/IO/raw_ostream.h"
+#include "kaiju/IR/Function.h"
+#include "kaiju/IR/TranslationUnit.h"
+
+namespace kaiju {
+
+// \brief Writes \p Fn to \p OS in kaiju's textual IR format, which
+// parseIR() reads back.
+//
+// A function reads
+//
+//   define i32 @max(i32 %a, i32 %b) {
+//   entry:
+//     %c = icmp slt i32 %a, %b
+//     br i1 %c, label %less, label %done
+//   less:
+//     br label %done
+//   done:
+//     %m = phi i32 [ %b, %less ], [ %a, %entry ]
+//     ret i32 %m
+//   }
+//
+// Values are printed by name when the name is unique within the function,
+// quoted if it is not an identifier, and by number otherwise, in order of
+// definition. Integer constants are printed as unsigned decimals, floating
+// point constants as the hexadecimal bits of their double value so they
+// round trip exactly, and undefined values as undef. A ; starts a comment
+// running to the end of the line.
+void printFunction(const Function &Fn, raw_ostream &OS);
+
+// \brief Writes the functions of \p TU to \p OS, in the order of its symbol
+// table.
+void printIR(const TranslationUnit &TU, raw_ostream &OS);
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_IRPRINTER_H
@@ -2,29 +2,52 @@
 #ifndef KAIJU_IR_INSTRUCTION_H
 #define KAIJU_IR_INSTRUCTION_H
 
+#include "kaiju/ADT/SmallVector.h"
 #include "kaiju/IR/Value.h"
 
 namespace kaiju {
 
+    class BasicBlock;
+
 // Class Instruction
 //
 // \brief This is the base class for instructions within the Kaiju IR.
 //
 class Instruction : public Value {
+    friend class BasicBlock;
+
 public:
     // \brief Various Binary Operations that can be expressed.
+    //
+    // Div and Rem treat their operands as signed integers, UDiv and URem as
+    // unsigned integers. MulHS and MulHU produce the high half of the double
+    // width signed and unsigned products respectively.
     enum BinaryOpTy {
         Add,
         Sub,
         Mul,
         Div,
         Rem,
+        UDiv,
+        URem,
+        Shl,
+        LShr,
+        AShr,
+        And,
+        MulHS,
+        MulHU,
     };
 
     // \brief The kind of instruction used as RTTI.
     enum InstructionTy {
         BinaryOpInstTy,
+        CmpInstTy,
+        BranchInstTy,
         ReturnInstTy,
+        AllocaInstTy,
+        LoadInstTy,
+        StoreInstTy,
+        PhiNodeTy,
     };
 
 protected:
@@ -32,15 +55,59 @@ protected:
     // \brief RTTI.
     InstructionTy SubclassID;
 
+    // \brief The block this instruction is inserted in.
+    BasicBlock *Parent;
+
+    // \brief The values this instruction operates on, inline unless this
+    // is a phi node with many incoming values.
+    SmallVector<Value *, 3> Operands;
+
     // ctor for subcasses.
-    explicit Instruction(Context &C, InstructionTy Subclass)
-         : Value(Type::getLabelTy(C), Value::InstructionVal),
-           SubclassID(Subclass) { /* empty */ }
+    explicit Instruction(Type *Ty, InstructionTy Subclass)
+         : Value(Ty, Value::InstructionVal),
+           SubclassID(Subclass), Parent(nullptr) { /* empty */ }
 
 public:
 
     // \brief Returns this object's RTTI.
     InstructionTy getInstructionID() const { return SubclassID; }
+
+    // \brief Returns whether this instruction ends a BasicBlock.
+    bool isTerminator() const {
+        return SubclassID == BranchInstTy || SubclassID == ReturnInstTy;
+    }
+
+    // \brief Returns the block this instruction is inserted in, if any.
+    const BasicBlock *getParent() const { return Parent; }
+          BasicBlock *getParent()       { return Parent; }
+
+    // \brief Operand accessors.
+    std::size_t getNumOperands() const { return Operands.size(); }
+
+    Value *getOperand(unsigned i) const {
+        assert(i < Operands.size() && "operand index out of range.");
+        return Operands[i];
+    }
+
+    void setOperand(unsigned i, Value *V) {
+        assert(i < Operands.size() && "operand index out of range.");
+        Operands[i] = V;
+    }
+
+    // \brief Replaces every operand equal to \p From with \p To.
+    void replaceUsesOfWith(Value *From, Value *To) {
+        for (Value *&Op : Operands)
+            if (Op == From)
+                Op = To;
+    }
+
+    // \brief Unlinks this instruction from its block and deletes it.
+    void eraseFromParent();
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Value *V) {
+        return V->getValueID() == Value::InstructionVal;
+    }
 };
 
 } // namespace kaiju
@@ -0,0 +1,48 @@
+
+#ifndef KAIJU_IR_LOADINST_H
+#define KAIJU_IR_LOADINST_H
+
+#include "kaiju/IR/Instruction.h"
+
+namespace kaiju {
+
+// Class LoadInst
+//
+// \brief This class is the itermediate representation for reading a value of
+// some type from memory.
+//
+class LoadInst : public Instruction {
+protected:
+
+    // ctor.
+    explicit LoadInst(Type *Ty, Value *Ptr)
+         : Instruction(Ty, Instruction::LoadInstTy) {
+        assert(isa<PointerType>(Ptr->getValueType())
+            && "Loads must be from a pointer.");
+        Operands.push_back(Ptr);
+    }
+
+public:
+
+    // \brief Primary way of constucting a LoadInst object, reads a value of
+    // type \p Ty from \p Ptr.
+    static LoadInst *get(Type *Ty, Value *Ptr) {
+        return new LoadInst(Ty, Ptr);
+    }
+
+    // \brief Returns the address being read.
+    Value *getPointerOperand() const { return getOperand(0); }
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Instruction *I) {
+        return I->getInstructionID() == Instruction::LoadInstTy;
+    }
+
+    static bool classof(const Value *V) {
+        return isa<Instruction>(V) && classof(cast<Instruction>(V));
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_LOADINST_H
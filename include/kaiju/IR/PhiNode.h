@@ -0,0 +1,71 @@
+
+#ifndef KAIJU_IR_PHINODE_H
+#define KAIJU_IR_PHINODE_H
+
+#include "kaiju/IR/BasicBlock.h"
+
+namespace kaiju {
+
+// Class PhiNode
+//
+// \brief This class is the itermediate representation for an SSA phi node,
+// which selects a value depending on the block control arrived from.
+//
+// The operands are pairs of an incoming value followed by the predecessor
+// it flows in from. Phi nodes are grouped at the start of their block.
+//
+class PhiNode : public Instruction {
+protected:
+
+    // ctor.
+    explicit PhiNode(Type *Ty)
+         : Instruction(Ty, Instruction::PhiNodeTy) { /* empty */ }
+
+public:
+
+    // \brief Primary way of constucting a PhiNode object. Incoming values are
+    // added with addIncoming().
+    static PhiNode *get(Type *Ty) {
+        return new PhiNode(Ty);
+    }
+
+    // \brief Returns the number of incoming edges.
+    unsigned getNumIncomingValues() const { return Operands.size() / 2; }
+
+    // \brief Returns the value flowing in along edge \p i.
+    Value *getIncomingValue(unsigned i) const { return getOperand(i * 2); }
+
+    void setIncomingValue(unsigned i, Value *V) { setOperand(i * 2, V); }
+
+    // \brief Returns the predecessor of edge \p i.
+    BasicBlock *getIncomingBlock(unsigned i) const {
+        return cast<BasicBlock>(getOperand(i * 2 + 1));
+    }
+
+    // \brief Adds an edge from \p BB carrying \p V.
+    void addIncoming(Value *V, BasicBlock *BB) {
+        assert(V->getValueType() == getValueType()
+            && "Incoming value must have the type of the phi node.");
+        Operands.push_back(V);
+        Operands.push_back(BB);
+    }
+
+    // \brief Removes edge \p i, the following edges move down by one.
+    void removeIncomingValue(unsigned i) {
+        assert(i < getNumIncomingValues() && "edge index out of range.");
+        Operands.erase(Operands.begin() + i * 2, Operands.begin() + i * 2 + 2);
+    }
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Instruction *I) {
+        return I->getInstructionID() == Instruction::PhiNodeTy;
+    }
+
+    static bool classof(const Value *V) {
+        return isa<Instruction>(V) && classof(cast<Instruction>(V));
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_PHINODE_H
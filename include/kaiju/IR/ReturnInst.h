@@ -12,18 +12,13 @@ namespace kaiju {
 // instruction.
 //
 class ReturnInst : public Instruction {
-
-    // \brief The value being returned.
-    //
-    // If this is null than there is no return value.
-    Value *RetValue;
-
 protected:
 
     // ctor.
     explicit ReturnInst(Context &C, Value *RVal)
-         : Instruction(C, Instruction::ReturnInstTy) {
-        RetValue = RVal;
+         : Instruction(Type::getVoidTy(C), Instruction::ReturnInstTy) {
+        if (RVal)
+            Operands.push_back(RVal);
     }
 
 public:
@@ -33,9 +28,25 @@ public:
         return new ReturnInst(RVal->getValueType()->getContext(), RVal);
     }
 
+    // \brief Constructs a ReturnInst that returns no value.
+    static ReturnInst *get(Context &C) {
+        return new ReturnInst(C, nullptr);
+    }
+
+    // \brief The value being returned.
+    //
+    // If this is null than there is no return value.
+    Value *getReturnValue() const {
+        return Operands.empty() ? nullptr : Operands[0];
+    }
+
     /// Methods for support type inquiry through isa, cast, and dyn_cast:
-    static bool classof(const Instruction *V) {
-        return V->getValueID() == Instruction::ReturnInstTy;
+    static bool classof(const Instruction *I) {
+        return I->getInstructionID() == Instruction::ReturnInstTy;
+    }
+
+    static bool classof(const Value *V) {
+        return isa<Instruction>(V) && classof(cast<Instruction>(V));
     }
 };
 
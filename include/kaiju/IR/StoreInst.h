@@ -0,0 +1,53 @@
+
+#ifndef KAIJU_IR_STOREINST_H
+#define KAIJU_IR_STOREINST_H
+
+#include "kaiju/IR/Instruction.h"
+
+namespace kaiju {
+
+// Class StoreInst
+//
+// \brief This class is the itermediate representation for writing a value to
+// memory. Operand 0 is the value stored, operand 1 the address.
+//
+class StoreInst : public Instruction {
+protected:
+
+    // ctor.
+    explicit StoreInst(Value *Val, Value *Ptr)
+         : Instruction(Type::getVoidTy(Val->getValueType()->getContext()),
+                       Instruction::StoreInstTy) {
+        assert(isa<PointerType>(Ptr->getValueType())
+            && "Stores must be to a pointer.");
+        Operands.push_back(Val);
+        Operands.push_back(Ptr);
+    }
+
+public:
+
+    // \brief Primary way of constucting a StoreInst object, writes \p Val
+    // to \p Ptr.
+    static StoreInst *get(Value *Val, Value *Ptr) {
+        return new StoreInst(Val, Ptr);
+    }
+
+    // \brief Returns the value being written.
+    Value *getValueOperand() const { return getOperand(0); }
+
+    // \brief Returns the address being written.
+    Value *getPointerOperand() const { return getOperand(1); }
+
+    /// Methods for support type inquiry through isa, cast, and dyn_cast:
+    static bool classof(const Instruction *I) {
+        return I->getInstructionID() == Instruction::StoreInstTy;
+    }
+
+    static bool classof(const Value *V) {
+        return isa<Instruction>(V) && classof(cast<Instruction>(V));
+    }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_IR_STOREINST_H
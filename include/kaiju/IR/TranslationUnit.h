@@ -2,14 +2,23 @@
 #ifndef KAIJU_IR_TRANSLATIONUNIT_H
 #define KAIJU_IR_TRANSLATIONUNIT_H
 
-#include <map>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
+#include "kaiju/ADT/StringMap.h"
 #include "kaiju/ADT/StringRef.h"
 #include "kaiju/IR/Type.h"
 #include "kaiju/IR/Function.h"
 #include "kaiju/IR/Argument.h"
+#include "kaiju/IR/AllocaInst.h"
 #include "kaiju/IR/BinaryOperator.h"
+#include "kaiju/IR/BranchInst.h"
+#include "kaiju/IR/CmpInst.h"
+#include "kaiju/IR/LoadInst.h"
+#include "kaiju/IR/PhiNode.h"
 #include "kaiju/IR/ReturnInst.h"
+#include "kaiju/IR/StoreInst.h"
 #include "kaiju/IO/Path.h"
 #include "kaiju/IO/MemoryBuffer.h"
 
@@ -18,8 +27,8 @@ namespace kaiju {
 class TranslationUnit {
 
     // \brief This is a symbol table mapping all functions to their respective
-    // labels.
-    std::map<StringRef, Function *> FunctionSymbolTable;
+    // labels. The table owns copies of the names.
+    StringMap<Function *> FunctionSymbolTable;
 
     // \brief This is the path of this Translation Unit's file.
     Path &path;
@@ -37,12 +46,36 @@ public:
     // \brief Returns the path of this TranslationUnit
     const Path &getPath() const { return path; }
 
-    // \brief Primary way of constructing a itermediate function node.
+    // \brief Returns the functions of this TranslationUnit sorted by name,
+    // the order in which they are printed and written out.
+    std::vector<std::pair<StringRef, Function *>> getFunctions() const {
+        std::vector<std::pair<StringRef, Function *>> Fns;
+        Fns.reserve(FunctionSymbolTable.size());
+        for (const auto &Entry : FunctionSymbolTable)
+            Fns.emplace_back(Entry.getKey(), Entry.getValue());
+
+        std::sort(Fns.begin(), Fns.end(),
+                  [](const std::pair<StringRef, Function *> &L,
+                     const std::pair<StringRef, Function *> &R) {
+                      return L.first < R.first;
+                  });
+        return Fns;
+    }
+
+    // \brief Returns the function named \p Name, or null if there is none.
+    Function *getFunction(StringRef Name) const {
+        return FunctionSymbolTable.lookup(Name);
+    }
+
+    // \brief Primary way of constructing a itermediate function node. The
+    // function is entered in the symbol table, replacing any earlier one of
+    // the same name.
     Value *createFunc(Type *Result, StringRef Name) {
         assert(Result && "Type cannot be null");
 
         FunctionType *ty = FunctionType::get(Result);
         Function *fn = new Function(ty, Name);
+        FunctionSymbolTable[Name] = fn;
         return cast<Value>(fn);
     }
 
@@ -57,12 +90,11 @@ public:
         return cast<Value>(arg);
     }
 
-    // \brief Inserts a BasicBlock into a function.
+    // \brief Appends a new BasicBlock to a function. The first block created
+    // for a function is its entry block.
     Value *createBlock(Context &C, StringRef Name, Function *Fn) {
-        assert(!Fn->InstructionBody && "This function already has a body.");
-
         BasicBlock *bb = BasicBlock::get(C, Name);
-        Fn->InstructionBody = bb;
+        Fn->Blocks.push_back(bb);
         bb->Parent = Fn;
 
         return cast<Value>(bb);
@@ -73,15 +105,78 @@ public:
     Value *createBinOp(Instruction::BinaryOpTy Ty,
             Value *LHO, Value *RHO, BasicBlock *Block) {
         BinaryOperator *BinOp = BinaryOperator::get(Ty, LHO, RHO);
-        Block->InstList.push_back(BinOp);
+        Block->push_back(BinOp);
 
         return cast<Value>(BinOp);
     }
 
+    // \brief Creates a new comparison instruction inside the block specified.
+    Value *createCmp(CmpInst::Predicate Pred,
+            Value *LHO, Value *RHO, BasicBlock *Block) {
+        CmpInst *Cmp = CmpInst::get(Pred, LHO, RHO);
+        Block->push_back(Cmp);
+
+        return cast<Value>(Cmp);
+    }
+
+    // \brief Creates an unconditional branch inside the block specified.
+    Value *createBr(BasicBlock *Dest, BasicBlock *Block) {
+        BranchInst *Br = BranchInst::get(Dest);
+        Block->push_back(Br);
+
+        return cast<Value>(Br);
+    }
+
+    // \brief Creates a conditional branch inside the block specified.
+    Value *createCondBr(Value *Cond, BasicBlock *IfTrue, BasicBlock *IfFalse,
+            BasicBlock *Block) {
+        BranchInst *Br = BranchInst::get(Cond, IfTrue, IfFalse);
+        Block->push_back(Br);
+
+        return cast<Value>(Br);
+    }
+
+    // \brief Creates a stack slot holding a value of type \p Ty inside the
+    // block specified. Local variables are given a slot in the entry block
+    // and are promoted to SSA registers by promoteMemoryToRegister().
+    Value *createAlloca(Type *Ty, BasicBlock *Block, StringRef Name = "") {
+        AllocaInst *Alloca = AllocaInst::get(Ty);
+        Alloca->setName(Name);
+        Block->push_back(Alloca);
+
+        return cast<Value>(Alloca);
+    }
+
+    // \brief Creates a load of a value of type \p Ty from \p Ptr inside the
+    // block specified.
+    Value *createLoad(Type *Ty, Value *Ptr, BasicBlock *Block) {
+        LoadInst *Load = LoadInst::get(Ty, Ptr);
+        Block->push_back(Load);
+
+        return cast<Value>(Load);
+    }
+
+    // \brief Creates a store of \p Val to \p Ptr inside the block specified.
+    Value *createStore(Value *Val, Value *Ptr, BasicBlock *Block) {
+        StoreInst *Store = StoreInst::get(Val, Ptr);
+        Block->push_back(Store);
+
+        return cast<Value>(Store);
+    }
+
+    // \brief Creates a phi node with no incoming edges inside the block
+    // specified.
+    Value *createPhi(Type *Ty, BasicBlock *Block) {
+        PhiNode *Phi = PhiNode::get(Ty);
+        Block->push_back(Phi);
+
+        return cast<Value>(Phi);
+    }
+
     // \brief Creates a Return instruction inside the block specified.
     Value *createRet(Value *RetValue, BasicBlock *Block) {
         ReturnInst *Ret = ReturnInst::get(RetValue);
-        Block->InstList.push_back(Ret);
+        Block->push_back(Ret);
 
         return cast<Value>(Ret);
     }
@@ -5,6 +5,7 @@
 #include <map>
 #include <vector>
 
+#include "kaiju/IO/raw_ostream.h"
 #include "kaiju/Support/Casting.h"
 
 namespace kaiju {
@@ -66,7 +67,7 @@ protected:
 public:
     // \brief A method for dumping the contents of this function into a
     // output stream.
-    virtual std::ostream &dump(std::ostream &os) const;
+    virtual raw_ostream &dump(raw_ostream &os) const;
 
     // \brief Returns this type's context.
     const Context &getContext() const { return Ctx; }
@@ -9,6 +9,7 @@
 namespace kaiju {
 
     class Type;
+    class IdentifierInfo;
 
 class Value {
 public:
@@ -28,6 +29,7 @@ public:
 
         ConstantIntVal,
         ConstantFPVal,
+        UndefValueVal,
     };
 
 private:
@@ -41,8 +43,10 @@ private:
 
 public:
     explicit Value(Type *Ty, unsigned scid)
-         : ValueType(Ty), SubclassID(scid) { /* empty */ }
+         : ValueType(Ty), SubclassID(scid), hasName(false) { /* empty */ }
 
+    // dtor, releases this value's name binding.
+    virtual ~Value();
 
     // \brief Returns whether this Value has a named bound to it or not.
     bool hasNameBinding() const { return hasName;   }
@@ -54,6 +58,10 @@ public:
     /// it's not free.
     StringRef getName() const;
 
+    // \brief Returns the interned name of this value, null if it has none.
+    // Two values have the same name exactly when these are the same.
+    IdentifierInfo *getIdentifier() const;
+
     /// \brief Change the name of the value.
     ///
     /// Choose a new unique name if the provided name is taken.
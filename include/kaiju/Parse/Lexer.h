@@ -4,6 +4,7 @@
 
 #include "kaiju/IR/TranslationUnit.h"
 #include "kaiju/Parse/Token.h"
+#include "kaiju/Support/IdentifierTable.h"
 #include "kaiju/Support/DiagnosticBuilder.h"
 #include "kaiju/Support/Diagnostic.h"
 
@@ -21,6 +22,9 @@ class Lexer {
     // \brief This is this Lexer's DiagnosticBuilder.
     DiagnosticBuilder &Builder;
 
+    // \brief Where identifiers are interned.
+    IdentifierTable &Identifiers;
+
     const char *Start,  //< \brief The beginning of the TranslationUnit's buffer
                *End;    //< \brief The end of the TranslationUnit's buffer.
 
@@ -49,11 +53,14 @@ class Lexer {
     // \brief Scans a new character literal from this lexer's buffer.
     Token scanCharacterLiteral();
 
+    // \brief Scans an identifier or keyword from this lexer's buffer.
+    Token scanIdentifier();
+
 public:
 
     // ctor.
-    Lexer(TranslationUnit &TU, DiagnosticBuilder &DB)
-         : Unit(TU), Builder(DB) {
+    Lexer(TranslationUnit &TU, DiagnosticBuilder &DB, IdentifierTable &IT)
+         : Unit(TU), Builder(DB), Identifiers(IT) {
         Start   = Unit.getMemoryBuffer().begin();
         End     = Unit.getMemoryBuffer().end();
 
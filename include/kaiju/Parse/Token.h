@@ -4,9 +4,12 @@
 
 #include "kaiju/ADT/StringRef.h"
 #include "kaiju/IO/SourceLoc.h"
+#include "kaiju/IO/raw_ostream.h"
 
 namespace kaiju {
 
+class IdentifierInfo;
+
 namespace tok {
 
 // \brief The a token identifier paired with lexemes to create tokens.
@@ -34,9 +37,12 @@ class Token {
     // This lexeme that represents this token
     StringRef text;
 
+    // The interned name of an identifier or keyword, null for other tokens.
+    IdentifierInfo *Identifier;
+
 public:
-    Token(tok::Type type, StringRef str)
-        : Kind(type), text(str) { /* empty */ }
+    Token(tok::Type type, StringRef str, IdentifierInfo *II = nullptr)
+        : Kind(type), text(str), Identifier(II) { /* empty */ }
 
     // \brief Returns a SourceLoc from the beginning of this tokens lexeme.
     inline SourceLoc getLoc() const { return text.begin(); }
@@ -47,6 +53,9 @@ public:
     // \brief Returns this tokens lexeme.
     inline StringRef getText() const { return text; }
 
+    // \brief Returns the interned name of this identifier or keyword.
+    inline IdentifierInfo *getIdentifierInfo() const { return Identifier; }
+
     // \brief The following methods are for convientently comparing token types.
 
     bool is(tok::Type K)    const { return Kind == K; }
@@ -63,7 +72,7 @@ public:
     }
 };
 
-std::ostream &operator<<(std::ostream &os, const Token &tok);
+raw_ostream &operator<<(raw_ostream &os, const Token &tok);
 
 } // namespace kaiju
 
@@ -96,6 +96,17 @@
 #define KAIJU_PREFETCH(addr, rw, locality)
 #endif
 
+/// KAIJU_HAS_COMPUTED_GOTO - Whether labels can be used as values and jumped
+/// to with "goto *", which lets interpreters dispatch through a label table
+/// instead of a switch. Builds may define it to 0 to use the switch anyway.
+#ifndef KAIJU_HAS_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define KAIJU_HAS_COMPUTED_GOTO 1
+#else
+#define KAIJU_HAS_COMPUTED_GOTO 0
+#endif
+#endif
+
 #if __has_attribute(used) || KAIJU_GNUC_PREREQ(3, 1, 0)
 #define KAIJU_ATTRIBUTE_USED __attribute__((__used__))
 #else
@@ -299,6 +310,15 @@
 # define KAIJU_ASSUME_ALIGNED(p, a) (p)
 #endif
 
+/// \macro KAIJU_RESTRICT
+/// \brief Qualifies a pointer as the only way to reach what it points to,
+/// which lets loops over it be vectorized without overlap checks.
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+# define KAIJU_RESTRICT __restrict
+#else
+# define KAIJU_RESTRICT
+#endif
+
 /// \macro KAIJU_ALIGNAS
 /// \brief Used to specify a minimum alignment for a structure or variable.
 #if __GNUC__ && !__has_feature(cxx_alignas) && !KAIJU_GNUC_PREREQ(4, 8, 1)
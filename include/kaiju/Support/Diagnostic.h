@@ -2,12 +2,14 @@
 #ifndef KAIJU_SUPPORT_DIAGNOSTIC_H
 #define KAIJU_SUPPORT_DIAGNOSTIC_H
 
-#include <any>
 #include <cassert>
-#include <iostream>
-#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 
 #include "kaiju/ADT/StringRef.h"
+#include "kaiju/IO/SourceLoc.h"
+#include "kaiju/IO/raw_ostream.h"
 
 namespace kaiju {
 
@@ -20,9 +22,32 @@ enum ErrorID {
 #include "kaiju/Support/DiagnosticCodes.def"
 };
 
+// \brief How serious a diagnostic is, from the macro declaring it.
+enum Severity {
+    Error,
+    Warning,
+    Note,
+};
+
 // \brief Get the Diagnostic Message mapped to the specified error code.
 const char *message(ErrorID id);
 
+// \brief Returns the name the specified error code is declared with.
+const char *name(ErrorID id);
+
+// \brief Returns the severity spelled in lower case, "error" and so on.
+const char *severityName(Severity s);
+
+// \brief Returns the severity of the specified error code.
+constexpr Severity severity(ErrorID id) {
+    constexpr Severity Severities[] = {
+#define DIAGNOSTIC(DIAGTYPE, DIAGID, TEXT) \
+        DIAGTYPE,
+#include "kaiju/Support/DiagnosticCodes.def"
+    };
+    return Severities[id];
+}
+
 } // namespace err
 
 namespace detail {
@@ -37,7 +62,8 @@ enum ArgumentTypeInfo {
     VoidPointerType,
 };
 
-// \brief Union wrapper.
+// \brief Tagged union holding one argument of a Diagnostic. Arguments are
+// trivially copyable, strings are referenced, not copied.
 struct Argument {
     ArgumentTypeInfo type_info;
 
@@ -47,87 +73,234 @@ struct Argument {
         char        signed_char;
         unsigned char unsigned_char;
         StringRef   string_ref;
-        void *      void_pointer;
+        const void *void_pointer;
     };
 
-    Argument()
-         : type_info(VoidPointerType),
-           void_pointer(nullptr) { }
+    constexpr Argument()
+         : type_info(VoidPointerType), void_pointer(nullptr) { }
 
-    Argument(Argument &other)
-         : type_info(other.type_info),
-           void_pointer(nullptr) {
-    }
+    constexpr Argument(char value)
+         : type_info(SignedCharType), signed_char(value) { }
 
-    Argument(char value)
-         : type_info(SignedCharType),
-           signed_char(value) { }
+    constexpr Argument(unsigned char value)
+         : type_info(UnsignedCharType), unsigned_char(value) { }
+
+    constexpr Argument(int value)
+         : type_info(SignedIntType), signed_integer(value) { }
+
+    constexpr Argument(long value)
+         : type_info(SignedIntType), signed_integer(value) { }
+
+    constexpr Argument(long long value)
+         : type_info(SignedIntType), signed_integer(value) { }
+
+    constexpr Argument(unsigned value)
+         : type_info(UnsignedIntType), unsigned_integer(value) { }
+
+    constexpr Argument(unsigned long value)
+         : type_info(UnsignedIntType), unsigned_integer(value) { }
+
+    constexpr Argument(unsigned long long value)
+         : type_info(UnsignedIntType), unsigned_integer(value) { }
 
     Argument(StringRef value)
-         : type_info(StringRefType),
-           string_ref(value) { }
+         : type_info(StringRefType), string_ref(value) { }
+
+    Argument(const char *value)
+         : type_info(StringRefType), string_ref(value) { }
+
+    constexpr Argument(const void *value)
+         : type_info(VoidPointerType), void_pointer(value) { }
 };
 
-// \brief Template specialization for a cast to integral types.
-template<typename T,
-    typename = std::enable_if<std::is_integral<T>::value>>
-T cast_argument(Argument &val);
+// \brief Writes the value of \p val.
+raw_ostream &operator<<(raw_ostream &os, const Argument &val);
+
+// \brief The most arguments a Diagnostic can carry.
+constexpr std::size_t MaxArguments = 4;
+
+// \brief The most pieces a diagnostic message can be split into.
+constexpr std::size_t MaxFormatPieces = 16;
+
+// \brief A run of literal text of a diagnostic message, or the slot of an
+// argument when Arg is not negative.
+struct FormatPiece {
+    uint16_t Begin;
+    uint16_t Length;
+    int8_t Arg;
+};
+
+// \brief A diagnostic message split into its pieces, with the number of
+// arguments it takes.
+struct FormatString {
+    const char *Text;
+    uint8_t NumPieces;
+    uint8_t Arity;
+    FormatPiece Pieces[MaxFormatPieces];
+};
+
+// \brief Called while parsing a malformed message, which is not allowed in
+// a constant expression and so fails the build.
+void invalidFormat(const char *Reason);
+
+// \brief Splits \p Text at its placeholders, %0 to %3 for the arguments and
+// %% for a percent sign.
+constexpr FormatString parseFormat(const char *Text) {
+    FormatString F = {};
+    F.Text = Text;
+
+    std::size_t Begin = 0, i = 0;
+    auto addPiece = [&](std::size_t B, std::size_t L, int A) {
+        if (F.NumPieces == MaxFormatPieces)
+            invalidFormat("too many pieces in a diagnostic message.");
+        F.Pieces[F.NumPieces++] = FormatPiece { uint16_t(B), uint16_t(L),
+                                                int8_t(A) };
+    };
+
+    for (; Text[i]; ++i) {
+        if (Text[i] != '%')
+            continue;
+
+        if (i != Begin)
+            addPiece(Begin, i - Begin, -1);
+
+        char C = Text[i + 1];
+        if (C == '%') {
+            // The second percent sign starts the next literal.
+            Begin = ++i;
+            continue;
+        }
+
+        if (C < '0' || C >= char('0' + MaxArguments))
+            invalidFormat("bad placeholder in a diagnostic message.");
+
+        addPiece(0, 0, C - '0');
+        if (std::size_t(C - '0') >= F.Arity)
+            F.Arity = C - '0' + 1;
+        Begin = ++i + 1;
+    }
+
+    if (i != Begin)
+        addPiece(Begin, i - Begin, -1);
+    return F;
+}
+
+// \brief Returns the value of \p val, which must hold a T.
+template<typename T>
+T cast_argument(const Argument &val);
+
+template<>
+int64_t cast_argument<int64_t>(const Argument &val);
 
-// \brief Signed character specialization.
 template<>
-char cast_argument<char>(Argument &val);
+uint64_t cast_argument<uint64_t>(const Argument &val);
 
-// \brief Casts to strings.
 template<>
-std::string cast_argument<std::string>(Argument &val);
+char cast_argument<char>(const Argument &val);
+
+template<>
+StringRef cast_argument<StringRef>(const Argument &val);
 
 } // namespace detail
 
+namespace err {
+
+// \brief The messages of all diagnostics, split at compile time.
+inline constexpr detail::FormatString Formats[] = {
+#define DIAGNOSTIC(DIAGTYPE, DIAGID, TEXT) \
+    detail::parseFormat(TEXT),
+#include "kaiju/Support/DiagnosticCodes.def"
+};
+
+// \brief Returns the number of arguments the message of \p id takes.
+constexpr unsigned arity(ErrorID id) { return Formats[id].Arity; }
+
+} // namespace err
+
 // Class Diagnostic
 //
 // \brief Diagnostic is runtime diagnostic interface. It stores metadata on a
 // enumerated error message.
 //
+// The arguments are stored inline, so a Diagnostic is a small trivially
+// copyable value which never allocates. The number of arguments comes from
+// the argument pack of the constructor and is checked against the capacity
+// at compile time.
+//
 class Diagnostic final {
-    friend class DiagnosticBuilder;
+public:
+    // \brief The most arguments a Diagnostic can carry.
+    static const std::size_t MaxArguments = detail::MaxArguments;
 
+private:
     // \brief The identifier mapped to static data that pertains to this Diagnostic.
     err::ErrorID ErrorCode;
 
+    // \brief Where in the buffer of its TranslationUnit this Diagnostic was
+    // reported, null if nowhere in particular.
+    const char *Loc;
+
+    // \brief The range of source this Diagnostic is about, underlined when
+    // it is shown, both null if there is none.
+    const char *RangeBegin;
+    const char *RangeEnd;
+
+    // \brief The number of arguments stored in this class.
+    uint8_t NoArgs;
+
     // \brief Arguments to be passed with this Diagnostic.
-    detail::Argument *Arguments;
-    std::size_t NoArgs; //< \brief The number of arguments stored in this class.
-
-    // \brief Dispatch constructor for handling parameter packs.
-	template <typename T, typename... Ts>
-	void disptach(int i, T&& v, Ts&&... Args) {
-		Arguments[i] = std::forward<T>(v);
-		dispatch(++i, std::forward<Ts>(Args)...);
-        NoArgs++;
-    }
-    void dispatch(int) { /* empty */ }
+    detail::Argument Arguments[MaxArguments];
 
 public:
-
     // ctor.
     template <typename... Ts>
-    Diagnostic(err::ErrorID errorc, Ts&&... Args) : ErrorCode(errorc) {
-        Arguments = new detail::Argument[10];
-        disptach(0, std::forward<Ts>(Args)...);
+    Diagnostic(err::ErrorID errorc, SourceLoc loc, Ts&&... Args)
+         : ErrorCode(errorc), Loc(loc.get()),
+           RangeBegin(nullptr), RangeEnd(nullptr), NoArgs(sizeof...(Ts)),
+           Arguments{ detail::Argument(std::forward<Ts>(Args))... } {
+        static_assert(sizeof...(Ts) <= MaxArguments,
+                      "too many arguments for a Diagnostic.");
+        assert(sizeof...(Ts) == err::arity(errorc)
+            && "wrong number of arguments for the diagnostic message.");
     }
 
-    Diagnostic(err::ErrorID errorc)
-         : ErrorCode(errorc) { }
-
     // \brief Get the argument stored at the index specified.
-    detail::Argument &getArgument(std::size_t i) const {
-        assert(i >= 0 && i <= NoArgs
-            && "bounds checking error. in getArgument");
+    const detail::Argument &getArgument(std::size_t i) const {
+        assert(i < NoArgs && "bounds checking error. in getArgument");
         return Arguments[i];
     }
 
+    // \brief Returns the number of arguments of this Diagnostic.
+    std::size_t getNumArguments() const { return NoArgs; }
+
     // \brief Get the ID of this Diagnostic.
     err::ErrorID getErrorCode() const { return ErrorCode; }
+
+    // \brief Returns the severity of this Diagnostic.
+    err::Severity getSeverity() const { return err::severity(ErrorCode); }
+
+    // \brief Returns where this Diagnostic was reported.
+    SourceLoc getLoc() const { return Loc; }
+
+    // \brief Sets the range of source this Diagnostic is about.
+    Diagnostic &setRange(const SourceRange &R) {
+        RangeBegin = R.begin().get();
+        RangeEnd = R.end().get();
+        return *this;
+    }
+
+    // \brief Returns whether this Diagnostic has a range.
+    bool hasRange() const { return RangeBegin != nullptr; }
+
+    // \brief Returns the range of this Diagnostic, which must have one.
+    SourceRange getRange() const {
+        assert(hasRange() && "diagnostic without a range.");
+        return SourceRange(RangeBegin, RangeEnd);
+    }
+
+    // \brief Writes the message of this Diagnostic with its arguments, in a
+    // single pass over the pieces of the message.
+    void print(raw_ostream &os) const;
 };
 
 } // namespace kaiju
@@ -4,8 +4,10 @@
 
 #include "kaiju/IR/TranslationUnit.h"
 #include "kaiju/Support/Diagnostic.h"
+#include "kaiju/Support/DiagnosticEngine.h"
 
 #include <cassert>
+#include <optional>
 
 namespace kaiju {
 
@@ -18,37 +20,41 @@ class DiagnosticBuilder {
     // \brief The TranslationUnit context this class is emitting errors from.
     TranslationUnit &Unit;
 
-    // \brief The current Diagnostic that is in-flight.
-    Diagnostic *Diag;
+    // \brief Where flushed diagnostics are reported to.
+    DiagnosticEngine &Engine;
 
-    // \brief Whether a diagnostic is in-flight or not.
-    bool hasDiag;
+    // \brief The current Diagnostic that is in-flight, built in place.
+    std::optional<Diagnostic> Diag;
 
 public:
 
     // ctor.
-    DiagnosticBuilder(TranslationUnit &TU)
-         : Unit(TU) {
-        Diag = nullptr;
-        hasDiag = false;
+    DiagnosticBuilder(TranslationUnit &TU, DiagnosticEngine &E)
+         : Unit(TU), Engine(E) { /* empty */ }
+
+    // \brief Creates a new Diagnostic and puts it in-flight, replacing any
+    // earlier one, reported at \p Loc. The arguments must match the
+    // placeholders of the message of \p ID.
+    template <err::ErrorID ID, typename... Ts>
+    Diagnostic &create(SourceLoc Loc, Ts&&... Args) {
+        static_assert(sizeof...(Ts) == err::arity(ID),
+                      "wrong number of arguments for the diagnostic message.");
+        return Diag.emplace(ID, Loc, std::forward<Ts>(Args)...);
     }
 
-    // \brief Creates a new Diagnostic and puts it in-flight.
-    template <typename... Ts>
-    Diagnostic *create(err::ErrorID errorc, Ts&&... Args) {
-        Diagnostic *diag = new Diagnostic(errorc, Args...);
-        hasDiag = true;
-        Diag = diag;
-        return diag;
+    // \brief Get's the current diagnostic if there is one in-flight.
+    Diagnostic &getDiagnostic() {
+        assert(Diag && "No Diagnostic in-flight to retrieve.");
+        return *Diag;
     }
 
-    // \brief Get's the current diagnostic if there is one in-flight.
-    Diagnostic *getDiagnostic() const {
-        assert(hasDiag && "No Diagnostic in-flight to retrieve.");
-        return Diag;
+    // \brief Returns whether the engine has seen as many errors as it will
+    // emit, so there is no point in going on.
+    bool hasReachedErrorLimit() const {
+        return Engine.hasReachedErrorLimit();
     }
 
-    // \brief Flush the current diagnostic in-flight.
+    // \brief Flush the current diagnostic in-flight to the engine.
     void flush();
 };
 
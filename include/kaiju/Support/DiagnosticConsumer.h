@@ -0,0 +1,113 @@
+
+#ifndef KAIJU_SUPPORT_DIAGNOSTICCONSUMER_H
+#define KAIJU_SUPPORT_DIAGNOSTICCONSUMER_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "kaiju/IO/LineIndex.h"
+#include "kaiju/IO/raw_ostream.h"
+#include "kaiju/IR/TranslationUnit.h"
+#include "kaiju/Support/Diagnostic.h"
+
+namespace kaiju {
+
+// Class DiagnosticConsumer
+//
+// \brief The interface through which diagnostics leave the compiler, to a
+// terminal, a file or a tool.
+//
+class DiagnosticConsumer {
+    // \brief The lines of the buffer diagnostics were last reported in.
+    // Diagnostics arrive sorted by file, so each buffer is indexed once.
+    std::optional<LineIndex> Lines;
+
+protected:
+    // \brief Returns the line index of the buffer of \p Unit.
+    LineIndex &getLineIndex(const TranslationUnit &Unit);
+
+public:
+    // dtor.
+    virtual ~DiagnosticConsumer();
+
+    // \brief Handles the diagnostic \p D, reported in \p Unit.
+    virtual void handleDiagnostic(const TranslationUnit &Unit,
+                                  const Diagnostic &D) = 0;
+
+    // \brief Called once no more diagnostics follow for now, so buffered
+    // output can be written out.
+    virtual void finish() { /* empty */ }
+};
+
+// Class TextDiagnosticPrinter
+//
+// \brief Prints diagnostics as text, followed by the line of source they
+// were reported on with a caret under the location and its range underlined.
+//
+// Lines are collected in the buffer of the stream and go out in large
+// writes, on finish() or once the buffer fills up. Whether to color the
+// output is decided once, from the stream.
+//
+class TextDiagnosticPrinter : public DiagnosticConsumer {
+    raw_ostream &OS;
+    bool UseColors;
+    bool ShowCarets;
+
+    // \brief Writes the line of \p D and the caret line under it.
+    void printSnippet(const TranslationUnit &Unit, const Diagnostic &D);
+
+public:
+    // ctor. Snippets of source are left out unless \p showCarets.
+    explicit TextDiagnosticPrinter(raw_ostream &os, bool showCarets = true)
+         : OS(os), UseColors(os.has_colors()),
+           ShowCarets(showCarets) { /* empty */ }
+
+    // dtor. Flushes the stream.
+    ~TextDiagnosticPrinter() override;
+
+    void handleDiagnostic(const TranslationUnit &Unit,
+                          const Diagnostic &D) override;
+
+    void finish() override { OS.flush(); }
+};
+
+// Class JSONDiagnosticPrinter
+//
+// \brief Streams diagnostics as JSON lines, one object per diagnostic, for
+// tools which would otherwise have to parse the text output.
+//
+// Each object holds the code, name and severity of the diagnostic, the file,
+// byte offset, line and column where it was reported when it has a
+// location, the formatted message and the raw arguments, for example
+//
+//   {"code":"ERR0000","name":"lex_malformed_character","severity":"error",
+//    "file":"a.kj","offset":4,"line":1,"column":5,
+//    "message":"malformed character '$' found.","args":["$"]}
+//
+// without the line break.
+//
+class JSONDiagnosticPrinter : public DiagnosticConsumer {
+    raw_ostream &OS;
+
+    // \brief Holds the message while it is formatted, reused so printing
+    // does not allocate once it has grown.
+    std::string Message;
+
+public:
+    // ctor.
+    explicit JSONDiagnosticPrinter(raw_ostream &os) : OS(os) { /* empty */ }
+
+    // dtor. Flushes the stream.
+    ~JSONDiagnosticPrinter() override;
+
+    void handleDiagnostic(const TranslationUnit &Unit,
+                          const Diagnostic &D) override;
+
+    void finish() override { OS.flush(); }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_SUPPORT_DIAGNOSTICCONSUMER_H
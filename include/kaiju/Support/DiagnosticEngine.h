@@ -0,0 +1,86 @@
+
+#ifndef KAIJU_SUPPORT_DIAGNOSTICENGINE_H
+#define KAIJU_SUPPORT_DIAGNOSTICENGINE_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "kaiju/IR/TranslationUnit.h"
+#include "kaiju/Support/Diagnostic.h"
+#include "kaiju/Support/DiagnosticConsumer.h"
+
+namespace kaiju {
+
+// Class DiagnosticEngine
+//
+// \brief Collects the diagnostics of any number of threads and hands them to
+// a DiagnosticConsumer in a deterministic order.
+//
+// Every thread reporting to an engine gets a queue of its own, registered
+// with a compare-and-swap on first use, so reporting takes no lock. At the
+// end of a phase, once the reporting threads are done, emitDiagnostics()
+// sorts what was reported by file, offset and content, which makes the
+// output the same for any number of threads. Errors are counted atomically
+// so workers can stop early once the error limit is reached.
+//
+class DiagnosticEngine {
+    struct ThreadQueue;
+
+    // \brief Where diagnostics are emitted to.
+    DiagnosticConsumer &Consumer;
+
+    // \brief The number of errors after which to stop, 0 for no limit.
+    unsigned ErrorLimit;
+
+    // \brief Identifies this engine in the queue caches of threads, unlike
+    // its address, which a later engine may reuse.
+    uint64_t ID;
+
+    // \brief The queues of all threads which have reported, newest first.
+    std::atomic<ThreadQueue *> Queues;
+
+    // \brief The number of errors reported so far.
+    std::atomic<unsigned> NumErrors;
+
+    // \brief The number of errors handed to the consumer so far, only
+    // touched by emitDiagnostics().
+    unsigned NumEmittedErrors;
+
+    // \brief Returns the queue of the calling thread, registering one if it
+    // has none yet.
+    ThreadQueue &getQueue();
+
+public:
+    // ctor.
+    explicit DiagnosticEngine(DiagnosticConsumer &C, unsigned errorLimit = 0);
+
+    DiagnosticEngine(const DiagnosticEngine &) = delete;
+    DiagnosticEngine &operator=(const DiagnosticEngine &) = delete;
+
+    // dtor. Diagnostics not emitted yet are dropped.
+    ~DiagnosticEngine();
+
+    // \brief Records \p D, reported in \p Unit. Safe to call from any
+    // thread; nothing is emitted until emitDiagnostics().
+    void report(const TranslationUnit &Unit, const Diagnostic &D);
+
+    // \brief Returns the number of errors reported so far.
+    unsigned getNumErrors() const {
+        return NumErrors.load(std::memory_order_relaxed);
+    }
+
+    // \brief Returns whether as many errors as the limit allows have been
+    // reported, after which work may as well stop.
+    bool hasReachedErrorLimit() const {
+        return ErrorLimit && getNumErrors() >= ErrorLimit;
+    }
+
+    // \brief Sorts the diagnostics reported since the last call and hands
+    // them to the consumer, up to the error limit, then finishes it. Must
+    // not run concurrently with report().
+    void emitDiagnostics();
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_SUPPORT_DIAGNOSTICENGINE_H
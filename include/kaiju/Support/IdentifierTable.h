@@ -0,0 +1,112 @@
+
+#ifndef KAIJU_SUPPORT_IDENTIFIERTABLE_H
+#define KAIJU_SUPPORT_IDENTIFIERTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "kaiju/ADT/DenseMap.h"
+#include "kaiju/ADT/StringRef.h"
+#include "kaiju/Parse/Token.h"
+
+namespace kaiju {
+
+class IdentifierTable;
+
+// Class IdentifierInfo
+//
+// \brief The one copy of an identifier, shared by every use of it.
+//
+// An IdentifierInfo is created once per distinct name and never moves or
+// goes away while its table lives, so two names are equal exactly when
+// their IdentifierInfos are the same, and tables keyed by name can hash
+// the pointer. Whether the name is a keyword is decided when it is
+// interned.
+//
+class IdentifierInfo {
+    friend class IdentifierTable;
+
+    // \brief The number of characters of the name, stored after this.
+    uint32_t Length;
+
+    // \brief The kind of token this name lexes as, tok::identifier unless
+    // it is a keyword.
+    tok::Type TokenKind;
+
+    // ctor.
+    IdentifierInfo(uint32_t length, tok::Type kind)
+         : Length(length), TokenKind(kind) { /* empty */ }
+
+public:
+    IdentifierInfo(const IdentifierInfo &) = delete;
+    IdentifierInfo &operator=(const IdentifierInfo &) = delete;
+
+    // \brief Returns the name, which is null terminated.
+    StringRef getName() const {
+        return StringRef(reinterpret_cast<const char *>(this + 1), Length);
+    }
+
+    // \brief Returns the kind of token this name lexes as.
+    tok::Type getTokenKind() const { return TokenKind; }
+
+    // \brief Returns whether this name is a keyword.
+    bool isKeyword() const { return TokenKind != tok::identifier; }
+};
+
+// Class IdentifierTable
+//
+// \brief Interns names, handing out one IdentifierInfo per distinct name.
+//
+// Names are copied once into large slabs owned by the table, so interning
+// allocates rarely and the table does not depend on the buffer a name was
+// read from. The keywords of TokenTypes.def are interned up front.
+//
+class IdentifierTable {
+    // \brief Every name interned so far, keyed by the copy in the slabs.
+    DenseMap<StringRef, IdentifierInfo *> Names;
+
+    // \brief The slabs identifiers are allocated from.
+    std::vector<char *> Slabs;
+    char *SlabCur;
+    char *SlabEnd;
+
+    // \brief The size of a slab, larger names get one of their own.
+    static const std::size_t SlabSize = 16 * 1024;
+
+    // \brief Allocates \p Size bytes aligned for an IdentifierInfo.
+    void *allocate(std::size_t Size);
+
+    // \brief Interns \p Name as a token of the given kind.
+    IdentifierInfo &create(StringRef Name, tok::Type Kind);
+
+public:
+    // ctor. Interns the keywords.
+    IdentifierTable();
+
+    IdentifierTable(const IdentifierTable &) = delete;
+    IdentifierTable &operator=(const IdentifierTable &) = delete;
+
+    // dtor. Frees every IdentifierInfo.
+    ~IdentifierTable();
+
+    // \brief Returns the IdentifierInfo of \p Name, interning it on first
+    // use.
+    IdentifierInfo &get(StringRef Name) {
+        auto It = Names.find(Name);
+        if (It != Names.end())
+            return *It->second;
+        return create(Name, tok::identifier);
+    }
+
+    // \brief Returns the IdentifierInfo of \p Name if it has been interned,
+    // null otherwise.
+    IdentifierInfo *lookup(StringRef Name) const { return Names.lookup(Name); }
+
+    // \brief Returns the number of distinct names interned.
+    unsigned size() const { return Names.size(); }
+};
+
+} // namespace kaiju
+
+#endif // KAIJU_SUPPORT_IDENTIFIERTABLE_H
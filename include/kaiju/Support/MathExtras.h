@@ -0,0 +1,107 @@
+
+#ifndef KAIJU_SUPPORT_MATHEXTRAS_H
+#define KAIJU_SUPPORT_MATHEXTRAS_H
+
+#include <cassert>
+#include <cstdint>
+
+#include "kaiju/Support/Compiler.h"
+
+namespace kaiju {
+
+// \brief Storage type wide enough to hold every IntegerType value (up to
+// 128 bits). Values narrower than 128 bits are kept zero-extended.
+KAIJU_EXTENSION typedef unsigned __int128 uint128_t;
+KAIJU_EXTENSION typedef __int128 int128_t;
+
+// \brief Returns a mask with the low \p Width bits set.
+inline uint128_t maskTrailingOnes(unsigned Width) {
+    assert(Width <= 128 && "integer width out of range.");
+    return Width == 128 ? ~uint128_t(0)
+                        : (uint128_t(1) << Width) - 1;
+}
+
+// \brief Truncates \p V to \p Width bits.
+inline uint128_t truncateToWidth(uint128_t V, unsigned Width) {
+    return V & maskTrailingOnes(Width);
+}
+
+// \brief Interprets the low \p Width bits of \p V as a two's complement
+// number and sign extends it to 128 bits.
+inline int128_t signExtend(uint128_t V, unsigned Width) {
+    assert(Width > 0 && Width <= 128 && "integer width out of range.");
+    unsigned Shift = 128 - Width;
+    return static_cast<int128_t>(V << Shift) >> Shift;
+}
+
+// \brief Returns whether the sign bit of a \p Width bit value is set.
+inline bool isNegative(uint128_t V, unsigned Width) {
+    return (V >> (Width - 1)) & 1;
+}
+
+// \brief Returns whether \p V is a non-zero power of two.
+inline bool isPowerOf2(uint128_t V) {
+    return V && !(V & (V - 1));
+}
+
+// \brief Returns the number of trailing zero bits in \p V, or 128 if \p V is
+// zero.
+inline unsigned countTrailingZeros(uint128_t V) {
+    if (!V)
+        return 128;
+
+    uint64_t Lo = static_cast<uint64_t>(V);
+    if (Lo)
+        return __builtin_ctzll(Lo);
+    return 64 + __builtin_ctzll(static_cast<uint64_t>(V >> 64));
+}
+
+// \brief Returns the floor log base 2 of a power of two.
+inline unsigned log2(uint128_t V) {
+    assert(isPowerOf2(V) && "log2 of a non power of two.");
+    return countTrailingZeros(V);
+}
+
+// \brief Returns the high \p Width bits of the 2 * \p Width bit unsigned
+// product of \p A and \p B. Both operands must be zero-extended.
+inline uint128_t mulHighUnsigned(uint128_t A, uint128_t B, unsigned Width) {
+    if (Width <= 64)
+        return (A * B) >> Width;
+
+    // Schoolbook multiplication on 64-bit halves to recover the upper half of
+    // the 256-bit product.
+    uint128_t ALo = static_cast<uint64_t>(A), AHi = A >> 64;
+    uint128_t BLo = static_cast<uint64_t>(B), BHi = B >> 64;
+
+    uint128_t LL = ALo * BLo, LH = ALo * BHi;
+    uint128_t HL = AHi * BLo, HH = AHi * BHi;
+
+    uint128_t Mid = (LL >> 64) + static_cast<uint64_t>(LH)
+                  + static_cast<uint64_t>(HL);
+    uint128_t Lo = (Mid << 64) | static_cast<uint64_t>(LL);
+    uint128_t Hi = HH + (LH >> 64) + (HL >> 64) + (Mid >> 64);
+
+    if (Width == 128)
+        return Hi;
+
+    unsigned Shift = Width;
+    return truncateToWidth((Lo >> Shift) | (Hi << (128 - Shift)), Width);
+}
+
+// \brief Returns the high \p Width bits of the 2 * \p Width bit signed
+// product of \p A and \p B. Operands are \p Width bit two's complement values.
+inline uint128_t mulHighSigned(uint128_t A, uint128_t B, unsigned Width) {
+    uint128_t Hi = mulHighUnsigned(A, B, Width);
+
+    // mulhs(a, b) = mulhu(a, b) - (a < 0 ? b : 0) - (b < 0 ? a : 0).
+    if (isNegative(A, Width))
+        Hi -= B;
+    if (isNegative(B, Width))
+        Hi -= A;
+
+    return truncateToWidth(Hi, Width);
+}
+
+} // namespace kaiju
+
+#endif // KAIJU_SUPPORT_MATHEXTRAS_H
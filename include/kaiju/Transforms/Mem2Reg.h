@@ -0,0 +1,21 @@
+
+#ifndef KAIJU_TRANSFORMS_MEM2REG_H
+#define KAIJU_TRANSFORMS_MEM2REG_H
+
+#include "kaiju/IR/Function.h"
+
+namespace kaiju {
+
+// \brief Promotes stack slots to SSA registers.
+//
+// Every alloca in the entry block whose address is only used by loads and
+// stores of its allocated type is removed. Phi nodes are placed at the
+// iterated dominance frontier of the blocks storing to the slot, pruned to
+// the blocks where the slot is live, and loads are replaced by the reaching
+// definition in a single walk over the dominator tree. Loads that no store
+// reaches read an UndefValue. Returns whether the function was changed.
+bool promoteMemoryToRegister(Function &Fn);
+
+} // namespace kaiju
+
+#endif // KAIJU_TRANSFORMS_MEM2REG_H
@@ -0,0 +1,21 @@
+
+#ifndef KAIJU_TRANSFORMS_REASSOCIATE_H
+#define KAIJU_TRANSFORMS_REASSOCIATE_H
+
+#include "kaiju/IR/Function.h"
+
+namespace kaiju {
+
+// \brief Reassociates chains of integer Add, Mul and And operations in \p Fn.
+//
+// Each expression tree of a single associative and commutative opcode is
+// flattened into its leaves, constant leaves are folded together, and the
+// remaining leaves are recombined into a tree whose depth is logarithmic in
+// the number of leaves. Leaves that become available earlier (lower rank) are
+// combined first so independent operations can execute in parallel.
+// Returns whether the function was changed.
+bool reassociate(Function &Fn);
+
+} // namespace kaiju
+
+#endif // KAIJU_TRANSFORMS_REASSOCIATE_H
@@ -0,0 +1,21 @@
+
+#ifndef KAIJU_TRANSFORMS_SCCP_H
+#define KAIJU_TRANSFORMS_SCCP_H
+
+#include "kaiju/IR/Function.h"
+
+namespace kaiju {
+
+// \brief Sparse conditional constant propagation.
+//
+// Propagates constant lattice values along SSA def-use edges and block
+// reachability along CFG edges at the same time, so values computed only on
+// paths that can never execute do not pessimize the result. Once solved,
+// instructions proven constant are replaced, conditional branches on constant
+// conditions become unconditional, and blocks that can never execute are
+// deleted. Returns whether the function was changed.
+bool runSCCP(Function &Fn);
+
+} // namespace kaiju
+
+#endif // KAIJU_TRANSFORMS_SCCP_H
@@ -0,0 +1,41 @@
+
+#ifndef KAIJU_TRANSFORMS_STRENGTHREDUCTION_H
+#define KAIJU_TRANSFORMS_STRENGTHREDUCTION_H
+
+#include "kaiju/IR/Function.h"
+#include "kaiju/Support/MathExtras.h"
+
+namespace kaiju {
+
+// \brief Magic number for unsigned division by a constant. The quotient is
+// mulhu(x, Multiplier) >> Shift, unless NeedsAdd is set in which case it is
+// (((x - t) >> 1) + t) >> (Shift - 1) with t = mulhu(x, Multiplier).
+struct UnsignedMagic {
+    uint128_t Multiplier;
+    bool NeedsAdd;
+    unsigned Shift;
+};
+
+// \brief Magic number for signed division by a constant, see
+// "Hacker's Delight", chapter 10.
+struct SignedMagic {
+    uint128_t Multiplier;
+    unsigned Shift;
+};
+
+// \brief Computes the magic number for unsigned division of a \p Width bit
+// integer by \p Divisor, which must be greater than one.
+UnsignedMagic computeUnsignedMagic(uint128_t Divisor, unsigned Width);
+
+// \brief Computes the magic number for signed division of a \p Width bit
+// integer by \p Divisor, whose magnitude must be greater than one.
+SignedMagic computeSignedMagic(uint128_t Divisor, unsigned Width);
+
+// \brief Rewrites integer multiplications, divisions and remainders by
+// constants in \p Fn into cheaper shift, mask and multiply-high sequences.
+// Returns whether the function was changed.
+bool reduceStrength(Function &Fn);
+
+} // namespace kaiju
+
+#endif // KAIJU_TRANSFORMS_STRENGTHREDUCTION_H
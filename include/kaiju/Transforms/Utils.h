@@ -0,0 +1,31 @@
+
+#ifndef KAIJU_TRANSFORMS_UTILS_H
+#define KAIJU_TRANSFORMS_UTILS_H
+
+#include <map>
+#include <vector>
+
+#include "kaiju/IR/Function.h"
+
+namespace kaiju {
+
+// \brief Maps values that are being replaced to their replacement.
+using ValueReplacementMap = std::map<Value *, Value *>;
+
+// \brief Returns the value \p V is finally replaced with in \p Replacements,
+// following chains of replacements, or \p V if it is not being replaced.
+Value *getReplacement(const ValueReplacementMap &Replacements, Value *V);
+
+// \brief Rewrites every operand of every instruction in \p Fn according to
+// \p Replacements. Chains of replacements (a -> b, b -> c) are followed to
+// their end. This is a single sweep over the function, so passes should batch
+// their replacements rather than calling this once per value.
+void replaceAllUsesWith(Function &Fn, const ValueReplacementMap &Replacements);
+
+// \brief Unlinks and deletes every instruction in \p Dead, sweeping each
+// affected block once. Uses must have been rewritten beforehand.
+void eraseInstructions(const std::vector<Instruction *> &Dead);
+
+} // namespace kaiju
+
+#endif // KAIJU_TRANSFORMS_UTILS_H
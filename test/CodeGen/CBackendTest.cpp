@@ -0,0 +1,66 @@
+
+#include "kaiju/CodeGen/CBackend.h"
+
+using namespace kaiju;
+
+#include <cstdio>
+#include <string>
+
+#include "kaiju/IR/IR.h"
+#include "kaiju/IR/IRParser.h"
+
+namespace {
+
+// \brief Functions whose names would clash with each other, with C or with
+// the helpers of the output if they were only made legal identifiers.
+const char *const Names[][2] = {
+    { "f.x",          "f_2Ex" },
+    { "f_x",          "f__x" },
+    { "int",          "kaiju_fn_int" },
+    { "main",         "kaiju_fn_main" },
+    { "sqrtf",        "kaiju_fn_sqrtf" },
+    { "kaiju_sext32", "kaiju_fn_kaiju__sext32" },
+    { "_x",           "kaiju_fn___x" },
+    { "1x",           "kaiju_fn_1x" },
+    { "f",            "f" },
+};
+
+int fail(const char *Message, const std::string &Output) {
+    std::fprintf(stderr, "CBackendTest: %s\n%s", Message, Output.c_str());
+    return 1;
+}
+
+} // end anonymous namespace
+
+int main() {
+    std::string source;
+    for (const auto &Name : Names)
+        source += std::string("define i32 @\"") + Name[0] + "\"(i32 %a) {\n"
+                  "entry:\n"
+                  "  ret i32 %a\n"
+                  "}\n";
+
+    Context &C = getGlobalContext();
+    Path path("names");
+    MemoryBuffer buffer(nullptr, nullptr);
+    TranslationUnit unit(path, buffer);
+
+    std::string error;
+    if (!parseIR(source, unit, C, error))
+        return fail(error.c_str(), source);
+
+    std::string output;
+    {
+        raw_string_ostream os(output);
+        emitC(unit, os);
+    }
+
+    for (const auto &Name : Names) {
+        std::string definition = std::string("uint32_t ") + Name[1] + "(";
+        if (output.find(definition) == std::string::npos)
+            return fail(("no function " + std::string(Name[1])).c_str(),
+                        output);
+    }
+
+    return 0;
+}
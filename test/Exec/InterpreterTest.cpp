@@ -0,0 +1,77 @@
+
+#include "kaiju/Exec/Interpreter.h"
+
+using namespace kaiju;
+
+#include <cstdio>
+#include <string>
+
+#include "kaiju/IR/IR.h"
+#include "kaiju/IR/IRParser.h"
+
+// Every handler of the interpreter must end by dispatching the next
+// instruction, however it dispatches. Run this test against an interpreter
+// built with -DKAIJU_HAS_COMPUTED_GOTO=0 as well as the default, so the
+// switch taken where labels are not values is covered too.
+
+namespace {
+
+// \brief Doubles 1 until %n iterations are done, through branches, phi
+// copies and arithmetic, and divides at the end.
+const char *const Source =
+    "define i32 @pow2(i32 %n) {\n"
+    "entry:\n"
+    "  br label %loop\n"
+    "loop:\n"
+    "  %i = phi i32 [ 0, %entry ], [ %i2, %loop ]\n"
+    "  %x = phi i32 [ 1, %entry ], [ %x2, %loop ]\n"
+    "  %x2 = mul i32 %x, 2\n"
+    "  %i2 = add i32 %i, 1\n"
+    "  %c = icmp ult i32 %i2, %n\n"
+    "  br i1 %c, label %loop, label %exit\n"
+    "exit:\n"
+    "  ret i32 %x2\n"
+    "}\n"
+    "define i32 @div(i32 %a, i32 %b) {\n"
+    "entry:\n"
+    "  %q = udiv i32 %a, %b\n"
+    "  %r = sub i32 %q, 1\n"
+    "  ret i32 %r\n"
+    "}\n";
+
+int fail(const char *Message) {
+    std::fprintf(stderr, "InterpreterTest: %s\n", Message);
+    return 1;
+}
+
+} // end anonymous namespace
+
+int main() {
+    Context &C = getGlobalContext();
+    Path path("interpreter");
+    MemoryBuffer buffer(nullptr, nullptr);
+    TranslationUnit unit(path, buffer);
+
+    std::string error;
+    if (!parseIR(Source, unit, C, error))
+        return fail(error.c_str());
+
+    GenericValue result;
+    Interpreter pow2(*unit.getFunction("pow2"));
+    if (!pow2.run({ GenericValue::getInt(4) }, result))
+        return fail("pow2 trapped.");
+    if (result.IntVal != 16)
+        return fail("pow2(4) is not 16.");
+    if (pow2.getNumBackEdges() != 3)
+        return fail("pow2(4) did not take 3 back edges.");
+
+    Interpreter div(*unit.getFunction("div"));
+    if (!div.run({ GenericValue::getInt(21), GenericValue::getInt(7) }, result))
+        return fail("div trapped.");
+    if (result.IntVal != 2)
+        return fail("div(21, 7) is not 2.");
+    if (div.run({ GenericValue::getInt(21), GenericValue::getInt(0) }, result))
+        return fail("div(21, 0) did not trap.");
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+
+#include "kaiju/IO/LineIndex.h"
+
+using namespace kaiju;
+
+#include <cstdio>
+
+namespace {
+
+// \brief Two lines, the last without a line break, ending in a null like
+// the buffers MemoryBuffer::read() returns.
+const char Source[] = "ab\ncd";
+
+int fail(const char *Message) {
+    std::fprintf(stderr, "LineIndexTest: %s\n", Message);
+    return 1;
+}
+
+} // end anonymous namespace
+
+int main() {
+    MemoryBuffer buffer(Source, Source + sizeof(Source));
+    LineIndex lines(buffer);
+
+    if (lines.getLineFromLoc(Source + 1).str() != "ab")
+        return fail("the first line is not ab.");
+
+    // The null is the end of the buffer, not a column of the last line.
+    if (lines.getLineFromLoc(Source + 4).str() != "cd")
+        return fail("the last line is not cd.");
+
+    if (lines.getLineAndColumn(Source + 4).first != 2)
+        return fail("cd is not on line 2.");
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+
+#include "kaiju/Parse/Lexer.h"
+
+using namespace kaiju;
+
+#include <cstdio>
+#include <cstring>
+#include <optional>
+
+#include "kaiju/IR/IR.h"
+#include "kaiju/Support/DiagnosticConsumer.h"
+#include "kaiju/Support/DiagnosticEngine.h"
+
+namespace {
+
+// \brief Sources which must lex without a diagnostic, one character literal
+// after another.
+const char *const CharacterLiterals[] = {
+    "'a'\n",
+    "'a' 'b'\n'c'",
+    "'\\n' '\\'' '\\\\' x",
+};
+
+// \brief Counts the diagnostics reported.
+class CountingConsumer : public DiagnosticConsumer {
+public:
+    unsigned Count = 0;
+
+    void handleDiagnostic(const TranslationUnit &, const Diagnostic &) override {
+        ++Count;
+    }
+};
+
+// \brief Lexes \p Buffer, which ends in a null like the buffers
+// MemoryBuffer::read() returns, and returns the number of diagnostics.
+unsigned lex(const char *Name, MemoryBuffer &Buffer) {
+    Path path(Name);
+    TranslationUnit unit(path, Buffer);
+    CountingConsumer consumer;
+    DiagnosticEngine engine(consumer);
+    DiagnosticBuilder db(unit, engine);
+
+    Lexer lexer(unit, db, getGlobalContext().Identifiers);
+    for (Token tok = lexer.scan(); tok.isNot(tok::eof); tok = lexer.scan())
+        ;
+    engine.emitDiagnostics();
+    return consumer.Count;
+}
+
+int fail(const char *Message, const char *Source) {
+    std::fprintf(stderr, "LexerTest: %s: %s\n", Message, Source);
+    return 1;
+}
+
+} // end anonymous namespace
+
+// The samples to lex are given on the command line, samples/sample0.kju
+// when run from the top of the tree without any.
+int main(int argc, char const *argv[]) {
+    for (const char *Source : CharacterLiterals) {
+        MemoryBuffer buffer(Source, Source + std::strlen(Source) + 1);
+        if (lex("literal", buffer) != 0)
+            return fail("diagnostics reported", Source);
+    }
+
+    const char *defaultSample = "samples/sample0.kju";
+    const char *const *first = argc > 1 ? argv + 1 : &defaultSample;
+    const char *const *last = argc > 1 ? argv + argc : &defaultSample + 1;
+    for (const char *const *I = first; I != last; ++I) {
+        std::optional<MemoryBuffer> buffer = MemoryBuffer::read(*I);
+        if (!buffer)
+            return fail("cannot read sample", *I);
+        if (lex(*I, *buffer) != 0)
+            return fail("diagnostics reported", *I);
+    }
+
+    return 0;
+}
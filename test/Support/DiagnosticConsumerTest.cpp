@@ -0,0 +1,60 @@
+
+#include "kaiju/Support/DiagnosticConsumer.h"
+
+using namespace kaiju;
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "kaiju/IR/IR.h"
+#include "kaiju/Parse/Lexer.h"
+#include "kaiju/Support/DiagnosticEngine.h"
+
+namespace {
+
+// \brief A byte which cannot start a UTF-8 sequence, lexed as a malformed
+// character whose argument is that byte.
+const char Source[] = "\x94";
+
+// \brief A file name in well-formed UTF-8, which must be kept as it is.
+const char FileName[] = "caf\xC3\xA9.kju";
+
+int fail(const char *Message, const std::string &Output) {
+    std::fprintf(stderr, "DiagnosticConsumerTest: %s\n%s", Message,
+                 Output.c_str());
+    return 1;
+}
+
+} // end anonymous namespace
+
+int main() {
+    std::string output;
+    {
+        Path path(FileName);
+        MemoryBuffer buffer(Source, Source + sizeof(Source));
+        TranslationUnit unit(path, buffer);
+        raw_string_ostream os(output);
+        JSONDiagnosticPrinter printer(os);
+        DiagnosticEngine engine(printer);
+        DiagnosticBuilder db(unit, engine);
+
+        Lexer lexer(unit, db, getGlobalContext().Identifiers);
+        for (Token tok = lexer.scan(); tok.isNot(tok::eof); tok = lexer.scan())
+            ;
+        engine.emitDiagnostics();
+    }
+
+    if (output.find("\"args\":[\"\\uFFFD\"]") == std::string::npos)
+        return fail("the byte argument was not replaced.", output);
+
+    // The message quotes the byte too; it must not appear raw anywhere.
+    if (output.find('\x94') != std::string::npos)
+        return fail("a byte of malformed UTF-8 was copied.", output);
+
+    std::string file = std::string("\"file\":\"") + FileName + "\"";
+    if (output.find(file) == std::string::npos)
+        return fail("well-formed UTF-8 was not kept.", output);
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+
+#include "kaiju/Transforms/SCCP.h"
+
+using namespace kaiju;
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include "kaiju/IR/IR.h"
+#include "kaiju/IR/IRParser.h"
+#include "kaiju/IR/IRPrinter.h"
+
+namespace {
+
+// \brief A loop over a variable that is never initialized, as mem2reg leaves
+// it. The loop condition is never defined, yet both blocks after the entry
+// are reachable and must survive.
+const char *const UndefLoop =
+    "define i32 @f(i32 %a) {\n"
+    "entry:\n"
+    "  br label %loop\n"
+    "loop:\n"
+    "  %0 = phi i32 [ undef, %entry ], [ %0, %loop ]\n"
+    "  %1 = icmp eq i32 %0, 0\n"
+    "  br i1 %1, label %loop, label %exit\n"
+    "exit:\n"
+    "  ret i32 %a\n"
+    "}\n";
+
+int fail(const char *Message) {
+    std::fprintf(stderr, "SCCPTest: %s\n", Message);
+    return 1;
+}
+
+} // end anonymous namespace
+
+int main() {
+    Context &C = getGlobalContext();
+    Path path("undef-loop");
+    MemoryBuffer buffer(nullptr, nullptr);
+    TranslationUnit unit(path, buffer);
+
+    std::string error;
+    if (!parseIR(UndefLoop, unit, C, error))
+        return fail(error.c_str());
+
+    Function *F = unit.getFunction("f");
+    runSCCP(*F);
+
+    if (F->size() != 3)
+        return fail("a reachable block was deleted.");
+
+    // Every successor must still be a block of the function.
+    for (BasicBlock *BB : *F)
+        for (unsigned i = 0, e = BB->getNumSuccessors(); i != e; ++i)
+            if (std::find(F->begin(), F->end(), BB->getSuccessor(i))
+                    == F->end())
+                return fail("a branch refers to a deleted block.");
+
+    std::string text;
+    {
+        raw_string_ostream os(text);
+        printFunction(*F, os);
+    }
+
+    Path againPath("undef-loop-again");
+    TranslationUnit again(againPath, buffer);
+    if (!parseIR(text, again, C, error))
+        return fail(error.c_str());
+
+    return 0;
+}